@@ -0,0 +1,579 @@
+// The sprite atlas, baked by --bake-atlas from the sprite recipes in source.cpp. Don't edit;
+// rebake after changing a sprite. Pixels are RGBA, run-length coded (see gfx::EncodeRuns).
+#pragma once
+
+namespace baked_atlas {
+
+constexpr int WIDTH = 256;
+constexpr int HEIGHT = 256;
+constexpr unsigned long long RECIPE_HASH = 0xE5B6BD028AB55D89ull;
+
+constexpr unsigned char RUNS[13551] = {
+    127,0,0,0,0,127,0,0,0,0,127,0,0,0,0,127,0,0,0,0,1,0,0,0,
+    0,99,0,0,0,255,25,0,0,0,0,133,230,41,55,16,230,41,55,64,230,41,55,128,
+    230,41,55,175,230,41,55,191,230,41,55,239,3,230,41,55,255,133,230,41,55,239,230,41,
+    55,191,230,41,55,175,230,41,55,128,230,41,55,64,230,41,55,16,39,0,0,0,0,131,
+    200,122,255,48,200,122,255,128,200,122,255,175,200,122,255,207,43,200,122,255,255,131,200,122,
+    255,207,200,122,255,175,200,122,255,128,200,122,255,48,21,0,0,0,0,99,0,0,0,255,
+    22,0,0,0,0,130,230,41,55,32,230,41,55,112,230,41,55,207,15,230,41,55,255,130,
+    230,41,55,207,230,41,55,112,230,41,55,32,33,0,0,0,0,130,200,122,255,32,200,122,
+    255,143,200,122,255,223,51,200,122,255,255,130,200,122,255,223,200,122,255,143,200,122,255,32,
+    18,0,0,0,0,99,0,0,0,255,20,0,0,0,0,129,230,41,55,64,230,41,55,175,
+    21,230,41,55,255,129,230,41,55,175,230,41,55,64,29,0,0,0,0,129,200,122,255,16,
+    200,122,255,159,57,200,122,255,255,129,200,122,255,159,200,122,255,16,16,0,0,0,0,99,
+    0,0,0,255,18,0,0,0,0,129,230,41,55,64,230,41,55,191,25,230,41,55,255,129,
+    230,41,55,191,230,41,55,64,26,0,0,0,0,129,200,122,255,80,200,122,255,239,59,200,
+    122,255,255,129,200,122,255,239,200,122,255,80,15,0,0,0,0,99,0,0,0,255,12,0,
+    0,0,0,41,0,121,241,255,19,0,0,0,0,128,200,122,255,159,63,200,122,255,255,128,
+    200,122,255,159,14,0,0,0,0,99,0,0,0,255,12,0,0,0,0,41,0,121,241,255,
+    17,0,0,0,0,129,200,122,255,16,200,122,255,191,65,200,122,255,255,129,200,122,255,191,
+    200,122,255,16,12,0,0,0,0,5,0,0,0,255,87,127,106,79,255,5,0,0,0,255,
+    12,0,0,0,0,41,0,121,241,255,17,0,0,0,0,128,200,122,255,191,67,200,122,255,
+    255,128,200,122,255,191,12,0,0,0,0,5,0,0,0,255,87,127,106,79,255,5,0,0,
+    0,255,12,0,0,0,0,41,0,121,241,255,16,0,0,0,0,128,200,122,255,159,69,200,
+    122,255,255,128,200,122,255,159,11,0,0,0,0,5,0,0,0,255,87,127,106,79,255,5,
+    0,0,0,255,11,0,0,0,0,128,230,41,55,16,41,0,121,241,255,128,230,41,55,16,
+    14,0,0,0,0,128,200,122,255,80,71,200,122,255,255,128,200,122,255,80,10,0,0,0,
+    0,5,0,0,0,255,87,127,106,79,255,5,0,0,0,255,10,0,0,0,0,129,230,41,
+    55,16,230,41,55,207,41,0,121,241,255,129,230,41,55,207,230,41,55,16,12,0,0,0,
+    0,129,200,122,255,16,200,122,255,239,71,200,122,255,255,129,200,122,255,239,200,122,255,16,
+    9,0,0,0,0,5,0,0,0,255,87,127,106,79,255,5,0,0,0,255,10,0,0,0,
+    0,129,230,41,55,207,230,41,55,255,14,0,121,241,255,11,253,249,0,255,14,0,121,241,
+    255,129,230,41,55,255,230,41,55,207,12,0,0,0,0,128,200,122,255,159,73,200,122,255,
+    255,128,200,122,255,159,9,0,0,0,0,5,0,0,0,255,87,127,106,79,255,5,0,0,
+    0,255,9,0,0,0,0,128,230,41,55,159,1,230,41,55,255,14,0,121,241,255,11,253,
+    249,0,255,14,0,121,241,255,1,230,41,55,255,128,230,41,55,159,10,0,0,0,0,128,
+    200,122,255,32,31,200,122,255,255,128,188,120,250,255,1,150,112,234,255,5,100,102,214,255,
+    1,150,112,234,255,128,188,120,250,255,31,200,122,255,255,128,200,122,255,32,8,0,0,0,
+    0,5,0,0,0,255,87,127,106,79,255,5,0,0,0,255,8,0,0,0,0,128,230,41,
+    55,96,2,230,41,55,255,14,0,121,241,255,11,253,249,0,255,14,0,121,241,255,2,230,
+    41,55,255,128,230,41,55,96,9,0,0,0,0,128,200,122,255,143,27,200,122,255,255,132,
+    163,115,239,255,100,102,214,255,57,99,198,255,10,86,177,255,9,87,177,255,1,32,105,193,
+    255,5,51,137,214,255,1,32,105,193,255,132,9,87,177,255,10,86,177,255,57,99,198,255,
+    100,102,214,255,163,115,239,255,27,200,122,255,255,128,200,122,255,143,8,0,0,0,0,5,
+    0,0,0,255,87,127,106,79,255,5,0,0,0,255,7,0,0,0,0,129,230,41,55,32,
+    230,41,55,239,2,230,41,55,255,14,0,121,241,255,11,253,249,0,255,14,0,121,241,255,
+    2,230,41,55,255,129,230,41,55,239,230,41,55,32,8,0,0,0,0,128,200,122,255,223,
+    24,200,122,255,255,134,163,115,239,255,85,101,208,255,20,90,182,255,25,98,188,255,47,128,
+    208,255,70,157,229,255,89,177,245,255,11,102,191,255,255,134,89,177,245,255,70,157,229,255,
+    47,128,208,255,25,98,188,255,20,90,182,255,85,101,208,255,163,115,239,255,24,200,122,255,
+    255,128,200,122,255,223,8,0,0,0,0,5,0,0,0,255,87,127,106,79,255,5,0,0,
+    0,255,6,0,0,0,0,20,0,82,172,255,11,253,249,0,255,20,0,82,172,255,6,0,
+    0,0,0,128,200,122,255,48,23,200,122,255,255,132,150,112,234,255,44,96,193,255,17,92,
+    182,255,57,143,219,255,89,177,245,255,19,102,191,255,255,132,89,177,245,255,57,143,219,255,
+    17,92,182,255,44,96,193,255,150,112,234,255,23,200,122,255,255,128,200,122,255,48,7,0,
+    0,0,0,5,0,0,0,255,87,127,106,79,255,5,0,0,0,255,6,0,0,0,0,20,
+    0,82,172,255,11,253,249,0,255,20,0,82,172,255,6,0,0,0,0,128,200,122,255,128,
+    21,200,122,255,255,131,163,115,239,255,44,96,193,255,32,105,193,255,70,157,229,255,25,102,
+    191,255,255,131,70,157,229,255,32,105,193,255,44,96,193,255,163,115,239,255,21,200,122,255,
+    255,128,200,122,255,128,7,0,0,0,0,5,0,0,0,255,3,127,106,79,255,79,0,0,
+    0,255,3,127,106,79,255,5,0,0,0,255,6,0,0,0,0,20,0,82,172,255,11,253,
+    249,0,255,20,0,82,172,255,6,0,0,0,0,128,200,122,255,175,20,200,122,255,255,130,
+    85,101,208,255,9,87,177,255,64,150,224,255,29,102,191,255,255,130,64,150,224,255,9,87,
+    177,255,85,101,208,255,20,200,122,255,255,128,200,122,255,175,7,0,0,0,0,5,0,0,
+    0,255,3,127,106,79,255,79,0,0,0,255,3,127,106,79,255,5,0,0,0,255,5,0,
+    0,0,0,128,230,41,55,64,20,0,82,172,255,11,253,249,0,255,20,0,82,172,255,128,
+    230,41,55,64,5,0,0,0,0,128,200,122,255,207,18,200,122,255,255,131,188,120,250,255,
+    34,92,188,255,36,113,198,255,96,184,250,255,31,102,191,255,255,131,96,184,250,255,36,113,
+    198,255,34,92,188,255,188,120,250,255,18,200,122,255,255,128,200,122,255,207,7,0,0,0,
+    0,5,0,0,0,255,3,127,106,79,255,79,0,0,0,255,3,127,106,79,255,5,0,0,
+    0,255,5,0,0,0,0,128,230,41,55,175,20,0,82,172,255,11,253,249,0,255,20,0,
+    82,172,255,128,230,41,55,175,5,0,0,0,0,18,200,122,255,255,130,163,115,239,255,10,
+    86,177,255,57,143,219,255,35,102,191,255,255,130,57,143,219,255,10,86,177,255,163,115,239,
+    255,18,200,122,255,255,7,0,0,0,0,5,0,0,0,255,3,127,106,79,255,79,0,0,
+    0,255,3,127,106,79,255,5,0,0,0,255,4,0,0,0,0,129,230,41,55,32,230,41,
+    55,255,20,0,82,172,255,11,253,249,0,255,20,0,82,172,255,129,230,41,55,255,230,41,
+    55,32,4,0,0,0,0,17,200,122,255,255,130,188,120,250,255,10,86,177,255,64,150,224,
+    255,37,102,191,255,255,130,64,150,224,255,10,86,177,255,188,120,250,255,17,200,122,255,255,
+    7,0,0,0,0,5,0,0,0,255,3,127,106,79,255,3,0,0,0,255,71,76,63,47,
+    255,3,0,0,0,255,3,127,106,79,255,5,0,0,0,255,4,0,0,0,0,129,230,41,
+    55,112,230,41,55,255,20,0,82,172,255,11,253,249,0,255,20,0,82,172,255,129,230,41,
+    55,255,230,41,55,112,4,0,0,0,0,17,200,122,255,255,129,34,92,188,255,57,143,219,
+    255,39,102,191,255,255,129,57,143,219,255,34,92,188,255,17,200,122,255,255,7,0,0,0,
+    0,5,0,0,0,255,3,127,106,79,255,3,0,0,0,255,71,76,63,47,255,3,0,0,
+    0,255,3,127,106,79,255,5,0,0,0,255,4,0,0,0,0,129,230,41,55,207,230,41,
+    55,255,20,0,82,172,255,11,253,249,0,255,20,0,82,172,255,129,230,41,55,255,230,41,
+    55,207,4,0,0,0,0,16,200,122,255,255,129,97,104,214,255,36,113,198,255,41,102,191,
+    255,255,129,36,113,198,255,97,104,214,255,16,200,122,255,255,7,0,0,0,0,5,0,0,
+    0,255,3,127,106,79,255,3,0,0,0,255,71,76,63,47,255,3,0,0,0,255,3,127,
+    106,79,255,5,0,0,0,255,3,0,0,0,0,128,230,41,55,16,1,230,41,55,255,53,
+    0,82,172,255,1,230,41,55,255,128,230,41,55,16,3,0,0,0,0,15,200,122,255,255,
+    130,175,117,245,255,9,87,177,255,96,184,250,255,41,102,191,255,255,130,96,184,250,255,9,
+    87,177,255,175,117,245,255,15,200,122,255,255,7,0,0,0,0,5,0,0,0,255,3,127,
+    106,79,255,3,0,0,0,255,71,76,63,47,255,3,0,0,0,255,3,127,106,79,255,5,
+    0,0,0,255,3,0,0,0,0,128,230,41,55,64,1,230,41,55,255,53,0,82,172,255,
+    1,230,41,55,255,128,230,41,55,64,3,0,0,0,0,15,200,122,255,255,129,85,101,208,
+    255,54,134,214,255,43,102,191,255,255,129,54,134,214,255,85,101,208,255,15,200,122,255,255,
+    7,0,0,0,0,5,0,0,0,255,3,127,106,79,255,3,0,0,0,255,71,76,63,47,
+    255,3,0,0,0,255,3,127,106,79,255,5,0,0,0,255,3,0,0,0,0,128,230,41,
+    55,128,7,230,41,55,255,41,0,121,241,255,7,230,41,55,255,128,230,41,55,128,3,0,
+    0,0,0,15,200,122,255,255,129,10,86,177,255,89,177,245,255,43,102,191,255,255,129,89,
+    177,245,255,10,86,177,255,15,200,122,255,255,7,0,0,0,0,5,0,0,0,255,3,127,
+    106,79,255,3,0,0,0,255,71,76,63,47,255,3,0,0,0,255,3,127,106,79,255,5,
+    0,0,0,255,3,0,0,0,0,128,230,41,55,175,7,230,41,55,255,41,0,121,241,255,
+    7,230,41,55,255,128,230,41,55,175,3,0,0,0,0,14,200,122,255,255,129,150,112,234,
+    255,25,98,188,255,45,102,191,255,255,129,25,98,188,255,150,112,234,255,14,200,122,255,255,
+    7,0,0,0,0,5,0,0,0,255,3,127,106,79,255,3,0,0,0,255,71,76,63,47,
+    255,3,0,0,0,255,3,127,106,79,255,5,0,0,0,255,3,0,0,0,0,128,230,41,
+    55,191,7,230,41,55,255,41,0,121,241,255,7,230,41,55,255,128,230,41,55,191,3,0,
+    0,0,0,14,200,122,255,255,129,113,105,219,255,41,121,203,255,45,102,191,255,255,129,41,
+    121,203,255,113,105,219,255,14,200,122,255,255,7,0,0,0,0,5,0,0,0,255,3,127,
+    106,79,255,3,0,0,0,255,71,76,63,47,255,3,0,0,0,255,3,127,106,79,255,5,
+    0,0,0,255,3,0,0,0,0,128,230,41,55,239,7,230,41,55,255,41,0,121,241,255,
+    7,230,41,55,255,128,230,41,55,239,3,0,0,0,0,14,200,122,255,255,129,100,102,214,
+    255,51,137,214,255,45,102,191,255,255,129,51,137,214,255,100,102,214,255,14,200,122,255,255,
+    7,0,0,0,0,5,0,0,0,255,3,127,106,79,255,3,0,0,0,255,71,76,63,47,
+    255,3,0,0,0,255,3,127,106,79,255,5,0,0,0,255,3,0,0,0,0,8,230,41,
+    55,255,41,0,121,241,255,8,230,41,55,255,3,0,0,0,0,14,200,122,255,255,129,100,
+    102,214,255,51,137,214,255,45,102,191,255,255,129,51,137,214,255,100,102,214,255,14,200,122,
+    255,255,7,0,0,0,0,5,0,0,0,255,3,127,106,79,255,3,0,0,0,255,71,76,
+    63,47,255,3,0,0,0,255,3,127,106,79,255,5,0,0,0,255,3,0,0,0,0,8,
+    230,41,55,255,41,0,121,241,255,8,230,41,55,255,3,0,0,0,0,14,200,122,255,255,
+    129,113,105,219,255,41,121,203,255,45,102,191,255,255,129,41,121,203,255,113,105,219,255,14,
+    200,122,255,255,7,0,0,0,0,5,0,0,0,255,3,127,106,79,255,3,0,0,0,255,
+    71,76,63,47,255,3,0,0,0,255,3,127,106,79,255,5,0,0,0,255,3,0,0,0,
+    0,8,230,41,55,255,41,0,121,241,255,8,230,41,55,255,3,0,0,0,0,14,200,122,
+    255,255,129,150,112,234,255,25,98,188,255,45,102,191,255,255,129,25,98,188,255,150,112,234,
+    255,14,200,122,255,255,7,0,0,0,0,5,0,0,0,255,3,127,106,79,255,3,0,0,
+    0,255,71,76,63,47,255,3,0,0,0,255,3,127,106,79,255,5,0,0,0,255,3,0,
+    0,0,0,8,230,41,55,255,41,0,121,241,255,8,230,41,55,255,3,0,0,0,0,15,
+    200,122,255,255,129,10,86,177,255,89,177,245,255,43,102,191,255,255,129,89,177,245,255,10,
+    86,177,255,15,200,122,255,255,7,0,0,0,0,5,0,0,0,255,3,127,106,79,255,3,
+    0,0,0,255,71,76,63,47,255,3,0,0,0,255,3,127,106,79,255,5,0,0,0,255,
+    3,0,0,0,0,8,230,41,55,255,41,0,121,241,255,8,230,41,55,255,3,0,0,0,
+    0,15,200,122,255,255,129,85,101,208,255,54,134,214,255,43,102,191,255,255,129,54,134,214,
+    255,85,101,208,255,15,200,122,255,255,7,0,0,0,0,5,0,0,0,255,3,127,106,79,
+    255,3,0,0,0,255,71,76,63,47,255,3,0,0,0,255,3,127,106,79,255,5,0,0,
+    0,255,3,0,0,0,0,8,230,41,55,255,41,0,121,241,255,8,230,41,55,255,3,0,
+    0,0,0,15,200,122,255,255,130,175,117,245,255,9,87,177,255,96,184,250,255,41,102,191,
+    255,255,130,96,184,250,255,9,87,177,255,175,117,245,255,15,200,122,255,255,7,0,0,0,
+    0,5,0,0,0,255,3,127,106,79,255,3,0,0,0,255,71,76,63,47,255,3,0,0,
+    0,255,3,127,106,79,255,5,0,0,0,255,3,0,0,0,0,59,230,41,55,255,3,0,
+    0,0,0,16,200,122,255,255,129,97,104,214,255,36,113,198,255,41,102,191,255,255,129,36,
+    113,198,255,97,104,214,255,16,200,122,255,255,7,0,0,0,0,5,0,0,0,255,3,127,
+    106,79,255,3,0,0,0,255,71,76,63,47,255,3,0,0,0,255,3,127,106,79,255,5,
+    0,0,0,255,3,0,0,0,0,59,230,41,55,255,3,0,0,0,0,17,200,122,255,255,
+    129,34,92,188,255,57,143,219,255,39,102,191,255,255,129,57,143,219,255,34,92,188,255,17,
+    200,122,255,255,7,0,0,0,0,5,0,0,0,255,3,127,106,79,255,3,0,0,0,255,
+    71,76,63,47,255,3,0,0,0,255,3,127,106,79,255,5,0,0,0,255,3,0,0,0,
+    0,11,230,41,55,255,35,0,82,172,255,11,230,41,55,255,3,0,0,0,0,17,200,122,
+    255,255,130,188,120,250,255,10,86,177,255,64,150,224,255,37,102,191,255,255,130,64,150,224,
+    255,10,86,177,255,188,120,250,255,17,200,122,255,255,7,0,0,0,0,5,0,0,0,255,
+    3,127,106,79,255,3,0,0,0,255,71,76,63,47,255,3,0,0,0,255,3,127,106,79,
+    255,5,0,0,0,255,3,0,0,0,0,11,230,41,55,255,35,0,82,172,255,11,230,41,
+    55,255,3,0,0,0,0,18,200,122,255,255,130,163,115,239,255,10,86,177,255,57,143,219,
+    255,35,102,191,255,255,130,57,143,219,255,10,86,177,255,163,115,239,255,18,200,122,255,255,
+    7,0,0,0,0,5,0,0,0,255,3,127,106,79,255,3,0,0,0,255,71,76,63,47,
+    255,3,0,0,0,255,3,127,106,79,255,5,0,0,0,255,3,0,0,0,0,11,230,41,
+    55,255,1,0,82,172,255,31,102,191,255,255,1,0,82,172,255,11,230,41,55,255,3,0,
+    0,0,0,19,200,122,255,255,131,188,120,250,255,34,92,188,255,36,113,198,255,96,184,250,
+    255,31,102,191,255,255,131,96,184,250,255,36,113,198,255,34,92,188,255,188,120,250,255,19,
+    200,122,255,255,7,0,0,0,0,5,0,0,0,255,3,127,106,79,255,3,0,0,0,255,
+    71,76,63,47,255,3,0,0,0,255,3,127,106,79,255,5,0,0,0,255,3,0,0,0,
+    0,11,230,41,55,255,1,0,82,172,255,31,102,191,255,255,1,0,82,172,255,11,230,41,
+    55,255,3,0,0,0,0,21,200,122,255,255,130,85,101,208,255,9,87,177,255,64,150,224,
+    255,29,102,191,255,255,130,64,150,224,255,9,87,177,255,85,101,208,255,21,200,122,255,255,
+    7,0,0,0,0,5,0,0,0,255,3,127,106,79,255,3,0,0,0,255,71,76,63,47,
+    255,3,0,0,0,255,3,127,106,79,255,5,0,0,0,255,3,0,0,0,0,11,230,41,
+    55,255,1,0,82,172,255,31,102,191,255,255,1,0,82,172,255,11,230,41,55,255,3,0,
+    0,0,0,22,200,122,255,255,131,163,115,239,255,44,96,193,255,32,105,193,255,70,157,229,
+    255,25,102,191,255,255,131,70,157,229,255,32,105,193,255,44,96,193,255,163,115,239,255,22,
+    200,122,255,255,7,0,0,0,0,5,0,0,0,255,3,127,106,79,255,3,0,0,0,255,
+    71,76,63,47,255,3,0,0,0,255,3,127,106,79,255,5,0,0,0,255,3,0,0,0,
+    0,11,230,41,55,255,1,0,82,172,255,31,102,191,255,255,1,0,82,172,255,11,230,41,
+    55,255,3,0,0,0,0,24,200,122,255,255,132,150,112,234,255,44,96,193,255,17,92,182,
+    255,57,143,219,255,89,177,245,255,19,102,191,255,255,132,89,177,245,255,57,143,219,255,17,
+    92,182,255,44,96,193,255,150,112,234,255,24,200,122,255,255,7,0,0,0,0,5,0,0,
+    0,255,3,127,106,79,255,3,0,0,0,255,71,76,63,47,255,3,0,0,0,255,3,127,
+    106,79,255,5,0,0,0,255,3,0,0,0,0,11,230,41,55,255,1,0,82,172,255,31,
+    102,191,255,255,1,0,82,172,255,11,230,41,55,255,3,0,0,0,0,26,200,122,255,255,
+    134,163,115,239,255,85,101,208,255,20,90,182,255,25,98,188,255,47,128,208,255,70,157,229,
+    255,89,177,245,255,11,102,191,255,255,134,89,177,245,255,70,157,229,255,47,128,208,255,25,
+    98,188,255,20,90,182,255,85,101,208,255,163,115,239,255,26,200,122,255,255,7,0,0,0,
+    0,5,0,0,0,255,3,127,106,79,255,3,0,0,0,255,71,76,63,47,255,3,0,0,
+    0,255,3,127,106,79,255,5,0,0,0,255,3,0,0,0,0,11,230,41,55,255,1,0,
+    82,172,255,31,102,191,255,255,1,0,82,172,255,11,230,41,55,255,3,0,0,0,0,29,
+    200,122,255,255,132,163,115,239,255,100,102,214,255,57,99,198,255,10,86,177,255,9,87,177,
+    255,1,32,105,193,255,5,51,137,214,255,1,32,105,193,255,132,9,87,177,255,10,86,177,
+    255,57,99,198,255,100,102,214,255,163,115,239,255,29,200,122,255,255,7,0,0,0,0,5,
+    0,0,0,255,3,127,106,79,255,3,0,0,0,255,71,76,63,47,255,3,0,0,0,255,
+    3,127,106,79,255,5,0,0,0,255,3,0,0,0,0,11,230,41,55,255,1,0,82,172,
+    255,31,102,191,255,255,1,0,82,172,255,11,230,41,55,255,3,0,0,0,0,33,200,122,
+    255,255,128,188,120,250,255,1,150,112,234,255,5,100,102,214,255,1,150,112,234,255,128,188,
+    120,250,255,33,200,122,255,255,7,0,0,0,0,5,0,0,0,255,3,127,106,79,255,3,
+    0,0,0,255,71,76,63,47,255,3,0,0,0,255,3,127,106,79,255,5,0,0,0,255,
+    3,0,0,0,0,11,230,41,55,255,1,0,82,172,255,31,102,191,255,255,1,0,82,172,
+    255,11,230,41,55,255,3,0,0,0,0,79,200,122,255,255,7,0,0,0,0,5,0,0,
+    0,255,3,127,106,79,255,3,0,0,0,255,71,76,63,47,255,3,0,0,0,255,3,127,
+    106,79,255,5,0,0,0,255,3,0,0,0,0,11,230,41,55,255,1,0,82,172,255,31,
+    102,191,255,255,1,0,82,172,255,11,230,41,55,255,3,0,0,0,0,79,200,122,255,255,
+    7,0,0,0,0,5,0,0,0,255,3,127,106,79,255,3,0,0,0,255,71,76,63,47,
+    255,3,0,0,0,255,3,127,106,79,255,5,0,0,0,255,3,0,0,0,0,11,230,41,
+    55,255,1,0,82,172,255,31,102,191,255,255,1,0,82,172,255,11,230,41,55,255,3,0,
+    0,0,0,79,200,122,255,255,7,0,0,0,0,5,0,0,0,255,3,127,106,79,255,3,
+    0,0,0,255,71,76,63,47,255,3,0,0,0,255,3,127,106,79,255,5,0,0,0,255,
+    3,0,0,0,0,11,230,41,55,255,1,0,82,172,255,31,102,191,255,255,1,0,82,172,
+    255,11,230,41,55,255,3,0,0,0,0,79,200,122,255,255,7,0,0,0,0,5,0,0,
+    0,255,3,127,106,79,255,3,0,0,0,255,71,76,63,47,255,3,0,0,0,255,3,127,
+    106,79,255,5,0,0,0,255,3,0,0,0,0,11,230,41,55,255,1,0,82,172,255,31,
+    102,191,255,255,1,0,82,172,255,11,230,41,55,255,3,0,0,0,0,79,200,122,255,255,
+    7,0,0,0,0,5,0,0,0,255,3,127,106,79,255,3,0,0,0,255,71,76,63,47,
+    255,3,0,0,0,255,3,127,106,79,255,5,0,0,0,255,3,0,0,0,0,11,230,41,
+    55,255,1,0,82,172,255,31,102,191,255,255,1,0,82,172,255,11,230,41,55,255,3,0,
+    0,0,0,79,200,122,255,255,7,0,0,0,0,5,0,0,0,255,3,127,106,79,255,3,
+    0,0,0,255,71,76,63,47,255,3,0,0,0,255,3,127,106,79,255,5,0,0,0,255,
+    3,0,0,0,0,11,230,41,55,255,1,0,82,172,255,31,102,191,255,255,1,0,82,172,
+    255,11,230,41,55,255,3,0,0,0,0,79,200,122,255,255,7,0,0,0,0,5,0,0,
+    0,255,3,127,106,79,255,3,0,0,0,255,71,76,63,47,255,3,0,0,0,255,3,127,
+    106,79,255,5,0,0,0,255,3,0,0,0,0,11,230,41,55,255,1,0,82,172,255,31,
+    102,191,255,255,1,0,82,172,255,11,230,41,55,255,3,0,0,0,0,79,200,122,255,255,
+    7,0,0,0,0,5,0,0,0,255,3,127,106,79,255,3,0,0,0,255,71,76,63,47,
+    255,3,0,0,0,255,3,127,106,79,255,5,0,0,0,255,3,0,0,0,0,11,230,41,
+    55,255,1,0,82,172,255,31,102,191,255,255,1,0,82,172,255,11,230,41,55,255,3,0,
+    0,0,0,79,200,122,255,255,7,0,0,0,0,5,0,0,0,255,3,127,106,79,255,3,
+    0,0,0,255,71,76,63,47,255,3,0,0,0,255,3,127,106,79,255,5,0,0,0,255,
+    3,0,0,0,0,11,230,41,55,255,1,0,82,172,255,31,102,191,255,255,1,0,82,172,
+    255,11,230,41,55,255,3,0,0,0,0,79,200,122,255,255,7,0,0,0,0,5,0,0,
+    0,255,3,127,106,79,255,3,0,0,0,255,71,76,63,47,255,3,0,0,0,255,3,127,
+    106,79,255,5,0,0,0,255,3,0,0,0,0,11,230,41,55,255,1,0,82,172,255,31,
+    102,191,255,255,1,0,82,172,255,11,230,41,55,255,3,0,0,0,0,79,200,122,255,255,
+    7,0,0,0,0,5,0,0,0,255,3,127,106,79,255,3,0,0,0,255,71,76,63,47,
+    255,3,0,0,0,255,3,127,106,79,255,5,0,0,0,255,3,0,0,0,0,11,230,41,
+    55,255,1,0,82,172,255,31,102,191,255,255,1,0,82,172,255,11,230,41,55,255,3,0,
+    0,0,0,79,200,122,255,255,7,0,0,0,0,5,0,0,0,255,3,127,106,79,255,3,
+    0,0,0,255,71,76,63,47,255,3,0,0,0,255,3,127,106,79,255,5,0,0,0,255,
+    3,0,0,0,0,11,230,41,55,255,1,0,82,172,255,31,102,191,255,255,1,0,82,172,
+    255,11,230,41,55,255,3,0,0,0,0,79,200,122,255,255,7,0,0,0,0,5,0,0,
+    0,255,3,127,106,79,255,3,0,0,0,255,71,76,63,47,255,3,0,0,0,255,3,127,
+    106,79,255,5,0,0,0,255,3,0,0,0,0,11,230,41,55,255,35,0,82,172,255,11,
+    230,41,55,255,3,0,0,0,0,79,200,122,255,255,7,0,0,0,0,5,0,0,0,255,
+    3,127,106,79,255,3,0,0,0,255,71,76,63,47,255,3,0,0,0,255,3,127,106,79,
+    255,5,0,0,0,255,3,0,0,0,0,11,230,41,55,255,35,0,82,172,255,11,230,41,
+    55,255,3,0,0,0,0,79,200,122,255,255,7,0,0,0,0,5,0,0,0,255,3,127,
+    106,79,255,3,0,0,0,255,71,76,63,47,255,3,0,0,0,255,3,127,106,79,255,5,
+    0,0,0,255,3,0,0,0,0,59,230,41,55,255,3,0,0,0,0,79,200,122,255,255,
+    7,0,0,0,0,5,0,0,0,255,3,127,106,79,255,3,0,0,0,255,71,76,63,47,
+    255,3,0,0,0,255,3,127,106,79,255,5,0,0,0,255,3,0,0,0,0,59,230,41,
+    55,255,3,0,0,0,0,79,200,122,255,255,7,0,0,0,0,5,0,0,0,255,3,127,
+    106,79,255,3,0,0,0,255,71,76,63,47,255,3,0,0,0,255,3,127,106,79,255,5,
+    0,0,0,255,3,0,0,0,0,59,230,41,55,255,3,0,0,0,0,79,200,122,255,255,
+    7,0,0,0,0,5,0,0,0,255,3,127,106,79,255,3,0,0,0,255,71,76,63,47,
+    255,3,0,0,0,255,3,127,106,79,255,5,0,0,0,255,3,0,0,0,0,59,230,41,
+    55,255,3,0,0,0,0,79,200,122,255,255,7,0,0,0,0,5,0,0,0,255,3,127,
+    106,79,255,3,0,0,0,255,71,76,63,47,255,3,0,0,0,255,3,127,106,79,255,5,
+    0,0,0,255,3,0,0,0,0,59,230,41,55,255,3,0,0,0,0,79,200,122,255,255,
+    7,0,0,0,0,5,0,0,0,255,3,127,106,79,255,3,0,0,0,255,71,76,63,47,
+    255,3,0,0,0,255,3,127,106,79,255,5,0,0,0,255,3,0,0,0,0,59,230,41,
+    55,255,3,0,0,0,0,79,200,122,255,255,7,0,0,0,0,5,0,0,0,255,3,127,
+    106,79,255,3,0,0,0,255,71,76,63,47,255,3,0,0,0,255,3,127,106,79,255,5,
+    0,0,0,255,3,0,0,0,0,59,230,41,55,255,3,0,0,0,0,79,200,122,255,255,
+    7,0,0,0,0,5,0,0,0,255,3,127,106,79,255,3,0,0,0,255,71,76,63,47,
+    255,3,0,0,0,255,3,127,106,79,255,5,0,0,0,255,3,0,0,0,0,59,230,41,
+    55,255,3,0,0,0,0,79,200,122,255,255,7,0,0,0,0,5,0,0,0,255,3,127,
+    106,79,255,3,0,0,0,255,71,76,63,47,255,3,0,0,0,255,3,127,106,79,255,5,
+    0,0,0,255,3,0,0,0,0,59,230,41,55,255,3,0,0,0,0,79,200,122,255,255,
+    7,0,0,0,0,5,0,0,0,255,3,127,106,79,255,3,0,0,0,255,71,76,63,47,
+    255,3,0,0,0,255,3,127,106,79,255,5,0,0,0,255,3,0,0,0,0,59,230,41,
+    55,255,3,0,0,0,0,79,200,122,255,255,7,0,0,0,0,5,0,0,0,255,3,127,
+    106,79,255,3,0,0,0,255,71,76,63,47,255,3,0,0,0,255,3,127,106,79,255,5,
+    0,0,0,255,3,0,0,0,0,59,230,41,55,255,3,0,0,0,0,79,200,122,255,255,
+    7,0,0,0,0,5,0,0,0,255,3,127,106,79,255,3,0,0,0,255,71,76,63,47,
+    255,3,0,0,0,255,3,127,106,79,255,5,0,0,0,255,3,0,0,0,0,59,230,41,
+    55,255,3,0,0,0,0,79,200,122,255,255,7,0,0,0,0,5,0,0,0,255,3,127,
+    106,79,255,3,0,0,0,255,71,76,63,47,255,3,0,0,0,255,3,127,106,79,255,5,
+    0,0,0,255,3,0,0,0,0,59,230,41,55,255,3,0,0,0,0,79,200,122,255,255,
+    7,0,0,0,0,5,0,0,0,255,3,127,106,79,255,3,0,0,0,255,71,76,63,47,
+    255,3,0,0,0,255,3,127,106,79,255,5,0,0,0,255,3,0,0,0,0,59,230,41,
+    55,255,3,0,0,0,0,79,200,122,255,255,7,0,0,0,0,5,0,0,0,255,3,127,
+    106,79,255,3,0,0,0,255,71,76,63,47,255,3,0,0,0,255,3,127,106,79,255,5,
+    0,0,0,255,3,0,0,0,0,59,230,41,55,255,3,0,0,0,0,79,200,122,255,255,
+    7,0,0,0,0,5,0,0,0,255,3,127,106,79,255,3,0,0,0,255,71,76,63,47,
+    255,3,0,0,0,255,3,127,106,79,255,5,0,0,0,255,3,0,0,0,0,59,230,41,
+    55,255,3,0,0,0,0,79,200,122,255,255,7,0,0,0,0,5,0,0,0,255,3,127,
+    106,79,255,79,0,0,0,255,3,127,106,79,255,5,0,0,0,255,3,0,0,0,0,59,
+    230,41,55,255,3,0,0,0,0,79,200,122,255,255,7,0,0,0,0,5,0,0,0,255,
+    3,127,106,79,255,79,0,0,0,255,3,127,106,79,255,5,0,0,0,255,3,0,0,0,
+    0,59,230,41,55,255,3,0,0,0,0,79,200,122,255,255,7,0,0,0,0,5,0,0,
+    0,255,3,127,106,79,255,79,0,0,0,255,3,127,106,79,255,5,0,0,0,255,3,0,
+    0,0,0,59,230,41,55,255,3,0,0,0,0,79,200,122,255,255,7,0,0,0,0,5,
+    0,0,0,255,3,127,106,79,255,79,0,0,0,255,3,127,106,79,255,5,0,0,0,255,
+    3,0,0,0,0,59,230,41,55,255,3,0,0,0,0,79,200,122,255,255,7,0,0,0,
+    0,5,0,0,0,255,87,127,106,79,255,5,0,0,0,255,3,0,0,0,0,59,230,41,
+    55,255,3,0,0,0,0,79,200,122,255,255,7,0,0,0,0,5,0,0,0,255,87,127,
+    106,79,255,5,0,0,0,255,3,0,0,0,0,59,230,41,55,255,3,0,0,0,0,79,
+    200,122,255,255,7,0,0,0,0,5,0,0,0,255,87,127,106,79,255,5,0,0,0,255,
+    3,0,0,0,0,59,230,41,55,255,3,0,0,0,0,128,200,122,255,207,77,200,122,255,
+    255,128,200,122,255,207,7,0,0,0,0,5,0,0,0,255,87,127,106,79,255,5,0,0,
+    0,255,3,0,0,0,0,59,230,41,55,255,3,0,0,0,0,128,200,122,255,175,77,200,
+    122,255,255,128,200,122,255,175,7,0,0,0,0,5,0,0,0,255,87,127,106,79,255,5,
+    0,0,0,255,3,0,0,0,0,59,230,41,55,255,3,0,0,0,0,128,200,122,255,128,
+    77,200,122,255,255,128,200,122,255,128,7,0,0,0,0,5,0,0,0,255,87,127,106,79,
+    255,5,0,0,0,255,3,0,0,0,0,59,230,41,55,255,3,0,0,0,0,128,200,122,
+    255,48,77,200,122,255,255,128,200,122,255,48,7,0,0,0,0,5,0,0,0,255,87,127,
+    106,79,255,5,0,0,0,255,3,0,0,0,0,128,230,41,55,239,57,230,41,55,255,128,
+    230,41,55,239,4,0,0,0,0,128,200,122,255,223,75,200,122,255,255,128,200,122,255,223,
+    8,0,0,0,0,5,0,0,0,255,87,127,106,79,255,5,0,0,0,255,3,0,0,0,
+    0,128,230,41,55,191,57,230,41,55,255,128,230,41,55,191,4,0,0,0,0,128,200,122,
+    255,143,75,200,122,255,255,128,200,122,255,143,8,0,0,0,0,5,0,0,0,255,3,127,
+    106,79,255,79,0,0,0,255,3,127,106,79,255,5,0,0,0,255,3,0,0,0,0,128,
+    230,41,55,175,57,230,41,55,255,128,230,41,55,175,4,0,0,0,0,128,200,122,255,32,
+    75,200,122,255,255,128,200,122,255,32,8,0,0,0,0,5,0,0,0,255,3,127,106,79,
+    255,79,0,0,0,255,3,127,106,79,255,5,0,0,0,255,3,0,0,0,0,128,230,41,
+    55,128,57,230,41,55,255,128,230,41,55,128,5,0,0,0,0,128,200,122,255,159,73,200,
+    122,255,255,128,200,122,255,159,9,0,0,0,0,5,0,0,0,255,3,127,106,79,255,79,
+    0,0,0,255,3,127,106,79,255,5,0,0,0,255,3,0,0,0,0,128,230,41,55,64,
+    57,230,41,55,255,128,230,41,55,64,5,0,0,0,0,129,200,122,255,16,200,122,255,239,
+    71,200,122,255,255,129,200,122,255,239,200,122,255,16,9,0,0,0,0,5,0,0,0,255,
+    3,127,106,79,255,79,0,0,0,255,3,127,106,79,255,5,0,0,0,255,3,0,0,0,
+    0,128,230,41,55,16,57,230,41,55,255,128,230,41,55,16,6,0,0,0,0,128,200,122,
+    255,80,71,200,122,255,255,128,200,122,255,80,10,0,0,0,0,5,0,0,0,255,3,127,
+    106,79,255,3,0,0,0,255,71,76,63,47,255,3,0,0,0,255,3,127,106,79,255,5,
+    0,0,0,255,4,0,0,0,0,128,230,41,55,207,55,230,41,55,255,128,230,41,55,207,
+    8,0,0,0,0,128,200,122,255,159,69,200,122,255,255,128,200,122,255,159,11,0,0,0,
+    0,5,0,0,0,255,3,127,106,79,255,3,0,0,0,255,71,76,63,47,255,3,0,0,
+    0,255,3,127,106,79,255,5,0,0,0,255,4,0,0,0,0,128,230,41,55,112,55,230,
+    41,55,255,128,230,41,55,112,9,0,0,0,0,128,200,122,255,191,67,200,122,255,255,128,
+    200,122,255,191,12,0,0,0,0,5,0,0,0,255,3,127,106,79,255,3,0,0,0,255,
+    71,76,63,47,255,3,0,0,0,255,3,127,106,79,255,5,0,0,0,255,4,0,0,0,
+    0,128,230,41,55,32,55,230,41,55,255,128,230,41,55,32,9,0,0,0,0,129,200,122,
+    255,16,200,122,255,191,65,200,122,255,255,129,200,122,255,191,200,122,255,16,12,0,0,0,
+    0,5,0,0,0,255,3,127,106,79,255,3,0,0,0,255,71,76,63,47,255,3,0,0,
+    0,255,3,127,106,79,255,5,0,0,0,255,5,0,0,0,0,128,230,41,55,175,53,230,
+    41,55,255,128,230,41,55,175,12,0,0,0,0,128,200,122,255,159,63,200,122,255,255,128,
+    200,122,255,159,14,0,0,0,0,5,0,0,0,255,3,127,106,79,255,3,0,0,0,255,
+    71,76,63,47,255,3,0,0,0,255,3,127,106,79,255,5,0,0,0,255,5,0,0,0,
+    0,128,230,41,55,64,53,230,41,55,255,128,230,41,55,64,13,0,0,0,0,129,200,122,
+    255,102,200,122,255,254,59,200,122,255,255,129,200,122,255,254,200,122,255,102,15,0,0,0,
+    0,5,0,0,0,255,3,127,106,79,255,3,0,0,0,255,71,76,63,47,255,3,0,0,
+    0,255,3,127,106,79,255,5,0,0,0,255,6,0,0,0,0,128,230,41,55,191,51,230,
+    41,55,255,128,230,41,55,191,15,0,0,0,0,128,200,122,255,106,59,200,122,255,255,128,
+    200,122,255,106,16,0,0,0,0,5,0,0,0,255,3,127,106,79,255,3,0,0,0,255,
+    71,76,63,47,255,3,0,0,0,255,3,127,106,79,255,5,0,0,0,255,6,0,0,0,
+    0,128,230,41,55,64,51,230,41,55,255,128,230,41,55,64,16,0,0,0,0,129,200,122,
+    255,96,200,122,255,241,55,200,122,255,255,129,200,122,255,241,200,122,255,96,17,0,0,0,
+    0,5,0,0,0,255,3,127,106,79,255,3,0,0,0,255,71,76,63,47,255,3,0,0,
+    0,255,3,127,106,79,255,5,0,0,0,255,7,0,0,0,0,128,230,41,55,175,49,230,
+    41,55,255,128,230,41,55,175,18,0,0,0,0,130,200,122,255,32,200,122,255,143,200,122,
+    255,207,51,200,122,255,255,130,200,122,255,207,200,122,255,143,200,122,255,32,18,0,0,0,
+    0,5,0,0,0,255,3,127,106,79,255,3,0,0,0,255,71,76,63,47,255,3,0,0,
+    0,255,3,127,106,79,255,5,0,0,0,255,7,0,0,0,0,129,230,41,55,32,230,41,
+    55,239,47,230,41,55,255,129,230,41,55,239,230,41,55,32,95,0,0,0,0,5,0,0,
+    0,255,3,127,106,79,255,3,0,0,0,255,71,76,63,47,255,3,0,0,0,255,3,127,
+    106,79,255,5,0,0,0,255,8,0,0,0,0,128,230,41,55,96,47,230,41,55,255,128,
+    230,41,55,96,96,0,0,0,0,5,0,0,0,255,3,127,106,79,255,3,0,0,0,255,
+    71,76,63,47,255,3,0,0,0,255,3,127,106,79,255,5,0,0,0,255,9,0,0,0,
+    0,128,230,41,55,159,45,230,41,55,255,128,230,41,55,159,97,0,0,0,0,5,0,0,
+    0,255,3,127,106,79,255,3,0,0,0,255,71,76,63,47,255,3,0,0,0,255,3,127,
+    106,79,255,5,0,0,0,255,10,0,0,0,0,128,230,41,55,207,43,230,41,55,255,128,
+    230,41,55,207,98,0,0,0,0,5,0,0,0,255,3,127,106,79,255,3,0,0,0,255,
+    71,76,63,47,255,3,0,0,0,255,3,127,106,79,255,5,0,0,0,255,10,0,0,0,
+    0,129,230,41,55,16,230,41,55,207,41,230,41,55,255,129,230,41,55,207,230,41,55,16,
+    98,0,0,0,0,5,0,0,0,255,3,127,106,79,255,3,0,0,0,255,71,76,63,47,
+    255,3,0,0,0,255,3,127,106,79,255,5,0,0,0,255,11,0,0,0,0,129,230,41,
+    55,16,230,41,55,207,39,230,41,55,255,129,230,41,55,207,230,41,55,16,99,0,0,0,
+    0,5,0,0,0,255,3,127,106,79,255,3,0,0,0,255,71,76,63,47,255,3,0,0,
+    0,255,3,127,106,79,255,5,0,0,0,255,12,0,0,0,0,129,230,41,55,16,230,41,
+    55,207,37,230,41,55,255,129,230,41,55,207,230,41,55,16,100,0,0,0,0,5,0,0,
+    0,255,3,127,106,79,255,3,0,0,0,255,71,76,63,47,255,3,0,0,0,255,3,127,
+    106,79,255,5,0,0,0,255,14,0,0,0,0,128,230,41,55,159,35,230,41,55,255,128,
+    230,41,55,159,102,0,0,0,0,5,0,0,0,255,3,127,106,79,255,3,0,0,0,255,
+    71,76,63,47,255,3,0,0,0,255,3,127,106,79,255,5,0,0,0,255,15,0,0,0,
+    0,129,230,41,55,96,230,41,55,239,31,230,41,55,255,129,230,41,55,239,230,41,55,96,
+    103,0,0,0,0,5,0,0,0,255,3,127,106,79,255,3,0,0,0,255,71,76,63,47,
+    255,3,0,0,0,255,3,127,106,79,255,5,0,0,0,255,16,0,0,0,0,129,230,41,
+    55,32,230,41,55,175,29,230,41,55,255,129,230,41,55,175,230,41,55,32,104,0,0,0,
+    0,5,0,0,0,255,3,127,106,79,255,3,0,0,0,255,71,76,63,47,255,3,0,0,
+    0,255,3,127,106,79,255,5,0,0,0,255,18,0,0,0,0,129,230,41,55,64,230,41,
+    55,191,25,230,41,55,255,129,230,41,55,191,230,41,55,64,106,0,0,0,0,5,0,0,
+    0,255,3,127,106,79,255,3,0,0,0,255,71,76,63,47,255,3,0,0,0,255,3,127,
+    106,79,255,5,0,0,0,255,20,0,0,0,0,129,230,41,55,64,230,41,55,175,21,230,
+    41,55,255,129,230,41,55,175,230,41,55,64,108,0,0,0,0,5,0,0,0,255,3,127,
+    106,79,255,3,0,0,0,255,71,76,63,47,255,3,0,0,0,255,3,127,106,79,255,5,
+    0,0,0,255,22,0,0,0,0,130,230,41,55,32,230,41,55,112,230,41,55,207,15,230,
+    41,55,255,130,230,41,55,207,230,41,55,112,230,41,55,32,110,0,0,0,0,5,0,0,
+    0,255,3,127,106,79,255,3,0,0,0,255,71,76,63,47,255,3,0,0,0,255,3,127,
+    106,79,255,5,0,0,0,255,25,0,0,0,0,133,230,41,55,16,230,41,55,64,230,41,
+    55,128,230,41,55,175,230,41,55,191,230,41,55,239,3,230,41,55,255,133,230,41,55,239,
+    230,41,55,191,230,41,55,175,230,41,55,128,230,41,55,64,230,41,55,16,113,0,0,0,
+    0,5,0,0,0,255,3,127,106,79,255,3,0,0,0,255,71,76,63,47,255,3,0,0,
+    0,255,3,127,106,79,255,5,0,0,0,255,127,0,0,0,0,27,0,0,0,0,5,0,
+    0,0,255,3,127,106,79,255,3,0,0,0,255,71,76,63,47,255,3,0,0,0,255,3,
+    127,106,79,255,5,0,0,0,255,127,0,0,0,0,27,0,0,0,0,5,0,0,0,255,
+    3,127,106,79,255,3,0,0,0,255,71,76,63,47,255,3,0,0,0,255,3,127,106,79,
+    255,5,0,0,0,255,127,0,0,0,0,27,0,0,0,0,5,0,0,0,255,3,127,106,
+    79,255,3,0,0,0,255,71,76,63,47,255,3,0,0,0,255,3,127,106,79,255,5,0,
+    0,0,255,127,0,0,0,0,27,0,0,0,0,5,0,0,0,255,3,127,106,79,255,3,
+    0,0,0,255,71,76,63,47,255,3,0,0,0,255,3,127,106,79,255,5,0,0,0,255,
+    127,0,0,0,0,27,0,0,0,0,5,0,0,0,255,3,127,106,79,255,3,0,0,0,
+    255,71,76,63,47,255,3,0,0,0,255,3,127,106,79,255,5,0,0,0,255,127,0,0,
+    0,0,27,0,0,0,0,5,0,0,0,255,3,127,106,79,255,3,0,0,0,255,71,76,
+    63,47,255,3,0,0,0,255,3,127,106,79,255,5,0,0,0,255,127,0,0,0,0,27,
+    0,0,0,0,5,0,0,0,255,3,127,106,79,255,3,0,0,0,255,71,76,63,47,255,
+    3,0,0,0,255,3,127,106,79,255,5,0,0,0,255,127,0,0,0,0,27,0,0,0,
+    0,5,0,0,0,255,3,127,106,79,255,3,0,0,0,255,71,76,63,47,255,3,0,0,
+    0,255,3,127,106,79,255,5,0,0,0,255,127,0,0,0,0,27,0,0,0,0,5,0,
+    0,0,255,3,127,106,79,255,3,0,0,0,255,71,76,63,47,255,3,0,0,0,255,3,
+    127,106,79,255,5,0,0,0,255,127,0,0,0,0,27,0,0,0,0,5,0,0,0,255,
+    3,127,106,79,255,3,0,0,0,255,71,76,63,47,255,3,0,0,0,255,3,127,106,79,
+    255,5,0,0,0,255,127,0,0,0,0,27,0,0,0,0,5,0,0,0,255,3,127,106,
+    79,255,3,0,0,0,255,71,76,63,47,255,3,0,0,0,255,3,127,106,79,255,5,0,
+    0,0,255,127,0,0,0,0,27,0,0,0,0,5,0,0,0,255,3,127,106,79,255,3,
+    0,0,0,255,71,76,63,47,255,3,0,0,0,255,3,127,106,79,255,5,0,0,0,255,
+    127,0,0,0,0,27,0,0,0,0,5,0,0,0,255,3,127,106,79,255,3,0,0,0,
+    255,71,76,63,47,255,3,0,0,0,255,3,127,106,79,255,5,0,0,0,255,127,0,0,
+    0,0,27,0,0,0,0,5,0,0,0,255,3,127,106,79,255,3,0,0,0,255,71,76,
+    63,47,255,3,0,0,0,255,3,127,106,79,255,5,0,0,0,255,127,0,0,0,0,27,
+    0,0,0,0,5,0,0,0,255,3,127,106,79,255,3,0,0,0,255,71,76,63,47,255,
+    3,0,0,0,255,3,127,106,79,255,5,0,0,0,255,127,0,0,0,0,27,0,0,0,
+    0,5,0,0,0,255,3,127,106,79,255,3,0,0,0,255,71,76,63,47,255,3,0,0,
+    0,255,3,127,106,79,255,5,0,0,0,255,127,0,0,0,0,27,0,0,0,0,5,0,
+    0,0,255,3,127,106,79,255,3,0,0,0,255,71,76,63,47,255,3,0,0,0,255,3,
+    127,106,79,255,5,0,0,0,255,127,0,0,0,0,27,0,0,0,0,5,0,0,0,255,
+    3,127,106,79,255,3,0,0,0,255,71,76,63,47,255,3,0,0,0,255,3,127,106,79,
+    255,5,0,0,0,255,127,0,0,0,0,27,0,0,0,0,5,0,0,0,255,3,127,106,
+    79,255,3,0,0,0,255,71,76,63,47,255,3,0,0,0,255,3,127,106,79,255,5,0,
+    0,0,255,127,0,0,0,0,27,0,0,0,0,5,0,0,0,255,3,127,106,79,255,3,
+    0,0,0,255,71,76,63,47,255,3,0,0,0,255,3,127,106,79,255,5,0,0,0,255,
+    127,0,0,0,0,27,0,0,0,0,5,0,0,0,255,3,127,106,79,255,3,0,0,0,
+    255,71,76,63,47,255,3,0,0,0,255,3,127,106,79,255,5,0,0,0,255,127,0,0,
+    0,0,27,0,0,0,0,5,0,0,0,255,3,127,106,79,255,3,0,0,0,255,71,76,
+    63,47,255,3,0,0,0,255,3,127,106,79,255,5,0,0,0,255,127,0,0,0,0,27,
+    0,0,0,0,5,0,0,0,255,3,127,106,79,255,3,0,0,0,255,71,76,63,47,255,
+    3,0,0,0,255,3,127,106,79,255,5,0,0,0,255,127,0,0,0,0,27,0,0,0,
+    0,5,0,0,0,255,3,127,106,79,255,3,0,0,0,255,71,76,63,47,255,3,0,0,
+    0,255,3,127,106,79,255,5,0,0,0,255,127,0,0,0,0,27,0,0,0,0,5,0,
+    0,0,255,3,127,106,79,255,3,0,0,0,255,71,76,63,47,255,3,0,0,0,255,3,
+    127,106,79,255,5,0,0,0,255,127,0,0,0,0,27,0,0,0,0,5,0,0,0,255,
+    3,127,106,79,255,79,0,0,0,255,3,127,106,79,255,5,0,0,0,255,127,0,0,0,
+    0,27,0,0,0,0,5,0,0,0,255,3,127,106,79,255,79,0,0,0,255,3,127,106,
+    79,255,5,0,0,0,255,127,0,0,0,0,27,0,0,0,0,5,0,0,0,255,3,127,
+    106,79,255,79,0,0,0,255,3,127,106,79,255,5,0,0,0,255,127,0,0,0,0,27,
+    0,0,0,0,5,0,0,0,255,3,127,106,79,255,79,0,0,0,255,3,127,106,79,255,
+    5,0,0,0,255,127,0,0,0,0,27,0,0,0,0,5,0,0,0,255,87,127,106,79,
+    255,5,0,0,0,255,127,0,0,0,0,27,0,0,0,0,5,0,0,0,255,87,127,106,
+    79,255,5,0,0,0,255,127,0,0,0,0,27,0,0,0,0,5,0,0,0,255,87,127,
+    106,79,255,5,0,0,0,255,127,0,0,0,0,27,0,0,0,0,5,0,0,0,255,87,
+    127,106,79,255,5,0,0,0,255,127,0,0,0,0,27,0,0,0,0,5,0,0,0,255,
+    87,127,106,79,255,5,0,0,0,255,127,0,0,0,0,27,0,0,0,0,5,0,0,0,
+    255,87,127,106,79,255,5,0,0,0,255,127,0,0,0,0,27,0,0,0,0,5,0,0,
+    0,255,87,127,106,79,255,5,0,0,0,255,127,0,0,0,0,27,0,0,0,0,5,0,
+    0,0,255,87,127,106,79,255,5,0,0,0,255,127,0,0,0,0,27,0,0,0,0,5,
+    0,0,0,255,87,127,106,79,255,5,0,0,0,255,127,0,0,0,0,27,0,0,0,0,
+    5,0,0,0,255,87,127,106,79,255,5,0,0,0,255,127,0,0,0,0,27,0,0,0,
+    0,99,0,0,0,255,127,0,0,0,0,27,0,0,0,0,99,0,0,0,255,127,0,0,
+    0,0,27,0,0,0,0,99,0,0,0,255,127,0,0,0,0,27,0,0,0,0,99,0,
+    0,0,255,127,0,0,0,0,27,0,0,0,0,99,0,0,0,255,127,0,0,0,0,27,
+    0,0,0,0,99,0,0,0,255,127,0,0,0,0,127,0,0,0,0,127,0,0,0,0,
+    127,0,0,0,0,127,0,0,0,0,127,0,0,0,0,127,0,0,0,0,127,0,0,0,
+    0,127,0,0,0,0,51,0,0,0,0,130,255,215,0,32,255,215,0,80,255,215,0,128,
+    1,255,215,0,191,128,255,215,0,239,3,255,215,0,255,128,255,215,0,239,1,255,215,0,
+    191,130,255,215,0,128,255,215,0,80,255,215,0,32,127,0,0,0,0,108,0,0,0,0,
+    130,255,215,0,48,255,215,0,143,255,215,0,223,15,255,215,0,255,130,255,215,0,223,255,
+    215,0,143,255,215,0,48,127,0,0,0,0,102,0,0,0,0,130,255,215,0,16,255,215,
+    0,112,255,215,0,223,21,255,215,0,255,130,255,215,0,223,255,215,0,112,255,215,0,16,
+    127,0,0,0,0,97,0,0,0,0,130,255,215,0,16,255,215,0,128,255,215,0,239,25,
+    255,215,0,255,130,255,215,0,239,255,215,0,128,255,215,0,16,127,0,0,0,0,94,0,
+    0,0,0,129,255,215,0,112,255,215,0,239,29,255,215,0,255,129,255,215,0,239,255,215,
+    0,112,127,0,0,0,0,91,0,0,0,0,129,255,215,0,32,255,215,0,191,33,255,215,
+    0,255,129,255,215,0,191,255,215,0,32,127,0,0,0,0,88,0,0,0,0,129,255,215,
+    0,96,255,215,0,239,35,255,215,0,255,129,255,215,0,239,255,215,0,96,127,0,0,0,
+    0,86,0,0,0,0,128,255,215,0,159,39,255,215,0,255,128,255,215,0,159,127,0,0,
+    0,0,84,0,0,0,0,128,255,215,0,159,41,255,215,0,255,128,255,215,0,159,127,0,
+    0,0,0,82,0,0,0,0,128,255,215,0,207,43,255,215,0,255,128,255,215,0,207,127,
+    0,0,0,0,80,0,0,0,0,128,255,215,0,159,45,255,215,0,255,128,255,215,0,159,
+    127,0,0,0,0,78,0,0,0,0,128,255,215,0,159,47,255,215,0,255,128,255,215,0,
+    159,127,0,0,0,0,76,0,0,0,0,128,255,215,0,96,49,255,215,0,255,128,255,215,
+    0,96,127,0,0,0,0,74,0,0,0,0,129,255,215,0,32,255,215,0,239,49,255,215,
+    0,255,129,255,215,0,239,255,215,0,32,127,0,0,0,0,73,0,0,0,0,128,255,215,
+    0,191,51,255,215,0,255,128,255,215,0,191,127,0,0,0,0,72,0,0,0,0,128,255,
+    215,0,112,53,255,215,0,255,128,255,215,0,112,127,0,0,0,0,70,0,0,0,0,129,
+    255,215,0,16,255,215,0,239,11,255,215,0,255,129,207,175,0,255,112,94,0,255,1,64,
+    54,0,255,129,112,94,0,255,207,175,0,255,16,255,215,0,255,129,207,175,0,255,112,94,
+    0,255,1,64,54,0,255,129,112,94,0,255,207,175,0,255,12,255,215,0,255,129,255,215,
+    0,239,255,215,0,16,127,0,0,0,0,69,0,0,0,0,128,255,215,0,128,11,255,215,
+    0,255,128,112,94,0,255,5,0,0,0,255,128,112,94,0,255,14,255,215,0,255,128,112,
+    94,0,255,5,0,0,0,255,128,112,94,0,255,12,255,215,0,255,128,255,215,0,128,127,
+    0,0,0,0,68,0,0,0,0,129,255,215,0,16,255,215,0,239,10,255,215,0,255,128,
+    112,94,0,255,7,0,0,0,255,128,112,94,0,255,12,255,215,0,255,128,112,94,0,255,
+    7,0,0,0,255,128,112,94,0,255,11,255,215,0,255,129,255,215,0,239,255,215,0,16,
+    127,0,0,0,0,67,0,0,0,0,128,255,215,0,112,10,255,215,0,255,128,207,175,0,
+    255,9,0,0,0,255,128,207,175,0,255,10,255,215,0,255,128,207,175,0,255,9,0,0,
+    0,255,128,207,175,0,255,11,255,215,0,255,128,255,215,0,112,127,0,0,0,0,67,0,
+    0,0,0,128,255,215,0,223,10,255,215,0,255,128,112,94,0,255,9,0,0,0,255,128,
+    112,94,0,255,10,255,215,0,255,128,112,94,0,255,9,0,0,0,255,128,112,94,0,255,
+    11,255,215,0,255,128,255,215,0,223,127,0,0,0,0,66,0,0,0,0,128,255,215,0,
+    48,11,255,215,0,255,128,64,54,0,255,9,0,0,0,255,128,64,54,0,255,10,255,215,
+    0,255,128,64,54,0,255,9,0,0,0,255,128,64,54,0,255,12,255,215,0,255,128,255,
+    215,0,48,127,0,0,0,0,65,0,0,0,0,128,255,215,0,143,11,255,215,0,255,128,
+    64,54,0,255,9,0,0,0,255,128,64,54,0,255,10,255,215,0,255,128,64,54,0,255,
+    9,0,0,0,255,128,64,54,0,255,12,255,215,0,255,128,255,215,0,143,127,0,0,0,
+    0,65,0,0,0,0,128,255,215,0,223,11,255,215,0,255,128,112,94,0,255,9,0,0,
+    0,255,128,112,94,0,255,10,255,215,0,255,128,112,94,0,255,9,0,0,0,255,128,112,
+    94,0,255,12,255,215,0,255,128,255,215,0,223,127,0,0,0,0,64,0,0,0,0,128,
+    255,215,0,32,12,255,215,0,255,128,207,175,0,255,9,0,0,0,255,128,207,175,0,255,
+    10,255,215,0,255,128,207,175,0,255,9,0,0,0,255,128,207,175,0,255,13,255,215,0,
+    255,128,255,215,0,32,127,0,0,0,0,63,0,0,0,0,128,255,215,0,80,13,255,215,
+    0,255,128,112,94,0,255,7,0,0,0,255,128,112,94,0,255,12,255,215,0,255,128,112,
+    94,0,255,7,0,0,0,255,128,112,94,0,255,14,255,215,0,255,128,255,215,0,80,127,
+    0,0,0,0,63,0,0,0,0,128,255,215,0,128,14,255,215,0,255,128,112,94,0,255,
+    5,0,0,0,255,128,112,94,0,255,14,255,215,0,255,128,112,94,0,255,5,0,0,0,
+    255,128,112,94,0,255,15,255,215,0,255,128,255,215,0,128,127,0,0,0,0,63,0,0,
+    0,0,128,255,215,0,191,15,255,215,0,255,129,207,175,0,255,112,94,0,255,1,64,54,
+    0,255,129,112,94,0,255,207,175,0,255,16,255,215,0,255,129,207,175,0,255,112,94,0,
+    255,1,64,54,0,255,129,112,94,0,255,207,175,0,255,16,255,215,0,255,128,255,215,0,
+    191,127,0,0,0,0,63,0,0,0,0,128,255,215,0,191,61,255,215,0,255,128,255,215,
+    0,191,127,0,0,0,0,63,0,0,0,0,128,255,215,0,239,61,255,215,0,255,128,255,
+    215,0,239,127,0,0,0,0,63,0,0,0,0,63,255,215,0,255,127,0,0,0,0,63,
+    0,0,0,0,63,255,215,0,255,127,0,0,0,0,63,0,0,0,0,63,255,215,0,255,
+    127,0,0,0,0,63,0,0,0,0,63,255,215,0,255,127,0,0,0,0,63,0,0,0,
+    0,128,255,215,0,239,61,255,215,0,255,128,255,215,0,239,127,0,0,0,0,63,0,0,
+    0,0,128,255,215,0,191,61,255,215,0,255,128,255,215,0,191,127,0,0,0,0,63,0,
+    0,0,0,128,255,215,0,191,61,255,215,0,255,128,255,215,0,191,127,0,0,0,0,63,
+    0,0,0,0,128,255,215,0,128,61,255,215,0,255,128,255,215,0,128,127,0,0,0,0,
+    63,0,0,0,0,128,255,215,0,80,61,255,215,0,255,128,255,215,0,80,127,0,0,0,
+    0,63,0,0,0,0,128,255,215,0,32,61,255,215,0,255,128,255,215,0,32,127,0,0,
+    0,0,64,0,0,0,0,128,255,215,0,223,59,255,215,0,255,128,255,215,0,223,127,0,
+    0,0,0,65,0,0,0,0,128,255,215,0,143,59,255,215,0,255,128,255,215,0,143,127,
+    0,0,0,0,65,0,0,0,0,128,255,215,0,48,59,255,215,0,255,128,255,215,0,48,
+    127,0,0,0,0,66,0,0,0,0,128,255,215,0,223,57,255,215,0,255,128,255,215,0,
+    223,127,0,0,0,0,67,0,0,0,0,128,255,215,0,112,57,255,215,0,255,128,255,215,
+    0,112,127,0,0,0,0,67,0,0,0,0,129,255,215,0,16,255,215,0,239,55,255,215,
+    0,255,129,255,215,0,239,255,215,0,16,127,0,0,0,0,68,0,0,0,0,128,255,215,
+    0,128,55,255,215,0,255,128,255,215,0,128,127,0,0,0,0,69,0,0,0,0,129,255,
+    215,0,16,255,215,0,239,53,255,215,0,255,129,255,215,0,239,255,215,0,16,127,0,0,
+    0,0,70,0,0,0,0,128,255,215,0,112,53,255,215,0,255,128,255,215,0,112,127,0,
+    0,0,0,72,0,0,0,0,128,255,215,0,191,51,255,215,0,255,128,255,215,0,191,127,
+    0,0,0,0,73,0,0,0,0,129,255,215,0,32,255,215,0,239,49,255,215,0,255,129,
+    255,215,0,239,255,215,0,32,127,0,0,0,0,74,0,0,0,0,128,255,215,0,96,49,
+    255,215,0,255,128,255,215,0,96,127,0,0,0,0,76,0,0,0,0,128,255,215,0,159,
+    47,255,215,0,255,128,255,215,0,159,127,0,0,0,0,78,0,0,0,0,128,255,215,0,
+    159,45,255,215,0,255,128,255,215,0,159,127,0,0,0,0,80,0,0,0,0,128,255,215,
+    0,207,43,255,215,0,255,128,255,215,0,207,127,0,0,0,0,82,0,0,0,0,128,255,
+    215,0,159,41,255,215,0,255,128,255,215,0,159,127,0,0,0,0,84,0,0,0,0,128,
+    255,215,0,159,39,255,215,0,255,128,255,215,0,159,127,0,0,0,0,86,0,0,0,0,
+    129,255,215,0,96,255,215,0,239,35,255,215,0,255,129,255,215,0,239,255,215,0,96,127,
+    0,0,0,0,88,0,0,0,0,129,255,215,0,32,255,215,0,191,33,255,215,0,255,129,
+    255,215,0,191,255,215,0,32,127,0,0,0,0,91,0,0,0,0,129,255,215,0,112,255,
+    215,0,239,29,255,215,0,255,129,255,215,0,239,255,215,0,112,127,0,0,0,0,94,0,
+    0,0,0,130,255,215,0,16,255,215,0,128,255,215,0,239,25,255,215,0,255,130,255,215,
+    0,239,255,215,0,128,255,215,0,16,127,0,0,0,0,97,0,0,0,0,130,255,215,0,
+    16,255,215,0,112,255,215,0,223,21,255,215,0,255,130,255,215,0,223,255,215,0,112,255,
+    215,0,16,127,0,0,0,0,102,0,0,0,0,130,255,215,0,48,255,215,0,143,255,215,
+    0,223,15,255,215,0,255,130,255,215,0,223,255,215,0,143,255,215,0,48,127,0,0,0,
+    0,108,0,0,0,0,130,255,215,0,32,255,215,0,80,255,215,0,128,1,255,215,0,191,
+    128,255,215,0,239,3,255,215,0,255,128,255,215,0,239,1,255,215,0,191,130,255,215,0,
+    128,255,215,0,80,255,215,0,32,127,0,0,0,0,127,0,0,0,0,127,0,0,0,0,
+    127,0,0,0,0,127,0,0,0,0,127,0,0,0,0,127,0,0,0,0,127,0,0,0,
+    0,127,0,0,0,0,127,0,0,0,0,127,0,0,0,0,127,0,0,0,0,127,0,0,
+    0,0,127,0,0,0,0,127,0,0,0,0,127,0,0,0,0,127,0,0,0,0,127,0,
+    0,0,0,127,0,0,0,0,127,0,0,0,0,127,0,0,0,0,127,0,0,0,0,127,
+    0,0,0,0,127,0,0,0,0,127,0,0,0,0,127,0,0,0,0,127,0,0,0,0,
+    127,0,0,0,0,127,0,0,0,0,127,0,0,0,0,127,0,0,0,0,127,0,0,0,
+    0,127,0,0,0,0,127,0,0,0,0,127,0,0,0,0,127,0,0,0,0,127,0,0,
+    0,0,127,0,0,0,0,127,0,0,0,0,127,0,0,0,0,127,0,0,0,0,127,0,
+    0,0,0,127,0,0,0,0,127,0,0,0,0,127,0,0,0,0,127,0,0,0,0,127,
+    0,0,0,0,127,0,0,0,0,127,0,0,0,0,127,0,0,0,0,127,0,0,0,0,
+    127,0,0,0,0,127,0,0,0,0,85,0,0,0,0,
+};
+
+} // namespace baked_atlas
@@ -1,1703 +1,9289 @@
-#include "raylib.h"
-#include <vector>
-#include <string>
-#include <random>
-#include <chrono>
-#include <algorithm>
-#include <memory>
-#include <queue>
-#include <iostream>
-#include <functional>
-
-const int GLOBAL_SCREEN_WIDTH = 1280;
-const int GLOBAL_SCREEN_HEIGHT = 720;
-
-// Variables for the starting screen's "suffer" message
-static bool showSufferMessage = false;
-static float sufferMessageTimer = 0.0f;
-const float SUFFER_MESSAGE_DISPLAY_TIME = 2.0f; // How long the message sticks around
-
-
-// The base class for all our game levels. Each level will inherit from this!
-class Levels {
-public:
-    Levels(int screenW, int screenH) : screenWidth(screenW), screenHeight(screenH) {}
-    virtual ~Levels() = default; // Important for proper cleanup of derived classes
-
-    virtual void Load() = 0;             // Get level-specific stuff ready
-    virtual void Unload() = 0;           // Clean up level-specific stuff
-    virtual void Update(float deltaTime) = 0; // Update game logic for the level
-    virtual void Draw() = 0;             // Draw everything in the level
-    virtual bool IsComplete() = 0;       // Check if the level is done (won or lost)
-    virtual std::string GetName() const = 0; 
-    virtual std::string GetInstructions() const = 0; 
-
-protected:
-    int screenWidth;
-    int screenHeight;
-};
-
-// function to keep values within a certain range
-std::function<float(float, float, float)> minmax = [](float value, float min_val, float max_val) -> float {
-    if (value < min_val) return min_val;
-    if (value > max_val) return max_val;
-    return value;
-};
-
-// Constants specific to the Maze Level
-const int MAZE_BASE_WIDTH_CELLS = 35;
-const int MAZE_BASE_HEIGHT_CELLS = 21;
-
-const Color MAZE_WALL_COLOR = { 128, 0, 128, 255 }; // Walls are purple
-const Color MAZE_PATH_COLOR = { 0, 0, 0, 255 };     // Paths are black
-const Color MAZE_PLAYER_COLOR = { 255, 215, 0, 255 }; // Player is gold
-const Color MAZE_PLAYER_EYE_COLOR = { 0, 0, 0, 255 }; // Player eyes are black
-const Color MAZE_COIN_COLOR = { 255, 193, 7, 255 };   // Coins are orange-yellow
-const Color MAZE_START_COLOR = { 0, 0, 0, 255 };     // Start is black
-const Color MAZE_END_COLOR = { 50, 205, 50, 255 };   // End is green
-const Color MAZE_TEXT_COLOR = { 245, 245, 245, 255 }; // Text is off-white
-
-// first level: the Maze
-class MazeLevel : public Levels {
-public:
-    MazeLevel(int screenW, int screenH);
-    ~MazeLevel() override;
-
-    void Load() override;
-    void Unload() override;
-    void Update(float deltaTime) override;
-    void Draw() override;
-    bool IsComplete() override;
-    std::string GetName() const override { return "Maze Level"; }
-    std::string GetInstructions() const override { return "Navigate the maze using ARROW keys. \n \n Collect all coins and reach the green exit to win."; }
-
-    void GenerateNewMazeStructure();
-
-private:
-    std::vector<std::vector<bool>> mazeGrid; // True means wall, false means path
-    int mazeWidthCells;
-    int mazeHeightCells;
-    float cellSizePixels;
-    int startCol, startRow;
-    int endCol, endRow;
-
-    float playerX, playerY;
-    float playerSize;
-    float playerSpeed;
-
-    std::vector<Vector2> coins;
-    int totalInitialCoins;
-    int collectedCoins;
-    float coinSize;
-    const float COIN_SPAWN_CHANCE = 0.3f; // Chance for a coin to appear in a path cell
-
-    bool levelWon;
-    bool mazeGeneratedForPreview; 
-
-    void InitMazeGrid();
-    void RecursiveGenerateMaze(int r, int c); 
-    bool CheckWallCollision(float px, float py, float pSize, float dx, float dy);
-    void ResetPlayerAndCoins();
-    void CalculateMazeDimensions(); 
-};
-
-// Random number generators for the maze
-static std::random_device s_maze_rd;
-static std::mt19937 s_maze_gen(s_maze_rd());
-static std::uniform_real_distribution<> s_maze_dis(0.0, 1.0);
-
-MazeLevel::MazeLevel(int screenW, int screenH)
-    : Levels(screenW, screenH),
-      mazeWidthCells(0), mazeHeightCells(0), cellSizePixels(0.0f),
-      startCol(0), startRow(0), endCol(0), endRow(0),
-      playerX(0), playerY(0), playerSize(0), playerSpeed(3.0f),
-      coinSize(0), totalInitialCoins(0), collectedCoins(0),
-      levelWon(false), mazeGeneratedForPreview(false)
-{
-    CalculateMazeDimensions();
-    InitMazeGrid();
-}
-
-MazeLevel::~MazeLevel() {
-    Unload();
-}
-
-void MazeLevel::CalculateMazeDimensions() {
-    mazeWidthCells = MAZE_BASE_WIDTH_CELLS;
-    if (mazeWidthCells % 2 == 0) mazeWidthCells++; // Making sure it's odd for maze generation
-    mazeHeightCells = MAZE_BASE_HEIGHT_CELLS;
-    if (mazeHeightCells % 2 == 0) mazeHeightCells++; 
-
-    float cellWidthByScreen = (float)screenWidth / mazeWidthCells;
-    float cellHeightByScreen = (float)screenHeight / mazeHeightCells;
-
-    cellSizePixels = std::floor(std::min(cellWidthByScreen, cellHeightByScreen));
-
-    mazeWidthCells = (int)(screenWidth / cellSizePixels);
-    if (mazeWidthCells % 2 == 0) mazeWidthCells--;
-    if (mazeWidthCells <= 0) mazeWidthCells = 1;
-
-    mazeHeightCells = (int)(screenHeight / cellSizePixels);
-    if (mazeHeightCells % 2 == 0) mazeHeightCells--;
-    if (mazeHeightCells <= 0) mazeHeightCells = 1;
-
-    if (mazeWidthCells < 3) mazeWidthCells = 3; // Minimum maze size
-    if (mazeHeightCells < 3) mazeHeightCells = 3;
-
-    startCol = 1; // Starting point for the player
-    startRow = 1;
-    endCol = mazeWidthCells - 2; // Ending point for the player
-    endRow = mazeHeightCells - 2;
-
-    playerSize = cellSizePixels * 0.6f;
-    coinSize = cellSizePixels * 0.3f;
-}
-
-void MazeLevel::InitMazeGrid() {
-    mazeGrid.clear();
-    mazeGrid.resize(mazeHeightCells, std::vector<bool>(mazeWidthCells, true)); // All cells start as walls
-}
-
-void MazeLevel::RecursiveGenerateMaze(int r, int c) {
-    mazeGrid[r][c] = false; // Mark current cell as path
-
-    int dr[] = {-2, 0, 2, 0}; // Directions for moving two cells at a time (skipping a wall)
-    int dc[] = {0, 2, 0, -2};
-
-    std::vector<int> directions = {0, 1, 2, 3};
-    std::shuffle(directions.begin(), directions.end(), s_maze_gen); // Randomize directions
-
-    for (int dir : directions) {
-        int nextR = r + dr[dir];
-        int nextC = c + dc[dir];
-        int wallR = r + dr[dir] / 2; // Wall in between current and next cell
-        int wallC = c + dc[dir] / 2;
-
-        // If next cell is within bounds and is still a wall, make a path
-        if (nextR >= 0 && nextR < mazeHeightCells && nextC >= 0 && nextC < mazeWidthCells && mazeGrid[nextR][nextC]) {
-            mazeGrid[wallR][wallC] = false; // the wall
-            RecursiveGenerateMaze(nextR, nextC); 
-        }
-    }
-}
-
-void MazeLevel::GenerateNewMazeStructure() {
-    CalculateMazeDimensions();
-    InitMazeGrid();
-    RecursiveGenerateMaze(startRow, startCol);
-    mazeGeneratedForPreview = true;
-}
-
-void MazeLevel::ResetPlayerAndCoins() {
-    // Put player back at the start
-    playerX = startCol * cellSizePixels + (cellSizePixels - playerSize) / 2;
-    playerY = startRow * cellSizePixels + (cellSizePixels - playerSize) / 2;
-    levelWon = false;
-
-    coins.clear();
-    collectedCoins = 0;
-    totalInitialCoins = 0;
-
-    // Distribute coins randomly in path cells
-    for (int r = 0; r < mazeHeightCells; ++r) {
-        for (int c = 0; c < mazeWidthCells; ++c) {
-            // If it's a path cell and not the start/end
-            if (!mazeGrid[r][c] && !(r == startRow && c == startCol) && !(r == endRow && c == endCol)) {
-                if (s_maze_dis(s_maze_gen) < COIN_SPAWN_CHANCE) {
-                    float coinX = c * cellSizePixels + cellSizePixels / 2;
-                    float coinY = r * cellSizePixels + cellSizePixels / 2;
-                    coins.push_back({coinX, coinY});
-                    totalInitialCoins++;
-                }
-            }
-        }
-    }
-}
-
-void MazeLevel::Load() {
-    CalculateMazeDimensions();
-    if (!mazeGeneratedForPreview) {
-        GenerateNewMazeStructure();
-    }
-    ResetPlayerAndCoins(); // Set up player and coins for the current maze
-}
-
-void MazeLevel::Unload() {
-    mazeGrid.clear();
-    coins.clear();
-    mazeGeneratedForPreview = false; // Reset for next time we load a maze
-}
-
-bool MazeLevel::CheckWallCollision(float px, float py, float pSize, float dx, float dy) {
-    float newPlayerX = px + dx;
-    float newPlayerY = py + dy;
-    Rectangle playerRect = {newPlayerX, newPlayerY, pSize, pSize};
-
-    // Calculate which maze cells the player is currently overlapping
-    int minCol = static_cast<int>(playerRect.x / cellSizePixels);
-    int maxCol = static_cast<int>((playerRect.x + playerRect.width - 1) / cellSizePixels);
-    int minRow = static_cast<int>(playerRect.y / cellSizePixels);
-    int maxRow = static_cast<int>((playerRect.y + playerRect.height - 1) / cellSizePixels);
-
-    // Clamp to ensure we don't go out of bounds of the maze grid
-    minCol = minmax(minCol, 0, mazeWidthCells - 1);
-    maxCol = minmax(maxCol, 0, mazeWidthCells - 1);
-    minRow = minmax(minRow, 0, mazeHeightCells - 1);
-    maxRow = minmax(maxRow, 0, mazeHeightCells - 1);
-
-    for (int r = minRow; r <= maxRow; ++r) {
-        for (int c = minCol; c <= maxCol; ++c) {
-            if (r < 0 || r >= mazeHeightCells || c < 0 || c >= mazeWidthCells) continue;
-            if (mazeGrid[r][c]) { // check If it's a wall
-                Rectangle wallCellRect = { (float)c * cellSizePixels, (float)r * cellSizePixels, (float)cellSizePixels, (float)cellSizePixels };
-                if (CheckCollisionRecs(playerRect, wallCellRect)) { 
-
-                    return true; // Collision detected
-                }
-            }
-        }
-    }
-    return false; // No collision
-}
-
-void MazeLevel::Update(float deltaTime) {
-    if (levelWon) return; // Don't update if level is already won
-
-    float dx = 0, dy = 0;
-    // Handle player movement based on arrow keys
-    if (IsKeyDown(KEY_RIGHT)) dx += playerSpeed;
-    if (IsKeyDown(KEY_LEFT)) dx -= playerSpeed;
-    if (IsKeyDown(KEY_UP)) dy -= playerSpeed;
-    if (IsKeyDown(KEY_DOWN)) dy += playerSpeed;
-
-    // Move player if no wall collision
-    if (!CheckWallCollision(playerX, playerY, playerSize, dx, 0)) { playerX += dx; }
-    if (!CheckWallCollision(playerX, playerY, playerSize, 0, dy)) { playerY += dy; }
-
-    // Keep player within screen bounds
-    playerX = minmax(playerX, 0.0f, (float)screenWidth - playerSize);
-    playerY = minmax(playerY, 0.0f, (float)screenHeight - playerSize);
-
-    Rectangle playerRect = {playerX, playerY, playerSize, playerSize};
-    // Check for coin collection
-    for (int i = 0; i < coins.size(); ++i) {
-        Rectangle coinRect = { coins[i].x - coinSize / 2, coins[i].y - coinSize / 2, coinSize, coinSize };
-        if (CheckCollisionRecs(playerRect, coinRect)) {
-            collectedCoins++;
-            coins.erase(coins.begin() + i); // Remove collected coin
-            i--; // Adjust index after erase
-        }
-    }
-
-    // Check for level completion (reached exit and collected all coins)
-    Rectangle exitRect = { (float)endCol * cellSizePixels, (float)endRow * cellSizePixels, (float)cellSizePixels, (float)cellSizePixels };
-    if (CheckCollisionRecs(playerRect, exitRect) && collectedCoins == totalInitialCoins) {
-        levelWon = true;
-    }
-}
-
-void MazeLevel::Draw() {
-    // Draw maze grid
-    for (int r = 0; r < mazeHeightCells; r++) {
-        for (int c = 0; c < mazeWidthCells; c++) {
-            // Only draw if it's visible on screen
-            if (c * cellSizePixels < screenWidth && r * cellSizePixels < screenHeight) {
-                if (mazeGrid[r][c]) {
-                    DrawRectangle(c * cellSizePixels, r * cellSizePixels, cellSizePixels, cellSizePixels, MAZE_WALL_COLOR);
-                } else {
-                    DrawRectangle(c * cellSizePixels, r * cellSizePixels, cellSizePixels, cellSizePixels, MAZE_PATH_COLOR);
-                }
-            }
-        }
-    }
-
-    // Draw start and end points
-    DrawRectangle(startCol * cellSizePixels, startRow * cellSizePixels, cellSizePixels, cellSizePixels, MAZE_START_COLOR);
-    DrawRectangle(endCol * cellSizePixels, endRow * cellSizePixels, cellSizePixels, cellSizePixels, MAZE_END_COLOR);
-
-    // Draw all active coins
-    for (const auto& coin : coins) {
-        DrawCircle(coin.x, coin.y, coinSize / 2, MAZE_COIN_COLOR);
-    }
-
-    // Draw the player (a simple circle with eyes)
-    DrawCircle(playerX + playerSize / 2, playerY + playerSize / 2, playerSize / 2, MAZE_PLAYER_COLOR);
-    DrawCircle(playerX + playerSize / 2 - playerSize * 0.18f, playerY + playerSize / 2 - playerSize * 0.15f, playerSize * 0.09f, MAZE_PLAYER_EYE_COLOR);
-    DrawCircle(playerX + playerSize / 2 + playerSize * 0.18f, playerY + playerSize / 2 - playerSize * 0.15f, playerSize * 0.09f, MAZE_PLAYER_EYE_COLOR);
-
-    // Display coin count
-    std::string coinText = "Coins: " + std::to_string(collectedCoins) + "/" + std::to_string(totalInitialCoins);
-    DrawText(coinText.c_str(), 10, 10, 20, MAZE_TEXT_COLOR);
-}
-
-bool MazeLevel::IsComplete() {
-    return levelWon;
-}
-
-
-// Constants for the Space Invaders Level
-const int SI_PLAYER_SPEED = 5;            // How fast the player's spaceship moves horizontally.
-const int SI_BULLET_SPEED = 3;            // How fast both player and invader bullets travel.
-const int SI_INVADER_SPEED = 1;           // The base speed for how much invaders shift horizontally in one step.
-const int SI_INVADER_ROWS = 2;            // Number of rows of invaders to spawn.
-const int SI_INVADER_COLS = 8;            // Number of columns of invaders to spawn in each row.
-const int SI_INVADER_SPACING_X = 50;      // Horizontal distance between the center of invaders.
-const int SI_INVADER_SPACING_Y = 40;      // Vertical distance between the center of invader rows.
-const int SI_INVADER_START_X = 50;        // X-coordinate where the first invader (top-left of formation) starts.
-const int SI_INVADER_START_Y = 100;       // Y-coordinate where the first invader (top-left of formation) starts.
-const float SI_INVADER_FIRE_RATE = 0.15f; // The chance (per second) an invader might fire a bullet.
-const float SI_INVADER_MOVE_INTERVAL = 0.8f; // How long (in seconds) between each horizontal movement step for the invaders.
-const float SI_INVADER_DESCENT_AMOUNT = 20.0f; // How much the invaders drop down when they hit a screen edge and reverse direction.
-
-// Random number generators for invaders
-static std::mt19937 s_si_rng(std::chrono::steady_clock::now().time_since_epoch().count());
-static std::uniform_real_distribution<float> s_si_dist(0.0f, 1.0f);
-
-// second level: Space Invaders
-class SpaceInvadersLevel : public Levels {
-public:
-    // Represents a bullet in the game
-    class Bullet {
-    public:
-        Rectangle rect;
-        bool active;
-        bool isPlayerBullet; // Is this a player's bullet or an invader's
-
-        Bullet(Vector2 pos, bool playerBullet) : active(true), isPlayerBullet(playerBullet) {
-    // Initialize the bullet's bounding rectangle (position, width, height)
-    // 'pos.x' and 'pos.y' come from the Vector2 argument, defining the bullet's starting coordinates.
-    // The bullet itself is 5 pixels wide and 10 pixels tall.
-    rect = { pos.x, pos.y, 5, 10 };
-}
-        void Update(float screenHeight) {
-            if (active) {
-                if (isPlayerBullet) {
-                    rect.y -= SI_BULLET_SPEED; // Player bullets go up
-                } else {
-                    rect.y += SI_BULLET_SPEED; // Invader bullets go down
-                }
-
-                // Deactivate bullet if it goes off screen
-                if (rect.y < 0 || rect.y > screenHeight) {
-                    active = false;
-                }
-            }
-        }
-
-        void Draw() const {
-            if (active) {
-                DrawRectangleRec(rect, isPlayerBullet ? YELLOW : RED);
-            }
-        }
-    };
-
-    // Represents the player's spaceship
-    class Player {
-    public:
-        Rectangle rect;
-        int lives;
-        float lastShotTime; // To control firing rate
-
-        Player(int screenW, int screenH) : lives(5), lastShotTime(0.0f) {
-            rect = { (float)screenW / 2 - 25, (float)screenH - 70, 50, 50 };
-        }
-
-        void Update(std::vector<std::unique_ptr<Bullet>>& playerBullets, float screenW, float currentTime) {
-            // Move left/right
-            if (IsKeyDown(KEY_LEFT) && rect.x > 0) {
-                rect.x -= SI_PLAYER_SPEED;
-            }
-            if (IsKeyDown(KEY_RIGHT) && rect.x < screenW - rect.width) {
-                rect.x += SI_PLAYER_SPEED;
-            }
-            // Fire bullet if space is pressed and enough time has passed
-            if (IsKeyDown(KEY_SPACE) && (currentTime - lastShotTime >= 0.5f)) {
-                playerBullets.push_back(std::make_unique<Bullet>(Vector2{ rect.x + rect.width / 2 - 2.5f, rect.y }, true));
-                lastShotTime = currentTime;
-            }
-        }
-
-        void Draw() const {
-            // Simple triangle shape for the player
-            Vector2 p1 = { rect.x + rect.width / 2, rect.y };
-            Vector2 p2 = { rect.x, rect.y + rect.height };
-            Vector3 p3_temp = { rect.x + rect.width, rect.y + rect.height, 0.0f };
-            DrawTriangle(p1, p2, { p3_temp.x, p3_temp.y }, DARKBLUE);
-
-            // Some details on the player ship
-            DrawRectangle(rect.x, rect.y + rect.height * 0.2f, rect.width, rect.height * 0.1f, WHITE);
-            DrawRectangle(rect.x, rect.y + rect.height * 0.4f, rect.width, rect.height * 0.1f, BLACK);
-            DrawRectangle(rect.x, rect.y + rect.height * 0.6f, rect.width, rect.height * 0.1f, WHITE);
-            DrawRectangle(rect.x, rect.y + rect.height * 0.8f, rect.width, rect.height * 0.1f, BLACK);
-            DrawRectangle(rect.x + rect.width / 4, rect.y + rect.height / 2, rect.width / 2, rect.height / 2, BLUE);
-        }
-
-        void TakeDamage() { lives--; }
-        bool IsAlive() const { return lives > 0; }
-    };
-
-    // Represents an invader amongus
-    class Invader {
-    public:
-        Rectangle rect;
-        bool active;
-        int type; // Could be used for different invader behaviors/looks altho we have used a very simpler approach
-
-        Invader(Vector2 pos, int invaderType) : active(true), type(invaderType) {
-            rect = { pos.x, pos.y, 30, 30 };
-        }
-
-        void Draw() const {
-            if (active) {
-                // Drawing a simple invader shape
-                DrawRectangle(rect.x, rect.y + rect.height * 0.1f, rect.width, rect.height * 0.9f, RED);
-                DrawCircle(rect.x + rect.width / 2, rect.y + rect.height * 0.1f, rect.width / 2, RED);
-                DrawCircle(rect.x + rect.width / 2, rect.y + rect.height, rect.width / 2, RED);
-
-                DrawRectangle(rect.x + rect.width * 0.2f, rect.y + rect.height * 0.2f, rect.width * 0.6f, rect.height * 0.4f, SKYBLUE);
-                DrawRectangleLines(rect.x + rect.width * 0.2f, rect.y + rect.height * 0.2f, rect.width * 0.6f, rect.height * 0.4f, DARKBLUE);
-
-                DrawRectangle(rect.x + rect.width * 0.15f, rect.y - 10, rect.width * 0.7f, 15, BLUE);
-                DrawRectangle(rect.x + rect.width * 0.05f, rect.y - 5, rect.width * 0.9f, 5, DARKBLUE);
-                DrawRectangle(rect.x + rect.width / 2 - 3, rect.y - 7, 6, 6, YELLOW);
-            }
-        }
-
-        void FireBullet(std::vector<std::unique_ptr<Bullet>>& invaderBullets) {
-            if (active) {
-                invaderBullets.push_back(std::make_unique<Bullet>(Vector2{ rect.x + rect.width / 2 - 2.5f, rect.y + rect.height }, false));
-            }
-        }
-    };
-
-    SpaceInvadersLevel(int screenW, int screenH);
-    ~SpaceInvadersLevel() override;
-
-    void Load() override;
-    void Unload() override;
-    void Update(float deltaTime) override;
-    void Draw() override;
-    bool IsComplete() override;
-    std::string GetName() const override { return "Space Invaders Level"; }
-    std::string GetInstructions() const override { return "Use LEFT/RIGHT arrows to move. \n \n Press SPACE to shoot. Destroy all invaders before\n \n  they reach the bottom or \n \n you run out of lives!"; }
-
-    bool DidPlayerWinThisLevel() const { return gameWon; }
-
-private:
-    Player player;
-    std::vector<std::unique_ptr<Invader>> invaders;
-    std::vector<std::unique_ptr<Bullet>> playerBullets;
-    std::vector<std::unique_ptr<Bullet>> invaderBullets;
-    int score;
-    bool gameOver;
-    bool gameWon;
-    float invaderMoveDirection; // 1.0f for right, -1.0f for left
-    float invaderMoveTimer;
-    float currentScreenW, currentScreenH;
-};
-
-SpaceInvadersLevel::SpaceInvadersLevel(int screenW, int screenH)
-    : Levels(screenW, screenH),
-      player(screenW, screenH),
-      score(0), gameOver(false), gameWon(false),
-      invaderMoveDirection(1.0f), invaderMoveTimer(0.0f),
-      currentScreenW((float)screenW), currentScreenH((float)screenH)
-{
-}
-
-SpaceInvadersLevel::~SpaceInvadersLevel() {
-    Unload();
-}
-
-void SpaceInvadersLevel::Load() {
-    player = Player(screenWidth, screenHeight); // Reset player state
-    score = 0;
-    gameOver = false;
-    gameWon = false;
-    invaderMoveDirection = 1.0f;
-    invaderMoveTimer = 0.0f;
-
-    playerBullets.clear();
-    invaderBullets.clear();
-    invaders.clear();
-
-    // Spawn invaders in a grid
-    for (int row = 0; row < SI_INVADER_ROWS; ++row) {
-        for (int col = 0; col < SI_INVADER_COLS; ++col) {
-            Vector2 invaderPos = {
-                (float)SI_INVADER_START_X + col * SI_INVADER_SPACING_X,
-                (float)SI_INVADER_START_Y + row * SI_INVADER_SPACING_Y
-            };
-            invaders.push_back(std::make_unique<Invader>(invaderPos, row));
-        }
-    }
-}
-
-void SpaceInvadersLevel::Unload() {
-    playerBullets.clear();
-    invaderBullets.clear();
-    invaders.clear();
-}
-
-void SpaceInvadersLevel::Update(float deltaTime) {
-    if (gameOver || gameWon) {
-        return; // Stop updating if game is over or won
-    }
-
-    player.Update(playerBullets, currentScreenW, GetTime());
-
-    // Update and clean up player bullets if not active then remove
-    for (auto& bullet : playerBullets) { bullet->Update(currentScreenH); }
-    playerBullets.erase(std::remove_if(playerBullets.begin(), playerBullets.end(), [](const std::unique_ptr<Bullet>& b) { return !b->active; }), playerBullets.end());
-
-    // Update and clean up invader bullets
-    for (auto& bullet : invaderBullets) { bullet->Update(currentScreenH); }
-    invaderBullets.erase(std::remove_if(invaderBullets.begin(), invaderBullets.end(), [](const std::unique_ptr<Bullet>& b) { return !b->active; }), invaderBullets.end());
-
-    invaderMoveTimer += GetFrameTime();
-    bool shouldDescend = false;
-    // Check if it's time for invaders to move horizontally
-    if (invaderMoveTimer >= SI_INVADER_MOVE_INTERVAL) {
-        invaderMoveTimer = 0.0f;
-        float minX = currentScreenW;
-        float maxX = 0;
-        bool anyInvaderActive = false;
-        // Find the leftmost and rightmost active invaders
-        for (const auto& invader : invaders) {
-            if (invader->active) {
-                minX = std::min(minX, invader->rect.x);
-                maxX = std::max(maxX, invader->rect.x + invader->rect.width);
-                anyInvaderActive = true;
-            }
-        }
-
-        if (anyInvaderActive) {
-            // Reverse direction and descend if invaders hit screen edges
-            if (invaderMoveDirection == 1.0f) { // Moving right
-                if (maxX >= currentScreenW - 20) {
-                    invaderMoveDirection = -1.0f; // Switch to left
-                    shouldDescend = true;
-                }
-            } else { // Moving left
-                if (minX <= 20) {
-                    invaderMoveDirection = 1.0f; // Switch to right
-                    shouldDescend = true;
-                }
-            }
-
-            // Move invaders
-            for (auto& invader : invaders) {
-                if (invader->active) {
-                    invader->rect.x += invaderMoveDirection * SI_INVADER_SPEED * 10; // Move horizontally
-                    if (shouldDescend) {
-                        invader->rect.y += SI_INVADER_DESCENT_AMOUNT; // Move down
-                        if (invader->rect.y + invader->rect.height >= player.rect.y) {
-                            gameOver = true; // Invaders reached player line
-                        }
-                    }
-                }
-            }
-        }
-    }
-
-    // Invaders randomly fire bullets
-    for (auto& invader : invaders) {
-        if (invader->active && s_si_dist(s_si_rng) < SI_INVADER_FIRE_RATE * GetFrameTime()) {
-            //generates a completely random number between 0 and 1 for each active invader every frame and then calculates the probability of firing for the current frame.
-            invader->FireBullet(invaderBullets);
-        }
-    }
-
-    // Player bullet collisions with invaders
-    for (auto& pBullet : playerBullets) {
-        if (pBullet->active) {
-            for (auto& invader : invaders) {
-                if (invader->active && CheckCollisionRecs(pBullet->rect, invader->rect)) {
-                    pBullet->active = false; // Bullet hits invader
-                    invader->active = false; // Invader destroyed
-                    score += 100;
-                    break;
-                }
-            }
-        }
-    }
-
-    // Invader bullet collisions with player
-    for (auto& iBullet : invaderBullets) {
-        if (iBullet->active) {
-            if (CheckCollisionRecs(iBullet->rect, player.rect)) {
-                iBullet->active = false; // Bullet hits player
-                player.TakeDamage(); // Player loses a life
-                if (!player.IsAlive()) {
-                    gameOver = true; // No more lives, game over
-                }
-                break;
-            }
-        }
-    }
-
-    // Check if all invaders are destroyed (win condition)
-    bool allInvadersDestroyed = true;
-    for (const auto& invader : invaders) {
-        if (invader->active) {
-            allInvadersDestroyed = false;
-            break;
-        }
-    }
-    if (allInvadersDestroyed) {
-        gameWon = true;
-    }
-}
-
-void SpaceInvadersLevel::Draw() {
-    player.Draw(); // Draw the player
-
-    // Draw all active invaders and bullets
-    for (const auto& invader : invaders) { invader->Draw(); }
-    for (const auto& bullet : playerBullets) { bullet->Draw(); }
-    for (const auto& bullet : invaderBullets) { bullet->Draw(); }
-
-    // Display score and lives
-    DrawText(TextFormat("SCORE: %04i", score), 10, 10, 20, WHITE);
-    DrawText(TextFormat("LIVES: %i", player.lives), screenWidth - 100, 10, 20, WHITE);
-
-    // Display game over or level complete messages
-    if (gameOver) {
-        DrawText("GAME OVER!", screenWidth / 2 - MeasureText("GAME OVER!", 40) / 2, screenHeight / 2 - 20, 40, RED);
-    } else if (gameWon) {
-        DrawText("LEVEL COMPLETE!", screenWidth / 2 - MeasureText("LEVEL COMPLETE!", 40) / 2, screenHeight / 2 - 20, 40, GOLD);
-    }
-}
-
-bool SpaceInvadersLevel::IsComplete() {
-    return gameOver || gameWon; // Level is complete if won or lost
-}
-
-// Constants specific to the Flappy Level
-const int FLAPPY_PIPE_WIDTH = 80;                     // The fixed width of each pipe segment in pixels.
-const int FLAPPY_PIPE_GAP = 150;                      // The vertical size of the opening/gap between the top and bottom pipes.
-const float FLAPPY_PIPE_SPEED = 100.0f;               // How fast pipes move from right to left across the screen (pixels per second).
-const float FLAPPY_BIRD_RADIUS = 20.0f;               // The radius of the bird's circular collision and visual model.
-const float FLAPPY_BIRD_JUMP_STRENGTH = -250.0f;      // The initial upward vertical velocity applied when the bird 'jumps' (negative because Y increases downwards).
-const float FLAPPY_GRAVITY = 700.0f;                  // The constant downward acceleration applied to the bird (pixels per second squared).
-const int FLAPPY_WIN_SCORE = 10;                      // The score the player needs to achieve to complete the Flappy Level.
-const float FLAPPY_INITIAL_HEALTH = 100.0f;           // The bird's starting health points for the level.
-const float FLAPPY_DAMAGE_PER_HIT = 25.0f;            // The amount of health the bird loses upon colliding with a pipe or screen edge.
-const float FLAPPY_MIN_HORIZONTAL_PIPE_SPACING = 250.0f; // The minimum horizontal distance maintained between the right edge of one pipe and the left edge of the next.
-const int FLAPPY_FONT_SIZE = 40;                      // The size of the font used for displaying score, health, and messages in this level.
-
-// third level: Flappy
-class FlappyLevel : public Levels {
-public:
-    // Internal states for the Flappy level
-    enum FlappyGameScreen {
-        FLAPPY_MENU = 0,
-        FLAPPY_PLAYING,
-        FLAPPY_GAME_OVER,
-        FLAPPY_WIN
-    };
-
-    // Base class for game objects in Flappy (Bird, Pipe)
-    class GameObject {
-    public:
-        virtual void Update(float deltaTime) = 0;
-        virtual void Draw() = 0;
-        virtual ~GameObject() = default;
-    };
-
-    // The bird character
-    class Bird : public GameObject {
-    private:
-        Vector2 m_position;
-        float m_velocityY;
-        Color m_color;
-        float m_radius;
-        float m_health;
-        int m_screenW, m_screenH;
-
-    public:
-        Bird(int screenW, int screenH)
-            : m_position({(float)screenW / 4, (float)screenH / 2}), // Start in the middle-left
-              m_velocityY(0.0f),
-              m_color(PURPLE),
-              m_radius(FLAPPY_BIRD_RADIUS),
-              m_health(FLAPPY_INITIAL_HEALTH),
-              m_screenW(screenW), m_screenH(screenH)
-        {
-        }
-
-        Vector2 getPosition() const { return m_position; }
-        float getRadius() const { return m_radius; }
-        float getHealth() const { return m_health; }
-
-        void setPosition(Vector2 pos) { m_position = pos; }
-        void setVelocityY(float velocity) { m_velocityY = velocity; }
-        void setHealth(float health) { m_health = health; }
-
-        void Jump() {
-            m_velocityY = FLAPPY_BIRD_JUMP_STRENGTH; // Apply upward velocity
-        }
-
-        void takeDamage(float amount) {
-            m_health -= amount;
-            if (m_health < 0) {
-                m_health = 0;
-            }
-        }
-
-        void Update(float deltaTime) override {
-            m_velocityY += FLAPPY_GRAVITY * deltaTime; // Apply gravity
-            m_position.y += m_velocityY * deltaTime;    // Update vertical position
-
-            // Keep bird within vertical bounds of the screen
-            if (m_position.y < m_radius * 1.5f) {
-                m_position.y = m_radius * 1.5f;
-                m_velocityY = 0;
-            }
-            if (m_position.y > m_screenH - m_radius * 1.5f) {
-                m_position.y = m_screenH - m_radius * 1.5f;
-                m_velocityY = 0;
-            }
-        }
-
-        void Draw() override {
-            // Draw a slightly-squashed rounded rectangle for the body
-            float bodyWidth = m_radius * 2.0f;
-            float bodyHeight = m_radius * 2.5f;
-            float legHeight = m_radius * 0.8f;
-            float legWidth = m_radius * 0.7f;
-            float visorWidth = m_radius * 1.2f;
-            float visorHeight = m_radius * 0.8f;
-
-            Rectangle bodyRect = {
-                m_position.x - bodyWidth / 2,
-                m_position.y - bodyHeight / 2,
-                bodyWidth,
-                bodyHeight
-            };
-            DrawRectangleRounded(bodyRect, 0.5f, 8, m_color);
-
-            // Draw legs
-            Rectangle leftLegRect = {
-                m_position.x - bodyWidth / 2 + m_radius * 0.2f,
-                m_position.y + bodyHeight / 2 - legHeight,
-                legWidth,
-                legHeight
-            };
-            DrawRectangleRounded(leftLegRect, 0.5f, 8, m_color);
-
-            Rectangle rightLegRect = {
-                m_position.x + bodyWidth / 2 - legWidth - m_radius * 0.2f,
-                m_position.y + bodyHeight / 2 - legHeight,
-                legWidth,
-                legHeight
-            };
-            DrawRectangleRounded(rightLegRect, 0.5f, 8, m_color);
-
-            // Draw a visor/eye
-            DrawEllipse(
-                (int)m_position.x,
-                (int)(m_position.y - bodyHeight / 2 + visorHeight / 2 + m_radius * 0.3f),
-                (int)(visorWidth / 2),
-                (int)(visorHeight / 2),
-                SKYBLUE
-            );
-            DrawEllipseLines(
-                (int)m_position.x,
-                (int)(m_position.y - bodyHeight / 2 + visorHeight / 2 + m_radius * 0.3f),
-                (int)(visorWidth / 2),
-                (int)(visorHeight / 2),
-                DARKBLUE
-            );
-        }
-    };
-
-    // The pipes that the bird needs to avoid
-    class Pipe : public GameObject {
-    private:
-        Rectangle m_topRect;
-        Rectangle m_bottomRect;
-        bool m_scored; // Has the player scored by passing this pipe?
-        int m_screenH;
-
-    public:
-        Pipe(float startX, float gapY, int screenH) : m_scored(false), m_screenH(screenH) {
-            // Calculate dimensions for top and bottom pipes based on gapY
-            m_topRect = {startX, 0, (float)FLAPPY_PIPE_WIDTH, gapY - FLAPPY_PIPE_GAP / 2};
-            m_bottomRect = {startX, gapY + FLAPPY_PIPE_GAP / 2, (float)FLAPPY_PIPE_WIDTH, (float)m_screenH - (gapY + FLAPPY_PIPE_GAP / 2)};
-        }
-
-        Rectangle getTopRect() const { return m_topRect; }
-        Rectangle getBottomRect() const { return m_bottomRect; }
-        bool isScored() const { return m_scored; }
-        void markScored() { m_scored = true; }
-
-        void Update(float deltaTime) override {
-            // Pipes move from right to left
-            m_topRect.x -= FLAPPY_PIPE_SPEED * deltaTime;
-            m_bottomRect.x -= FLAPPY_PIPE_SPEED * deltaTime;
-        }
-
-        void Draw() override {
-            DrawRectangleRec(m_topRect, GREEN);
-            DrawRectangleRec(m_bottomRect, GREEN);
-            DrawRectangleLinesEx(m_topRect, 2, DARKGREEN);
-            DrawRectangleLinesEx(m_bottomRect, 2, DARKBROWN);
-        }
-    };
-
-    FlappyLevel(int screenW, int screenH);
-    ~FlappyLevel() override;
-
-    void Load() override;
-    void Unload() override;
-    void Update(float deltaTime) override;
-    void Draw() override;
-    bool IsComplete() override;
-    std::string GetName() const override { return "Flappy Level"; }
-    std::string GetInstructions() const override { return "Press SPACE to make your character flap.\n \n Avoid hitting the pipes and the ground. \n \nGet a score of 10 to win."; }
-
-    bool DidPlayerWinThisLevel() const { return m_playerWonLevel; }
-
-private:
-    std::unique_ptr<Bird> m_bird;
-    std::vector<std::unique_ptr<Pipe>> m_pipes;
-    int m_score;
-    FlappyGameScreen m_currentScreen; // Current state of this level
-
-    std::random_device m_rd;
-    std::mt19937 m_gen;
-    std::uniform_int_distribution<> m_distrib;
-
-    bool m_levelFinished; // True when this specific level is done
-    bool m_playerWonLevel; // True if player won this level
-
-    void GenerateNewPipe();
-    void InitFlappyGame(); // Sets up a new Flappy game instance
-};
-
-// Static random engine for FlappyLevel (for consistent random numbers)
-static std::random_device s_flappy_rd;
-static std::mt19937 s_flappy_gen(s_flappy_rd());
-static std::uniform_int_distribution<> s_flappy_distrib(FLAPPY_PIPE_GAP, GLOBAL_SCREEN_HEIGHT - FLAPPY_PIPE_GAP);
-
-FlappyLevel::FlappyLevel(int screenW, int screenH)
-    : Levels(screenW, screenH),
-      m_score(0),
-      m_currentScreen(FLAPPY_MENU),
-      m_gen(s_flappy_gen),
-      m_distrib(s_flappy_distrib),
-      m_levelFinished(false),
-      m_playerWonLevel(false)
-{
-}
-
-FlappyLevel::~FlappyLevel() {
-    Unload();
-}
-
-void FlappyLevel::InitFlappyGame() {
-    m_bird = std::make_unique<Bird>(screenWidth, screenHeight);
-    m_pipes.clear();
-    m_score = 0;
-    m_levelFinished = false;
-    m_playerWonLevel = false;
-    // Add initial pipes, spaced out from the start
-    m_pipes.push_back(std::make_unique<Pipe>((float)screenWidth, (float)m_distrib(m_gen), screenHeight));
-    m_pipes.push_back(std::make_unique<Pipe>((float)screenWidth + FLAPPY_MIN_HORIZONTAL_PIPE_SPACING, (float)m_distrib(m_gen), screenHeight));
-    m_currentScreen = FLAPPY_MENU; // Start at the menu for this level
-}
-
-void FlappyLevel::Load() {
-    InitFlappyGame(); // Reset and set up the game
-}
-
-void FlappyLevel::Unload() {
-    m_pipes.clear(); // Clears all unique pointers, deallocating pipes
-}
-
-void FlappyLevel::GenerateNewPipe() {
-    float gapY = (float)m_distrib(m_gen); // Random Y position for the gap
-    // Determine X position for the new pipe
-    float newPipeX = m_pipes.empty() ? (float)screenWidth : m_pipes.back()->getTopRect().x + FLAPPY_MIN_HORIZONTAL_PIPE_SPACING;
-    m_pipes.push_back(std::make_unique<Pipe>(newPipeX, gapY, screenHeight));
-}
-
-void FlappyLevel::Update(float deltaTime) {
-    switch (m_currentScreen) {
-        case FLAPPY_MENU: {
-            if (IsKeyPressed(KEY_SPACE)) { // Start game on spacebar press
-                m_currentScreen = FLAPPY_PLAYING;
-            }
-        } break;
-        case FLAPPY_PLAYING: {
-            m_bird->Update(deltaTime);
-
-            bool collisionOccurred = false;
-            for (size_t i = 0; i < m_pipes.size(); ++i) {
-                m_pipes[i]->Update(deltaTime);
-
-                // Check for collision with top or bottom pipe
-                if (CheckCollisionCircleRec(m_bird->getPosition(), m_bird->getRadius(), m_pipes[i]->getTopRect()) ||
-                    CheckCollisionCircleRec(m_bird->getPosition(), m_bird->getRadius(), m_pipes[i]->getBottomRect())) {
-                    collisionOccurred = true;
-                }
-
-                // Score if bird passed the pipe and hasn't scored yet for this pipe
-                if (!m_pipes[i]->isScored() && m_pipes[i]->getTopRect().x + FLAPPY_PIPE_WIDTH < m_bird->getPosition().x - m_bird->getRadius()) {
-                    m_score++;
-                    m_pipes[i]->markScored();
-                }
-            }
-
-            // Check for collision with top/bottom screen edges
-            if (m_bird->getPosition().y + m_bird->getRadius() >= screenHeight || m_bird->getPosition().y - m_bird->getRadius() <= 0) {
-                 collisionOccurred = true;
-            }
-
-            // Handle collisions
-            if (collisionOccurred) {
-                m_bird->takeDamage(FLAPPY_DAMAGE_PER_HIT); // Take damage
-                if (m_bird->getHealth() <= 0) {
-                    m_currentScreen = FLAPPY_GAME_OVER; // Game over if no health left
-                    m_levelFinished = true;
-                    m_playerWonLevel = false;
-                } else {
-                    // Reset bird position and clear pipes for a "retry"
-                    m_bird->setPosition({(float)screenWidth / 4, (float)screenHeight / 2});
-                    m_bird->setVelocityY(0.0f);
-                    m_pipes.clear();
-                    m_pipes.push_back(std::make_unique<Pipe>((float)screenWidth, (float)m_distrib(m_gen), screenHeight));
-                    m_pipes.push_back(std::make_unique<Pipe>((float)screenWidth + FLAPPY_MIN_HORIZONTAL_PIPE_SPACING, (float)m_distrib(m_gen), screenHeight));
-                }
-            }
-
-            // Remove off-screen pipes
-            if (!m_pipes.empty() && m_pipes[0]->getTopRect().x + FLAPPY_PIPE_WIDTH < 0) {
-                m_pipes.erase(m_pipes.begin());
-            }
-
-            // Generate new pipes if needed
-            if (m_pipes.back()->getTopRect().x < screenWidth - FLAPPY_MIN_HORIZONTAL_PIPE_SPACING) {
-                GenerateNewPipe();
-            }
-
-            // Check for win condition
-            if (m_score >= FLAPPY_WIN_SCORE) {
-                m_currentScreen = FLAPPY_WIN;
-                m_levelFinished = true;
-                m_playerWonLevel = true;
-            }
-
-            if (IsKeyPressed(KEY_SPACE)) { // Player jumps on spacebar press
-                m_bird->Jump();
-            }
-        } break;
-        default: break;
-    }
-}
-
-void FlappyLevel::Draw() {
-    // Draw all active pipes
-    for (const auto& pipe : m_pipes) {
-        pipe->Draw();
-    }
-
-    m_bird->Draw(); // Draw the bird
-
-    // Display score
-    DrawText(TextFormat("Score: %02i", m_score), 10, 10, FLAPPY_FONT_SIZE, WHITE);
-
-    // Draw health bar
-    int healthBarX = screenWidth - 10 - 100;
-    int healthBarY = 10;
-    int healthBarWidth = 100;
-    int healthBarHeight = 20;
-
-    DrawRectangle(healthBarX, healthBarY, healthBarWidth, healthBarHeight, DARKGRAY);
-    DrawRectangle(healthBarX, healthBarY, (int)(m_bird->getHealth() / FLAPPY_INITIAL_HEALTH * healthBarWidth), healthBarHeight, RED);
-    DrawRectangleLines(healthBarX, healthBarY, healthBarWidth, healthBarHeight, WHITE);
-    DrawText(TextFormat("Health: %.0f", m_bird->getHealth()), healthBarX, healthBarY + healthBarHeight + 5, 20, WHITE);
-
-    // Draw ground
-    DrawRectangle(0, screenHeight - 20, screenWidth, 20, BROWN);
-    DrawRectangleLines(0, screenHeight - 20, screenWidth, 20, DARKBROWN);
-
-    // Draw different screens based on current level state
-    switch (m_currentScreen) {
-        case FLAPPY_MENU: {
-            DrawText("FLAPPY", screenWidth / 2 - MeasureText("FLAPPY", FLAPPY_FONT_SIZE * 1.5f) / 2, screenHeight / 4, FLAPPY_FONT_SIZE * 1.5f, WHITE);
-            DrawText("Press SPACE to Start", screenWidth / 2 - MeasureText("Press SPACE to Start", FLAPPY_FONT_SIZE) / 2, screenHeight / 2, FLAPPY_FONT_SIZE, GRAY);
-        } break;
-        case FLAPPY_GAME_OVER: {
-            DrawText("GAME OVER!", screenWidth / 2 - MeasureText("GAME OVER!", FLAPPY_FONT_SIZE * 1.5f) / 2, screenHeight / 4, FLAPPY_FONT_SIZE * 1.5f, RED);
-            DrawText(TextFormat("Final Score: %02i", m_score), screenWidth / 2 - MeasureText(TextFormat("Final Score: %02i", m_score), FLAPPY_FONT_SIZE) / 2, screenHeight / 2 - FLAPPY_FONT_SIZE / 2, FLAPPY_FONT_SIZE, WHITE);
-        } break;
-        case FLAPPY_WIN: {
-            DrawText("LEVEL COMPLETE!", screenWidth / 2 - MeasureText("LEVEL COMPLETE!", FLAPPY_FONT_SIZE * 1.5f) / 2, screenHeight / 4, FLAPPY_FONT_SIZE * 1.5f, GOLD);
-            DrawText(TextFormat("Final Score: %02i", m_score), screenWidth / 2 - MeasureText(TextFormat("Final Score: %02i", m_score), FLAPPY_FONT_SIZE) / 2, screenHeight / 2 - FLAPPY_FONT_SIZE / 2, FLAPPY_FONT_SIZE, WHITE);
-        } break;
-        default: break;
-    }
-}
-
-bool FlappyLevel::IsComplete() {
-    return m_levelFinished; // Level is complete when the internal state says so
-}
-
-
-// Constants specific to the Obstacle Level
-const float OBSTACLE_PLAYER_SIZE = 40.0f;
-const float OBSTACLE_PLAYER_SPEED = 200.0f; 
-const float OBSTACLE_JUMP_FORCE = 400.0f;
-const float OBSTACLE_GRAVITY = 800.0f;
-
-
-// Our fourth level: the Obstacle Course!
-class ObstacleLevel : public Levels {
-public:
-    // Internal screens for the Obstacle level
-    enum ObstacleGameScreen {
-        OBSTACLE_TITLE = 0, // Title screen for this specific level (not used much now)
-        OBSTACLE_GAMEPLAY,  // Where the actual running and jumping happens
-        OBSTACLE_ENDING     // Win/loss screen for this level
-    };
-
-    // Base class for game objects in Obstacle Level
-    class GameObject {
-    protected:
-        Vector2 position;
-        Rectangle bounds;
-        Color color;
-
-    public:
-        GameObject() : position({0, 0}), bounds({0, 0, 0, 0}), color(WHITE) {}
-        GameObject(Vector2 pos, float width, float height, Color col)
-            : position(pos), bounds({pos.x, pos.y, width, height}), color(col) {}
-        GameObject(const GameObject& other)
-            : position(other.position), bounds(other.bounds), color(other.color) {}
-
-        virtual ~GameObject() = default;
-
-        virtual void Draw() const = 0;
-        virtual void Update(float dt) {} // Default: static objects don't update
-
-        Rectangle GetBounds() const { return bounds; }
-        Vector2 GetPosition() const { return position; }
-        void SetPosition(Vector2 newPos) {
-            position = newPos;
-            bounds.x = newPos.x;
-            bounds.y = newPos.y;
-        }
-    };
-
-    // The player character for the Obstacle level
-    class Player : public GameObject {
-    private:
-        Vector2 velocity;
-        bool onGround;
-        bool jumped;
-        int m_screenW, m_screenH;
-
-    public:
-        Player(int screenW, int screenH)
-            : GameObject({100.0f, (float)screenH - OBSTACLE_PLAYER_SIZE - 50.0f}, OBSTACLE_PLAYER_SIZE, OBSTACLE_PLAYER_SIZE, PURPLE),
-              velocity({0, 0}), onGround(false), jumped(false), m_screenW(screenW), m_screenH(screenH) {}
-
-        Player(Vector2 pos, float size, Color col, int screenW, int screenH)
-            : GameObject(pos, size, size, col), velocity({0, 0}), onGround(false), jumped(false), m_screenW(screenW), m_screenH(screenH) {}
-
-        Player(const Player& other)
-            : GameObject(other), velocity(other.velocity), onGround(other.onGround), jumped(other.jumped), m_screenW(other.m_screenW), m_screenH(other.m_screenH) {}
-
-        ~Player() override = default;
-
-        void Draw() const override {
-            DrawRectangleRounded(bounds, 0.5f, 8, color); // Main body
-            // Little decorative bits for the player
-            DrawRectangle(bounds.x - bounds.width * 0.2f, bounds.y + bounds.height * 0.1f, bounds.width * 0.2f, bounds.height * 0.6f, ColorAlpha(color, 0.8f));
-            Rectangle visor = {bounds.x + bounds.width * 0.2f, bounds.y + bounds.height * 0.2f, bounds.width * 0.6f, bounds.height * 0.3f};
-            DrawRectangleRounded(visor, 0.5f, 8, SKYBLUE);
-            DrawRectangleRoundedLines(visor, 0.5f, 8, 2, DARKBLUE);
-        }
-
-        void Update(float dt) override {
-            velocity.y += OBSTACLE_GRAVITY * dt; // Apply gravity
-
-            // Handle horizontal movement
-            if (IsKeyDown(KEY_LEFT)) {
-                velocity.x = -OBSTACLE_PLAYER_SPEED;
-            } else if (IsKeyDown(KEY_RIGHT)) {
-                velocity.x = OBSTACLE_PLAYER_SPEED;
-            } else {
-                velocity.x = 0;
-            }
-
-            // Handle jumping
-            if (IsKeyPressed(KEY_SPACE) && onGround) {
-                velocity.y = -OBSTACLE_JUMP_FORCE; // Instant upward force
-                onGround = false;
-                jumped = true;
-            }
-
-            position.x += velocity.x * dt; // Update horizontal position
-            position.y += velocity.y * dt; // Update vertical position
-
-            bounds.x = position.x;
-            bounds.y = position.y;
-
-            // Keep player within horizontal screen bounds
-            if (position.x < 0) {
-                position.x = 0;
-                velocity.x = 0;
-            } else if (position.x + bounds.width > m_screenW) {
-                position.x = m_screenW - bounds.width;
-                velocity.x = 0;
-            }
-            onGround = false; // Assume off ground until collision detects otherwise
-        }
-
-        Vector2 GetVelocity() const { return velocity; }
-        bool IsOnGround() const { return onGround; }
-        bool HasJumped() const { return jumped; }
-
-        void SetVelocity(Vector2 newVel) { velocity = newVel; }
-        void SetOnGround(bool status) { onGround = status; }
-        void SetJumped(bool status) { jumped = status; }
-
-        // Comparison for player state (useful for debugging/testing)
-        bool operator==(const Player& other) const {
-            return (position.x == other.position.x && position.y == other.position.y);
-        }
-    };
-
-    // Rectangular obstacles that block the player
-    class Obstacle : public GameObject {
-    public:
-        Obstacle() : GameObject() {}
-        Obstacle(Rectangle rect, Color col = BLUE) : GameObject({rect.x, rect.y}, rect.width, rect.height, col) {}
-        Obstacle(const Obstacle& other) : GameObject(other) {}
-        ~Obstacle() override = default;
-
-        void Draw() const override {
-            DrawRectangleRec(bounds, color);
-        }
-        void Update(float dt) override {}
-    };
-
-    // Collectible coins!
-    class Coin : public GameObject {
-    public:
-        Coin() : GameObject() {}
-        Coin(Vector2 pos, float size, Color col = YELLOW) : GameObject(pos, size, size, col) {}
-        Coin(const Coin& other) : GameObject(other) {}
-        ~Coin() override = default;
-
-        void Draw() const override {
-            // Draw a circle with a dollar sign on it
-            DrawCircle((int)(bounds.x + bounds.width / 2), (int)(bounds.y + bounds.height / 2), bounds.width / 2, color);
-            DrawCircleLines((int)(bounds.x + bounds.width / 2), (int)(bounds.y + bounds.height / 2), bounds.width / 2, DARKGRAY);
-            const char* dollarSign = "$";
-            int fontSize = (int)(bounds.width * 0.6f);
-            int textWidth = MeasureText(dollarSign, fontSize);
-            DrawText(dollarSign, (int)(bounds.x + bounds.width / 2 - textWidth / 2), (int)(bounds.y + bounds.height / 2 - fontSize / 2), fontSize, BROWN);
-        }
-        void Update(float dt) override {}
-    };
-
-    // The exit door to complete the level
-    class ExitDoor : public GameObject {
-    public:
-        ExitDoor() : GameObject() {}
-        ExitDoor(Rectangle rect, Color col) : GameObject({rect.x, rect.y}, rect.width, rect.height, col) {}
-        ExitDoor(const ExitDoor& other) : GameObject(other) {}
-        ~ExitDoor() override = default;
-
-        void Draw() const override {
-            // Draw a rectangular door with panels
-            DrawRectangleRec(bounds, color);
-            DrawRectangleLinesEx(bounds, 3, BLACK);
-            Rectangle panel1 = {bounds.x + bounds.width * 0.1f, bounds.y + bounds.height * 0.1f, bounds.width * 0.8f, bounds.height * 0.4f};
-            Rectangle panel2 = {bounds.x + bounds.width * 0.1f, bounds.y + bounds.height * 0.55f, bounds.width * 0.8f, bounds.height * 0.35f};
-            DrawRectangleRec(panel1, DARKBROWN);
-            DrawRectangleRec(panel2, DARKBROWN);
-            DrawRectangleLinesEx(panel1, 2, BLACK);
-            DrawRectangleLinesEx(panel2, 2, BLACK);
-            DrawText("EXIT", (int)bounds.x + 5, (int)bounds.y - 20, 15, WHITE);
-        }
-        void Update(float dt) override {}
-    };
-
-    ObstacleLevel(int screenW, int screenH);
-    ~ObstacleLevel() override;
-
-    void Load() override;
-    void Unload() override;
-    void Update(float dt) override;
-    void Draw() override;
-    bool IsComplete() override;
-    std::string GetName() const override { return "Obstacle Course Level"; }
-    std::string GetInstructions() const override { return "Use LEFT/RIGHT arrows to move. \n \n Press SPACE to jump. \n \n Collect all coins and reach the EXIT door to win!"; }
-
-    bool DidPlayerWinThisLevel() const { return m_playerWonLevel; }
-
-private:
-    Player m_player;
-    ExitDoor m_exitDoor;
-    std::vector<std::unique_ptr<GameObject>> m_obstacles; // Store various obstacles
-    std::vector<std::unique_ptr<Coin>> m_coins;
-    ObstacleGameScreen m_currentScreen;
-    bool m_levelFinished;
-    bool m_playerWonLevel;
-    Vector2 m_startPoint; // Player's starting position
-    int m_collectedCoins;
-    int m_totalCoins;
-
-    void InitObstacleGame(); // Setup for a new game in this level
-};
-
-ObstacleLevel::ObstacleLevel(int screenW, int screenH)
-    : Levels(screenW, screenH),
-      m_player(screenW, screenH),
-      m_exitDoor(),
-      m_currentScreen(OBSTACLE_TITLE),
-      m_levelFinished(false),
-      m_playerWonLevel(false),
-      m_startPoint({0,0}),
-      m_collectedCoins(0),
-      m_totalCoins(0)
-{
-}
-
-ObstacleLevel::~ObstacleLevel() {
-    Unload();
-}
-
-void ObstacleLevel::InitObstacleGame() {
-    // Reset player and set starting point
-    m_player = Player({100.0f, (float)screenHeight - OBSTACLE_PLAYER_SIZE - 50.0f}, OBSTACLE_PLAYER_SIZE, PURPLE, screenWidth, screenHeight);
-    m_startPoint = m_player.GetPosition();
-
-    // Set the exit door's position
-    m_exitDoor = ExitDoor({ (float)screenWidth - 100.0f, 50.0f, 50.0f, 80.0f }, BROWN);
-
-    m_obstacles.clear();
-    m_coins.clear();
-
-    // Add ground obstacle (bottom of the screen)
-    m_obstacles.push_back(std::make_unique<Obstacle>(Rectangle{ 0, (float)screenHeight - 50, (float)screenWidth, 50 }));
-
-    // Add various platforms as obstacles
-    m_obstacles.push_back(std::make_unique<Obstacle>(Rectangle{ 150, (float)screenHeight - 150, 100, 20 }));
-    m_obstacles.push_back(std::make_unique<Obstacle>(Rectangle{ 300, (float)screenHeight - 250, 90, 20 }));
-    m_obstacles.push_back(std::make_unique<Obstacle>(Rectangle{ 450, (float)screenHeight - 350, 80, 20 }));
-
-    m_obstacles.push_back(std::make_unique<Obstacle>(Rectangle{ 550, (float)screenHeight - 300, 60, 20 }));
-    m_obstacles.push_back(std::make_unique<Obstacle>(Rectangle{ 700, (float)screenHeight - 300, 60, 20 }));
-
-    m_obstacles.push_back(std::make_unique<Obstacle>(Rectangle{ 800, (float)screenHeight - 400, 50, 20 }));
-    m_obstacles.push_back(std::make_unique<Obstacle>(Rectangle{ 900, (float)screenHeight - 500, 50, 20 }));
-    m_obstacles.push_back(std::make_unique<Obstacle>(Rectangle{ 800, (float)screenHeight - 600, 50, 20 }));
-
-    m_obstacles.push_back(std::make_unique<Obstacle>(Rectangle{ 950, (float)screenHeight - 550, 60, 20 }));
-    m_obstacles.push_back(std::make_unique<Obstacle>(Rectangle{ 1100, (float)screenHeight - 450, 70, 20 }));
-
-    m_obstacles.push_back(std::make_unique<Obstacle>(Rectangle{ 1150, (float)screenHeight - 300, 50, 20 }));
-    m_obstacles.push_back(std::make_unique<Obstacle>(Rectangle{ (float)screenWidth - 150, (float)screenHeight - 100, 100, 20 }));
-    m_obstacles.push_back(std::make_unique<Obstacle>(Rectangle{ 1000, (float)screenHeight - 200, 80, 20 }));
-
-    // Spawn coins above platforms
-    float coinSize = 20.0f;
-    for (const auto& obs_ptr : m_obstacles) {
-        if (obs_ptr->GetBounds().height < 50 && obs_ptr->GetBounds().y < screenHeight - 50) { // Only add coins to platforms
-            Vector2 coinPos = {
-                obs_ptr->GetBounds().x + obs_ptr->GetBounds().width / 2 - coinSize / 2,
-                obs_ptr->GetBounds().y - coinSize - 10
-            };
-            m_coins.push_back(std::make_unique<Coin>(coinPos, coinSize));
-        }
-    }
-    m_totalCoins = m_coins.size(); // Keep track of total coins
-    m_collectedCoins = 0;
-
-    m_currentScreen = OBSTACLE_GAMEPLAY; // Start directly in gameplay for this level
-    m_levelFinished = false;
-    m_playerWonLevel = false;
-}
-
-void ObstacleLevel::Load() {
-    InitObstacleGame(); // Prepare the level for play
-}
-
-void ObstacleLevel::Unload() {
-    m_obstacles.clear(); // Clear all unique pointers
-    m_coins.clear();
-}
-
-void ObstacleLevel::Update(float dt) {
-    switch (m_currentScreen) {
-        case OBSTACLE_GAMEPLAY: {
-            m_player.Update(dt); // Update player physics and input
-
-            m_player.SetOnGround(false); // Assume airborne until collision with ground/platform
-
-            // Handle player-obstacle collisions
-            for (const auto& obs_ptr : m_obstacles) {
-                if (CheckCollisionRecs(m_player.GetBounds(), obs_ptr->GetBounds())) {
-                    // Check for collision from above (landing on platform)
-                    if (m_player.GetVelocity().y > 0 && m_player.GetBounds().y + m_player.GetBounds().height - m_player.GetVelocity().y * dt <= obs_ptr->GetBounds().y) {
-                        m_player.SetPosition({m_player.GetPosition().x, obs_ptr->GetBounds().y - m_player.GetBounds().height});
-                        m_player.SetVelocity({m_player.GetVelocity().x, 0}); // Stop vertical movement
-                        m_player.SetOnGround(true);
-                        m_player.SetJumped(false);
-                    }
-                    // Check for collision from below (hitting head on platform)
-                    else if (m_player.GetVelocity().y < 0 && m_player.GetBounds().y - m_player.GetBounds().y * dt >= obs_ptr->GetBounds().y + obs_ptr->GetBounds().height) {
-                        m_player.SetPosition({m_player.GetPosition().x, obs_ptr->GetBounds().y + obs_ptr->GetBounds().height});
-                        m_player.SetVelocity({m_player.GetVelocity().x, 0}); // Stop upward movement
-                    }
-                    // Check for collision from left (hitting side of platform)
-                    else if (m_player.GetVelocity().x > 0 && m_player.GetBounds().x + m_player.GetBounds().width - m_player.GetVelocity().x * dt <= obs_ptr->GetBounds().x) {
-                        m_player.SetPosition({obs_ptr->GetBounds().x - m_player.GetBounds().width, m_player.GetPosition().y});
-                        m_player.SetVelocity({0, m_player.GetVelocity().y}); // Stop horizontal movement
-                    }
-                    // Check for collision from right (hitting side of platform)
-                    else if (m_player.GetVelocity().x < 0 && m_player.GetBounds().x - m_player.GetVelocity().x * dt >= obs_ptr->GetBounds().x + obs_ptr->GetBounds().width) {
-                        m_player.SetPosition({obs_ptr->GetBounds().x + obs_ptr->GetBounds().width, m_player.GetPosition().y});
-                        m_player.SetVelocity({0, m_player.GetVelocity().y}); // Stop horizontal movement
-                    }
-                }
-            }
-
-            // Check for coin collection
-            for (int i = 0; i < m_coins.size(); ) {
-                if (CheckCollisionRecs(m_player.GetBounds(), m_coins[i]->GetBounds())) {
-                    m_collectedCoins++;
-                    m_coins.erase(m_coins.begin() + i); // Remove collected coin
-                } else {
-                    i++; // Move to next coin
-                }
-            }
-
-            // Check if player fell off the screen (game over)
-            if (m_player.GetPosition().y > screenHeight) {
-                m_levelFinished = true;
-                m_playerWonLevel = false;
-                m_currentScreen = OBSTACLE_ENDING;
-            }
-
-            // Check for level completion (reached exit door and collected all coins)
-            if (CheckCollisionRecs(m_player.GetBounds(), m_exitDoor.GetBounds())) {
-                if (m_collectedCoins == m_totalCoins) {
-                    m_playerWonLevel = true;
-                    m_levelFinished = true;
-                    m_currentScreen = OBSTACLE_ENDING;
-                }
-            }
-        } break;
-        case OBSTACLE_ENDING: {
-            // Nothing to update, waiting for main game state to change
-        } break;
-        default: break;
-    }
-}
-
-void ObstacleLevel::Draw() {
-    switch (m_currentScreen) {
-        case OBSTACLE_GAMEPLAY: {
-            // Draw all obstacles and coins
-            for (const auto& obs_ptr : m_obstacles) {
-                obs_ptr->Draw();
-            }
-            for (const auto& coin_ptr : m_coins) {
-                coin_ptr->Draw();
-            }
-            m_player.Draw(); // Draw the player
-            m_exitDoor.Draw(); // Draw the exit door
-
-            // Draw start point indicator
-            DrawCircle((int)m_startPoint.x + (int)OBSTACLE_PLAYER_SIZE / 2, (int)m_startPoint.y + (int)OBSTACLE_PLAYER_SIZE / 2, 10, GREEN);
-            DrawText("START", (int)m_startPoint.x, (int)m_startPoint.y - 20, 15, GREEN);
-            // Display coin count
-            DrawText(TextFormat("Coins: %d/%d", m_collectedCoins, m_totalCoins), 10, 10, 20, WHITE);
-        } break;
-        case OBSTACLE_ENDING: {
-            // Display win or lose message
-            if (m_playerWonLevel) {
-                DrawText("LEVEL COMPLETE!", screenWidth / 2 - MeasureText("LEVEL COMPLETE!", 50) / 2, screenHeight / 3, 50, GOLD);
-                DrawText(TextFormat("Collected: %d/%d Coins", m_collectedCoins, m_totalCoins), screenWidth / 2 - MeasureText(TextFormat("Collected: %d/%d Coins", m_collectedCoins, m_totalCoins), 30) / 2, screenHeight / 3 + 60, 30, WHITE);
-            } else {
-                DrawText("GAME OVER!", screenWidth / 2 - MeasureText("GAME OVER!", 60) / 2, screenHeight / 3, 60, RED);
-            }
-        } break;
-        default: break;
-    }
-}
-
-bool ObstacleLevel::IsComplete() {
-    return m_levelFinished; // Level is complete when the internal state says so
-}
-
-
-// Enum for the overall game screens/states
-enum GameScreen {
-    TITLE_SCREEN_GLOBAL,         // The very first screen of the game
-    PLAYING_LEVEL,               // A level from our queue is active
-    LEVEL_TRANSITION,            // Screen between levels
-    GAME_OVER_GLOBAL,            // Player lost the whole game
-    GAME_WON_GLOBAL              // Player completed all levels
-};
-
-GameScreen currentGlobalScreen = TITLE_SCREEN_GLOBAL; // Start here!
-std::queue<std::unique_ptr<Levels>> gameLevels; // The order of levels to play
-std::unique_ptr<Levels> currentActiveLevel = nullptr; // The level we are currently playing
-
-std::string nextLevelName = "";
-std::string nextLevelInstructions = "";
-Rectangle confirmButton = { (float)GLOBAL_SCREEN_WIDTH / 2 - 100, (float)GLOBAL_SCREEN_HEIGHT * 0.75f, 200, 50 };
-
-// Forward declarations for our global UI drawing functions
-void DrawStartingScreen();
-void DrawLevelTransitionScreen();
-void DrawGlobalGameOverScreen();
-void DrawGlobalGameWonScreen();
-void SetupGameLevels(); // Prepares the sequence of levels
-void LoadNextLevel(); // Loads the next level from the queue
-
-// Function to draw the new starting screen
-void DrawStartingScreen() {
-    ClearBackground(BLACK); // Black background for the start screen
-
-    // Text inviting the player to "escape" or "suffer"
-    const char* descriptionText = "You are in prison for kidnapping a qurbani ka bakra,\n \n \n \n \n \n \n \n       you should";
-    int fontSize = 30;
-    int textWidth = MeasureText(descriptionText, fontSize);
-    DrawText(descriptionText, GLOBAL_SCREEN_WIDTH / 2 - textWidth / 2, GLOBAL_SCREEN_HEIGHT / 2 - 150, fontSize, WHITE);
-
-    // "Escape" Button
-    Rectangle escapeButtonRec = { (float)GLOBAL_SCREEN_WIDTH / 2 - 150, (float)GLOBAL_SCREEN_HEIGHT / 2 + 50, 300, 70 };
-    DrawRectangleRec(escapeButtonRec, GREEN);
-    DrawText("ESCAPE", (int)(escapeButtonRec.x + escapeButtonRec.width / 2 - MeasureText("ESCAPE", 40) / 2), (int)(escapeButtonRec.y + escapeButtonRec.height / 2 - 20), 40, BLACK);
-
-    // "Suffer" Button
-    Rectangle sufferButtonRec = { (float)GLOBAL_SCREEN_WIDTH / 2 - 150, (float)GLOBAL_SCREEN_HEIGHT / 2 + 150, 300, 70 };
-    DrawRectangleRec(sufferButtonRec, RED);
-    DrawText("SUFFER", (int)(sufferButtonRec.x + sufferButtonRec.width / 2 - MeasureText("SUFFER", 40) / 2), (int)(sufferButtonRec.y + sufferButtonRec.height / 2 - 20), 40, BLACK);
-
-    // Check for button clicks
-    if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON)) {
-        Vector2 mousePoint = GetMousePosition();
-
-        if (CheckCollisionPointRec(mousePoint, escapeButtonRec)) {
-            showSufferMessage = false; // Hide message if it was showing
-            SetupGameLevels(); // Populate the queue with levels
-            LoadNextLevel();   // Load the first level into memory
-            currentGlobalScreen = PLAYING_LEVEL; // Change state to main game
-            std::cout << "Escape button pressed! Changing to PLAYING_LEVEL." << std::endl; // Debug output
-        } else if (CheckCollisionPointRec(mousePoint, sufferButtonRec)) {
-            showSufferMessage = true;
-            sufferMessageTimer = 0.0f; // Reset timer for the message
-            std::cout << "Suffer button pressed! Displaying message." << std::endl; // Debug output
-        }
-    }
-
-    // Update and draw "Suffer" message if active
-    if (showSufferMessage) {
-        sufferMessageTimer += GetFrameTime();
-        if (sufferMessageTimer < SUFFER_MESSAGE_DISPLAY_TIME) {
-            DrawText("NO LOSER YOU NEED TO ESCAPE", GLOBAL_SCREEN_WIDTH / 2 - MeasureText("NO LOSER YOU NEED TO ESCAPE", 30) / 2, GLOBAL_SCREEN_HEIGHT / 2 + 280, 30, YELLOW);
-        } else {
-            showSufferMessage = false; // Hide message after its time
-        }
-    }
-}
-
-
-// Main game loop and state management
-int main() {
-    InitWindow(GLOBAL_SCREEN_WIDTH, GLOBAL_SCREEN_HEIGHT, ""); // Initialize the game window
-    SetTargetFPS(60); // Aim for 60 frames per second
-
-    while (!WindowShouldClose()) { // Loop while the window is open
-        float deltaTime = GetFrameTime(); // Time since last frame
-
-        // Update logic based on the current overall game screen
-        switch (currentGlobalScreen) {
-            case TITLE_SCREEN_GLOBAL:
-                // All title screen updates are handled within DrawStartingScreen() now.
-                break;
-            case PLAYING_LEVEL:
-                if (currentActiveLevel) {
-                    currentActiveLevel->Update(deltaTime); // Update the current level
-                    if (currentActiveLevel->IsComplete()) { // Check if the level is finished
-                        bool levelSucceeded = true;
-                        // Special checks for specific level types to see if player won or lost
-                        if (currentActiveLevel->GetName() == "Space Invaders Level") {
-                            SpaceInvadersLevel* siLevel = static_cast<SpaceInvadersLevel*>(currentActiveLevel.get());
-                            if (!siLevel->DidPlayerWinThisLevel()) {
-                                levelSucceeded = false;
-                            }
-                        } else if (currentActiveLevel->GetName() == "Flappy Level") {
-                            FlappyLevel* flappyLevel = static_cast<FlappyLevel*>(currentActiveLevel.get());
-                            if (!flappyLevel->DidPlayerWinThisLevel()) {
-                                levelSucceeded = false;
-                            }
-                        } else if (currentActiveLevel->GetName() == "Obstacle Course Level") {
-                            ObstacleLevel* obstacleLevel = static_cast<ObstacleLevel*>(currentActiveLevel.get());
-                            if (!obstacleLevel->DidPlayerWinThisLevel()) {
-                                levelSucceeded = false;
-                            }
-                        }
-                        // MazeLevel's IsComplete() means a win for that level
-
-                        currentActiveLevel->Unload(); // Clean up current level's resources
-
-                        if (levelSucceeded) {
-                            if (!gameLevels.empty()) {
-                                // Prepare data for the transition screen to the next level
-                                nextLevelName = gameLevels.front()->GetName();
-                                nextLevelInstructions = gameLevels.front()->GetInstructions();
-                                currentGlobalScreen = LEVEL_TRANSITION; // Go to the transition screen
-                            } else {
-                                currentActiveLevel = nullptr; // No more levels left
-                                currentGlobalScreen = GAME_WON_GLOBAL; // Player completed all levels!
-                            }
-                        } else {
-                            currentActiveLevel = nullptr; // Level failed
-                            currentGlobalScreen = GAME_OVER_GLOBAL; // Game Over for the whole game
-                        }
-                    }
-                } else {
-                    currentGlobalScreen = GAME_OVER_GLOBAL; // Fallback to game over if somehow no active level
-                }
-                break;
-
-            case LEVEL_TRANSITION: {
-                // Wait for the player to click "Ready!"
-                if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON)) {
-                    if (CheckCollisionPointRec(GetMousePosition(), confirmButton)) {
-                        LoadNextLevel(); // Load the next level
-                        if (currentActiveLevel) {
-                            currentGlobalScreen = PLAYING_LEVEL; // Start playing the new level
-                        } else {
-                            currentGlobalScreen = GAME_WON_GLOBAL; // Should mean all levels are done
-                        }
-                    }
-                }
-            } break;
-
-            case GAME_OVER_GLOBAL:
-                if (IsKeyPressed(KEY_ENTER)) { // Press Enter to go back to title
-                    currentGlobalScreen = TITLE_SCREEN_GLOBAL;
-                    showSufferMessage = false; // Reset title screen messages
-                    sufferMessageTimer = 0.0f;
-                }
-                break;
-
-            case GAME_WON_GLOBAL:
-                if (IsKeyPressed(KEY_ENTER)) { // Press Enter to go back to title
-                    currentGlobalScreen = TITLE_SCREEN_GLOBAL;
-                    showSufferMessage = false; // Reset title screen messages
-                    sufferMessageTimer = 0.0f;
-                }
-                break;
-        }
-
-        BeginDrawing(); // Start drawing for this frame
-        ClearBackground(BLACK); // Clear screen to black
-
-        // Draw based on the current overall game screen
-        if (currentGlobalScreen == PLAYING_LEVEL && currentActiveLevel) {
-            currentActiveLevel->Draw(); // Draw the current active game level
-        } else if (currentGlobalScreen == TITLE_SCREEN_GLOBAL) {
-            DrawStartingScreen(); // Draw the initial game start screen
-        } else if (currentGlobalScreen == LEVEL_TRANSITION) {
-            DrawLevelTransitionScreen(); // Draw the screen between levels
-        } else if (currentGlobalScreen == GAME_OVER_GLOBAL) {
-            DrawGlobalGameOverScreen(); // Draw the game over screen
-        } else if (currentGlobalScreen == GAME_WON_GLOBAL) {
-            DrawGlobalGameWonScreen(); // Draw the game won screen
-        }
-
-        EndDrawing(); // End drawing for this frame
-    }
-
-    // Clean up resources before closing the window
-    if (currentActiveLevel) {
-        currentActiveLevel->Unload();
-    }
-
-    CloseWindow(); // Close the Raylib window
-    return 0;
-}
-
-
-// Draws the screen shown between levels
-void DrawLevelTransitionScreen() {
-    DrawRectangle(0, 0, GLOBAL_SCREEN_WIDTH, GLOBAL_SCREEN_HEIGHT, Fade(BLACK, 0.8f)); // Dark overlay
-
-    // Display next level's name and instructions
-    const char* titleText = "Next Level: ";
-    int titleFontSize = 40;
-    int titleTextWidth = MeasureText(titleText, titleFontSize);
-    int nameTextWidth = MeasureText(nextLevelName.c_str(), titleFontSize);
-    DrawText(titleText, GLOBAL_SCREEN_WIDTH / 2 - (titleTextWidth + nameTextWidth) / 2, GLOBAL_SCREEN_HEIGHT / 4, titleFontSize, RAYWHITE);
-    DrawText(nextLevelName.c_str(), GLOBAL_SCREEN_WIDTH / 2 - (titleTextWidth + nameTextWidth) / 2 + titleTextWidth, GLOBAL_SCREEN_HEIGHT / 4, titleFontSize, GOLD);
-
-    DrawText("How to Play:", GLOBAL_SCREEN_WIDTH / 2 - MeasureText("How to Play:", 30) / 2, GLOBAL_SCREEN_HEIGHT / 2 - 50, 30, RAYWHITE);
-    DrawText(nextLevelInstructions.c_str(), GLOBAL_SCREEN_WIDTH / 2 - MeasureText(nextLevelInstructions.c_str(), 25) / 2, GLOBAL_SCREEN_HEIGHT / 2, 25, LIGHTGRAY);
-
-    // "Ready!" button to proceed
-    DrawRectangleRec(confirmButton, DARKGREEN);
-    DrawRectangleLinesEx(confirmButton, 3, GREEN);
-    const char* buttonText = "Ready!";
-    int buttonTextWidth = MeasureText(buttonText, 30);
-    DrawText(buttonText, (int)(confirmButton.x + confirmButton.width / 2 - buttonTextWidth / 2), (int)(confirmButton.y + confirmButton.height / 2 - 15), 30, RAYWHITE);
-}
-
-// Draws the screen when the player loses the entire game
-void DrawGlobalGameOverScreen() {
-    DrawText("loser you got caught.", GLOBAL_SCREEN_WIDTH / 2 - MeasureText("GAME OVER!", 60) / 2, GLOBAL_SCREEN_HEIGHT / 2 - 50, 60, RED);
-    DrawText("Press ENTER to bribe & Try Again", GLOBAL_SCREEN_WIDTH / 2 - MeasureText("Press ENTER to Try Again", 30) / 2, GLOBAL_SCREEN_HEIGHT / 2 + 20, 30, WHITE);
-}
-
-// Draws the screen when the player wins the entire game
-void DrawGlobalGameWonScreen() {
-    DrawText("CONGRATULATIONS!", GLOBAL_SCREEN_WIDTH / 2 - MeasureText("CONGRATULATIONS!", 50) / 2, GLOBAL_SCREEN_HEIGHT / 2 - 80, 50, GOLD);
-    DrawText("You Escaped prison!", GLOBAL_SCREEN_WIDTH / 2 - MeasureText("You Escaped ALL Levels!", 40) / 2, GLOBAL_SCREEN_HEIGHT / 2 - 20, 40, LIME);
-    DrawText("Press ENTER to kidnap a bakra again!", GLOBAL_SCREEN_WIDTH / 2 - MeasureText("Press ENTER to Play Again", 30) / 2, GLOBAL_SCREEN_HEIGHT / 2 + 50, 30, WHITE);
-}
-
-// Sets up the predefined order of levels for the game
-void SetupGameLevels() {
-    // Clear any previous levels
-    while (!gameLevels.empty()) {
-        gameLevels.pop();
-    }
-
-    // Add levels in sequence
-    gameLevels.push(std::make_unique<MazeLevel>(GLOBAL_SCREEN_WIDTH, GLOBAL_SCREEN_HEIGHT));
-    gameLevels.push(std::make_unique<SpaceInvadersLevel>(GLOBAL_SCREEN_WIDTH, GLOBAL_SCREEN_HEIGHT));
-    gameLevels.push(std::make_unique<FlappyLevel>(GLOBAL_SCREEN_WIDTH, GLOBAL_SCREEN_HEIGHT));
-    gameLevels.push(std::make_unique<ObstacleLevel>(GLOBAL_SCREEN_WIDTH, GLOBAL_SCREEN_HEIGHT));
-}
-
-// Helper function to load the next level from our queue
-void LoadNextLevel() {
-    // Unload the current level if one is active
-    if (currentActiveLevel) {
-        currentActiveLevel->Unload();
-        currentActiveLevel = nullptr; // Ensure proper deallocation
-    }
-    
-    // If there are more levels in the queue, load the next one
-    if (!gameLevels.empty()) {
-        currentActiveLevel = std::move(gameLevels.front()); // Take ownership of the next level
-        gameLevels.pop(); // Remove it from the queue
-        currentActiveLevel->Load(); // Initialize the new level
-        std::cout << "Loading Level: " << currentActiveLevel->GetName() << std::endl; // Debug output
-        std::cout << "Instructions: " << currentActiveLevel->GetInstructions() << std::endl; // Debug output
-    } else {
-        currentActiveLevel = nullptr; // No more levels left
-    }
-}
+#include "raylib.h"
+#include <vector>
+#include <string>
+#include <random>
+#include <chrono>
+#include <algorithm>
+#include <memory>
+#include <iostream>
+#include <functional>
+#include <atomic>
+#include <mutex>
+#include <tuple>
+#include <cstring>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+#include <new>
+#include <stdexcept>
+#include <cstddef>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <cassert>
+#include <array>
+#include <future>
+#include <thread>
+#include <initializer_list>
+#include <iterator>
+#include <cmath>
+#include <cctype>
+#include <deque>
+#include <condition_variable>
+#include <ctime>
+#include <cerrno>
+#ifdef __linux__
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <dirent.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <netinet/tcp.h>
+#endif
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// The sprite atlas written by --bake-atlas. Without it the atlas is rasterized at startup.
+#if defined(__has_include)
+#if __has_include("bakra_atlas.h")
+#include "bakra_atlas.h"
+#define BAKRA_BAKED_ATLAS
+#endif
+#endif
+
+const int GLOBAL_SCREEN_WIDTH = 1280;
+const int GLOBAL_SCREEN_HEIGHT = 720;
+
+// Variables for the starting screen's "suffer" message
+static bool showSufferMessage = false;
+static float sufferMessageTimer = 0.0f;
+const float SUFFER_MESSAGE_DISPLAY_TIME = 2.0f; // How long the message sticks around
+
+
+// Cold start: where the time goes between exec and the first presented frame, and the startup
+// work that --fast-start leaves until the title screen is up. Kept first in the file so the
+// profile is the first thing our static initializers construct.
+namespace startup {
+
+// How long ago the process was exec'd, from the kernel's start time (10 ms ticks); -1 if unknown
+double SecondsSinceExec() {
+#ifdef __linux__
+    FILE* statFile = std::fopen("/proc/self/stat", "r");
+    if (!statFile) return -1.0;
+    char line[1024];
+    size_t length = std::fread(line, 1, sizeof(line) - 1, statFile);
+    std::fclose(statFile);
+    line[length] = '\0';
+    const char* field = std::strrchr(line, ')'); // The command name may hold spaces
+    if (!field) return -1.0;
+    for (int skipped = 0; skipped < 20 && field; ++skipped) field = std::strchr(field + 1, ' '); // On to field 22
+    timespec now;
+    if (!field || clock_gettime(CLOCK_BOOTTIME, &now) != 0) return -1.0;
+    double startSeconds = (double)std::strtoull(field + 1, nullptr, 10) / (double)sysconf(_SC_CLK_TCK);
+    return std::max(0.0, (double)now.tv_sec + now.tv_nsec * 1e-9 - startSeconds);
+#else
+    return -1.0;
+#endif
+}
+
+// Named points in time since the profile was constructed. The report goes out once the first
+// frame has been presented and the deferred work is done, whichever comes last, so it also
+// covers what a fast start put off.
+class Profile {
+public:
+    static const size_t MAX_MARKS = 24;
+
+    Profile() : m_start(std::chrono::steady_clock::now()), m_execSeconds(SecondsSinceExec()), m_count(0),
+                m_outstanding(2), m_verbose(false), m_simulated(false), m_presented(false) {}
+
+    void SetVerbose(bool verbose) { m_verbose = verbose; } // Before anything is marked
+    bool Presented() const { return m_presented.load(std::memory_order_acquire); }
+
+    // Records that the phase called 'name' ended now
+    void Mark(const char* name) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_count < MAX_MARKS) m_marks[m_count++] = { name, std::chrono::steady_clock::now() };
+    }
+
+    // Called every frame; only the first of each counts
+    void FrameSimulated() {
+        if (m_simulated.load(std::memory_order_relaxed) || m_simulated.exchange(true)) return;
+        Mark("first frame recorded");
+    }
+    void FramePresented() {
+        if (m_presented.load(std::memory_order_relaxed)) return;
+        Mark("first frame presented");
+        m_presented.store(true, std::memory_order_release);
+        Arrive();
+    }
+    void WorkDone() { Arrive(); }
+
+private:
+    struct Entry {
+        const char* name;
+        std::chrono::steady_clock::time_point at;
+    };
+
+    std::chrono::steady_clock::time_point m_start; // Our first static initializer
+    double m_execSeconds;
+    std::mutex m_mutex;
+    Entry m_marks[MAX_MARKS];
+    size_t m_count;
+    std::atomic<int> m_outstanding; // The first frame and the deferred work
+    bool m_verbose;
+    std::atomic<bool> m_simulated;
+    std::atomic<bool> m_presented;
+
+    void Arrive() {
+        if (m_outstanding.fetch_sub(1, std::memory_order_acq_rel) == 1) Report();
+    }
+
+    // Milliseconds since exec, or since our static initializers when exec time is unknown
+    double Millis(std::chrono::steady_clock::time_point at) const {
+        return std::max(0.0, m_execSeconds) * 1000.0 + std::chrono::duration<double, std::milli>(at - m_start).count();
+    }
+
+    void Report() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const char* since = m_execSeconds >= 0.0 ? "exec" : "static init";
+        double firstFrame = 0.0;
+        for (size_t i = 0; i < m_count; ++i) {
+            if (std::strcmp(m_marks[i].name, "first frame presented") == 0) firstFrame = Millis(m_marks[i].at);
+        }
+        double ready = m_count != 0 ? Millis(m_marks[m_count - 1].at) : 0.0;
+        std::printf("Startup: first frame %.1f ms, fully loaded %.1f ms after %s\n", firstFrame, ready, since);
+        if (m_verbose) {
+            std::printf("  %-26s %9s %9s\n", "phase", "ends at", "took");
+            double previous = std::max(0.0, m_execSeconds) * 1000.0;
+            if (m_execSeconds >= 0.0) std::printf("  %-26s %9.1f %9.1f\n", "exec and dynamic linking", previous, previous);
+            for (size_t i = 0; i < m_count; ++i) {
+                double at = Millis(m_marks[i].at);
+                std::printf("  %-26s %9.1f %9.1f\n", m_marks[i].name, at, at - previous);
+                previous = at;
+            }
+        }
+        std::fflush(stdout);
+    }
+};
+
+Profile profile;
+
+// Startup work the title screen can do without. Steps run in order on the thread that
+// simulates, one per frame after the first one is up, so no frame pays for all of them.
+class DeferredWork {
+public:
+    DeferredWork() : m_next(0) {}
+
+    void Add(const char* name, std::function<void()> step) { m_steps.push_back({ name, std::move(step) }); }
+    bool Pending() const { return m_next < m_steps.size(); }
+
+    void RunNext() {
+        if (!Pending()) return;
+        Step& step = m_steps[m_next++];
+        step.run();
+        profile.Mark(step.name);
+        if (!Pending()) profile.WorkDone();
+    }
+
+    // Runs whatever is left right now, for when something needs it
+    void Finish() {
+        while (Pending()) RunNext();
+    }
+
+private:
+    struct Step {
+        const char* name;
+        std::function<void()> run;
+    };
+    std::vector<Step> m_steps;
+    size_t m_next;
+};
+
+} // namespace startup
+
+
+// Memory for everything a level owns comes from its own arena. Allocation is a pointer bump,
+// and unloading a level is a single Reset() instead of freeing every object one by one.
+namespace mem {
+
+class MonotonicArena {
+public:
+    explicit MonotonicArena(size_t firstBlockSize = 256 * 1024)
+        : m_firstBlockSize(firstBlockSize), m_current(0), m_offset(0), m_used(0), m_highWater(0) {}
+    MonotonicArena(const MonotonicArena&) = delete;
+    MonotonicArena& operator=(const MonotonicArena&) = delete;
+
+    void* Allocate(size_t size, size_t align = alignof(std::max_align_t)) {
+        while (true) {
+            if (m_current < m_blocks.size()) {
+                Block& block = m_blocks[m_current];
+                // Align the actual address, not just the offset (blocks are only max_align_t aligned)
+                uintptr_t base = reinterpret_cast<uintptr_t>(block.data.get());
+                size_t start = (size_t)(((base + m_offset + align - 1) & ~(uintptr_t)(align - 1)) - base);
+                if (start + size <= block.size) {
+                    m_offset = start + size;
+                    m_used += size;
+                    m_highWater = std::max(m_highWater, m_used);
+                    return block.data.get() + start;
+                }
+                // Block is full, try the next one we already own
+                m_current++;
+                m_offset = 0;
+                continue;
+            }
+            // Out of blocks: grab a bigger one (kept for the lifetime of the arena)
+            size_t lastSize = m_blocks.empty() ? m_firstBlockSize / 2 : m_blocks.back().size;
+            size_t blockSize = std::max(lastSize * 2, size + align);
+            m_blocks.push_back({ std::unique_ptr<unsigned char[]>(new unsigned char[blockSize]), blockSize });
+        }
+    }
+
+    // Placement-constructs a T inside the arena. The destructor is never run, so only plain data belongs here.
+    template <typename T, typename... Args>
+    T* New(Args&&... args) {
+        static_assert(std::is_trivially_destructible<T>::value, "Arena objects are never destroyed");
+        return new (Allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+    }
+
+    template <typename T>
+    T* NewArray(size_t count) {
+        static_assert(std::is_trivially_destructible<T>::value, "Arena objects are never destroyed");
+        T* items = static_cast<T*>(Allocate(sizeof(T) * count, alignof(T)));
+        for (size_t i = 0; i < count; ++i) new (items + i) T();
+        return items;
+    }
+
+    // Forgets every allocation at once. Blocks are kept, so the next level load reuses the same memory.
+    void Reset() {
+        m_current = 0;
+        m_offset = 0;
+        m_used = 0;
+    }
+
+    size_t BytesUsed() const { return m_used; }
+    size_t HighWater() const { return m_highWater; }
+    size_t BytesReserved() const {
+        size_t total = 0;
+        for (const auto& block : m_blocks) total += block.size;
+        return total;
+    }
+
+private:
+    struct Block {
+        std::unique_ptr<unsigned char[]> data;
+        size_t size;
+    };
+
+    std::vector<Block> m_blocks;
+    size_t m_firstBlockSize;
+    size_t m_current; // Index of the block we are bumping in
+    size_t m_offset;  // Bump offset inside that block
+    size_t m_used;
+    size_t m_highWater;
+};
+
+// Fixed-size slots carved out of an arena, with a free list so slots can be recycled
+// while the level runs. Reset() goes together with the arena's Reset().
+class FixedPool {
+public:
+    FixedPool(MonotonicArena& arena, size_t slotSize, size_t align)
+        : m_arena(arena), m_slotSize(std::max(slotSize, sizeof(FreeSlot))), m_align(align), m_freeHead(nullptr), m_live(0) {}
+
+    void* Allocate() {
+        m_live++;
+        if (m_freeHead) {
+            FreeSlot* slot = m_freeHead;
+            m_freeHead = slot->next;
+            return slot;
+        }
+        return m_arena.Allocate(m_slotSize, m_align);
+    }
+
+    void Free(void* ptr) {
+        FreeSlot* slot = static_cast<FreeSlot*>(ptr);
+        slot->next = m_freeHead;
+        m_freeHead = slot;
+        m_live--;
+    }
+
+    void Reset() {
+        m_freeHead = nullptr;
+        m_live = 0;
+    }
+
+    size_t LiveSlots() const { return m_live; }
+
+private:
+    struct FreeSlot { FreeSlot* next; };
+
+    MonotonicArena& m_arena;
+    size_t m_slotSize;
+    size_t m_align;
+    FreeSlot* m_freeHead;
+    size_t m_live;
+};
+
+// STL allocator that hands out memory from an arena. deallocate() is a no-op:
+// the memory comes back when the arena is reset.
+template <typename T>
+class ArenaAllocator {
+public:
+    using value_type = T;
+
+    explicit ArenaAllocator(MonotonicArena& arena) noexcept : m_arena(&arena) {}
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) noexcept : m_arena(other.GetArena()) {}
+
+    T* allocate(size_t n) { return static_cast<T*>(m_arena->Allocate(n * sizeof(T), alignof(T))); }
+    void deallocate(T*, size_t) noexcept {}
+
+    MonotonicArena* GetArena() const noexcept { return m_arena; }
+
+    template <typename U>
+    bool operator==(const ArenaAllocator<U>& other) const noexcept { return m_arena == other.GetArena(); }
+    template <typename U>
+    bool operator!=(const ArenaAllocator<U>& other) const noexcept { return m_arena != other.GetArena(); }
+
+private:
+    MonotonicArena* m_arena;
+};
+
+// Per-frame scratch memory for short-lived strings and lists. Each thread has its own;
+// the main thread's is reset right after EndDrawing(), so nothing here may outlive the frame.
+inline MonotonicArena& FrameArena() {
+    thread_local MonotonicArena arena(64 * 1024);
+    return arena;
+}
+
+inline void ResetFrameArena() {
+    FrameArena().Reset();
+}
+
+template <typename T>
+struct ScratchAllocator : ArenaAllocator<T> {
+    template <typename U>
+    struct rebind { using other = ScratchAllocator<U>; };
+
+    ScratchAllocator() noexcept : ArenaAllocator<T>(FrameArena()) {}
+    template <typename U>
+    ScratchAllocator(const ScratchAllocator<U>& other) noexcept : ArenaAllocator<T>(other) {}
+};
+
+template <typename T>
+using ScratchVector = std::vector<T, ScratchAllocator<T>>;
+using ScratchString = std::basic_string<char, std::char_traits<char>, ScratchAllocator<char>>;
+
+// printf-style formatting into frame scratch memory; a drop-in for raylib's TextFormat()
+// without its small ring of shared static buffers.
+inline const char* ScratchFormat(const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    va_list sizeArgs;
+    va_copy(sizeArgs, args);
+    int length = std::vsnprintf(nullptr, 0, format, sizeArgs);
+    va_end(sizeArgs);
+    if (length < 0) {
+        va_end(args);
+        return "";
+    }
+    char* buffer = static_cast<char*>(FrameArena().Allocate((size_t)length + 1, 1));
+    std::vsnprintf(buffer, (size_t)length + 1, format, args);
+    va_end(args);
+    return buffer;
+}
+
+} // namespace mem
+
+
+// Heap instrumentation. Both builds replace the global operator new/delete:
+//   -DBAKRA_CHECK_FRAME_ALLOCS  asserts that a level in steady state does not touch the heap
+//   -DBAKRA_MEMORY_TRACKING     counts allocations, bytes and peak usage per level and phase,
+//                               and prints a memory budget report on every level transition
+#if defined(BAKRA_CHECK_FRAME_ALLOCS) || defined(BAKRA_MEMORY_TRACKING)
+#define BAKRA_HOOK_GLOBAL_NEW
+#endif
+
+namespace memtrack {
+
+enum Phase { PHASE_OTHER = 0, PHASE_LOAD, PHASE_UPDATE, PHASE_DRAW, PHASE_COUNT };
+const char* const PHASE_NAMES[PHASE_COUNT] = { "Other", "Load", "Update", "Draw" };
+
+const int MAX_SCOPES = 16;     // Scope 0 is "Global", the rest are level names
+const int SCOPE_NAME_LENGTH = 32;
+
+#ifdef BAKRA_HOOK_GLOBAL_NEW
+static std::atomic<size_t> g_heapAllocations{0}; // Allocations since the frame check last looked
+
+struct PhaseStats {
+    std::atomic<uint64_t> allocations{0};
+    std::atomic<uint64_t> frees{0};
+    std::atomic<uint64_t> bytesAllocated{0};
+};
+
+struct ScopeStats {
+    char name[SCOPE_NAME_LENGTH] = {};
+    PhaseStats phases[PHASE_COUNT];
+    std::atomic<int64_t> liveBytes{0};
+    std::atomic<int64_t> peakLiveBytes{0};
+    std::atomic<uint64_t> frames{0};
+};
+
+static ScopeStats g_scopes[MAX_SCOPES];
+static std::atomic<int> g_scopeCount{1};
+static std::atomic<int64_t> g_totalLiveBytes{0};
+static std::atomic<int64_t> g_totalPeakBytes{0};
+
+thread_local int t_scope = 0;
+thread_local Phase t_phase = PHASE_OTHER;
+
+// Every tracked block carries a 16-byte header so frees can be charged back to where the memory came from
+struct alignas(16) AllocHeader {
+    uint64_t size;
+    uint16_t scope;
+    uint16_t phase;
+};
+
+inline void UpdatePeak(std::atomic<int64_t>& peak, int64_t value) {
+    int64_t previous = peak.load(std::memory_order_relaxed);
+    while (value > previous && !peak.compare_exchange_weak(previous, value, std::memory_order_relaxed)) {}
+}
+
+inline void RecordAlloc(AllocHeader& header, size_t size) {
+    header.size = size;
+    header.scope = (uint16_t)t_scope;
+    header.phase = (uint16_t)t_phase;
+    g_heapAllocations.fetch_add(1, std::memory_order_relaxed);
+#ifdef BAKRA_MEMORY_TRACKING
+    ScopeStats& scope = g_scopes[header.scope];
+    PhaseStats& phase = scope.phases[header.phase];
+    phase.allocations.fetch_add(1, std::memory_order_relaxed);
+    phase.bytesAllocated.fetch_add(size, std::memory_order_relaxed);
+    UpdatePeak(scope.peakLiveBytes, scope.liveBytes.fetch_add((int64_t)size, std::memory_order_relaxed) + (int64_t)size);
+    UpdatePeak(g_totalPeakBytes, g_totalLiveBytes.fetch_add((int64_t)size, std::memory_order_relaxed) + (int64_t)size);
+#endif
+}
+
+inline void RecordFree(const AllocHeader& header) {
+#ifdef BAKRA_MEMORY_TRACKING
+    ScopeStats& scope = g_scopes[header.scope];
+    scope.phases[header.phase].frees.fetch_add(1, std::memory_order_relaxed);
+    scope.liveBytes.fetch_sub((int64_t)header.size, std::memory_order_relaxed);
+    g_totalLiveBytes.fetch_sub((int64_t)header.size, std::memory_order_relaxed);
+#else
+    (void)header;
+#endif
+}
+
+// Returns the scope index for a level name, registering it the first time
+inline int ScopeFor(const char* name) {
+    int count = g_scopeCount.load();
+    for (int i = 1; i < count; ++i) {
+        if (std::strncmp(g_scopes[i].name, name, SCOPE_NAME_LENGTH - 1) == 0) return i;
+    }
+    if (count >= MAX_SCOPES) return 0;
+    std::strncpy(g_scopes[count].name, name, SCOPE_NAME_LENGTH - 1);
+    g_scopeCount.store(count + 1);
+    return count;
+}
+
+inline void CountFrame(int scope) {
+    g_scopes[scope].frames.fetch_add(1, std::memory_order_relaxed);
+}
+
+// Attributes every allocation on this thread to a level and phase until it goes out of scope
+class PhaseScope {
+public:
+    PhaseScope(int scope, Phase phase) : m_prevScope(t_scope), m_prevPhase(t_phase) {
+        t_scope = scope;
+        t_phase = phase;
+    }
+    ~PhaseScope() {
+        t_scope = m_prevScope;
+        t_phase = m_prevPhase;
+    }
+    PhaseScope(const PhaseScope&) = delete;
+    PhaseScope& operator=(const PhaseScope&) = delete;
+
+private:
+    int m_prevScope;
+    Phase m_prevPhase;
+};
+
+// Memory budget report for one level, plus the process-wide totals
+inline void PrintReport(int scopeIndex, std::ostream& out) {
+#ifdef BAKRA_MEMORY_TRACKING
+    ScopeStats& scope = g_scopes[scopeIndex];
+    uint64_t frames = std::max<uint64_t>(1, scope.frames.load());
+    out << "---- Heap report: " << (scopeIndex == 0 ? "Global" : scope.name) << " ----\n";
+    for (int p = 0; p < PHASE_COUNT; ++p) {
+        const PhaseStats& phase = scope.phases[p];
+        out << "  " << PHASE_NAMES[p] << ": " << phase.allocations.load() << " allocs, "
+            << phase.frees.load() << " frees, " << phase.bytesAllocated.load() << " bytes";
+        if (p == PHASE_UPDATE || p == PHASE_DRAW) {
+            out << " (" << (double)phase.allocations.load() / frames << " allocs/frame over " << frames << " frames)";
+        }
+        out << "\n";
+    }
+    out << "  Live: " << scope.liveBytes.load() << " bytes, peak " << scope.peakLiveBytes.load() << " bytes\n";
+    out << "  Process live: " << g_totalLiveBytes.load() / 1024 << " KB, peak " << g_totalPeakBytes.load() / 1024 << " KB" << std::endl;
+#else
+    (void)scopeIndex;
+    (void)out;
+#endif
+}
+
+#else
+// Instrumentation compiled out: same API, no cost
+inline int ScopeFor(const char*) { return 0; }
+inline void CountFrame(int) {}
+class PhaseScope {
+public:
+    PhaseScope(int, Phase) {}
+};
+inline void PrintReport(int, std::ostream&) {}
+#endif
+
+} // namespace memtrack
+
+#ifdef BAKRA_HOOK_GLOBAL_NEW
+void* operator new(size_t size) {
+    void* raw = std::malloc(sizeof(memtrack::AllocHeader) + size);
+    if (!raw) throw std::bad_alloc();
+    memtrack::AllocHeader* header = static_cast<memtrack::AllocHeader*>(raw);
+    memtrack::RecordAlloc(*header, size);
+    return header + 1;
+}
+void* operator new[](size_t size) { return operator new(size); }
+void operator delete(void* ptr) noexcept {
+    if (!ptr) return;
+    memtrack::AllocHeader* header = static_cast<memtrack::AllocHeader*>(ptr) - 1;
+    memtrack::RecordFree(*header);
+    std::free(header);
+}
+void operator delete[](void* ptr) noexcept { operator delete(ptr); }
+void operator delete(void* ptr, size_t) noexcept { operator delete(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { operator delete(ptr); }
+#endif
+
+const int STEADY_STATE_WARMUP_FRAMES = 120; // Frames a level may spend warming up its pools before the check kicks in
+
+
+// Level state as flat bytes. Everything a level can change is written field by field as plain
+// data, so a state can be stored, compared byte for byte and restored later in the same run.
+namespace state {
+
+// FNV-1a, to catch files that were cut short or damaged. Pass the hash so far as 'hash' to continue it.
+uint64_t HashBytes(const unsigned char* data, size_t size, uint64_t hash = 0xCBF29CE484222325ull) {
+    for (size_t i = 0; i < size; ++i) hash = (hash ^ data[i]) * 0x100000001B3ull;
+    return hash;
+}
+
+class Writer {
+public:
+    void Clear() { m_bytes.clear(); }
+    void Reserve(size_t bytes) { m_bytes.reserve(bytes); }
+
+    template <typename T>
+    void Write(const T& value) {
+        static_assert(std::is_trivially_copyable<T>::value, "State must be plain data");
+        WriteBytes(&value, sizeof(T));
+    }
+
+    void WriteBytes(const void* data, size_t size) {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        m_bytes.insert(m_bytes.end(), bytes, bytes + size);
+    }
+
+    const unsigned char* Data() const { return m_bytes.data(); }
+    size_t Size() const { return m_bytes.size(); }
+
+private:
+    std::vector<unsigned char> m_bytes;
+};
+
+// Reads what a Writer wrote, in the same order. Reading past the end zero-fills and marks the reader failed.
+class Reader {
+public:
+    Reader(const unsigned char* data, size_t size) : m_data(data), m_size(size), m_offset(0), m_failed(false) {}
+
+    template <typename T>
+    void Read(T& value) {
+        static_assert(std::is_trivially_copyable<T>::value, "State must be plain data");
+        ReadBytes(&value, sizeof(T));
+    }
+
+    template <typename T>
+    T Read() {
+        T value;
+        Read(value);
+        return value;
+    }
+
+    void ReadBytes(void* out, size_t size) {
+        if (m_failed || m_size - m_offset < size) {
+            m_failed = true;
+            std::memset(out, 0, size);
+            return;
+        }
+        std::memcpy(out, m_data + m_offset, size);
+        m_offset += size;
+    }
+
+    bool Failed() const { return m_failed; }
+    bool AtEnd() const { return m_offset == m_size; }
+    size_t Remaining() const { return m_failed ? 0 : m_size - m_offset; }
+
+private:
+    const unsigned char* m_data;
+    size_t m_size;
+    size_t m_offset;
+    bool m_failed;
+};
+
+// The last few seconds of a level's states, one per simulation step, in a fixed byte budget.
+// Every KEYFRAME_INTERVAL-th state is stored whole; the others as the XOR with the state before,
+// so fields that didn't change become zeros. Either way the bytes are stored as runs: a count of
+// zero bytes, then a count of literal bytes. A keyframe is simply the XOR with an empty state.
+// The encoded states share one ring of bytes; when it is full (or holds the maximum number of
+// steps) the oldest states are dropped, a whole keyframe group at a time.
+class RewindBuffer {
+public:
+    static const int KEYFRAME_INTERVAL = 60;
+
+    // The ring is allocated by the first Push(), so a buffer that is never used costs nothing
+    RewindBuffer(size_t budgetBytes, size_t maxFrames)
+        : m_budget(budgetBytes), m_entries(maxFrames), m_oldest(0), m_count(0), m_write(0), m_nextFrame(0) {}
+
+    void Clear() {
+        m_count = 0;
+        m_write = 0;
+        m_newestState.clear();
+    }
+
+    // Stores the state of the next step
+    void Push(const unsigned char* state, size_t size) {
+        if (m_ring.empty()) m_ring.resize(m_budget);
+        if (m_count == m_entries.size()) DropOldest();
+        bool keyframe = m_count == 0 || Newest().sinceKeyframe + 1 >= KEYFRAME_INTERVAL;
+        Encode(keyframe ? nullptr : m_newestState.data(), keyframe ? 0 : m_newestState.size(), state, size);
+        size_t offset = Allocate(m_encoded.size());
+        if (!keyframe && m_count == 0) { // Making room dropped the states this delta was against
+            keyframe = true;
+            Encode(nullptr, 0, state, size);
+            offset = Allocate(m_encoded.size());
+        }
+        std::memcpy(m_ring.data() + offset, m_encoded.data(), m_encoded.size());
+
+        size_t sinceKeyframe = keyframe ? 0 : Newest().sinceKeyframe + 1;
+        Entry& entry = m_entries[(m_oldest + m_count) % m_entries.size()];
+        if (m_count == 0) m_firstFrame = m_nextFrame;
+        entry.offset = offset;
+        entry.size = m_encoded.size();
+        entry.sinceKeyframe = sinceKeyframe;
+        ++m_count;
+        ++m_nextFrame;
+        m_write = offset + entry.size;
+        m_newestState.assign(state, state + size);
+    }
+
+    // Removes the newest state and hands it back; false if there is nothing left
+    bool Pop(std::vector<unsigned char>& out) {
+        if (m_count == 0) return false;
+        out.assign(m_newestState.begin(), m_newestState.end());
+        --m_count;
+        --m_nextFrame;
+        if (m_count == 0) {
+            m_write = 0;
+            m_newestState.clear();
+        } else {
+            m_write = Newest().offset + Newest().size;
+            Get(m_nextFrame - 1, m_newestState);
+        }
+        return true;
+    }
+
+    // Decodes the state of step 'frame' into 'out'; false if it is no longer (or not yet) held
+    bool Get(uint64_t frame, std::vector<unsigned char>& out) const {
+        if (m_count == 0 || frame < m_firstFrame || frame >= m_nextFrame) return false;
+        size_t index = (size_t)(frame - m_firstFrame);
+        size_t first = index - m_entries[(m_oldest + index) % m_entries.size()].sinceKeyframe;
+        out.clear();
+        for (size_t i = first; i <= index; ++i) {
+            const Entry& entry = m_entries[(m_oldest + i) % m_entries.size()];
+            Decode(m_ring.data() + entry.offset, entry.size, out);
+        }
+        return true;
+    }
+
+    size_t Frames() const { return m_count; }
+    uint64_t FirstFrame() const { return m_count ? m_firstFrame : m_nextFrame; }
+    uint64_t NextFrame() const { return m_nextFrame; }
+
+    // Bytes the held states take up in the ring
+    size_t BytesUsed() const {
+        size_t used = 0;
+        for (size_t i = 0; i < m_count; ++i) used += m_entries[(m_oldest + i) % m_entries.size()].size;
+        return used;
+    }
+
+private:
+    struct Entry {
+        size_t offset, size;
+        size_t sinceKeyframe; // 0 for a keyframe
+    };
+
+    size_t m_budget;
+    std::vector<unsigned char> m_ring;
+    std::vector<Entry> m_entries; // Ring of m_count entries starting at m_oldest
+    size_t m_oldest, m_count;
+    size_t m_write;               // Ring offset just past the newest entry
+    uint64_t m_firstFrame = 0, m_nextFrame;
+    std::vector<unsigned char> m_newestState; // Decoded, for encoding the next delta
+    std::vector<unsigned char> m_encoded;
+
+    Entry& Newest() { return m_entries[(m_oldest + m_count - 1) % m_entries.size()]; }
+
+    // Drops the oldest state and any deltas that depended on it
+    void DropOldest() {
+        do {
+            m_oldest = (m_oldest + 1) % m_entries.size();
+            ++m_firstFrame;
+        } while (--m_count > 0 && m_entries[m_oldest].sinceKeyframe != 0);
+    }
+
+    // Finds room for 'size' contiguous bytes, dropping old states until it fits
+    size_t Allocate(size_t size) {
+        assert(size <= m_ring.size() && "a single state is larger than the rewind budget");
+        for (;;) {
+            if (m_count == 0) return 0;
+            size_t oldest = m_entries[m_oldest].offset;
+            if (oldest < m_write) { // Used bytes are [oldest, m_write): free space at the end, then at the start
+                if (m_write + size <= m_ring.size()) return m_write;
+                if (size <= oldest) return 0;
+            } else if (m_write + size <= oldest) { // Used bytes wrap around: free space is [m_write, oldest)
+                return m_write;
+            }
+            DropOldest();
+        }
+    }
+
+    static void WriteCount(std::vector<unsigned char>& out, size_t value) {
+        while (value >= 0x80) {
+            out.push_back((unsigned char)(value | 0x80));
+            value >>= 7;
+        }
+        out.push_back((unsigned char)value);
+    }
+
+    static size_t ReadCount(const unsigned char*& in) {
+        size_t value = 0;
+        for (int shift = 0;; shift += 7) {
+            unsigned char byte = *in++;
+            value |= (size_t)(byte & 0x7F) << shift;
+            if (!(byte & 0x80)) return value;
+        }
+    }
+
+    // Encodes 'state' XOR 'base' (base is zero past its end) as its size, then (zeros, literals) runs
+    void Encode(const unsigned char* base, size_t baseSize, const unsigned char* state, size_t size) {
+        const size_t MIN_ZERO_RUN = 4; // Shorter runs of zeros are cheaper as literals
+        auto delta = [&](size_t i) { return (unsigned char)(state[i] ^ (i < baseSize ? base[i] : 0)); };
+        m_encoded.clear();
+        WriteCount(m_encoded, size);
+        size_t i = 0;
+        while (i < size) {
+            size_t zeros = 0;
+            while (i + zeros < size && delta(i + zeros) == 0) ++zeros;
+            size_t literalStart = i + zeros, literalEnd = literalStart;
+            while (literalEnd < size) {
+                size_t run = 0;
+                while (literalEnd + run < size && run < MIN_ZERO_RUN && delta(literalEnd + run) == 0) ++run;
+                if (run == MIN_ZERO_RUN || literalEnd + run == size) break;
+                literalEnd += run + 1;
+            }
+            WriteCount(m_encoded, zeros);
+            WriteCount(m_encoded, literalEnd - literalStart);
+            for (size_t j = literalStart; j < literalEnd; ++j) m_encoded.push_back(delta(j));
+            i = literalEnd;
+        }
+    }
+
+    // Applies an encoded state to 'state', which holds the state it was encoded against (empty for a keyframe)
+    static void Decode(const unsigned char* in, size_t inSize, std::vector<unsigned char>& state) {
+        const unsigned char* end = in + inSize;
+        state.resize(ReadCount(in), 0);
+        size_t i = 0;
+        while (in < end) {
+            i += ReadCount(in);
+            size_t literals = ReadCount(in);
+            for (size_t j = 0; j < literals; ++j) state[i++] ^= *in++;
+        }
+    }
+};
+
+} // namespace state
+
+
+// A small archetype entity component system shared by every level.
+// Entities with the same set of components live together in fixed-size chunks,
+// one tightly packed array per component, so iterating a query walks memory linearly.
+namespace ecs {
+
+using Entity = uint32_t;          // Low 20 bits are the slot index, high 12 bits a generation counter
+using ComponentId = uint32_t;
+using ComponentMask = uint64_t;   // One bit per component type (max 64 types)
+
+const Entity NULL_ENTITY = 0xFFFFFFFFu;
+const uint32_t ENTITY_INDEX_BITS = 20;
+const uint32_t ENTITY_INDEX_MASK = (1u << ENTITY_INDEX_BITS) - 1;
+const uint32_t ENTITY_GENERATION_MASK = (1u << (32 - ENTITY_INDEX_BITS)) - 1; // Wraps, so a reused slot never runs out
+const size_t CHUNK_BYTES = 16 * 1024; // Size of one storage chunk
+const ComponentId MAX_COMPONENTS = 64; // One bit of ComponentMask each
+
+// Size of every component type that has an id so far, by id; 0 for ids not handed out yet.
+// World::Load checks saved columns against it.
+inline std::atomic<uint32_t> g_componentSizes[MAX_COMPONENTS];
+
+inline ComponentId RegisterComponent(size_t size) {
+    static std::atomic<ComponentId> next{0};
+    ComponentId id = next++;
+    if (id >= MAX_COMPONENTS) throw std::length_error("ecs: more component types than mask bits");
+    g_componentSizes[id].store((uint32_t)size, std::memory_order_release);
+    return id;
+}
+
+// Every component type gets a small id (and mask bit) the first time it is used
+template <typename T>
+ComponentId ComponentTypeId() {
+    static const ComponentId id = RegisterComponent(sizeof(T));
+    return id;
+}
+
+template <typename... Ts>
+ComponentMask MaskOf() {
+    return (ComponentMask{0} | ... | (ComponentMask{1} << ComponentTypeId<Ts>()));
+}
+
+// One block of component storage. Chunks come from the owning level's chunk pool,
+// so spawning entities never touches the heap once a level has been played.
+struct alignas(64) Chunk {
+    unsigned char bytes[CHUNK_BYTES];
+};
+
+// Column layout for one component inside an archetype's chunks
+struct Column {
+    ComponentId id;
+    size_t size;
+    size_t offset; // Byte offset of this component's array inside a chunk
+};
+
+// All entities that have exactly the same set of components
+class Archetype {
+public:
+    Archetype(mem::FixedPool& chunkPool, ComponentMask mask, std::vector<Column> columns)
+        : m_chunkPool(chunkPool), m_mask(mask), m_columns(std::move(columns)), m_count(0) {
+        m_capacity = CapacityFor(m_columns.data(), m_columns.size());
+
+        size_t offset = m_capacity * sizeof(Entity);
+        for (auto& col : m_columns) {
+            offset = (offset + 63) & ~size_t(63); // Each array starts on its own cache line
+            col.offset = offset;
+            offset += m_capacity * col.size;
+        }
+    }
+
+
+    // Rows that fit in one chunk, leaving room for alignment padding; 0 if not even one does
+    static size_t CapacityFor(const Column* columns, size_t count) {
+        size_t rowBytes = sizeof(Entity);
+        for (size_t c = 0; c < count; ++c) rowBytes += columns[c].size;
+        return (CHUNK_BYTES - 64 * (count + 1)) / rowBytes;
+    }
+
+    ComponentMask Mask() const { return m_mask; }
+    const std::vector<Column>& Columns() const { return m_columns; }
+    size_t Count() const { return m_count; }
+    size_t Capacity() const { return m_capacity; }
+    size_t ChunkCount() const { return m_chunks.size(); }
+
+    int ColumnIndex(ComponentId id) const {
+        for (size_t i = 0; i < m_columns.size(); ++i) {
+            if (m_columns[i].id == id) return (int)i;
+        }
+        return -1;
+    }
+
+    Entity* Entities(size_t chunk) { return reinterpret_cast<Entity*>(m_chunks[chunk]->bytes); }
+    const Entity* Entities(size_t chunk) const { return reinterpret_cast<const Entity*>(m_chunks[chunk]->bytes); }
+    void* ColumnData(size_t chunk, int column) { return m_chunks[chunk]->bytes + m_columns[column].offset; }
+    const void* ColumnData(size_t chunk, int column) const { return m_chunks[chunk]->bytes + m_columns[column].offset; }
+    size_t RowsInChunk(size_t chunk) const {
+        size_t start = chunk * m_capacity;
+        return std::min(m_capacity, m_count - start);
+    }
+
+    void* Component(size_t row, int column) {
+        return (unsigned char*)ColumnData(row / m_capacity, column) + (row % m_capacity) * m_columns[column].size;
+    }
+
+    size_t PushRow(Entity e) {
+        if (m_count == m_chunks.size() * m_capacity) {
+            m_chunks.push_back(static_cast<Chunk*>(m_chunkPool.Allocate()));
+        }
+        size_t row = m_count++;
+        Entities(row / m_capacity)[row % m_capacity] = e;
+        return row;
+    }
+
+    // Moves the last row into 'row' and returns the entity that moved (or NULL_ENTITY)
+    Entity SwapRemove(size_t row) {
+        size_t last = m_count - 1;
+        Entity moved = NULL_ENTITY;
+        if (row != last) {
+            moved = Entities(last / m_capacity)[last % m_capacity];
+            Entities(row / m_capacity)[row % m_capacity] = moved;
+            for (size_t c = 0; c < m_columns.size(); ++c) {
+                std::memcpy(Component(row, (int)c), Component(last, (int)c), m_columns[c].size);
+            }
+        }
+        m_count--;
+        if (!m_chunks.empty() && m_count <= (m_chunks.size() - 1) * m_capacity) {
+            m_chunkPool.Free(m_chunks.back());
+            m_chunks.pop_back();
+        }
+        return moved;
+    }
+
+    void ReleaseChunks() {
+        for (Chunk* chunk : m_chunks) m_chunkPool.Free(chunk);
+        DropChunks();
+    }
+
+    // Writes the used rows of one chunk: entities, then each column
+    void SaveChunk(state::Writer& out, size_t chunk) const {
+        size_t rows = RowsInChunk(chunk);
+        out.WriteBytes(Entities(chunk), rows * sizeof(Entity));
+        for (size_t c = 0; c < m_columns.size(); ++c) out.WriteBytes(ColumnData(chunk, (int)c), rows * m_columns[c].size);
+    }
+
+    // Appends a chunk holding 'rows' rows written by SaveChunk
+    void LoadChunk(state::Reader& in, size_t rows) {
+        m_chunks.push_back(static_cast<Chunk*>(m_chunkPool.Allocate()));
+        size_t chunk = m_chunks.size() - 1;
+        in.ReadBytes(Entities(chunk), rows * sizeof(Entity));
+        for (size_t c = 0; c < m_columns.size(); ++c) in.ReadBytes(ColumnData(chunk, (int)c), rows * m_columns[c].size);
+        m_count += rows;
+    }
+
+    // Forgets the chunks without returning them; used when the whole arena is being reset
+    void DropChunks() {
+        m_chunks.clear();
+        m_count = 0;
+    }
+
+private:
+    mem::FixedPool& m_chunkPool;
+    ComponentMask m_mask;
+    std::vector<Column> m_columns;
+    std::vector<Chunk*> m_chunks;
+    size_t m_capacity;
+    size_t m_count;
+};
+
+// Owns every entity of a level. Components must be plain data (trivially copyable)
+// because rows are moved around with memcpy.
+class World {
+public:
+    explicit World(mem::FixedPool& chunkPool) : m_chunkPool(chunkPool), m_iterating(0) {
+        // Bookkeeping is sized up front so spawning during play doesn't reallocate
+        m_records.reserve(1024);
+        m_freeSlots.reserve(1024);
+        m_pendingDestroy.reserve(256);
+    }
+    World(const World&) = delete;
+    World& operator=(const World&) = delete;
+
+    template <typename... Ts>
+    Entity Create(const Ts&... components) {
+        static_assert(sizeof...(Ts) > 0, "An entity needs at least one component");
+        static_assert((std::is_trivially_copyable<Ts>::value && ...), "Components must be plain data");
+
+        Archetype& arch = FindOrCreateArchetype<Ts...>();
+        Entity e = AllocateEntity();
+        size_t row = arch.PushRow(e);
+        (StoreComponent(arch.Component(row, arch.ColumnIndex(ComponentTypeId<Ts>())), components), ...);
+
+        Record& rec = m_records[e & ENTITY_INDEX_MASK];
+        rec.archetype = &arch;
+        rec.row = row;
+        return e;
+    }
+
+    // Destroys an entity. During a query the removal is deferred until iteration ends.
+    void Destroy(Entity e) {
+        if (!IsAlive(e)) return;
+        if (m_iterating > 0) {
+            m_pendingDestroy.push_back(e);
+            return;
+        }
+        Record& rec = m_records[e & ENTITY_INDEX_MASK];
+        Entity moved = rec.archetype->SwapRemove(rec.row);
+        if (moved != NULL_ENTITY) {
+            m_records[moved & ENTITY_INDEX_MASK].row = rec.row;
+        }
+        rec.archetype = nullptr;
+        rec.generation = (rec.generation + 1) & ENTITY_GENERATION_MASK;
+        m_freeSlots.push_back(e & ENTITY_INDEX_MASK);
+    }
+
+    bool IsAlive(Entity e) const {
+        uint32_t index = e & ENTITY_INDEX_MASK;
+        return e != NULL_ENTITY && index < m_records.size() &&
+               m_records[index].archetype != nullptr && m_records[index].generation == (e >> ENTITY_INDEX_BITS);
+    }
+
+    template <typename T>
+    T* Get(Entity e) {
+        if (!IsAlive(e)) return nullptr;
+        Record& rec = m_records[e & ENTITY_INDEX_MASK];
+        int column = rec.archetype->ColumnIndex(ComponentTypeId<T>());
+        return column < 0 ? nullptr : static_cast<T*>(rec.archetype->Component(rec.row, column));
+    }
+
+    // Visits every entity that has all of Ts. The callback takes (Ts&...) or (Entity, Ts&...).
+    template <typename... Ts, typename Fn>
+    void Each(Fn&& fn) {
+        const ComponentMask mask = MaskOf<Ts...>();
+        m_iterating++;
+        for (auto& arch : m_archetypes) {
+            if ((arch->Mask() & mask) != mask) continue;
+            int columns[] = { arch->ColumnIndex(ComponentTypeId<Ts>())... };
+            for (size_t chunk = 0; chunk < arch->ChunkCount(); ++chunk) {
+                EachInChunk<Ts...>(*arch, chunk, columns, fn, std::index_sequence_for<Ts...>{});
+            }
+        }
+        if (--m_iterating == 0) FlushPendingDestroy();
+    }
+
+    template <typename... Ts>
+    size_t Count() {
+        const ComponentMask mask = MaskOf<Ts...>();
+        size_t total = 0;
+        for (auto& arch : m_archetypes) {
+            if ((arch->Mask() & mask) == mask) total += arch->Count();
+        }
+        return total;
+    }
+
+    // Drops every entity and hands the chunks back to the chunk pool
+    void Clear() {
+        for (auto& arch : m_archetypes) arch->ReleaseChunks();
+        ForgetEntities();
+    }
+
+    // Writes every entity and component. Component ids are handed out as types are first used,
+    // so the bytes only make sense to the same run of the program.
+    void Save(state::Writer& out) const {
+        out.Write((uint32_t)m_archetypes.size());
+        for (const auto& arch : m_archetypes) {
+            out.Write(arch->Mask());
+            out.Write((uint32_t)arch->Columns().size());
+            for (const Column& col : arch->Columns()) {
+                out.Write(col.id);
+                out.Write((uint32_t)col.size);
+            }
+            out.Write((uint32_t)arch->Count());
+            for (size_t chunk = 0; chunk < arch->ChunkCount(); ++chunk) arch->SaveChunk(out, chunk);
+        }
+        out.Write((uint32_t)m_records.size());
+        for (const Record& rec : m_records) {
+            out.Write(ArchetypeIndex(rec.archetype));
+            out.Write((uint32_t)rec.row);
+            out.Write(rec.generation);
+        }
+        out.Write((uint32_t)m_freeSlots.size());
+        out.WriteBytes(m_freeSlots.data(), m_freeSlots.size() * sizeof(uint32_t));
+    }
+
+    // Replaces every entity with the ones Save() wrote. Returns false if the bytes don't fit this world.
+    bool Load(state::Reader& in) {
+        assert(m_iterating == 0 && "can't load a world while iterating it");
+        for (auto& arch : m_archetypes) arch->ReleaseChunks();
+
+        Archetype* loaded[MAX_LOADED_ARCHETYPES]; // Saved archetype index -> ours
+        uint32_t archetypeCount = in.Read<uint32_t>();
+        if (archetypeCount > MAX_LOADED_ARCHETYPES) return false;
+        for (uint32_t a = 0; a < archetypeCount && !in.Failed(); ++a) {
+            ComponentMask mask = in.Read<ComponentMask>();
+            uint32_t columnCount = in.Read<uint32_t>();
+            Column columns[MAX_COMPONENTS]; // One bit of the mask per component
+            if (columnCount > MAX_COMPONENTS) return false;
+            ComponentMask columnBits = 0;
+            for (uint32_t c = 0; c < columnCount; ++c) {
+                columns[c].id = in.Read<ComponentId>();
+                columns[c].size = in.Read<uint32_t>();
+                columns[c].offset = 0;
+                // Only components this build knows, at the size it knows them, each once
+                if (columns[c].id >= MAX_COMPONENTS || columns[c].size == 0) return false;
+                if (g_componentSizes[columns[c].id].load(std::memory_order_acquire) != columns[c].size) return false;
+                if (columnBits & (ComponentMask{1} << columns[c].id)) return false;
+                columnBits |= ComponentMask{1} << columns[c].id;
+            }
+            size_t capacity = Archetype::CapacityFor(columns, columnCount);
+            if (in.Failed() || columnBits != mask || capacity == 0) return false;
+            Archetype* arch = nullptr;
+            for (auto& existing : m_archetypes) {
+                if (existing->Mask() == mask) arch = existing.get();
+            }
+            if (!arch) {
+                m_archetypes.push_back(std::make_unique<Archetype>(m_chunkPool, mask, std::vector<Column>(columns, columns + columnCount)));
+                arch = m_archetypes.back().get();
+            }
+            if (arch->Columns().size() != columnCount) return false;
+            for (uint32_t c = 0; c < columnCount; ++c) {
+                if (arch->Columns()[c].id != columns[c].id || arch->Columns()[c].size != columns[c].size) return false;
+            }
+            uint32_t count = in.Read<uint32_t>();
+            size_t rowBytes = sizeof(Entity);
+            for (uint32_t c = 0; c < columnCount; ++c) rowBytes += columns[c].size;
+            if (count > in.Remaining() / rowBytes) return false; // More rows than bytes left
+            for (size_t start = 0; start < count && !in.Failed(); start += arch->Capacity()) {
+                arch->LoadChunk(in, std::min(arch->Capacity(), count - start));
+            }
+            loaded[a] = arch;
+        }
+
+        uint32_t recordCount = in.Read<uint32_t>();
+        const size_t recordBytes = sizeof(int32_t) + 2 * sizeof(uint32_t); // As Save() writes them
+        if (recordCount > ENTITY_INDEX_MASK || recordCount > in.Remaining() / recordBytes) return false;
+        m_records.resize(recordCount);
+        for (Record& rec : m_records) {
+            int32_t index = in.Read<int32_t>();
+            if (index >= (int32_t)archetypeCount) return false;
+            rec.archetype = index < 0 ? nullptr : loaded[index];
+            rec.row = in.Read<uint32_t>();
+            rec.generation = in.Read<uint32_t>();
+            if (rec.generation > ENTITY_GENERATION_MASK || (rec.archetype && rec.row >= rec.archetype->Count())) return false;
+        }
+        uint32_t freeCount = in.Read<uint32_t>();
+        if (freeCount > m_records.size() || freeCount > in.Remaining() / sizeof(uint32_t)) return false;
+        m_freeSlots.resize(freeCount);
+        in.ReadBytes(m_freeSlots.data(), m_freeSlots.size() * sizeof(uint32_t));
+        for (uint32_t slot : m_freeSlots) {
+            if (slot >= m_records.size() || m_records[slot].archetype) return false;
+        }
+        m_pendingDestroy.clear();
+        return !in.Failed();
+    }
+
+    // Drops every entity without touching the chunks. Only valid right before the chunk pool
+    // and its arena are reset, which is what makes unloading a level O(1) in the entity count.
+    void Reset() {
+        for (auto& arch : m_archetypes) arch->DropChunks();
+        ForgetEntities();
+    }
+
+private:
+    static const uint32_t MAX_LOADED_ARCHETYPES = 64; // Levels use a handful
+
+    struct Record {
+        Archetype* archetype = nullptr;
+        size_t row = 0;
+        uint32_t generation = 0;
+    };
+
+    mem::FixedPool& m_chunkPool;
+    std::vector<std::unique_ptr<Archetype>> m_archetypes;
+    std::vector<Record> m_records;
+    std::vector<uint32_t> m_freeSlots;
+    std::vector<Entity> m_pendingDestroy;
+    int m_iterating;
+
+    // Tag components have a byte of storage but no value; keep it zero so saved states compare equal
+    template <typename T>
+    static void StoreComponent(void* slot, const T& component) {
+        if constexpr (std::is_empty<T>::value) {
+            std::memset(slot, 0, sizeof(T));
+        } else {
+            std::memcpy(slot, &component, sizeof(T));
+        }
+    }
+
+    int32_t ArchetypeIndex(const Archetype* arch) const {
+        for (size_t i = 0; i < m_archetypes.size(); ++i) {
+            if (m_archetypes[i].get() == arch) return (int32_t)i;
+        }
+        return -1;
+    }
+
+    void ForgetEntities() {
+        m_freeSlots.clear();
+        for (uint32_t i = 0; i < m_records.size(); ++i) {
+            if (m_records[i].archetype) m_records[i].generation = (m_records[i].generation + 1) & ENTITY_GENERATION_MASK;
+            m_records[i].archetype = nullptr;
+            m_freeSlots.push_back(i);
+        }
+        m_pendingDestroy.clear();
+    }
+
+    Entity AllocateEntity() {
+        uint32_t index;
+        if (!m_freeSlots.empty()) {
+            index = m_freeSlots.back();
+            m_freeSlots.pop_back();
+        } else {
+            // The last index is left out: with a full generation it would read as NULL_ENTITY
+            if (m_records.size() >= ENTITY_INDEX_MASK) throw std::length_error("ecs::World: out of entity slots");
+            index = (uint32_t)m_records.size();
+            m_records.emplace_back();
+        }
+        return index | (m_records[index].generation << ENTITY_INDEX_BITS);
+    }
+
+    template <typename... Ts>
+    Archetype& FindOrCreateArchetype() {
+        const ComponentMask mask = MaskOf<Ts...>();
+        for (auto& arch : m_archetypes) {
+            if (arch->Mask() == mask) return *arch;
+        }
+        std::vector<Column> columns = { Column{ ComponentTypeId<Ts>(), sizeof(Ts), 0 }... };
+        m_archetypes.push_back(std::make_unique<Archetype>(m_chunkPool, mask, std::move(columns)));
+        return *m_archetypes.back();
+    }
+
+    template <typename... Ts, typename Fn, size_t... Is>
+    void EachInChunk(Archetype& arch, size_t chunk, const int* columns, Fn& fn, std::index_sequence<Is...>) {
+        Entity* entities = arch.Entities(chunk);
+        std::tuple<Ts*...> arrays{ static_cast<Ts*>(arch.ColumnData(chunk, columns[Is]))... };
+        size_t rows = arch.RowsInChunk(chunk);
+        for (size_t i = 0; i < rows; ++i) {
+            if constexpr (std::is_invocable<Fn&, Entity, Ts&...>::value) {
+                fn(entities[i], std::get<Is>(arrays)[i]...);
+            } else {
+                fn(std::get<Is>(arrays)[i]...);
+            }
+        }
+    }
+
+    void FlushPendingDestroy() {
+        for (size_t i = 0; i < m_pendingDestroy.size(); ++i) {
+            Destroy(m_pendingDestroy[i]);
+        }
+        m_pendingDestroy.clear();
+    }
+};
+
+// Runs a level's systems in the order they were added
+enum class Phase { Update, Draw };
+
+class Scheduler {
+public:
+    using SystemFn = std::function<void(World&, float)>;
+
+    void Add(Phase phase, const char* name, SystemFn fn) {
+        m_systems.push_back({ phase, name, std::move(fn) });
+    }
+
+    void Run(Phase phase, World& world, float deltaTime) {
+        for (auto& system : m_systems) {
+            if (system.phase == phase) system.fn(world, deltaTime);
+        }
+    }
+
+    void Clear() { m_systems.clear(); }
+
+private:
+    struct System {
+        Phase phase;
+        const char* name;
+        SystemFn fn;
+    };
+    std::vector<System> m_systems;
+};
+
+// Components shared by all levels
+struct Body { Rectangle rect; };           // Position and size of an entity
+struct Velocity { Vector2 value; };        // Movement in pixels per update
+struct Tint { Color color; };              // Main draw color
+struct Collectible { int value; };         // Coins the player can pick up
+struct Solid {};                           // Blocks player movement
+
+} // namespace ecs
+
+// Counter-based random numbers. A Stream is a 64-bit key plus a counter, and value n of a
+// stream is a pure function of (key, n) (the SplitMix64 finalizer), so streams cost 16 bytes,
+// can be jumped to any position, and Fork(id) derives an independent child stream from the
+// id alone. Forking per chunk, wave or session therefore gives the same numbers no matter
+// which thread gets there first. Helpers are defined here rather than through <random>
+// distributions so results are the same with every standard library.
+namespace rng {
+
+inline uint64_t Mix64(uint64_t z) {
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+class Stream {
+public:
+    using result_type = uint64_t; // Usable as a UniformRandomBitGenerator
+
+    explicit Stream(uint64_t seed = 0) : m_key(Mix64(seed)), m_counter(0) {}
+
+    // Value 'index' of this stream, without moving it
+    uint64_t At(uint64_t index) const { return Mix64(m_key + (index + 1) * 0x9E3779B97F4A7C15ull); }
+
+    uint64_t Next() { return At(m_counter++); }
+    uint64_t operator()() { return Next(); }
+    static constexpr uint64_t min() { return 0; }
+    static constexpr uint64_t max() { return ~0ull; }
+
+    // Independent child stream; the same id always gives the same child
+    Stream Fork(uint64_t streamId) const {
+        Stream child;
+        child.m_key = Mix64(m_key ^ Mix64(streamId + 0x632BE59BD9B4E019ull));
+        return child;
+    }
+
+    float NextFloat() { return (Next() >> 40) * (1.0f / 16777216.0f); }               // [0, 1)
+    double NextDouble() { return (Next() >> 11) * (1.0 / 9007199254740992.0); }      // [0, 1)
+    bool Chance(float probability) { return NextFloat() < probability; }
+
+    // Uniform integer in [lo, hi]
+    int Range(int lo, int hi) {
+        uint64_t span = (uint64_t)((int64_t)hi - lo) + 1;
+        return lo + (int)(((Next() >> 32) * span) >> 32); // Multiply-shift; bias is below 2^-32 * span
+    }
+
+    template <typename It>
+    void Shuffle(It first, It last) {
+        for (auto n = last - first; n > 1; --n) {
+            std::iter_swap(first + (n - 1), first + Range(0, (int)n - 1));
+        }
+    }
+
+    uint64_t Position() const { return m_counter; }
+    void Seek(uint64_t position) { m_counter = position; }
+
+private:
+    uint64_t m_key;
+    uint64_t m_counter;
+};
+
+// A fresh, unpredictable seed for when repeatability doesn't matter
+inline uint64_t EntropySeed() {
+    std::random_device device;
+    return ((uint64_t)device() << 32) ^ device() ^ (uint64_t)std::chrono::steady_clock::now().time_since_epoch().count();
+}
+
+} // namespace rng
+
+
+// Input is sampled once per frame on the main thread into a plain InputState, which is then
+// handed to whoever runs the simulation. Levels read it through the input:: functions below,
+// which look at the state installed for the current thread by input::Scope.
+namespace input {
+
+const int TRACKED_KEYS[] = { KEY_LEFT, KEY_RIGHT, KEY_UP, KEY_DOWN, KEY_SPACE, KEY_ENTER, KEY_BACKSPACE };
+const int TRACKED_KEY_COUNT = sizeof(TRACKED_KEYS) / sizeof(TRACKED_KEYS[0]);
+
+struct InputState {
+    uint32_t keysDown = 0;         // Bit i set while TRACKED_KEYS[i] is held
+    uint32_t keysPressed = 0;      // Bit i set if TRACKED_KEYS[i] went down since the last simulation step
+    bool mouseLeftPressed = false;
+    Vector2 mousePosition = { 0, 0 };
+};
+
+inline int KeyBit(int key) {
+    for (int i = 0; i < TRACKED_KEY_COUNT; ++i) {
+        if (TRACKED_KEYS[i] == key) return i;
+    }
+    return -1;
+}
+
+// Reads raylib's input state. Main thread only.
+inline InputState Sample() {
+    InputState state;
+    for (int i = 0; i < TRACKED_KEY_COUNT; ++i) {
+        if (IsKeyDown(TRACKED_KEYS[i])) state.keysDown |= 1u << i;
+        if (IsKeyPressed(TRACKED_KEYS[i])) state.keysPressed |= 1u << i;
+    }
+    state.mouseLeftPressed = IsMouseButtonPressed(MOUSE_LEFT_BUTTON);
+    state.mousePosition = GetMousePosition();
+    return state;
+}
+
+// Folds a newer sample into 'into': held keys and the mouse come from the newer sample, presses add up
+inline void Merge(InputState& into, const InputState& newer) {
+    into.keysDown = newer.keysDown;
+    into.keysPressed |= newer.keysPressed;
+    into.mouseLeftPressed = into.mouseLeftPressed || newer.mouseLeftPressed;
+    into.mousePosition = newer.mousePosition;
+}
+
+inline const InputState*& CurrentState() {
+    thread_local const InputState* current = nullptr;
+    return current;
+}
+
+// Makes 'state' the input seen by level code on this thread while the scope is alive
+class Scope {
+public:
+    explicit Scope(const InputState& state) : m_previous(CurrentState()) { CurrentState() = &state; }
+    ~Scope() { CurrentState() = m_previous; }
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+private:
+    const InputState* m_previous;
+};
+
+inline bool KeyDown(int key) {
+    int bit = KeyBit(key);
+    return CurrentState() && bit >= 0 && (CurrentState()->keysDown & (1u << bit)) != 0;
+}
+
+inline bool KeyPressed(int key) {
+    int bit = KeyBit(key);
+    return CurrentState() && bit >= 0 && (CurrentState()->keysPressed & (1u << bit)) != 0;
+}
+
+inline bool MouseLeftPressed() { return CurrentState() && CurrentState()->mouseLeftPressed; }
+inline Vector2 MousePosition() { return CurrentState() ? CurrentState()->mousePosition : Vector2{ 0, 0 }; }
+
+// Build up a state key by key, for input that doesn't come from a person
+inline void Hold(InputState& state, int key) { state.keysDown |= 1u << KeyBit(key); }
+inline void Press(InputState& state, int key) {
+    Hold(state, key);
+    state.keysPressed |= 1u << KeyBit(key);
+}
+inline bool Held(const InputState& state, int key) { return (state.keysDown & (1u << KeyBit(key))) != 0; }
+
+// The keys of a state in 16 bits (held, then pressed), for sending to another process. The mouse is
+// left out: only menus use it.
+static_assert(TRACKED_KEY_COUNT <= 8, "Packed input has 8 bits for each key set");
+inline uint16_t Pack(const InputState& state) { return (uint16_t)((state.keysDown & 0xFF) | (state.keysPressed & 0xFF) << 8); }
+inline InputState Unpack(uint16_t packed) {
+    InputState state;
+    state.keysDown = packed & 0xFF;
+    state.keysPressed = packed >> 8;
+    return state;
+}
+inline void Click(InputState& state, Rectangle button) {
+    state.mouseLeftPressed = true;
+    state.mousePosition = { button.x + button.width / 2, button.y + button.height / 2 };
+}
+
+// Hands input from the main thread to the simulation thread. Presses are accumulated
+// so a tap that happens between two simulation steps isn't lost.
+class Mailbox {
+public:
+    Mailbox() : m_fresh(false) {}
+
+    void Post(const InputState& sampled, std::chrono::steady_clock::time_point sampledAt) {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            Merge(m_pending, sampled);
+            m_sampledAt = sampledAt;
+            m_fresh = true;
+        }
+        m_posted.notify_one();
+    }
+
+    // 'sampledAt' receives when the newest of the taken samples was read
+    InputState Take(std::chrono::steady_clock::time_point* sampledAt = nullptr) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        InputState taken = m_pending;
+        m_pending.keysPressed = 0;
+        m_pending.mouseLeftPressed = false;
+        m_fresh = false;
+        if (sampledAt) *sampledAt = m_sampledAt;
+        return taken;
+    }
+
+    // Blocks until something is posted that hasn't been taken yet, or until 'deadline'.
+    // Returns whether there is fresh input.
+    bool WaitForPost(std::chrono::steady_clock::time_point deadline) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        return m_posted.wait_until(lock, deadline, [this]() { return m_fresh; });
+    }
+
+private:
+    std::mutex m_mutex;
+    std::condition_variable m_posted;
+    InputState m_pending;
+    std::chrono::steady_clock::time_point m_sampledAt;
+    bool m_fresh;
+};
+
+// Random but repeatable input for unattended runs: holds a random set of keys for a
+// random number of steps, then picks another. Never presses ENTER or BACKSPACE, or clicks.
+class ScriptedInput {
+public:
+    explicit ScriptedInput(rng::Stream stream) : m_rng(stream), m_framesLeft(0), m_held(0) {}
+
+    InputState Next() {
+        InputState state;
+        if (--m_framesLeft <= 0) {
+            uint32_t previous = m_held;
+            m_held = (uint32_t)m_rng.Range(0, (1 << TRACKED_KEY_COUNT) - 1) & ~(1u << KeyBit(KEY_ENTER)) & ~(1u << KeyBit(KEY_BACKSPACE));
+            m_framesLeft = m_rng.Range(5, 40);
+            state.keysPressed = m_held & ~previous;
+        }
+        state.keysDown = m_held;
+        return state;
+    }
+
+private:
+    rng::Stream m_rng;
+    int m_framesLeft;
+    uint32_t m_held;
+};
+
+} // namespace input
+
+
+// Drawing is recorded instead of issued straight to raylib. A DrawList is an immutable
+// snapshot of one frame once recorded, so the simulation thread can build it while the
+// main thread is still presenting the previous one.
+//
+// Before it is submitted a list is sorted so raylib can batch it: by layer first (what
+// must end up on top of what), then by texture and by the kind of geometry raylib emits
+// for the command. Within one layer and batch kind the recording order is kept, so levels
+// only need a new layer where a shape has to cover lines or text drawn before it.
+namespace gfx {
+
+// Painter's order between groups of draws; everything in a lower layer ends up underneath
+enum class Layer : uint8_t {
+    BACKGROUND,
+    WORLD,      // Level geometry, pickups
+    ACTORS,     // Players, enemies, projectiles
+    FOREGROUND, // Scenery that covers actors
+    HUD         // Scores, messages
+};
+
+// What raylib's batcher sees: commands of the same kind and texture share one draw call
+enum class BatchKind : uint8_t {
+    CLEAR,     // Not drawn through the batcher
+    SHAPES,    // Quads: rectangles, circles, triangles and thick lines on the shapes texture, sprites on the atlas
+    TRIANGLES, // Untextured triangles (ellipses)
+    LINES,     // One-pixel lines
+    TEXT       // Quads on the font texture
+};
+
+enum class CommandType : uint8_t {
+    CLEAR,
+    RECTANGLE,
+    RECTANGLE_LINES,
+    RECTANGLE_LINES_EX,
+    RECTANGLE_ROUNDED,
+    RECTANGLE_ROUNDED_LINES,
+    CIRCLE,
+    CIRCLE_LINES,
+    ELLIPSE,
+    ELLIPSE_LINES,
+    TRIANGLE,
+    TEXT,
+    SPRITE
+};
+
+inline BatchKind BatchKindOf(CommandType type) {
+    switch (type) {
+        case CommandType::CLEAR: return BatchKind::CLEAR;
+        case CommandType::ELLIPSE: return BatchKind::TRIANGLES;
+        case CommandType::RECTANGLE_LINES:
+        case CommandType::CIRCLE_LINES:
+        case CommandType::ELLIPSE_LINES: return BatchKind::LINES;
+        case CommandType::TEXT: return BatchKind::TEXT;
+        default: return BatchKind::SHAPES;
+    }
+}
+
+// Artwork drawn from the sprite atlas rather than from primitives
+enum class Sprite : uint8_t {
+    MAZE_PLAYER,     // The goat-eyed maze runner
+    FLAPPY_CREATURE, // Flappy's visored creature
+    EXIT_DOOR,       // The obstacle course's panelled door
+    INVADER_SAUCER,  // An invader
+    COUNT
+};
+
+// The rectangle a level passes to DrawSprite(), at the size the sprite is baked at, and how
+// far the artwork reaches outside it. Drawn at another size, both scale.
+struct SpriteFrame {
+    float width, height;
+    float left, top, right, bottom;
+};
+
+const SpriteFrame SPRITE_FRAMES[(size_t)Sprite::COUNT] = {
+    { 32.0f, 32.0f, 0.0f, 0.0f, 0.0f, 0.0f },
+    { 40.0f, 50.0f, 0.0f, 0.0f, 0.0f, 0.0f },
+    { 50.0f, 80.0f, 0.0f, 0.0f, 0.0f, 0.0f },
+    { 30.0f, 30.0f, 0.0f, 12.0f, 0.0f, 15.0f }, // Domes and cap reach above and below
+};
+
+const int ATLAS_SCALE = 2;        // Texels per pixel of the baked size, so sprites drawn a bit larger stay smooth
+const int ATLAS_GUTTER = 2;       // Transparent texels around each sprite, so filtering doesn't pick up its neighbours
+const int ATLAS_MAX_WIDTH = 256;
+const uint16_t ATLAS_TEXTURE = 1; // DrawCommand::texture of sprites
+
+// Where each sprite sits in the atlas: rows of sprites, tallest first. Depends only on SPRITE_FRAMES.
+struct AtlasLayout {
+    int width, height;
+    Rectangle sources[(size_t)Sprite::COUNT]; // In texels, without the gutter
+};
+
+inline const AtlasLayout& GetAtlasLayout() {
+    static const AtlasLayout layout = []() {
+        AtlasLayout result = {};
+        int texelWidth[(size_t)Sprite::COUNT], texelHeight[(size_t)Sprite::COUNT];
+        size_t order[(size_t)Sprite::COUNT];
+        for (size_t i = 0; i < (size_t)Sprite::COUNT; ++i) {
+            const SpriteFrame& frame = SPRITE_FRAMES[i];
+            texelWidth[i] = (int)std::ceil((frame.left + frame.width + frame.right) * ATLAS_SCALE);
+            texelHeight[i] = (int)std::ceil((frame.top + frame.height + frame.bottom) * ATLAS_SCALE);
+            order[i] = i;
+        }
+        std::stable_sort(std::begin(order), std::end(order), [&](size_t a, size_t b) { return texelHeight[a] > texelHeight[b]; });
+        int x = 0, y = 0, rowHeight = 0, width = 0;
+        for (size_t i : order) {
+            int cellWidth = texelWidth[i] + 2 * ATLAS_GUTTER, cellHeight = texelHeight[i] + 2 * ATLAS_GUTTER;
+            if (x > 0 && x + cellWidth > ATLAS_MAX_WIDTH) {
+                x = 0;
+                y += rowHeight;
+                rowHeight = 0;
+            }
+            result.sources[i] = { (float)(x + ATLAS_GUTTER), (float)(y + ATLAS_GUTTER), (float)texelWidth[i], (float)texelHeight[i] };
+            x += cellWidth;
+            rowHeight = std::max(rowHeight, cellHeight);
+            width = std::max(width, x);
+        }
+        result.width = result.height = 1; // Powers of two, so every GPU can mipmap it
+        while (result.width < width) result.width *= 2;
+        while (result.height < y + rowHeight) result.height *= 2;
+        return result;
+    }();
+    return layout;
+}
+
+// Where a sprite drawn at 'bounds' ends up, the artwork outside the rectangle included
+inline Rectangle SpriteDestination(Sprite sprite, Rectangle bounds) {
+    const SpriteFrame& frame = SPRITE_FRAMES[(size_t)sprite];
+    float scaleX = bounds.width / frame.width, scaleY = bounds.height / frame.height;
+    return { bounds.x - frame.left * scaleX, bounds.y - frame.top * scaleY,
+             (frame.left + frame.width + frame.right) * scaleX, (frame.top + frame.height + frame.bottom) * scaleY };
+}
+
+struct DrawCommand {
+    CommandType type;
+    Layer layer;
+    uint16_t texture;   // 0 for the shapes/font texture raylib picks itself
+    Color color;
+    int ival;           // Segments for rounded rectangles, font size for text, the Sprite of sprites
+    uint32_t text;      // Offset of the text in the list's text buffer
+    float v[7];         // Geometry; meaning depends on the type
+};
+
+struct SubmitStats {
+    uint32_t commands = 0;
+    uint32_t batches = 0;         // Draw calls raylib needs for the sorted list
+    uint32_t unsortedBatches = 0; // What it would have needed in recording order
+};
+
+// Records the subset of raylib's drawing API the game uses. Same names and signatures as raylib,
+// plus DrawSprite().
+class DrawList {
+public:
+    DrawList() : m_layer(Layer::WORLD), m_sorted(false), m_viewport{ 0, 0, 0, 0 }, m_hasViewport(false) {
+        m_commands.reserve(1024);
+        m_order.reserve(1024);
+        m_text.reserve(4096);
+    }
+
+    void Clear() {
+        m_commands.clear();
+        m_order.clear();
+        m_text.clear();
+        m_layer = Layer::WORLD;
+        m_sorted = false;
+        m_hasViewport = false;
+    }
+
+    // Layer for the commands recorded from now on
+    void SetLayer(Layer layer) { m_layer = layer; }
+
+    // Records everything from now on into 'viewport' instead of the whole screen, so two levels
+    // can share a frame side by side: positions are moved by its corner, filled rectangles are
+    // cut to it and clearing only fills it. Outlines, circles and text are moved but not cut.
+    void SetViewport(Rectangle viewport) {
+        m_viewport = viewport;
+        m_hasViewport = true;
+    }
+    void ResetViewport() { m_hasViewport = false; }
+
+    void ClearBackground(Color color) {
+        if (!m_hasViewport) {
+            Push(CommandType::CLEAR, color, {});
+            return;
+        }
+        Layer layer = m_layer;
+        m_layer = Layer::BACKGROUND;
+        DrawRectangleRec({ 0, 0, m_viewport.width, m_viewport.height }, color);
+        m_layer = layer;
+    }
+    void DrawRectangle(int posX, int posY, int width, int height, Color color) {
+        DrawRectangleRec({ (float)posX, (float)posY, (float)width, (float)height }, color);
+    }
+    void DrawRectangleRec(Rectangle rec, Color color) {
+        if (m_hasViewport) {
+            float right = std::min(rec.x + rec.width, m_viewport.width), bottom = std::min(rec.y + rec.height, m_viewport.height);
+            rec.x = std::max(rec.x, 0.0f);
+            rec.y = std::max(rec.y, 0.0f);
+            rec.width = right - rec.x;
+            rec.height = bottom - rec.y;
+            if (rec.width <= 0 || rec.height <= 0) return;
+        }
+        Push(CommandType::RECTANGLE, color, { rec.x, rec.y, rec.width, rec.height });
+    }
+    void DrawRectangleLines(int posX, int posY, int width, int height, Color color) {
+        Push(CommandType::RECTANGLE_LINES, color, { (float)posX, (float)posY, (float)width, (float)height });
+    }
+    void DrawRectangleLinesEx(Rectangle rec, float lineThick, Color color) {
+        Push(CommandType::RECTANGLE_LINES_EX, color, { rec.x, rec.y, rec.width, rec.height, lineThick });
+    }
+    void DrawRectangleRounded(Rectangle rec, float roundness, int segments, Color color) {
+        Push(CommandType::RECTANGLE_ROUNDED, color, { rec.x, rec.y, rec.width, rec.height, roundness }, segments);
+    }
+    void DrawRectangleRoundedLines(Rectangle rec, float roundness, int segments, float lineThick, Color color) {
+        Push(CommandType::RECTANGLE_ROUNDED_LINES, color, { rec.x, rec.y, rec.width, rec.height, roundness, lineThick }, segments);
+    }
+    void DrawCircle(int centerX, int centerY, float radius, Color color) {
+        Push(CommandType::CIRCLE, color, { (float)centerX, (float)centerY, radius });
+    }
+    void DrawCircleLines(int centerX, int centerY, float radius, Color color) {
+        Push(CommandType::CIRCLE_LINES, color, { (float)centerX, (float)centerY, radius });
+    }
+    void DrawEllipse(int centerX, int centerY, float radiusH, float radiusV, Color color) {
+        Push(CommandType::ELLIPSE, color, { (float)centerX, (float)centerY, radiusH, radiusV });
+    }
+    void DrawEllipseLines(int centerX, int centerY, float radiusH, float radiusV, Color color) {
+        Push(CommandType::ELLIPSE_LINES, color, { (float)centerX, (float)centerY, radiusH, radiusV });
+    }
+    void DrawTriangle(Vector2 v1, Vector2 v2, Vector2 v3, Color color) {
+        Push(CommandType::TRIANGLE, color, { v1.x, v1.y, v2.x, v2.y, v3.x, v3.y });
+    }
+    void DrawText(const char* text, int posX, int posY, int fontSize, Color color) {
+        DrawCommand& cmd = Push(CommandType::TEXT, color, { (float)posX, (float)posY }, fontSize);
+        cmd.text = (uint32_t)m_text.size();
+        m_text.insert(m_text.end(), text, text + std::strlen(text) + 1); // Copied: the caller's buffer may be scratch memory
+    }
+    // Draws 'sprite' from the atlas with its frame stretched over 'bounds' (see SpriteFrame)
+    void DrawSprite(Sprite sprite, Rectangle bounds, Color tint = WHITE) {
+        DrawCommand& cmd = Push(CommandType::SPRITE, tint, { bounds.x, bounds.y, bounds.width, bounds.height }, (int)sprite);
+        cmd.texture = ATLAS_TEXTURE;
+    }
+
+    size_t Size() const { return m_commands.size(); }
+    const std::vector<DrawCommand>& Commands() const { return m_commands; }
+    const char* Text(const DrawCommand& cmd) const { return m_text.data() + cmd.text; }
+
+    // Orders the commands for submission. Called once recording is finished.
+    void Sort() {
+        m_order.clear();
+        for (uint32_t i = 0; i < (uint32_t)m_commands.size(); ++i) {
+            const DrawCommand& cmd = m_commands[i];
+            // layer | texture | batch kind | recording index, so equal keys never happen
+            uint64_t key = ((uint64_t)cmd.layer << 56) | ((uint64_t)cmd.texture << 40) | ((uint64_t)BatchKindOf(cmd.type) << 32) | i;
+            m_order.push_back(key);
+        }
+        std::sort(m_order.begin(), m_order.end());
+        m_sorted = true;
+    }
+
+    // Draw calls raylib will need for this list, sorted or in recording order
+    uint32_t BatchCount(bool sorted) const {
+        uint32_t batches = 0;
+        bool first = true;
+        BatchKind kind = BatchKind::CLEAR;
+        uint16_t texture = 0;
+        for (size_t n = 0; n < m_commands.size(); ++n) {
+            const DrawCommand& cmd = sorted && m_sorted ? m_commands[(uint32_t)m_order[n]] : m_commands[n];
+            BatchKind cmdKind = BatchKindOf(cmd.type);
+            if (cmdKind == BatchKind::CLEAR) continue;
+            if (first || cmdKind != kind || cmd.texture != texture) ++batches;
+            first = false;
+            kind = cmdKind;
+            texture = cmd.texture;
+        }
+        return batches;
+    }
+
+    // Replays every recorded command into 'backend' (RaylibBackend, NullBackend, ...),
+    // in sorted order if Sort() was called
+    template <typename Backend>
+    SubmitStats Submit(Backend& backend) const {
+        SubmitLayers(backend, Layer::BACKGROUND, Layer::HUD);
+        return Stats();
+    }
+
+    SubmitStats Stats() const {
+        SubmitStats stats;
+        stats.commands = (uint32_t)m_commands.size();
+        stats.batches = BatchCount(true);
+        stats.unsortedBatches = BatchCount(false);
+        return stats;
+    }
+
+    // Replays only the commands on layers 'first' to 'last', e.g. to draw the HUD into a different target
+    template <typename Backend>
+    void SubmitLayers(Backend& backend, Layer first, Layer last) const {
+        for (size_t n = 0; n < m_commands.size(); ++n) {
+            const DrawCommand& cmd = m_sorted ? m_commands[(uint32_t)m_order[n]] : m_commands[n];
+            if (cmd.layer < first || cmd.layer > last) continue;
+            const float* v = cmd.v;
+            switch (cmd.type) {
+                case CommandType::CLEAR: backend.ClearBackground(cmd.color); break;
+                case CommandType::RECTANGLE: backend.DrawRectangleRec({ v[0], v[1], v[2], v[3] }, cmd.color); break;
+                case CommandType::RECTANGLE_LINES: backend.DrawRectangleLines((int)v[0], (int)v[1], (int)v[2], (int)v[3], cmd.color); break;
+                case CommandType::RECTANGLE_LINES_EX: backend.DrawRectangleLinesEx({ v[0], v[1], v[2], v[3] }, v[4], cmd.color); break;
+                case CommandType::RECTANGLE_ROUNDED: backend.DrawRectangleRounded({ v[0], v[1], v[2], v[3] }, v[4], cmd.ival, cmd.color); break;
+                case CommandType::RECTANGLE_ROUNDED_LINES: backend.DrawRectangleRoundedLines({ v[0], v[1], v[2], v[3] }, v[4], cmd.ival, v[5], cmd.color); break;
+                case CommandType::CIRCLE: backend.DrawCircle((int)v[0], (int)v[1], v[2], cmd.color); break;
+                case CommandType::CIRCLE_LINES: backend.DrawCircleLines((int)v[0], (int)v[1], v[2], cmd.color); break;
+                case CommandType::ELLIPSE: backend.DrawEllipse((int)v[0], (int)v[1], v[2], v[3], cmd.color); break;
+                case CommandType::ELLIPSE_LINES: backend.DrawEllipseLines((int)v[0], (int)v[1], v[2], v[3], cmd.color); break;
+                case CommandType::TRIANGLE: backend.DrawTriangle({ v[0], v[1] }, { v[2], v[3] }, { v[4], v[5] }, cmd.color); break;
+                case CommandType::TEXT: backend.DrawText(Text(cmd), (int)v[0], (int)v[1], cmd.ival, cmd.color); break;
+                case CommandType::SPRITE: backend.DrawSprite((Sprite)cmd.ival, { v[0], v[1], v[2], v[3] }, cmd.color); break;
+            }
+        }
+    }
+
+private:
+    std::vector<DrawCommand> m_commands;
+    std::vector<uint64_t> m_order; // Sort keys; the low 32 bits index m_commands
+    std::vector<char> m_text;
+    Layer m_layer;
+    bool m_sorted;
+    Rectangle m_viewport;
+    bool m_hasViewport;
+
+    DrawCommand& Push(CommandType type, Color color, std::initializer_list<float> values, int ival = 0) {
+        m_commands.emplace_back();
+        DrawCommand& cmd = m_commands.back();
+        cmd.type = type;
+        cmd.layer = type == CommandType::CLEAR ? Layer::BACKGROUND : m_layer;
+        cmd.texture = 0;
+        cmd.color = color;
+        cmd.ival = ival;
+        cmd.text = 0;
+        std::fill(std::begin(cmd.v), std::end(cmd.v), 0.0f);
+        std::copy(values.begin(), values.end(), cmd.v);
+        if (m_hasViewport) {
+            int points = type == CommandType::TRIANGLE ? 3 : 1; // Everything else starts with one position
+            for (int i = 0; i < points; ++i) {
+                cmd.v[i * 2] += m_viewport.x;
+                cmd.v[i * 2 + 1] += m_viewport.y;
+            }
+        }
+        return cmd;
+    }
+};
+
+const size_t COMMAND_TYPE_COUNT = (size_t)CommandType::SPRITE + 1;
+
+inline const char* CommandTypeName(CommandType type) {
+    static const char* const NAMES[COMMAND_TYPE_COUNT] = {
+        "Clear", "Rectangle", "RectangleLines", "RectangleLinesEx", "RectangleRounded", "RectangleRoundedLines",
+        "Circle", "CircleLines", "Ellipse", "EllipseLines", "Triangle", "Text", "Sprite"
+    };
+    return NAMES[(size_t)type];
+}
+
+// Run-length coding for atlas pixels: a byte n below 128 is followed by one pixel that repeats
+// n + 1 times, a byte n from 128 up by n - 127 pixels as they are
+inline void EncodeRuns(const std::vector<Color>& pixels, std::vector<unsigned char>& out) {
+    auto same = [](Color a, Color b) { return a.r == b.r && a.g == b.g && a.b == b.b && a.a == b.a; };
+    auto put = [&out](Color c) { out.insert(out.end(), { c.r, c.g, c.b, c.a }); };
+    size_t i = 0;
+    while (i < pixels.size()) {
+        size_t run = 1;
+        while (i + run < pixels.size() && run < 128 && same(pixels[i + run], pixels[i])) ++run;
+        if (run > 1) {
+            out.push_back((unsigned char)(run - 1));
+            put(pixels[i]);
+            i += run;
+            continue;
+        }
+        size_t literal = 1; // Up to the next pair of equal pixels
+        while (i + literal < pixels.size() && literal < 128 &&
+               !(i + literal + 1 < pixels.size() && same(pixels[i + literal], pixels[i + literal + 1]))) ++literal;
+        out.push_back((unsigned char)(127 + literal));
+        for (size_t n = 0; n < literal; ++n) put(pixels[i + n]);
+        i += literal;
+    }
+}
+
+// Fills 'pixels' (already sized) from EncodeRuns() output. False if the data doesn't fill it exactly.
+inline bool DecodeRuns(const unsigned char* data, size_t size, std::vector<Color>& pixels) {
+    size_t in = 0, out = 0;
+    while (in < size) {
+        unsigned char header = data[in++];
+        bool repeat = header < 128;
+        size_t count = repeat ? header + 1u : header - 127u;
+        size_t bytes = repeat ? 4 : 4 * count;
+        if (in + bytes > size || out + count > pixels.size()) return false;
+        for (size_t n = 0; n < count; ++n) {
+            const unsigned char* c = data + in + (repeat ? 0 : 4 * n);
+            pixels[out++] = Color{ c[0], c[1], c[2], c[3] };
+        }
+        in += bytes;
+    }
+    return out == pixels.size();
+}
+
+// The texture every sprite is drawn from. The pixels are set once at startup (from the atlas
+// baked into the binary, see LoadSpriteAtlas()) and kept, so ImageBackend can draw sprites
+// without a GPU; Upload() turns them into a texture in a single upload.
+class SpriteAtlas {
+public:
+    SpriteAtlas() : m_width(0), m_height(0), m_texture{} {}
+
+    void SetPixels(std::vector<Color> pixels, int width, int height) {
+        m_pixels = std::move(pixels);
+        m_width = width;
+        m_height = height;
+    }
+    bool HasPixels() const { return !m_pixels.empty(); }
+    const std::vector<Color>& Pixels() const { return m_pixels; }
+
+    // The pixels as a raylib Image; it doesn't own them
+    Image GetImage() const {
+        Image image = {};
+        image.data = const_cast<Color*>(m_pixels.data());
+        image.width = m_width;
+        image.height = m_height;
+        image.mipmaps = 1;
+        image.format = PIXELFORMAT_UNCOMPRESSED_R8G8B8A8;
+        return image;
+    }
+
+    // Render thread, after the window exists
+    void Upload() {
+        if (m_texture.id != 0 || !HasPixels()) return;
+        m_texture = LoadTextureFromImage(GetImage());
+        GenTextureMipmaps(&m_texture); // Sprites are mostly drawn smaller than baked
+        SetTextureFilter(m_texture, TEXTURE_FILTER_TRILINEAR);
+    }
+    void Unload() {
+        if (m_texture.id != 0) UnloadTexture(m_texture);
+        m_texture = Texture2D{};
+    }
+    const Texture2D& Texture() const { return m_texture; }
+
+private:
+    std::vector<Color> m_pixels;
+    int m_width, m_height;
+    Texture2D m_texture;
+};
+
+SpriteAtlas spriteAtlas;
+
+// Draws for real through raylib. Render thread only.
+struct RaylibBackend {
+    void ClearBackground(Color color) { ::ClearBackground(color); }
+    void DrawRectangleRec(Rectangle rec, Color color) { ::DrawRectangleRec(rec, color); }
+    void DrawRectangleLines(int posX, int posY, int width, int height, Color color) { ::DrawRectangleLines(posX, posY, width, height, color); }
+    void DrawRectangleLinesEx(Rectangle rec, float lineThick, Color color) { ::DrawRectangleLinesEx(rec, lineThick, color); }
+    void DrawRectangleRounded(Rectangle rec, float roundness, int segments, Color color) { ::DrawRectangleRounded(rec, roundness, segments, color); }
+    void DrawRectangleRoundedLines(Rectangle rec, float roundness, int segments, float lineThick, Color color) { ::DrawRectangleRoundedLines(rec, roundness, segments, lineThick, color); }
+    void DrawCircle(int centerX, int centerY, float radius, Color color) { ::DrawCircle(centerX, centerY, radius, color); }
+    void DrawCircleLines(int centerX, int centerY, float radius, Color color) { ::DrawCircleLines(centerX, centerY, radius, color); }
+    void DrawEllipse(int centerX, int centerY, float radiusH, float radiusV, Color color) { ::DrawEllipse(centerX, centerY, radiusH, radiusV, color); }
+    void DrawEllipseLines(int centerX, int centerY, float radiusH, float radiusV, Color color) { ::DrawEllipseLines(centerX, centerY, radiusH, radiusV, color); }
+    void DrawTriangle(Vector2 v1, Vector2 v2, Vector2 v3, Color color) { ::DrawTriangle(v1, v2, v3, color); }
+    void DrawText(const char* text, int posX, int posY, int fontSize, Color color) { ::DrawText(text, posX, posY, fontSize, color); }
+    void DrawSprite(Sprite sprite, Rectangle bounds, Color tint) {
+        ::DrawTexturePro(spriteAtlas.Texture(), GetAtlasLayout().sources[(size_t)sprite], SpriteDestination(sprite, bounds), { 0, 0 }, 0.0f, tint);
+    }
+};
+
+// Draws nothing. Counts primitives per type, records the bounding box of each one and
+// flags draws that can't be right (non-finite or negative geometry, empty text, nothing
+// on screen). Needs no window or GPU, so levels can be drawn headless.
+class NullBackend {
+public:
+    struct Primitive {
+        CommandType type;
+        Rectangle bounds;
+    };
+
+    explicit NullBackend(int screenW = GLOBAL_SCREEN_WIDTH, int screenH = GLOBAL_SCREEN_HEIGHT) : m_screen{ 0, 0, (float)screenW, (float)screenH } {
+        m_primitives.reserve(1024);
+        BeginFrame();
+    }
+
+    // Forgets the previous frame's counts and boxes
+    void BeginFrame() {
+        std::fill(std::begin(m_counts), std::end(m_counts), 0u);
+        m_primitives.clear();
+        m_invalid = 0;
+        m_offscreen = 0;
+        m_firstProblem = nullptr;
+    }
+
+    uint32_t Count(CommandType type) const { return m_counts[(size_t)type]; }
+    uint32_t Total() const { return (uint32_t)m_primitives.size(); }
+    uint32_t InvalidCount() const { return m_invalid; }
+    uint32_t OffscreenCount() const { return m_offscreen; }
+    const char* FirstProblem() const { return m_firstProblem; } // nullptr if the frame was clean
+    const std::vector<Primitive>& Primitives() const { return m_primitives; }
+
+    // Union of everything drawn this frame (the clear is not counted)
+    Rectangle Bounds() const {
+        bool any = false;
+        float x0 = 0, y0 = 0, x1 = 0, y1 = 0;
+        for (const Primitive& p : m_primitives) {
+            if (p.type == CommandType::CLEAR) continue;
+            if (!any) { x0 = p.bounds.x; y0 = p.bounds.y; x1 = p.bounds.x + p.bounds.width; y1 = p.bounds.y + p.bounds.height; any = true; continue; }
+            x0 = std::min(x0, p.bounds.x);
+            y0 = std::min(y0, p.bounds.y);
+            x1 = std::max(x1, p.bounds.x + p.bounds.width);
+            y1 = std::max(y1, p.bounds.y + p.bounds.height);
+        }
+        return { x0, y0, x1 - x0, y1 - y0 };
+    }
+
+    void ClearBackground(Color) { Record(CommandType::CLEAR, m_screen, true); }
+    void DrawRectangleRec(Rectangle rec, Color) { Record(CommandType::RECTANGLE, rec, rec.width >= 0 && rec.height >= 0); }
+    void DrawRectangleLines(int posX, int posY, int width, int height, Color) {
+        Record(CommandType::RECTANGLE_LINES, { (float)posX, (float)posY, (float)width, (float)height }, width >= 0 && height >= 0);
+    }
+    void DrawRectangleLinesEx(Rectangle rec, float lineThick, Color) {
+        Record(CommandType::RECTANGLE_LINES_EX, rec, rec.width >= 0 && rec.height >= 0 && lineThick > 0);
+    }
+    void DrawRectangleRounded(Rectangle rec, float roundness, int segments, Color) {
+        Record(CommandType::RECTANGLE_ROUNDED, rec, rec.width >= 0 && rec.height >= 0 && roundness >= 0 && segments >= 0);
+    }
+    void DrawRectangleRoundedLines(Rectangle rec, float roundness, int segments, float lineThick, Color) {
+        Record(CommandType::RECTANGLE_ROUNDED_LINES, rec, rec.width >= 0 && rec.height >= 0 && roundness >= 0 && segments >= 0 && lineThick > 0);
+    }
+    void DrawCircle(int centerX, int centerY, float radius, Color) {
+        Record(CommandType::CIRCLE, { centerX - radius, centerY - radius, 2 * radius, 2 * radius }, radius >= 0);
+    }
+    void DrawCircleLines(int centerX, int centerY, float radius, Color) {
+        Record(CommandType::CIRCLE_LINES, { centerX - radius, centerY - radius, 2 * radius, 2 * radius }, radius >= 0);
+    }
+    void DrawEllipse(int centerX, int centerY, float radiusH, float radiusV, Color) {
+        Record(CommandType::ELLIPSE, { centerX - radiusH, centerY - radiusV, 2 * radiusH, 2 * radiusV }, radiusH >= 0 && radiusV >= 0);
+    }
+    void DrawEllipseLines(int centerX, int centerY, float radiusH, float radiusV, Color) {
+        Record(CommandType::ELLIPSE_LINES, { centerX - radiusH, centerY - radiusV, 2 * radiusH, 2 * radiusV }, radiusH >= 0 && radiusV >= 0);
+    }
+    void DrawTriangle(Vector2 v1, Vector2 v2, Vector2 v3, Color) {
+        float x0 = std::min({ v1.x, v2.x, v3.x }), y0 = std::min({ v1.y, v2.y, v3.y });
+        float x1 = std::max({ v1.x, v2.x, v3.x }), y1 = std::max({ v1.y, v2.y, v3.y });
+        Record(CommandType::TRIANGLE, { x0, y0, x1 - x0, y1 - y0 }, true);
+    }
+    void DrawText(const char* text, int posX, int posY, int fontSize, Color) {
+        // Without a window raylib has no font to measure with, so estimate half an em per character
+        int columns = 0, lines = 1, lineLength = 0;
+        for (const char* c = text; *c; ++c) {
+            if (*c == '\n') { ++lines; lineLength = 0; continue; }
+            columns = std::max(columns, ++lineLength);
+        }
+        int width = std::max(MeasureText(text, fontSize), columns * fontSize / 2);
+        Record(CommandType::TEXT, { (float)posX, (float)posY, (float)width, (float)(lines * fontSize) }, text[0] != '\0' && fontSize > 0);
+    }
+    void DrawSprite(Sprite sprite, Rectangle bounds, Color) {
+        bool known = sprite < Sprite::COUNT;
+        Record(CommandType::SPRITE, known ? SpriteDestination(sprite, bounds) : bounds, known && bounds.width >= 0 && bounds.height >= 0);
+    }
+
+private:
+    Rectangle m_screen;
+    uint32_t m_counts[COMMAND_TYPE_COUNT];
+    std::vector<Primitive> m_primitives;
+    uint32_t m_invalid;
+    uint32_t m_offscreen;
+    const char* m_firstProblem;
+
+    void Record(CommandType type, Rectangle bounds, bool valid) {
+        ++m_counts[(size_t)type];
+        m_primitives.push_back({ type, bounds });
+        if (!std::isfinite(bounds.x) || !std::isfinite(bounds.y) || !std::isfinite(bounds.width) || !std::isfinite(bounds.height)) {
+            valid = false;
+        }
+        if (!valid) {
+            ++m_invalid;
+            if (!m_firstProblem) m_firstProblem = CommandTypeName(type);
+        } else if (type != CommandType::CLEAR && !CheckCollisionRecs(bounds, m_screen) && !(bounds.width == 0 || bounds.height == 0)) {
+            ++m_offscreen; // Legal, but wasted work
+        }
+    }
+};
+
+// Software-rasterizes into a CPU-side raylib Image with raylib's Image* functions, filling
+// in the shapes raylib has no Image version of. No blending: later draws overwrite pixels.
+// Without a window raylib has no font loaded, so text is drawn as a block covering its
+// estimated extents; that still catches text that moves, changes size or disappears.
+class ImageBackend {
+public:
+    explicit ImageBackend(Image* target) : m_target(target) {}
+
+    void ClearBackground(Color color) { ImageClearBackground(m_target, color); }
+    void DrawRectangleRec(Rectangle rec, Color color) { ImageDrawRectangleRec(m_target, rec, color); }
+    void DrawRectangleLines(int posX, int posY, int width, int height, Color color) {
+        ImageDrawRectangleLines(m_target, { (float)posX, (float)posY, (float)width, (float)height }, 1, color);
+    }
+    void DrawRectangleLinesEx(Rectangle rec, float lineThick, Color color) {
+        ImageDrawRectangleLines(m_target, rec, std::max(1, (int)lineThick), color);
+    }
+    void DrawRectangleRounded(Rectangle rec, float roundness, int, Color color) {
+        float r = CornerRadius(rec, roundness);
+        ImageDrawRectangleRec(m_target, { rec.x + r, rec.y, rec.width - 2 * r, rec.height }, color);
+        ImageDrawRectangleRec(m_target, { rec.x, rec.y + r, rec.width, rec.height - 2 * r }, color);
+        for (int corner = 0; corner < 4; ++corner) {
+            Vector2 c = CornerCenter(rec, r, corner);
+            ImageDrawCircle(m_target, (int)c.x, (int)c.y, (int)r, color);
+        }
+    }
+    void DrawRectangleRoundedLines(Rectangle rec, float roundness, int, float lineThick, Color color) {
+        float r = CornerRadius(rec, roundness);
+        int thick = std::max(1, (int)lineThick);
+        // raylib draws rounded outlines outside the rectangle
+        ImageDrawRectangleRec(m_target, { rec.x + r, rec.y - thick, rec.width - 2 * r, (float)thick }, color);
+        ImageDrawRectangleRec(m_target, { rec.x + r, rec.y + rec.height, rec.width - 2 * r, (float)thick }, color);
+        ImageDrawRectangleRec(m_target, { rec.x - thick, rec.y + r, (float)thick, rec.height - 2 * r }, color);
+        ImageDrawRectangleRec(m_target, { rec.x + rec.width, rec.y + r, (float)thick, rec.height - 2 * r }, color);
+        for (int corner = 0; corner < 4; ++corner) {
+            Vector2 c = CornerCenter(rec, r, corner);
+            float start = corner * PI / 2 + PI; // Top-left, top-right, bottom-right, bottom-left
+            for (int t = 0; t < thick; ++t) Arc(c, r + t + 0.5f, start, start + PI / 2, color);
+        }
+    }
+    void DrawCircle(int centerX, int centerY, float radius, Color color) { ImageDrawCircle(m_target, centerX, centerY, (int)radius, color); }
+    void DrawCircleLines(int centerX, int centerY, float radius, Color color) { ImageDrawCircleLines(m_target, centerX, centerY, (int)radius, color); }
+    void DrawEllipse(int centerX, int centerY, float radiusH, float radiusV, Color color) {
+        for (int dy = -(int)radiusV; dy <= (int)radiusV; ++dy) {
+            float t = radiusV > 0 ? dy / radiusV : 0.0f;
+            int halfWidth = (int)(radiusH * std::sqrt(std::max(0.0f, 1.0f - t * t)));
+            ImageDrawRectangle(m_target, centerX - halfWidth, centerY + dy, 2 * halfWidth + 1, 1, color);
+        }
+    }
+    void DrawEllipseLines(int centerX, int centerY, float radiusH, float radiusV, Color color) {
+        int steps = std::max(16, (int)(2 * PI * std::max(radiusH, radiusV)));
+        for (int i = 0; i < steps; ++i) {
+            float angle = 2 * PI * i / steps;
+            ImageDrawPixel(m_target, (int)std::lround(centerX + std::cos(angle) * radiusH), (int)std::lround(centerY + std::sin(angle) * radiusV), color);
+        }
+    }
+    void DrawTriangle(Vector2 v1, Vector2 v2, Vector2 v3, Color color) {
+        // Edge functions over the bounding box; accepts either winding
+        int x0 = (int)std::floor(std::min({ v1.x, v2.x, v3.x })), x1 = (int)std::ceil(std::max({ v1.x, v2.x, v3.x }));
+        int y0 = (int)std::floor(std::min({ v1.y, v2.y, v3.y })), y1 = (int)std::ceil(std::max({ v1.y, v2.y, v3.y }));
+        auto edge = [](Vector2 a, Vector2 b, float px, float py) { return (b.x - a.x) * (py - a.y) - (b.y - a.y) * (px - a.x); };
+        for (int y = y0; y <= y1; ++y) {
+            for (int x = x0; x <= x1; ++x) {
+                float px = x + 0.5f, py = y + 0.5f;
+                float e1 = edge(v1, v2, px, py), e2 = edge(v2, v3, px, py), e3 = edge(v3, v1, px, py);
+                if ((e1 >= 0 && e2 >= 0 && e3 >= 0) || (e1 <= 0 && e2 <= 0 && e3 <= 0)) ImageDrawPixel(m_target, x, y, color);
+            }
+        }
+    }
+    void DrawText(const char* text, int posX, int posY, int fontSize, Color color) {
+        if (GetFontDefault().texture.id != 0) {
+            ImageDrawText(m_target, text, posX, posY, fontSize, color);
+            return;
+        }
+        int column = 0, line = 0;
+        for (const char* c = text; *c; ++c) {
+            if (*c == '\n') { column = 0; ++line; continue; }
+            if (*c != ' ') ImageDrawRectangle(m_target, posX + column * fontSize / 2, posY + line * fontSize + fontSize / 4, fontSize / 2 - 1, fontSize / 2, color);
+            ++column;
+        }
+    }
+    void DrawSprite(Sprite sprite, Rectangle bounds, Color tint) {
+        if (!spriteAtlas.HasPixels()) return;
+        ImageDraw(m_target, spriteAtlas.GetImage(), GetAtlasLayout().sources[(size_t)sprite], SpriteDestination(sprite, bounds), tint);
+    }
+
+private:
+    Image* m_target;
+
+    static float CornerRadius(Rectangle rec, float roundness) {
+        return std::max(0.0f, std::min(roundness, 1.0f) * std::min(rec.width, rec.height) / 2);
+    }
+    static Vector2 CornerCenter(Rectangle rec, float r, int corner) {
+        return { corner == 0 || corner == 3 ? rec.x + r : rec.x + rec.width - r,
+                 corner < 2 ? rec.y + r : rec.y + rec.height - r };
+    }
+    void Arc(Vector2 center, float radius, float from, float to, Color color) {
+        int steps = std::max(4, (int)(radius * (to - from)));
+        for (int i = 0; i <= steps; ++i) {
+            float angle = from + (to - from) * i / steps;
+            ImageDrawPixel(m_target, (int)std::lround(center.x + std::cos(angle) * radius), (int)std::lround(center.y + std::sin(angle) * radius), color);
+        }
+    }
+};
+
+// Rasterizes with antialiasing and blending: each pixel takes 4x4 samples of a shape and the
+// covered share of them is blended over what is there. Far slower than raylib and only used
+// to bake the sprite atlas, whose edges have to stay smooth when sprites are scaled.
+class CoverageBackend {
+public:
+    CoverageBackend(int width, int height) : m_width(width), m_height(height), m_pixels((size_t)width * height * 4, 0.0f) {}
+
+    // Straight (not premultiplied) alpha, as raylib textures expect
+    std::vector<Color> Pixels() const {
+        std::vector<Color> out((size_t)m_width * m_height);
+        for (size_t i = 0; i < out.size(); ++i) {
+            const float* p = &m_pixels[i * 4];
+            float alpha = p[3];
+            auto channel = [alpha](float premultiplied) { return (unsigned char)std::lround(std::min(1.0f, premultiplied / alpha) * 255.0f); };
+            out[i] = alpha > 0.0f ? Color{ channel(p[0]), channel(p[1]), channel(p[2]), (unsigned char)std::lround(alpha * 255.0f) } : Color{ 0, 0, 0, 0 };
+        }
+        return out;
+    }
+
+    void ClearBackground(Color color) {
+        std::fill(m_pixels.begin(), m_pixels.end(), 0.0f);
+        Cover({ 0, 0, (float)m_width, (float)m_height }, color, [](float, float) { return true; });
+    }
+    void DrawRectangleRec(Rectangle rec, Color color) {
+        Cover(rec, color, [rec](float x, float y) { return InRectangle(rec, x, y); });
+    }
+    void DrawRectangleLines(int posX, int posY, int width, int height, Color color) {
+        DrawRectangleLinesEx({ (float)posX, (float)posY, (float)width, (float)height }, 1.0f, color);
+    }
+    void DrawRectangleLinesEx(Rectangle rec, float lineThick, Color color) {
+        Rectangle inner = { rec.x + lineThick, rec.y + lineThick, rec.width - 2 * lineThick, rec.height - 2 * lineThick };
+        Cover(rec, color, [rec, inner](float x, float y) { return InRectangle(rec, x, y) && !InRectangle(inner, x, y); });
+    }
+    void DrawRectangleRounded(Rectangle rec, float roundness, int, Color color) {
+        float r = CornerRadius(rec, roundness);
+        Cover(rec, color, [rec, r](float x, float y) { return InRounded(rec, r, x, y); });
+    }
+    void DrawRectangleRoundedLines(Rectangle rec, float roundness, int, float lineThick, Color color) {
+        // raylib draws rounded outlines outside the rectangle
+        float r = CornerRadius(rec, roundness);
+        Rectangle outer = { rec.x - lineThick, rec.y - lineThick, rec.width + 2 * lineThick, rec.height + 2 * lineThick };
+        Cover(outer, color, [rec, outer, r, lineThick](float x, float y) { return InRounded(outer, r + lineThick, x, y) && !InRounded(rec, r, x, y); });
+    }
+    void DrawCircle(int centerX, int centerY, float radius, Color color) {
+        DrawEllipse(centerX, centerY, radius, radius, color);
+    }
+    void DrawCircleLines(int centerX, int centerY, float radius, Color color) {
+        DrawEllipseLines(centerX, centerY, radius, radius, color);
+    }
+    void DrawEllipse(int centerX, int centerY, float radiusH, float radiusV, Color color) {
+        Vector2 center = { (float)centerX, (float)centerY };
+        Cover({ center.x - radiusH, center.y - radiusV, 2 * radiusH, 2 * radiusV }, color,
+              [center, radiusH, radiusV](float x, float y) { return InEllipse(center, radiusH, radiusV, x, y); });
+    }
+    void DrawEllipseLines(int centerX, int centerY, float radiusH, float radiusV, Color color) {
+        Vector2 center = { (float)centerX, (float)centerY };
+        Cover({ center.x - radiusH - 1, center.y - radiusV - 1, 2 * radiusH + 2, 2 * radiusV + 2 }, color, [center, radiusH, radiusV](float x, float y) {
+            return InEllipse(center, radiusH + 0.5f, radiusV + 0.5f, x, y) && !InEllipse(center, radiusH - 0.5f, radiusV - 0.5f, x, y);
+        });
+    }
+    void DrawTriangle(Vector2 v1, Vector2 v2, Vector2 v3, Color color) {
+        float x0 = std::min({ v1.x, v2.x, v3.x }), y0 = std::min({ v1.y, v2.y, v3.y });
+        float x1 = std::max({ v1.x, v2.x, v3.x }), y1 = std::max({ v1.y, v2.y, v3.y });
+        auto edge = [](Vector2 a, Vector2 b, float px, float py) { return (b.x - a.x) * (py - a.y) - (b.y - a.y) * (px - a.x); };
+        Cover({ x0, y0, x1 - x0, y1 - y0 }, color, [=](float x, float y) {
+            float e1 = edge(v1, v2, x, y), e2 = edge(v2, v3, x, y), e3 = edge(v3, v1, x, y);
+            return (e1 >= 0 && e2 >= 0 && e3 >= 0) || (e1 <= 0 && e2 <= 0 && e3 <= 0);
+        });
+    }
+    void DrawText(const char*, int, int, int, Color) {}  // Sprites have no text: there is no font when baking
+    void DrawSprite(Sprite, Rectangle, Color) {}          // Nor other sprites
+
+private:
+    static const int SAMPLES = 4; // Per pixel and axis
+
+    int m_width, m_height;
+    std::vector<float> m_pixels; // Premultiplied RGBA, 0..1
+
+    static bool InRectangle(Rectangle rec, float x, float y) {
+        return x >= rec.x && x < rec.x + rec.width && y >= rec.y && y < rec.y + rec.height;
+    }
+    static bool InRounded(Rectangle rec, float r, float x, float y) {
+        if (!InRectangle(rec, x, y)) return false;
+        float dx = x - std::max(rec.x + r, std::min(x, rec.x + rec.width - r)); // From the nearest point of the inner rectangle
+        float dy = y - std::max(rec.y + r, std::min(y, rec.y + rec.height - r));
+        return dx * dx + dy * dy <= r * r;
+    }
+    static bool InEllipse(Vector2 center, float radiusH, float radiusV, float x, float y) {
+        if (radiusH <= 0 || radiusV <= 0) return false;
+        float dx = (x - center.x) / radiusH, dy = (y - center.y) / radiusV;
+        return dx * dx + dy * dy <= 1.0f;
+    }
+    static float CornerRadius(Rectangle rec, float roundness) {
+        return std::max(0.0f, std::min(roundness, 1.0f) * std::min(rec.width, rec.height) / 2);
+    }
+
+    // Blends 'color' over every pixel of 'area' by the share of its samples 'inside' accepts
+    template <typename Inside>
+    void Cover(Rectangle area, Color color, Inside inside) {
+        int x0 = std::max(0, (int)std::floor(area.x)), x1 = std::min(m_width, (int)std::ceil(area.x + area.width) + 1);
+        int y0 = std::max(0, (int)std::floor(area.y)), y1 = std::min(m_height, (int)std::ceil(area.y + area.height) + 1);
+        const float source[4] = { color.r / 255.0f, color.g / 255.0f, color.b / 255.0f, color.a / 255.0f };
+        for (int y = y0; y < y1; ++y) {
+            for (int x = x0; x < x1; ++x) {
+                int covered = 0;
+                for (int sy = 0; sy < SAMPLES; ++sy) {
+                    for (int sx = 0; sx < SAMPLES; ++sx) {
+                        if (inside(x + (sx + 0.5f) / SAMPLES, y + (sy + 0.5f) / SAMPLES)) ++covered;
+                    }
+                }
+                if (covered == 0) continue;
+                float alpha = source[3] * covered / (SAMPLES * SAMPLES);
+                float* p = &m_pixels[((size_t)y * m_width + x) * 4];
+                for (int c = 0; c < 3; ++c) p[c] = source[c] * alpha + p[c] * (1.0f - alpha);
+                p[3] = alpha + p[3] * (1.0f - alpha);
+            }
+        }
+    }
+};
+
+struct ImageDiff {
+    int differentPixels = 0;
+    int totalPixels = 0;
+    float maxDelta = 0.0f; // 0..1, perceptual
+};
+
+// Perceptual difference between two R8G8B8A8 images of the same size: colours are
+// compared in YIQ space (weighted like the eye, after blending onto white), so a slight
+// hue shift counts for less than a change in brightness. Pixels whose difference exceeds
+// 'threshold' (0..1) are counted and, if 'diffOut' is given, painted red over a faded copy.
+inline ImageDiff PerceptualDiff(const Image& expected, const Image& actual, float threshold, Image* diffOut = nullptr) {
+    const float MAX_YIQ_DELTA = 35215.0f;
+    ImageDiff diff;
+    diff.totalPixels = expected.width * expected.height;
+    const Color* a = (const Color*)expected.data;
+    const Color* b = (const Color*)actual.data;
+    Color* out = diffOut ? (Color*)diffOut->data : nullptr;
+    for (int i = 0; i < diff.totalPixels; ++i) {
+        auto blend = [](unsigned char c, unsigned char alpha) { return 255.0f + (c - 255.0f) * alpha / 255.0f; };
+        float r1 = blend(a[i].r, a[i].a), g1 = blend(a[i].g, a[i].a), b1 = blend(a[i].b, a[i].a);
+        float r2 = blend(b[i].r, b[i].a), g2 = blend(b[i].g, b[i].a), b2 = blend(b[i].b, b[i].a);
+        float dy = (r1 - r2) * 0.29889531f + (g1 - g2) * 0.58662247f + (b1 - b2) * 0.11448223f;
+        float di = (r1 - r2) * 0.59597799f - (g1 - g2) * 0.27417610f - (b1 - b2) * 0.32180189f;
+        float dq = (r1 - r2) * 0.21147017f - (g1 - g2) * 0.52261711f + (b1 - b2) * 0.31114694f;
+        float delta = (0.5053f * dy * dy + 0.299f * di * di + 0.1957f * dq * dq) / MAX_YIQ_DELTA;
+        diff.maxDelta = std::max(diff.maxDelta, delta);
+        bool different = delta > threshold * threshold;
+        if (different) ++diff.differentPixels;
+        if (out) {
+            unsigned char gray = (unsigned char)(255 - (255 - (r1 * 0.3f + g1 * 0.59f + b1 * 0.11f)) * 0.1f);
+            out[i] = different ? Color{ 255, 0, 0, 255 } : Color{ gray, gray, gray, 255 };
+        }
+    }
+    diff.maxDelta = std::sqrt(diff.maxDelta);
+    return diff;
+}
+
+// Where presented frames go. BAKRA_NULL_RENDERER swaps raylib out for the counting backend.
+#ifdef BAKRA_NULL_RENDERER
+using ScreenBackend = NullBackend;
+#else
+using ScreenBackend = RaylibBackend;
+#endif
+
+// Chooses the resolution levels are rendered at from how long frames take, so a slow machine
+// keeps its frame rate by drawing fewer pixels. It shrinks quickly when frames run over
+// budget and grows back slowly, and only when the work left at the larger size (which grows
+// with the pixel count) would still fit comfortably. A scale that ran over is not retried for
+// a while. Together with a settling period after each change that keeps it from oscillating.
+class ResolutionScaler {
+public:
+    static constexpr float MIN_SCALE = 0.5f;
+    static constexpr float MAX_SCALE = 1.0f;
+    static constexpr float SHRINK_STEP = 0.1f;
+    static constexpr float GROW_STEP = 0.05f;
+    static constexpr double OVER_BUDGET = 1.05;  // Smoothed frame time above this share of the budget means frames are being missed
+    static constexpr double GROW_HEADROOM = 0.7; // Predicted work time at the larger scale must stay below this share
+    static constexpr int FRAMES_TO_SHRINK = 15;  // Consecutive over-budget frames before shrinking
+    static constexpr int FRAMES_TO_GROW = 120;   // Consecutive frames with headroom before growing
+    static constexpr int SETTLE_FRAMES = 30;     // Frames ignored after a change while timings catch up
+    static constexpr int RETRY_FRAMES = 600;     // How long a scale that ran over stays off limits
+
+    explicit ResolutionScaler(double budgetSeconds)
+        : m_budget(budgetSeconds), m_scale(MAX_SCALE), m_ceiling(MAX_SCALE), m_frameTime(0.0), m_workTime(0.0),
+          m_overFrames(0), m_headroomFrames(0), m_settleFrames(0), m_ceilingFrames(0), m_hasSample(false) {}
+
+    float Scale() const { return m_scale; }
+
+    // One frame's timings: 'frameSeconds' is the whole frame interval (it includes waiting on
+    // the GPU at the buffer swap), 'workSeconds' the part spent rendering. Returns the new scale.
+    float Update(double frameSeconds, double workSeconds) {
+        if (!m_hasSample) {
+            m_frameTime = frameSeconds;
+            m_workTime = workSeconds;
+            m_hasSample = true;
+        }
+        m_frameTime += (frameSeconds - m_frameTime) * 0.1;
+        m_workTime += (workSeconds - m_workTime) * 0.1;
+        if (m_ceilingFrames > 0 && --m_ceilingFrames == 0) m_ceiling = MAX_SCALE;
+        if (m_settleFrames > 0) {
+            --m_settleFrames;
+            return m_scale;
+        }
+
+        m_overFrames = m_frameTime > m_budget * OVER_BUDGET ? m_overFrames + 1 : 0;
+        if (m_overFrames >= FRAMES_TO_SHRINK && m_scale > MIN_SCALE) {
+            m_ceiling = m_scale;
+            m_ceilingFrames = RETRY_FRAMES;
+            SetScale(std::max(MIN_SCALE, m_scale - SHRINK_STEP));
+            return m_scale;
+        }
+
+        float larger = std::min(MAX_SCALE, m_scale + GROW_STEP);
+        double predictedWork = m_workTime * (larger * larger) / (m_scale * m_scale);
+        bool headroom = m_frameTime <= m_budget * OVER_BUDGET && predictedWork < m_budget * GROW_HEADROOM && larger < m_ceiling + 0.001f;
+        m_headroomFrames = headroom ? m_headroomFrames + 1 : 0;
+        if (m_headroomFrames >= FRAMES_TO_GROW && m_scale < MAX_SCALE) SetScale(larger);
+        return m_scale;
+    }
+
+private:
+    double m_budget;
+    float m_scale;
+    float m_ceiling;       // Smallest scale known to run over, while m_ceilingFrames lasts
+    double m_frameTime;    // Smoothed
+    double m_workTime;     // Smoothed
+    int m_overFrames;
+    int m_headroomFrames;
+    int m_settleFrames;
+    int m_ceilingFrames;
+    bool m_hasSample;
+
+    void SetScale(float scale) {
+        m_scale = scale;
+        m_overFrames = 0;
+        m_headroomFrames = 0;
+        m_settleFrames = SETTLE_FRAMES;
+    }
+};
+
+// Draws a frame's world layers into an offscreen target at a fraction of the window size and
+// stretches that over the window, then draws the HUD layer on top at full size so text stays
+// sharp. The target is allocated once at window size and only its top-left corner is used, so
+// changing the scale costs nothing. Render thread only, after the window exists.
+class ScaledRenderer {
+public:
+    ScaledRenderer() : m_target{}, m_width(0), m_height(0) {}
+
+    void Init(int width, int height) {
+        m_width = width;
+        m_height = height;
+        m_target = LoadRenderTexture(width, height);
+        SetTextureFilter(m_target.texture, TEXTURE_FILTER_BILINEAR);
+    }
+
+    void Shutdown() {
+        if (m_target.id != 0) UnloadRenderTexture(m_target);
+        m_target = RenderTexture2D{};
+    }
+
+    // Call between BeginDrawing() and EndDrawing()
+    template <typename Backend>
+    SubmitStats Present(const DrawList& list, Backend& backend, float scale) {
+        float width = std::round(m_width * scale);
+        float height = std::round(m_height * scale);
+        BeginTextureMode(m_target);
+        Camera2D camera = { { 0, 0 }, { 0, 0 }, 0.0f, width / m_width };
+        BeginMode2D(camera);
+        list.SubmitLayers(backend, Layer::BACKGROUND, Layer::FOREGROUND);
+        EndMode2D();
+        EndTextureMode();
+
+        // Render textures are stored bottom-up, so the used corner is at the top of the texture and flipped
+        Rectangle source = { 0, (float)m_height - height, width, -height };
+        DrawTexturePro(m_target.texture, source, { 0, 0, (float)m_width, (float)m_height }, { 0, 0 }, 0.0f, WHITE);
+        list.SubmitLayers(backend, Layer::HUD, Layer::HUD);
+        return list.Stats();
+    }
+
+private:
+    RenderTexture2D m_target;
+    int m_width, m_height;
+};
+
+// Paces the render loop so input is read as late as possible. Instead of sleeping after the
+// frame is presented (what SetTargetFPS does), it sleeps before the frame starts: until the
+// deadline minus the predicted frame work, so the frame is presented right on time with the
+// freshest input. The last stretch is spun rather than slept, since sleeps overshoot.
+// Work is predicted from recent frames: a slower frame raises the prediction immediately,
+// faster ones lower it gradually.
+class FramePacer {
+public:
+    using Clock = std::chrono::steady_clock;
+    static constexpr double SPIN_SECONDS = 0.002; // Sleeps can wake this late; spin the rest
+    static constexpr double SAFETY_SECONDS = 0.001; // Slack on top of the predicted work
+    static constexpr double WORK_DECAY = 0.05; // How fast the prediction follows faster frames
+    static constexpr double MISS_TOLERANCE_SECONDS = 0.0005;
+    static constexpr int REPORT_FRAMES = 60; // Frames per latency report
+
+    struct LatencyReport {
+        double minSeconds, averageSeconds, maxSeconds;
+        double predictedWorkSeconds;
+        int frames, missedDeadlines;
+    };
+
+    explicit FramePacer(double periodSeconds)
+        : m_period(periodSeconds), m_predictedWork(0.0), m_lastLatency(0.0),
+          m_deadline(), m_frameStart(Clock::now()),
+          m_windowMin(0.0), m_windowMax(0.0), m_windowSum(0.0), m_windowFrames(0), m_windowMissed(0) {}
+
+    // Blocks until the next frame has to start. Sample input right after this returns.
+    void WaitForFrameStart() {
+        Clock::time_point wakeAt = m_deadline - ToDuration(m_predictedWork + SAFETY_SECONDS);
+        if (wakeAt - Clock::now() > ToDuration(SPIN_SECONDS)) std::this_thread::sleep_until(wakeAt - ToDuration(SPIN_SECONDS));
+        while (Clock::now() < wakeAt) {}
+        m_frameStart = Clock::now();
+    }
+
+    // Call right after EndDrawing() with the sample time of the input the frame was simulated from.
+    // Returns true when a latency report is ready.
+    bool FramePresented(Clock::time_point inputSampledAt) {
+        Clock::time_point now = Clock::now();
+        double work = ToSeconds(now - m_frameStart);
+        m_predictedWork = work > m_predictedWork ? work : m_predictedWork + (work - m_predictedWork) * WORK_DECAY;
+        m_predictedWork = std::min(m_predictedWork, m_period - SAFETY_SECONDS);
+        if (m_deadline != Clock::time_point() && now > m_deadline + ToDuration(MISS_TOLERANCE_SECONDS)) ++m_windowMissed;
+
+        m_deadline += ToDuration(m_period);
+        if (m_deadline < now + ToDuration(m_predictedWork)) m_deadline = now + ToDuration(m_period); // Too late for this slot
+
+        if (inputSampledAt == Clock::time_point()) return false; // Nothing sampled yet
+        // The swapped frame reaches the screen at the display's next refresh, about one period later
+        m_lastLatency = ToSeconds(now - inputSampledAt) + m_period;
+        m_windowMin = m_windowFrames == 0 ? m_lastLatency : std::min(m_windowMin, m_lastLatency);
+        m_windowMax = m_windowFrames == 0 ? m_lastLatency : std::max(m_windowMax, m_lastLatency);
+        m_windowSum += m_lastLatency;
+        if (++m_windowFrames < REPORT_FRAMES) return false;
+        m_report = { m_windowMin, m_windowSum / m_windowFrames, m_windowMax, m_predictedWork, m_windowFrames, m_windowMissed };
+        m_windowSum = 0.0;
+        m_windowFrames = 0;
+        m_windowMissed = 0;
+        return true;
+    }
+
+    double LastLatency() const { return m_lastLatency; } // Input-to-photon estimate of the last frame
+    double PredictedWork() const { return m_predictedWork; }
+    const LatencyReport& Report() const { return m_report; }
+
+private:
+    static Clock::duration ToDuration(double seconds) {
+        return std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(seconds));
+    }
+    static double ToSeconds(Clock::duration duration) { return std::chrono::duration<double>(duration).count(); }
+
+    double m_period;
+    double m_predictedWork;
+    double m_lastLatency;
+    Clock::time_point m_deadline; // When the frame being paced should be presented; the first one goes out right away
+    Clock::time_point m_frameStart;
+    double m_windowMin, m_windowMax, m_windowSum;
+    int m_windowFrames, m_windowMissed;
+    LatencyReport m_report = {};
+};
+
+// Lock-free triple buffer: the writer always has a slot to fill, the reader always has
+// the newest complete slot, and neither ever waits for the other.
+template <typename T>
+class TripleBuffer {
+public:
+    TripleBuffer() : m_write(0), m_shared(1), m_read(2) {}
+
+    T& WriteSlot() { return m_slots[m_write]; }
+
+    void Publish() {
+        m_write = m_shared.exchange(m_write | FRESH_BIT, std::memory_order_acq_rel) & INDEX_MASK;
+    }
+
+    // Returns the newest published slot (or the last one read if nothing new arrived)
+    const T& Read() {
+        if (m_shared.load(std::memory_order_acquire) & FRESH_BIT) {
+            m_read = m_shared.exchange(m_read, std::memory_order_acq_rel) & INDEX_MASK;
+        }
+        return m_slots[m_read];
+    }
+
+private:
+    static const int FRESH_BIT = 4;
+    static const int INDEX_MASK = 3;
+
+    T m_slots[3];
+    int m_write;
+    std::atomic<int> m_shared;
+    int m_read;
+};
+
+// One simulated frame, ready to be rendered
+struct RenderSnapshot {
+    DrawList drawList;
+    uint64_t simFrame = 0;
+    std::chrono::steady_clock::time_point inputSampledAt; // When the input this frame was simulated with was read
+};
+
+// Work that must happen on the thread that owns the GL context (texture uploads and such).
+// Jobs return true when they are finished; unfinished jobs get more time next frame.
+class RenderJobQueue {
+public:
+    using Job = std::function<bool(double budgetSeconds)>;
+
+    void SetRenderThread() { m_renderThread = std::this_thread::get_id(); }
+    bool OnRenderThread() const { return std::this_thread::get_id() == m_renderThread; }
+
+    void Post(Job job) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_jobs.push_back(std::move(job));
+    }
+
+    // Runs queued jobs until they are done or the time budget is spent. Render thread only.
+    void Run(double budgetSeconds) {
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::duration<double>(budgetSeconds);
+        while (true) {
+            Job job;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if (m_jobs.empty()) return;
+                job = std::move(m_jobs.front());
+                m_jobs.erase(m_jobs.begin());
+            }
+            double remaining = std::chrono::duration<double>(deadline - std::chrono::steady_clock::now()).count();
+            if (!job(std::max(0.0, remaining))) {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_jobs.insert(m_jobs.begin(), std::move(job)); // Not finished, continue next frame
+                return;
+            }
+            if (std::chrono::steady_clock::now() >= deadline) return;
+        }
+    }
+
+    // Blocks until 'flag' is set. On the render thread the queue is drained while waiting,
+    // otherwise whoever calls Run() is expected to get to it.
+    void WaitFor(const std::atomic<bool>& flag) {
+        while (!flag.load(std::memory_order_acquire)) {
+            if (OnRenderThread()) Run(1.0);
+            else std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+
+    // Runs 'job' to completion on the render thread and waits for it
+    void RunAndWait(const Job& job) {
+        if (OnRenderThread()) {
+            while (!job(1.0)) {}
+            return;
+        }
+        auto done = std::make_shared<std::atomic<bool>>(false);
+        Post([job, done](double budget) {
+            if (!job(budget)) return false;
+            done->store(true, std::memory_order_release);
+            return true;
+        });
+        WaitFor(*done);
+    }
+
+private:
+    std::mutex m_mutex;
+    std::vector<Job> m_jobs;
+    std::thread::id m_renderThread;
+};
+
+} // namespace gfx
+
+
+namespace jobs {
+
+// Fixed set of worker threads with one task deque each. A worker takes the newest task
+// from its own deque and, when that runs dry, steals the oldest from another worker's,
+// so uneven tasks (a session that lasts ten times longer than the rest) don't leave
+// cores idle. The deques are mutex-guarded; tasks are coarse enough that this never shows.
+class WorkStealingPool {
+public:
+    using Task = std::function<void()>;
+
+    explicit WorkStealingPool(unsigned threadCount)
+        : m_queued(0), m_pending(0), m_next(0), m_stopping(false) {
+        threadCount = std::max(1u, threadCount);
+        for (unsigned i = 0; i < threadCount; ++i) m_queues.push_back(std::make_unique<Queue>());
+        for (unsigned i = 0; i < threadCount; ++i) m_threads.emplace_back([this, i]() { WorkerLoop(i); });
+    }
+
+    ~WorkStealingPool() {
+        {
+            std::lock_guard<std::mutex> lock(m_sleepMutex);
+            m_stopping = true;
+        }
+        m_wake.notify_all();
+        for (std::thread& thread : m_threads) thread.join();
+    }
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    unsigned ThreadCount() const { return (unsigned)m_threads.size(); }
+
+    // Hands the task to the workers round-robin; idle ones will steal it if its owner is busy
+    void Submit(Task task) {
+        Queue& queue = *m_queues[m_next.fetch_add(1, std::memory_order_relaxed) % m_queues.size()];
+        m_pending.fetch_add(1, std::memory_order_relaxed);
+        {
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            queue.tasks.push_back(std::move(task));
+        }
+        {
+            std::lock_guard<std::mutex> lock(m_sleepMutex);
+            ++m_queued;
+        }
+        m_wake.notify_one();
+    }
+
+    // Blocks until every submitted task has finished
+    void WaitIdle() {
+        std::unique_lock<std::mutex> lock(m_sleepMutex);
+        m_idle.wait(lock, [this]() { return m_pending.load(std::memory_order_acquire) == 0; });
+    }
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    std::vector<std::unique_ptr<Queue>> m_queues;
+    std::vector<std::thread> m_threads;
+    std::mutex m_sleepMutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_idle;
+    size_t m_queued; // Tasks sitting in a deque; guarded by m_sleepMutex
+    std::atomic<size_t> m_pending; // Submitted and not finished yet
+    std::atomic<unsigned> m_next;
+    bool m_stopping;
+
+    bool TryTake(unsigned self, Task& task) {
+        {
+            Queue& own = *m_queues[self];
+            std::lock_guard<std::mutex> lock(own.mutex);
+            if (!own.tasks.empty()) {
+                task = std::move(own.tasks.back());
+                own.tasks.pop_back();
+                return true;
+            }
+        }
+        for (size_t offset = 1; offset < m_queues.size(); ++offset) {
+            Queue& victim = *m_queues[(self + offset) % m_queues.size()];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.tasks.empty()) {
+                task = std::move(victim.tasks.front());
+                victim.tasks.pop_front();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void WorkerLoop(unsigned self) {
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(m_sleepMutex);
+                m_wake.wait(lock, [this]() { return m_queued > 0 || m_stopping; });
+                if (m_queued == 0) return; // Stopping and nothing left
+            }
+            Task task;
+            if (!TryTake(self, task)) continue; // Someone else got there first
+            {
+                std::lock_guard<std::mutex> lock(m_sleepMutex);
+                --m_queued;
+            }
+            task();
+            if (m_pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                std::lock_guard<std::mutex> lock(m_sleepMutex);
+                m_idle.notify_all();
+            }
+        }
+    }
+};
+
+// Ring buffer between exactly one producer thread and one consumer thread. Push() and Pop()
+// never block, lock or allocate; Push() fails when the ring is full. Each side's index lives
+// on its own cache line, so the two threads don't fight over it.
+template <typename T, size_t CAPACITY>
+class SpscQueue {
+public:
+    static_assert((CAPACITY & (CAPACITY - 1)) == 0, "Capacity must be a power of two");
+
+    SpscQueue() : m_head(0), m_tailSeen(0), m_tail(0), m_headSeen(0) {}
+
+    bool Push(const T& item) { // Producer only
+        size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail - m_headSeen == CAPACITY) {
+            m_headSeen = m_head.load(std::memory_order_acquire); // Only look at the consumer's line when we seem full
+            if (tail - m_headSeen == CAPACITY) return false;
+        }
+        m_items[tail & (CAPACITY - 1)] = item;
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool Pop(T& item) { // Consumer only
+        size_t head = m_head.load(std::memory_order_relaxed);
+        if (head == m_tailSeen) {
+            m_tailSeen = m_tail.load(std::memory_order_acquire);
+            if (head == m_tailSeen) return false;
+        }
+        item = m_items[head & (CAPACITY - 1)];
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Pushes as many of 'items' as fit, in order, and publishes them with one store. Returns how
+    // many went in. Producer only.
+    size_t PushMany(const T* items, size_t count) {
+        size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (CAPACITY - (tail - m_headSeen) < count) m_headSeen = m_head.load(std::memory_order_acquire);
+        size_t pushed = std::min(count, CAPACITY - (tail - m_headSeen));
+        for (size_t i = 0; i < pushed; ++i) m_items[(tail + i) & (CAPACITY - 1)] = items[i];
+        m_tail.store(tail + pushed, std::memory_order_release);
+        return pushed;
+    }
+
+    bool Empty() const { return m_head.load(std::memory_order_acquire) == m_tail.load(std::memory_order_acquire); }
+
+private:
+    alignas(64) std::atomic<size_t> m_head; // Next item to pop
+    size_t m_tailSeen;                      // Consumer's last look at m_tail
+    alignas(64) std::atomic<size_t> m_tail; // Next slot to push into
+    size_t m_headSeen;                      // Producer's last look at m_head
+    alignas(64) T m_items[CAPACITY];
+};
+
+} // namespace jobs
+
+// Gameplay events for offline analysis. Emit() only copies a small record into a lock-free
+// ring, so it can stay on in release builds and be called from inside level systems; a writer
+// thread drains the ring into rotating binary files. Only the thread that called Attach()
+// records anything; on any other thread Emit() returns straight away.
+namespace telemetry {
+
+enum class EventType : uint8_t {
+    LEVEL_START = 1,
+    LEVEL_END,        // value: 1 won, 0 lost
+    COIN_COLLECTED,   // value: coin value
+    INVADER_KILLED,   // value: score after the kill
+    PLAYER_HIT,       // value: lives or health left
+    PIPE_PASSED,      // value: score after passing
+};
+
+const uint8_t NO_LEVEL = 0xFF;
+
+// One event, written to disk as it is
+struct Event {
+    uint32_t sequence; // Counts every event of the session, so gaps show where events were dropped
+    uint32_t step;     // Simulation step it happened in
+    EventType type;
+    uint8_t level;     // LevelTypeId, or NO_LEVEL
+    uint16_t reserved;
+    int32_t value;
+    float x, y;        // Where it happened, in screen pixels
+};
+static_assert(sizeof(Event) == 24, "Events are written byte for byte and must not have padding");
+
+class Recorder;
+
+// What the producing thread needs for every event, kept together in one thread_local. Events
+// collect in 'batch', which stays in this core's cache, and go to the shared ring once a step.
+struct Producer {
+    static const uint32_t BATCH_EVENTS = 64;
+
+    Recorder* recorder = nullptr;
+    uint32_t sequence = 0; // Of batch[0]
+    uint32_t pending = 0;  // Events in batch
+    uint32_t step = 0;
+    uint8_t level = NO_LEVEL;
+    Event batch[BATCH_EVENTS] = {};
+};
+thread_local Producer t_producer;
+
+class Recorder {
+public:
+    static const size_t RING_EVENTS = 8192;
+    static const size_t MAX_FILE_BYTES = 4 * 1024 * 1024;
+    static const int MAX_FILES = 8; // Per session; the oldest is deleted when a new one starts
+    static const int MAX_KEPT_FILES = 24; // Across sessions, this one's included: at most 96 MB on disk
+    static const uint32_t MAGIC = 0x4D4C5442; // "BTLM"
+    static const uint32_t VERSION = 1;
+
+    Recorder() : m_dropped(0), m_running(false), m_stop(false), m_file(nullptr), m_fileIndex(0), m_fileBytes(0), m_written(0) {}
+    ~Recorder() { Stop(); }
+
+    // Starts the writer. Files are named <prefix>-<start time>-<n>.bin.
+    bool Start(const char* prefix) {
+        Stop();
+        m_prefix = prefix;
+        m_session = (int64_t)std::time(nullptr);
+        m_fileIndex = 0;
+        m_written = 0;
+        PruneOldSessions();
+        if (!OpenFile()) {
+            std::cerr << "Telemetry: couldn't create " << FileName(0) << "; events won't be recorded" << std::endl;
+            return false;
+        }
+        m_stop.store(false, std::memory_order_relaxed);
+        m_writer = std::thread(&Recorder::WriterLoop, this);
+        m_running = true;
+        return true;
+    }
+
+    // Writes whatever is still in the ring and stops the writer. Producers must have detached.
+    void Stop() {
+        if (!m_running) return;
+        m_stop.store(true, std::memory_order_release);
+        m_writer.join();
+        if (m_file) std::fclose(m_file);
+        m_file = nullptr;
+        m_running = false;
+        std::cout << "Telemetry: " << m_written << " events in " << m_fileIndex + 1 << " files, "
+                  << m_dropped.load(std::memory_order_relaxed) << " dropped" << std::endl;
+    }
+
+    // Makes the calling thread this recorder's one producer
+    void Attach() {
+        if (!m_running) return;
+        t_producer.recorder = this;
+    }
+    static void Detach() {
+        Flush();
+        t_producer.recorder = nullptr;
+    }
+
+    // Hands the calling thread's batched events to its recorder. Whatever doesn't fit because the
+    // writer has fallen a whole ring behind is counted as dropped.
+    static void Flush() {
+        Producer& producer = t_producer;
+        if (producer.pending == 0) return;
+        if (Recorder* recorder = producer.recorder) {
+            size_t dropped = producer.pending - recorder->m_ring.PushMany(producer.batch, producer.pending);
+            if (dropped != 0) recorder->m_dropped.store(recorder->m_dropped.load(std::memory_order_relaxed) + dropped, std::memory_order_relaxed);
+        }
+        producer.sequence += producer.pending;
+        producer.pending = 0;
+    }
+
+    bool Running() const { return m_running; }
+    uint64_t Dropped() const { return m_dropped.load(std::memory_order_relaxed); }
+    int FileCount() const { return m_fileIndex + 1; } // This session's, once stopped
+
+    std::string FileName(int index) const {
+        char suffix[48];
+        std::snprintf(suffix, sizeof(suffix), "-%lld-%d.bin", (long long)m_session, index);
+        return m_prefix + suffix;
+    }
+
+private:
+    jobs::SpscQueue<Event, RING_EVENTS> m_ring;
+    std::atomic<uint64_t> m_dropped; // Written by the producer only
+    bool m_running;
+    std::atomic<bool> m_stop;
+
+    // Writer thread only while it runs
+    std::thread m_writer;
+    std::string m_prefix;
+    int64_t m_session;
+    FILE* m_file;
+    int m_fileIndex;
+    size_t m_fileBytes;
+    uint64_t m_written;
+    Event m_batch[256];
+
+    // Deletes the oldest files earlier sessions left under our prefix, so that together with the
+    // MAX_FILES this session may write there are at most MAX_KEPT_FILES. A kiosk that restarts
+    // every night would otherwise fill its disk.
+    void PruneOldSessions() const {
+#ifdef __linux__
+        size_t slash = m_prefix.rfind('/');
+        std::string directory = slash == std::string::npos ? "." : m_prefix.substr(0, slash + 1);
+        std::string stem = (slash == std::string::npos ? m_prefix : m_prefix.substr(slash + 1)) + "-";
+        DIR* listing = opendir(directory.c_str());
+        if (!listing) return;
+        std::vector<std::tuple<long long, int, std::string>> found; // Session, file number, name
+        while (dirent* entry = readdir(listing)) {
+            const char* name = entry->d_name;
+            if (std::strncmp(name, stem.c_str(), stem.size()) != 0) continue;
+            long long session = 0;
+            int index = 0, length = 0;
+            if (std::sscanf(name + stem.size(), "%lld-%d.bin%n", &session, &index, &length) != 2 ||
+                name[stem.size() + length] != '\0') continue; // Not one of ours
+            found.emplace_back(session, index, name);
+        }
+        closedir(listing);
+        if (found.size() <= (size_t)(MAX_KEPT_FILES - MAX_FILES)) return;
+        std::sort(found.begin(), found.end());
+        size_t excess = found.size() - (MAX_KEPT_FILES - MAX_FILES);
+        for (size_t i = 0; i < excess; ++i) {
+            std::string path = slash == std::string::npos ? std::get<2>(found[i]) : directory + std::get<2>(found[i]);
+            std::remove(path.c_str());
+        }
+#endif
+    }
+
+    bool OpenFile() {
+        m_file = std::fopen(FileName(m_fileIndex).c_str(), "wb");
+        if (!m_file) return false;
+        if (m_fileIndex >= MAX_FILES) std::remove(FileName(m_fileIndex - MAX_FILES).c_str());
+        state::Writer header;
+        header.Write((uint32_t)MAGIC);
+        header.Write((uint32_t)VERSION);
+        header.Write((uint32_t)sizeof(Event));
+        header.Write((uint32_t)m_fileIndex);
+        header.Write(m_session);
+        m_fileBytes = std::fwrite(header.Data(), 1, header.Size(), m_file);
+        return m_fileBytes == header.Size();
+    }
+
+    void WriterLoop() {
+        for (;;) {
+            bool stopping = m_stop.load(std::memory_order_acquire); // Producers are done by then, so one more drain gets everything
+            size_t count = 0;
+            while (count < sizeof(m_batch) / sizeof(m_batch[0]) && m_ring.Pop(m_batch[count])) ++count;
+            if (count != 0 && m_file) {
+                if (m_fileBytes >= MAX_FILE_BYTES) {
+                    std::fclose(m_file);
+                    ++m_fileIndex;
+                    if (!OpenFile()) std::cerr << "Telemetry: couldn't create " << FileName(m_fileIndex) << std::endl;
+                }
+                if (m_file) {
+                    m_fileBytes += std::fwrite(m_batch, sizeof(Event), count, m_file) * sizeof(Event);
+                    m_written += count;
+                }
+            }
+            if (count == sizeof(m_batch) / sizeof(m_batch[0])) continue; // More waiting
+            if (m_file) std::fflush(m_file);
+            if (stopping) return;
+            std::this_thread::sleep_for(std::chrono::milliseconds(WRITER_POLL_MS));
+        }
+    }
+
+    static constexpr int WRITER_POLL_MS = 10;
+};
+
+// Records an event on the attached thread. It reaches the writer at the next step.
+inline void Emit(EventType type, int32_t value = 0, float x = 0.0f, float y = 0.0f) {
+    Producer& producer = t_producer;
+    if (!producer.recorder) return;
+    if (producer.pending == Producer::BATCH_EVENTS) Recorder::Flush();
+    uint32_t slot = producer.pending++;
+    Event& event = producer.batch[slot];
+    event.sequence = producer.sequence + slot;
+    event.step = producer.step;
+    event.type = type;
+    event.level = producer.level;
+    event.reserved = 0;
+    event.value = value;
+    event.x = x;
+    event.y = y;
+}
+
+// Stamps later events on this thread with the next simulation step, or with the level being played.
+// Stepping also hands the last step's events to the writer.
+inline void NextStep() {
+    Recorder::Flush();
+    ++t_producer.step;
+}
+inline void SetLevel(uint8_t level) { t_producer.level = level; }
+
+} // namespace telemetry
+
+// Sound effects. Levels call Play() from Update(); that only copies a small command into a
+// lock-free queue, so it never waits. A mixer thread takes the commands, mixes the playing
+// voices with SIMD and feeds the sound device. The effects are synthesized when a level loads
+// rather than decoded from files. Like telemetry, only the thread that called Attach() makes
+// sound: levels simulated anywhere else (batch runs, bots planning, versus) stay silent.
+namespace audio {
+
+const int SAMPLE_RATE = 44100;
+const int BLOCK_FRAMES = 512;    // Stereo frames per mixed block, about 12 ms
+const int MAX_VOICES = 32;       // Playing at once; a new sound replaces the one closest to its end
+const float MASTER_GAIN = 0.5f;  // Headroom for a few loud voices at once
+
+enum class Effect : uint8_t {
+    SHOT,
+    HIT,
+    FLAP,
+    COIN,
+    JUMP,
+    COUNT
+};
+
+// How an effect is synthesized: a waveform whose pitch (or, for noise, filter cutoff) moves
+// from startHz to endHz, under a short attack and a falling envelope
+enum class Wave : uint8_t { SQUARE, SINE, NOISE };
+
+struct Recipe {
+    Wave wave;
+    float seconds;
+    float startHz, endHz;
+    float volume;
+    bool stepped; // Jumps to endHz a third of the way in instead of sliding: two notes
+};
+
+const Recipe RECIPES[(size_t)Effect::COUNT] = {
+    { Wave::SQUARE, 0.15f, 1200.0f, 200.0f, 0.30f, false }, // SHOT: falling zap
+    { Wave::NOISE, 0.25f, 2500.0f, 300.0f, 0.90f, false },  // HIT: thud of darkening noise
+    { Wave::SINE, 0.09f, 220.0f, 520.0f, 0.80f, false },    // FLAP: quick rising whoosh
+    { Wave::SQUARE, 0.18f, 988.0f, 1319.0f, 0.25f, true },  // COIN: B5 then E6
+    { Wave::SQUARE, 0.20f, 260.0f, 720.0f, 0.25f, false },  // JUMP: rising boing
+};
+
+// Renders an effect as mono samples in [-1, 1]
+inline void Synthesize(Effect effect, std::vector<float>& out) {
+    const Recipe& recipe = RECIPES[(size_t)effect];
+    const int count = (int)(recipe.seconds * SAMPLE_RATE);
+    const float attack = 0.003f * SAMPLE_RATE;
+    rng::Stream noise((uint64_t)effect + 1);
+    out.resize((size_t)count);
+    float phase = 0.0f, filtered = 0.0f;
+    for (int i = 0; i < count; ++i) {
+        float t = (float)i / count;
+        float hz = recipe.stepped ? (t < 1.0f / 3.0f ? recipe.startHz : recipe.endHz) : recipe.startHz + (recipe.endHz - recipe.startHz) * t;
+        float sample;
+        switch (recipe.wave) {
+            case Wave::SQUARE: sample = phase < 0.5f ? 1.0f : -1.0f; break;
+            case Wave::SINE: sample = std::sin(phase * 2.0f * PI); break;
+            default: { // One-pole low-pass over white noise, cutoff at 'hz'
+                float coefficient = 1.0f - std::exp(-2.0f * PI * hz / SAMPLE_RATE);
+                filtered += coefficient * (noise.NextFloat() * 2.0f - 1.0f - filtered);
+                sample = filtered * 2.0f;
+            } break;
+        }
+        phase += hz / SAMPLE_RATE;
+        phase -= std::floor(phase);
+        float envelope = std::min(1.0f, i / attack) * (1.0f - t) * (1.0f - t);
+        out[(size_t)i] = std::max(-1.0f, std::min(1.0f, sample * envelope * recipe.volume));
+    }
+}
+
+// The synthesized effects, shared by every level and never freed (a few hundred KB at most).
+// Prepare() may run on any thread, loading threads included; the mixer reads without locking.
+class EffectBank {
+public:
+    EffectBank() {
+        for (std::atomic<bool>& ready : m_ready) ready.store(false, std::memory_order_relaxed);
+    }
+
+    // Synthesizes 'effect' unless that was done already. Call from Load().
+    void Prepare(Effect effect) {
+        if (m_ready[(size_t)effect].load(std::memory_order_acquire)) return;
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_ready[(size_t)effect].load(std::memory_order_relaxed)) return;
+        Synthesize(effect, m_samples[(size_t)effect]);
+        m_ready[(size_t)effect].store(true, std::memory_order_release);
+    }
+
+    void Prepare(std::initializer_list<Effect> effects) {
+        for (Effect effect : effects) Prepare(effect);
+    }
+
+    // The samples of a prepared effect, or nullptr
+    const std::vector<float>* Samples(Effect effect) const {
+        return m_ready[(size_t)effect].load(std::memory_order_acquire) ? &m_samples[(size_t)effect] : nullptr;
+    }
+
+private:
+    std::mutex m_mutex;
+    std::vector<float> m_samples[(size_t)Effect::COUNT];
+    std::atomic<bool> m_ready[(size_t)Effect::COUNT];
+};
+
+EffectBank g_effects;
+
+// Where mixed blocks go. WantsBlock() says when the device has room for the next one.
+class Sink {
+public:
+    virtual ~Sink() = default;
+    virtual bool WantsBlock() = 0;
+    virtual void Submit(const int16_t* interleaved, int frames) = 0;
+};
+
+// raylib's audio stream. Open() and Close() on the thread that initialized the device; the
+// mixer thread calls the rest.
+class RaylibSink : public Sink {
+public:
+    RaylibSink() : m_open(false) { std::memset(&m_stream, 0, sizeof(m_stream)); }
+
+    bool Open() {
+        if (!IsAudioDeviceReady()) return false;
+        SetAudioStreamBufferSizeDefault(BLOCK_FRAMES);
+        m_stream = LoadAudioStream(SAMPLE_RATE, 16, 2);
+        m_open = m_stream.buffer != nullptr;
+        if (m_open) PlayAudioStream(m_stream);
+        return m_open;
+    }
+
+    void Close() {
+        if (!m_open) return;
+        StopAudioStream(m_stream);
+        UnloadAudioStream(m_stream);
+        m_open = false;
+    }
+
+    bool WantsBlock() override { return IsAudioStreamProcessed(m_stream); }
+    void Submit(const int16_t* interleaved, int frames) override { UpdateAudioStream(m_stream, interleaved, frames); }
+
+private:
+    AudioStream m_stream;
+    bool m_open;
+};
+
+// A device that plays nothing. Takes blocks at the rate a real device would, either in real time
+// or as fast as Advance() moves its clock along, so a simulation running faster than real time
+// still hears its sounds spaced as they would be. Keeps enough statistics to tell silence,
+// clipping and garbage apart.
+class NullSink : public Sink {
+public:
+    enum class Clock { REAL_TIME, ADVANCED };
+
+    explicit NullSink(Clock clock) : m_clock(clock), m_advanced(0), m_frames(0), m_blocks(0), m_audibleBlocks(0), m_peak(0), m_clipped(0) {
+        m_start = std::chrono::steady_clock::now();
+    }
+
+    bool WantsBlock() override {
+        uint64_t played = m_advanced.load(std::memory_order_acquire);
+        if (m_clock == Clock::REAL_TIME) {
+            played = (uint64_t)(std::chrono::duration<double>(std::chrono::steady_clock::now() - m_start).count() * SAMPLE_RATE);
+        }
+        return m_frames.load(std::memory_order_relaxed) < played + 2 * BLOCK_FRAMES; // Two blocks queued, as raylib does
+    }
+
+    // ADVANCED clock only: lets 'frames' more play
+    void Advance(uint64_t frames) { m_advanced.fetch_add(frames, std::memory_order_release); }
+
+    void Submit(const int16_t* interleaved, int frames) override {
+        int peak = 0;
+        uint64_t clipped = 0;
+        for (int i = 0; i < frames * 2; ++i) {
+            int magnitude = std::abs((int)interleaved[i]);
+            peak = std::max(peak, magnitude);
+            if (magnitude >= 32767) ++clipped;
+        }
+        if (peak > 0) m_audibleBlocks.fetch_add(1, std::memory_order_relaxed);
+        if (peak > m_peak.load(std::memory_order_relaxed)) m_peak.store(peak, std::memory_order_relaxed);
+        m_clipped.fetch_add(clipped, std::memory_order_relaxed);
+        m_blocks.fetch_add(1, std::memory_order_relaxed);
+        m_frames.fetch_add((uint64_t)frames, std::memory_order_release);
+    }
+
+    uint64_t Frames() const { return m_frames.load(std::memory_order_acquire); }
+    uint64_t Advanced() const { return m_advanced.load(std::memory_order_relaxed); }
+    uint64_t Blocks() const { return m_blocks.load(std::memory_order_relaxed); }
+    uint64_t AudibleBlocks() const { return m_audibleBlocks.load(std::memory_order_relaxed); }
+    int Peak() const { return m_peak.load(std::memory_order_relaxed); }
+    uint64_t ClippedSamples() const { return m_clipped.load(std::memory_order_relaxed); }
+
+private:
+    Clock m_clock;
+    std::chrono::steady_clock::time_point m_start;
+    std::atomic<uint64_t> m_advanced;
+    std::atomic<uint64_t> m_frames;
+    std::atomic<uint64_t> m_blocks;
+    std::atomic<uint64_t> m_audibleBlocks;
+    std::atomic<int> m_peak;
+    std::atomic<uint64_t> m_clipped;
+};
+
+// What Play() sends the mixer
+struct PlayCommand {
+    Effect effect;
+    float volume;
+    float pan; // -1 left to 1 right
+};
+
+class Mixer;
+thread_local Mixer* t_mixer = nullptr;
+
+class Mixer {
+public:
+    static const size_t QUEUE_COMMANDS = 256;
+
+    Mixer() : m_posted(0), m_dropped(0), m_running(false), m_stop(false), m_started(0), m_stolen(0), m_blocks(0), m_peakVoices(0) {
+        for (Voice& voice : m_voices) voice.samples = nullptr;
+    }
+    ~Mixer() { Stop(); }
+
+    // Starts the mixer thread feeding 'sink', which must outlive it
+    void Start(Sink& sink) {
+        Stop();
+        m_stop.store(false, std::memory_order_relaxed);
+        m_thread = std::thread(&Mixer::MixerLoop, this, &sink);
+        m_running = true;
+    }
+
+    // Stops the mixer thread. Producers must have detached.
+    void Stop() {
+        if (!m_running) return;
+        m_stop.store(true, std::memory_order_release);
+        m_thread.join();
+        m_running = false;
+    }
+
+    bool Running() const { return m_running; }
+
+    // Makes the calling thread this mixer's one producer
+    void Attach() {
+        if (!m_running) return;
+        t_mixer = this;
+    }
+    static void Detach() { t_mixer = nullptr; }
+
+    // Producer only. A command that doesn't fit in the queue is counted and dropped.
+    void Post(const PlayCommand& command) {
+        m_posted.store(m_posted.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        if (!m_queue.Push(command)) m_dropped.store(m_dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    // Starts the queued sounds and mixes the next block of every playing voice into
+    // 'interleaved' (BLOCK_FRAMES stereo frames). Mixer thread only, or a mixer that isn't running.
+    void MixBlock(int16_t* interleaved) {
+        PlayCommand command;
+        while (m_queue.Pop(command)) StartVoice(command);
+        std::fill(std::begin(m_left), std::end(m_left), 0.0f);
+        std::fill(std::begin(m_right), std::end(m_right), 0.0f);
+        int playing = 0;
+        for (Voice& voice : m_voices) {
+            if (!voice.samples) continue;
+            ++playing;
+            uint32_t frames = std::min((uint32_t)BLOCK_FRAMES, voice.length - voice.position);
+            MixVoice(voice.samples + voice.position, frames, voice.gainLeft, voice.gainRight, m_left, m_right);
+            voice.position += frames;
+            if (voice.position == voice.length) voice.samples = nullptr;
+        }
+        m_peakVoices = std::max(m_peakVoices, playing);
+        ToInterleaved(m_left, m_right, interleaved);
+        ++m_blocks;
+    }
+
+    uint64_t Posted() const { return m_posted.load(std::memory_order_relaxed); }
+    uint64_t Dropped() const { return m_dropped.load(std::memory_order_relaxed); } // Queue was full
+    // The rest are the mixer thread's; read them once it has stopped
+    uint64_t VoicesStarted() const { return m_started; }
+    uint64_t VoicesStolen() const { return m_stolen; }
+    uint64_t BlocksMixed() const { return m_blocks; }
+    int PeakVoices() const { return m_peakVoices; }
+
+    // Adds 'frames' mono samples into both channels at the given gains. SSE when the compiler
+    // targets it (every x86-64 build does); the scalar loop finishes the last few samples.
+    static void MixVoice(const float* samples, uint32_t frames, float gainLeft, float gainRight, float* left, float* right) {
+        uint32_t i = 0;
+#ifdef __SSE2__
+        const __m128 gainL = _mm_set1_ps(gainLeft), gainR = _mm_set1_ps(gainRight);
+        for (; i + 4 <= frames; i += 4) {
+            __m128 sample = _mm_loadu_ps(samples + i);
+            _mm_store_ps(left + i, _mm_add_ps(_mm_load_ps(left + i), _mm_mul_ps(sample, gainL)));
+            _mm_store_ps(right + i, _mm_add_ps(_mm_load_ps(right + i), _mm_mul_ps(sample, gainR)));
+        }
+#endif
+        for (; i < frames; ++i) {
+            left[i] += samples[i] * gainLeft;
+            right[i] += samples[i] * gainRight;
+        }
+    }
+
+    // Clamps to [-1, 1] and converts to interleaved 16-bit stereo
+    static void ToInterleaved(const float* left, const float* right, int16_t* interleaved) {
+#ifdef __SSE2__
+        static_assert(BLOCK_FRAMES % 4 == 0, "blocks are converted four frames at a time");
+        const __m128 lo = _mm_set1_ps(-1.0f), hi = _mm_set1_ps(1.0f), scale = _mm_set1_ps(32767.0f);
+        for (int i = 0; i < BLOCK_FRAMES; i += 4) {
+            __m128i l = _mm_cvtps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(_mm_load_ps(left + i), lo), hi), scale));
+            __m128i r = _mm_cvtps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(_mm_load_ps(right + i), lo), hi), scale));
+            __m128i packed = _mm_packs_epi32(_mm_unpacklo_epi32(l, r), _mm_unpackhi_epi32(l, r)); // L0 R0 L1 R1 L2 R2 L3 R3
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(interleaved + i * 2), packed);
+        }
+#else
+        for (int i = 0; i < BLOCK_FRAMES; ++i) {
+            interleaved[i * 2] = (int16_t)std::lrint(std::max(-1.0f, std::min(1.0f, left[i])) * 32767.0f);
+            interleaved[i * 2 + 1] = (int16_t)std::lrint(std::max(-1.0f, std::min(1.0f, right[i])) * 32767.0f);
+        }
+#endif
+    }
+
+private:
+    struct Voice {
+        const float* samples; // nullptr when the voice is free
+        uint32_t length;
+        uint32_t position;
+        float gainLeft, gainRight;
+    };
+
+    jobs::SpscQueue<PlayCommand, QUEUE_COMMANDS> m_queue;
+    std::atomic<uint64_t> m_posted;  // Written by the producer only
+    std::atomic<uint64_t> m_dropped; // Written by the producer only
+    bool m_running;
+    std::atomic<bool> m_stop;
+    std::thread m_thread;
+
+    // Mixer thread only while it runs
+    Voice m_voices[MAX_VOICES];
+    alignas(16) float m_left[BLOCK_FRAMES];
+    alignas(16) float m_right[BLOCK_FRAMES];
+    alignas(16) int16_t m_block[BLOCK_FRAMES * 2];
+    uint64_t m_started;
+    uint64_t m_stolen;
+    uint64_t m_blocks;
+    int m_peakVoices;
+
+    void StartVoice(const PlayCommand& command) {
+        const std::vector<float>* samples = g_effects.Samples(command.effect);
+        if (!samples || samples->empty()) return; // Not prepared by any Load()
+        Voice* target = nullptr;
+        for (Voice& voice : m_voices) {
+            if (!voice.samples) {
+                target = &voice;
+                break;
+            }
+            if (!target || voice.length - voice.position < target->length - target->position) target = &voice;
+        }
+        if (target->samples) ++m_stolen;
+        float pan = std::max(-1.0f, std::min(1.0f, command.pan));
+        float angle = (pan + 1.0f) * PI / 4.0f; // Constant power: the same loudness anywhere across
+        float gain = std::max(0.0f, command.volume) * MASTER_GAIN;
+        target->samples = samples->data();
+        target->length = (uint32_t)samples->size();
+        target->position = 0;
+        target->gainLeft = gain * std::cos(angle);
+        target->gainRight = gain * std::sin(angle);
+        ++m_started;
+    }
+
+    void MixerLoop(Sink* sink) {
+        while (!m_stop.load(std::memory_order_acquire)) {
+            bool mixed = false;
+            while (sink->WantsBlock() && !m_stop.load(std::memory_order_relaxed)) {
+                MixBlock(m_block);
+                sink->Submit(m_block, BLOCK_FRAMES);
+                mixed = true;
+            }
+            if (!mixed) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+};
+
+// Plays an effect on the attached thread's mixer; nothing anywhere else
+inline void Play(Effect effect, float volume = 1.0f, float pan = 0.0f) {
+    Mixer* mixer = t_mixer;
+    if (!mixer) return;
+    mixer->Post({ effect, volume, pan });
+}
+
+// Pan for something at 'x' on a screen 'width' wide
+inline float PanAt(float x, int width) { return width > 0 ? x / width * 2.0f - 1.0f : 0.0f; }
+
+} // namespace audio
+
+// Networking between processes on the same machine. Two players exchange only inputs, over
+// UDP on the loopback interface, and both sides simulate everything. Spectators get a TCP
+// stream of what is drawn.
+namespace net {
+
+class LoopbackSocket {
+public:
+    LoopbackSocket() : m_fd(-1), m_peerPort(0) {}
+    ~LoopbackSocket() { Close(); }
+    LoopbackSocket(const LoopbackSocket&) = delete;
+    LoopbackSocket& operator=(const LoopbackSocket&) = delete;
+
+    // Binds 127.0.0.1:'port' (0 picks a free one) without blocking reads
+    bool Open(uint16_t port) {
+        Close();
+#ifdef __linux__
+        m_fd = socket(AF_INET, SOCK_DGRAM, 0);
+        if (m_fd < 0) return false;
+        sockaddr_in address = Loopback(port);
+        if (bind(m_fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || fcntl(m_fd, F_SETFL, O_NONBLOCK) != 0) {
+            Close();
+            return false;
+        }
+        return true;
+#else
+        (void)port;
+        return false; // Only written for Linux so far
+#endif
+    }
+
+    uint16_t Port() const {
+#ifdef __linux__
+        sockaddr_in address;
+        socklen_t size = sizeof(address);
+        if (m_fd < 0 || getsockname(m_fd, reinterpret_cast<sockaddr*>(&address), &size) != 0) return 0;
+        return ntohs(address.sin_port);
+#else
+        return 0;
+#endif
+    }
+
+    void SetPeer(uint16_t port) { m_peerPort = port; }
+    uint16_t Peer() const { return m_peerPort; }
+
+    bool Send(const void* data, size_t size) {
+#ifdef __linux__
+        sockaddr_in address = Loopback(m_peerPort);
+        return m_fd >= 0 && sendto(m_fd, data, size, 0, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == (ssize_t)size;
+#else
+        (void)data; (void)size;
+        return false;
+#endif
+    }
+
+    // Size of the next datagram from the peer, or 0 once there are none. Anything from
+    // another port is skipped.
+    size_t Receive(void* buffer, size_t capacity) {
+#ifdef __linux__
+        while (m_fd >= 0) {
+            sockaddr_in from;
+            socklen_t fromSize = sizeof(from);
+            ssize_t got = recvfrom(m_fd, buffer, capacity, 0, reinterpret_cast<sockaddr*>(&from), &fromSize);
+            if (got < 0) return 0;
+            if (ntohs(from.sin_port) == m_peerPort && got > 0) return (size_t)got;
+        }
+#else
+        (void)buffer; (void)capacity;
+#endif
+        return 0;
+    }
+
+    void Close() {
+#ifdef __linux__
+        if (m_fd >= 0) close(m_fd);
+#endif
+        m_fd = -1;
+    }
+
+private:
+    friend class LoopbackStream;
+
+    int m_fd;
+    uint16_t m_peerPort;
+
+#ifdef __linux__
+    static sockaddr_in Loopback(uint16_t port) {
+        sockaddr_in address;
+        std::memset(&address, 0, sizeof(address));
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        address.sin_port = htons(port);
+        return address;
+    }
+#endif
+};
+
+// A TCP connection on the loopback interface, or a socket listening for them. Nothing on it
+// ever blocks once it is set up, so the game can feed it from the simulation thread.
+class LoopbackStream {
+public:
+    LoopbackStream() : m_fd(-1) {}
+    ~LoopbackStream() { Close(); }
+    LoopbackStream(const LoopbackStream&) = delete;
+    LoopbackStream& operator=(const LoopbackStream&) = delete;
+    LoopbackStream(LoopbackStream&& other) noexcept : m_fd(other.m_fd) { other.m_fd = -1; }
+    LoopbackStream& operator=(LoopbackStream&& other) noexcept {
+        if (this != &other) {
+            Close();
+            m_fd = other.m_fd;
+            other.m_fd = -1;
+        }
+        return *this;
+    }
+
+    // Listens on 127.0.0.1:'port' (0 picks a free one)
+    bool Listen(uint16_t port) {
+        Close();
+#ifdef __linux__
+        m_fd = socket(AF_INET, SOCK_STREAM, 0);
+        if (m_fd < 0) return false;
+        int reuse = 1;
+        setsockopt(m_fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+        sockaddr_in address = LoopbackSocket::Loopback(port);
+        if (bind(m_fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || listen(m_fd, 4) != 0 || !MakeNonBlocking()) {
+            Close();
+            return false;
+        }
+        return true;
+#else
+        (void)port;
+        return false;
+#endif
+    }
+
+    // Takes a waiting connection into 'client'; false if there is none
+    bool Accept(LoopbackStream& client) {
+#ifdef __linux__
+        if (m_fd < 0) return false;
+        int fd = accept(m_fd, nullptr, nullptr);
+        if (fd < 0) return false;
+        client.Close();
+        client.m_fd = fd;
+        if (!client.MakeNonBlocking()) {
+            client.Close();
+            return false;
+        }
+        return true;
+#else
+        (void)client;
+        return false;
+#endif
+    }
+
+    // Connects to 127.0.0.1:'port'. Loopback connections are made or refused at once.
+    bool Connect(uint16_t port) {
+        Close();
+#ifdef __linux__
+        m_fd = socket(AF_INET, SOCK_STREAM, 0);
+        if (m_fd < 0) return false;
+        sockaddr_in address = LoopbackSocket::Loopback(port);
+        if (connect(m_fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || !MakeNonBlocking()) {
+            Close();
+            return false;
+        }
+        return true;
+#else
+        (void)port;
+        return false;
+#endif
+    }
+
+    uint16_t Port() const {
+#ifdef __linux__
+        sockaddr_in address;
+        socklen_t size = sizeof(address);
+        if (m_fd < 0 || getsockname(m_fd, reinterpret_cast<sockaddr*>(&address), &size) != 0) return 0;
+        return ntohs(address.sin_port);
+#else
+        return 0;
+#endif
+    }
+
+    bool IsOpen() const { return m_fd >= 0; }
+
+    // How many bytes of 'data' were taken (0 while the connection's buffer is full), or -1
+    // once the connection is gone
+    int64_t Send(const void* data, size_t size) {
+#ifdef __linux__
+        if (m_fd < 0) return -1;
+        ssize_t sent = send(m_fd, data, size, MSG_NOSIGNAL);
+        if (sent >= 0) return sent;
+        return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR ? 0 : -1;
+#else
+        (void)data; (void)size;
+        return -1;
+#endif
+    }
+
+    // How many bytes arrived into 'buffer' (0 if none are waiting), or -1 once the other end closed
+    int64_t Receive(void* buffer, size_t capacity) {
+#ifdef __linux__
+        if (m_fd < 0) return -1;
+        ssize_t got = recv(m_fd, buffer, capacity, 0);
+        if (got > 0) return got;
+        if (got == 0) return -1;
+        return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR ? 0 : -1;
+#else
+        (void)buffer; (void)capacity;
+        return -1;
+#endif
+    }
+
+    void Close() {
+#ifdef __linux__
+        if (m_fd >= 0) close(m_fd);
+#endif
+        m_fd = -1;
+    }
+
+private:
+    int m_fd;
+
+#ifdef __linux__
+    // Non-blocking, and small writes go out at once instead of waiting to be merged
+    bool MakeNonBlocking() {
+        int noDelay = 1;
+        setsockopt(m_fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+        return fcntl(m_fd, F_SETFL, O_NONBLOCK) == 0;
+    }
+#endif
+};
+
+// Exchanges both players' inputs frame by frame, in one of two modes.
+//
+// LOCKSTEP: frame f is simulated only once both players' inputs for it are known, so both
+// sides run exactly the same frames. Local input is scheduled LOCKSTEP_INPUT_DELAY frames
+// ahead, which usually gets it to the peer before the frame needs it; when it doesn't, the
+// frame waits.
+//
+// ROLLBACK: local input is used almost at once and the peer's is predicted, by assuming they
+// keep holding what they last held, for up to MAX_ROLLBACK frames. When the real input turns
+// out different, TakeRollback() reports the first frame that was simulated wrong, and the
+// caller loads its state from before that frame and simulates up to Frame() again.
+//
+// Every packet repeats all inputs the peer hasn't acknowledged, so a lost packet costs nothing
+// but time. Every HASH_INTERVAL frames, once both inputs for it are known, both sides hash
+// their state and compare, which catches a desync within a fraction of a second.
+class Session {
+public:
+    enum class Mode : uint8_t { LOCKSTEP, ROLLBACK };
+
+    static const uint32_t MAGIC = 0x53525642; // "BVRS"
+    static const uint16_t VERSION = 2;
+    static const uint32_t LOCKSTEP_INPUT_DELAY = 3;
+    static const uint32_t ROLLBACK_INPUT_DELAY = 1;
+    static const uint32_t MAX_ROLLBACK = 8;    // Frames the peer's input may be predicted ahead
+    static const uint32_t HASH_INTERVAL = 30;
+    static const uint32_t WINDOW = 64;         // Frames of input kept per player
+    static const uint32_t MAX_PACKET_INPUTS = 32;
+    static constexpr uint32_t NO_FRAME = UINT32_MAX;
+    static constexpr int PEER_TIMEOUT_MS = 5000;
+
+    // What both players must agree on; player 0's proposal is the one played
+    struct Match {
+        uint8_t levelType;
+        uint64_t seed;
+    };
+
+    // The player with the lower port is player 0. Both sides must use the same mode.
+    Session(LoopbackSocket& socket, Mode mode)
+        : m_socket(socket), m_mode(mode), m_inputDelay(mode == Mode::ROLLBACK ? ROLLBACK_INPUT_DELAY : LOCKSTEP_INPUT_DELAY),
+          m_maxPrediction(mode == Mode::ROLLBACK ? MAX_ROLLBACK : 0), m_localPlayer(socket.Port() < socket.Peer() ? 0 : 1),
+          m_connected(false), m_heardPeer(false), m_error(nullptr), m_frame(0), m_localEnd(m_inputDelay), m_remoteEnd(m_inputDelay),
+          m_peerAck(m_inputDelay), m_rollbackFrame(NO_FRAME), m_rollbacks(0), m_longestRollback(0), m_desyncFrame(-1),
+          m_nextHashFrame(HASH_INTERVAL - 1), m_lastHashFrame(0), m_lastHash(0), m_hashes(0), m_lossPercent(0),
+          m_lossRng(socket.Port()), m_latency(0), m_delayedFirst(0), m_delayedCount(0), m_packetsSent(0), m_bytesSent(0) {
+        std::fill(std::begin(m_local), std::end(m_local), (uint16_t)0);
+        std::fill(std::begin(m_remote), std::end(m_remote), (uint16_t)0);
+        std::fill(std::begin(m_guess), std::end(m_guess), (uint16_t)0);
+        for (HashEntry& entry : m_localHashes) entry.frame = UINT32_MAX;
+        for (HashEntry& entry : m_peerHashes) entry.frame = UINT32_MAX;
+        m_lastHeard = std::chrono::steady_clock::now();
+        m_packet.Reserve(512);
+    }
+
+    // Agrees on 'match' with the peer: 'match' is our proposal going in, and what will be
+    // played once this returns true. Call once per tick until then.
+    bool Connect(Match& match) {
+        if (m_connected) return true;
+        m_packet.Clear();
+        WriteHeader(PacketType::HELLO);
+        m_packet.Write((uint8_t)m_localPlayer);
+        m_packet.Write((uint8_t)m_heardPeer);
+        m_packet.Write(m_mode);
+        const Match& proposal = m_heardPeer ? m_match : match;
+        m_packet.Write(proposal.levelType);
+        m_packet.Write(proposal.seed);
+        SendPacket();
+        FlushDelayed();
+        unsigned char buffer[MAX_PACKET_BYTES];
+        while (size_t size = m_socket.Receive(buffer, sizeof(buffer))) {
+            state::Reader reader(buffer, size);
+            PacketType type;
+            if (!ReadHeader(reader, type)) continue;
+            if (type == PacketType::INPUTS && m_heardPeer) { // The peer has started, so it heard us
+                m_connected = true;
+                ReadInputs(reader);
+                continue;
+            }
+            if (type != PacketType::HELLO) continue;
+            uint8_t peerPlayer = reader.Read<uint8_t>();
+            uint8_t peerHeardUs = reader.Read<uint8_t>();
+            Mode peerMode = reader.Read<Mode>();
+            Match peerMatch;
+            reader.Read(peerMatch.levelType);
+            reader.Read(peerMatch.seed);
+            if (reader.Failed()) continue;
+            if (peerPlayer == m_localPlayer) {
+                m_error = "both sides think they are the same player";
+                return false;
+            }
+            if (peerMode != m_mode) {
+                m_error = "the other player is playing a different mode";
+                return false;
+            }
+            if (!m_heardPeer) m_match = m_localPlayer == 0 ? match : peerMatch;
+            m_heardPeer = true;
+            if (peerHeardUs) m_connected = true;
+        }
+        if (m_heardPeer) match = m_match;
+        return m_connected;
+    }
+
+    // Schedules the local input for frame Frame() + the input delay. Returns false, keeping
+    // nothing, while that frame already has one because we are waiting for the peer.
+    bool AddLocalInput(uint16_t input) {
+        if (m_localEnd > m_frame + m_inputDelay) return false;
+        assert(m_localEnd - m_peerAck < WINDOW && "unacknowledged input would be overwritten");
+        m_local[m_localEnd % WINDOW] = input;
+        ++m_localEnd;
+        return true;
+    }
+
+    // Sends our unacknowledged inputs and newest hash, and takes in what the peer sent
+    void Pump() {
+        m_packet.Clear();
+        WriteHeader(PacketType::INPUTS);
+        m_packet.Write(m_remoteEnd); // Acknowledges the peer's inputs before this frame
+        uint32_t first = std::max(m_peerAck, m_localEnd - std::min(m_localEnd, (uint32_t)MAX_PACKET_INPUTS));
+        m_packet.Write(first);
+        m_packet.Write((uint8_t)(m_localEnd - first));
+        for (uint32_t frame = first; frame < m_localEnd; ++frame) m_packet.Write(m_local[frame % WINDOW]);
+        m_packet.Write(m_lastHashFrame);
+        m_packet.Write(m_lastHash);
+        SendPacket();
+        FlushDelayed();
+
+        unsigned char buffer[MAX_PACKET_BYTES];
+        while (size_t size = m_socket.Receive(buffer, sizeof(buffer))) {
+            state::Reader reader(buffer, size);
+            PacketType type;
+            if (ReadHeader(reader, type) && type == PacketType::INPUTS) ReadInputs(reader);
+        }
+    }
+
+    bool WantsLocalInput() const { return m_localEnd <= m_frame + m_inputDelay; }
+
+    // Frame() can be simulated: our input for it is in, and the peer's is known or may be predicted
+    bool Ready() const { return m_localEnd > m_frame && m_frame < m_remoteEnd + m_maxPrediction; }
+
+    // A player's input for a frame up to Frame(). The peer's input past what has arrived is a
+    // prediction, which is remembered so a different real input can trigger a rollback.
+    uint16_t Input(int player, uint32_t frame) {
+        assert(frame <= m_frame && frame < m_localEnd && frame + WINDOW > m_frame);
+        if (player == m_localPlayer) return m_local[frame % WINDOW];
+        if (frame < m_remoteEnd) return m_remote[frame % WINDOW];
+        uint16_t guess = (uint16_t)(m_remote[(m_remoteEnd - 1) % WINDOW] & HELD_KEYS); // Still held, but nothing newly pressed
+        m_guess[frame % WINDOW] = guess;
+        return guess;
+    }
+
+    // Finishes Frame()
+    void Advance() {
+        assert(Ready());
+        ++m_frame;
+    }
+
+    // Whether some frames were simulated with a predicted input that turned out wrong;
+    // 'from' is the first of them. Load the state from before it and simulate those frames
+    // again, up to Frame(), before anything else.
+    bool TakeRollback(uint32_t& from) {
+        if (m_rollbackFrame == NO_FRAME) return false;
+        from = m_rollbackFrame;
+        m_rollbackFrame = NO_FRAME;
+        ++m_rollbacks;
+        m_longestRollback = std::max(m_longestRollback, m_frame - from);
+        return true;
+    }
+
+    // The next frame whose resulting state should be hashed for RecordHash(), now that both
+    // inputs for it are known, or NO_FRAME.
+    uint32_t HashFrameDue() const {
+        if (m_rollbackFrame != NO_FRAME) return NO_FRAME; // Everything from there on is about to change
+        return m_nextHashFrame < std::min(m_frame, m_remoteEnd) ? m_nextHashFrame : NO_FRAME;
+    }
+
+    void RecordHash(uint32_t frame, uint64_t stateHash) {
+        assert(frame == m_nextHashFrame);
+        m_lastHashFrame = frame;
+        m_lastHash = stateHash;
+        RememberHash(m_localHashes, frame, stateHash);
+        ++m_hashes;
+        m_nextHashFrame += HASH_INTERVAL;
+    }
+
+    uint32_t Frame() const { return m_frame; }
+    uint32_t ConfirmedFrames() const { return std::min(m_frame, m_remoteEnd); } // Frames simulated with no predictions
+    int LocalPlayer() const { return m_localPlayer; }
+    bool Connected() const { return m_connected; }
+    const char* Error() const { return m_error; }
+    int64_t DesyncFrame() const { return m_desyncFrame; } // First frame known to differ, -1 if none
+    uint32_t HashesChecked() const { return m_hashes; }
+    uint32_t Rollbacks() const { return m_rollbacks; }
+    uint32_t LongestRollback() const { return m_longestRollback; } // In frames
+    bool PeerAcknowledged(uint32_t frame) const { return m_peerAck >= frame; } // The peer has our inputs up to 'frame'
+    bool PeerLost() const { return std::chrono::steady_clock::now() - m_lastHeard > std::chrono::milliseconds(PEER_TIMEOUT_MS); }
+    uint64_t PacketsSent() const { return m_packetsSent; }
+    uint64_t BytesSent() const { return m_bytesSent; }
+
+    // Drops this share of outgoing packets, to test over a loopback that never loses any
+    void SimulateLoss(int percent) { m_lossPercent = percent; }
+
+    // Holds outgoing packets back this long, to test over a loopback with no latency to speak of
+    void SimulateLatency(int milliseconds) { m_latency = std::chrono::milliseconds(milliseconds); }
+
+private:
+    enum class PacketType : uint8_t { HELLO = 1, INPUTS };
+    static const size_t MAX_PACKET_BYTES = 512;
+    static const size_t HASH_HISTORY = 8;
+    static const size_t MAX_DELAYED = 64; // Packets held back by SimulateLatency(); more are dropped
+    static const uint16_t HELD_KEYS = 0x00FF; // The keysDown half of an input::Pack()ed input
+
+    struct HashEntry {
+        uint32_t frame;
+        uint64_t hash;
+    };
+
+    struct DelayedPacket {
+        std::chrono::steady_clock::time_point due;
+        size_t size;
+        unsigned char bytes[MAX_PACKET_BYTES];
+    };
+
+    LoopbackSocket& m_socket;
+    Mode m_mode;
+    uint32_t m_inputDelay;
+    uint32_t m_maxPrediction;
+    int m_localPlayer;
+    bool m_connected;
+    bool m_heardPeer;
+    const char* m_error;
+    Match m_match = {};
+
+    uint32_t m_frame;     // Next frame to simulate
+    uint32_t m_localEnd;  // Frames before this have local input
+    uint32_t m_remoteEnd; // Frames before this have the peer's input
+    uint32_t m_peerAck;   // The peer has our input for frames before this
+    uint16_t m_local[WINDOW];
+    uint16_t m_remote[WINDOW];
+    uint16_t m_guess[WINDOW]; // What was predicted for the peer's frames from m_remoteEnd to m_frame
+
+    uint32_t m_rollbackFrame; // First frame simulated with a wrong prediction, NO_FRAME if none
+    uint32_t m_rollbacks;
+    uint32_t m_longestRollback;
+
+    int64_t m_desyncFrame;
+    uint32_t m_nextHashFrame;
+    uint32_t m_lastHashFrame;
+    uint64_t m_lastHash;
+    uint32_t m_hashes;
+    HashEntry m_localHashes[HASH_HISTORY];
+    HashEntry m_peerHashes[HASH_HISTORY];
+
+    int m_lossPercent;
+    rng::Stream m_lossRng;
+    std::chrono::milliseconds m_latency;
+    std::unique_ptr<DelayedPacket[]> m_delayed; // Ring of MAX_DELAYED, allocated on first use
+    size_t m_delayedFirst;
+    size_t m_delayedCount;
+    uint64_t m_packetsSent;
+    uint64_t m_bytesSent;
+    std::chrono::steady_clock::time_point m_lastHeard;
+    state::Writer m_packet;
+
+    void WriteHeader(PacketType type) {
+        m_packet.Write((uint32_t)MAGIC);
+        m_packet.Write((uint16_t)VERSION);
+        m_packet.Write(type);
+    }
+
+    bool ReadHeader(state::Reader& reader, PacketType& type) {
+        uint32_t magic = reader.Read<uint32_t>();
+        uint16_t version = reader.Read<uint16_t>();
+        reader.Read(type);
+        if (reader.Failed() || magic != MAGIC) return false;
+        if (version != VERSION) {
+            m_error = "the other player runs a different version";
+            return false;
+        }
+        m_lastHeard = std::chrono::steady_clock::now();
+        return true;
+    }
+
+    void SendPacket() {
+        if (m_lossPercent > 0 && m_lossRng.Range(0, 99) < m_lossPercent) return;
+        if (m_latency.count() > 0) {
+            if (!m_delayed) m_delayed.reset(new DelayedPacket[MAX_DELAYED]);
+            if (m_delayedCount == MAX_DELAYED) return;
+            DelayedPacket& delayed = m_delayed[(m_delayedFirst + m_delayedCount++) % MAX_DELAYED];
+            delayed.due = std::chrono::steady_clock::now() + m_latency;
+            delayed.size = m_packet.Size();
+            std::memcpy(delayed.bytes, m_packet.Data(), m_packet.Size());
+            return;
+        }
+        Send(m_packet.Data(), m_packet.Size());
+    }
+
+    // Sends the held-back packets whose time has come
+    void FlushDelayed() {
+        auto now = std::chrono::steady_clock::now();
+        while (m_delayedCount > 0 && m_delayed[m_delayedFirst].due <= now) {
+            const DelayedPacket& delayed = m_delayed[m_delayedFirst];
+            Send(delayed.bytes, delayed.size);
+            m_delayedFirst = (m_delayedFirst + 1) % MAX_DELAYED;
+            --m_delayedCount;
+        }
+    }
+
+    void Send(const unsigned char* data, size_t size) {
+        if (m_socket.Send(data, size)) {
+            ++m_packetsSent;
+            m_bytesSent += size;
+        }
+    }
+
+    void ReadInputs(state::Reader& reader) {
+        uint32_t ack = reader.Read<uint32_t>();
+        uint32_t first = reader.Read<uint32_t>();
+        uint8_t count = reader.Read<uint8_t>();
+        if (reader.Failed() || count > MAX_PACKET_INPUTS) return;
+        uint16_t inputs[MAX_PACKET_INPUTS];
+        for (uint8_t i = 0; i < count; ++i) reader.Read(inputs[i]);
+        uint32_t hashFrame = reader.Read<uint32_t>();
+        uint64_t hash = reader.Read<uint64_t>();
+        if (reader.Failed()) return;
+
+        if (ack <= m_localEnd) m_peerAck = std::max(m_peerAck, ack);
+        // Take the inputs that continue what we have; older ones are repeats
+        for (uint32_t frame = std::max(first, m_remoteEnd); frame < first + count && frame < m_frame + WINDOW; ++frame) {
+            if (frame != m_remoteEnd) break;
+            uint16_t input = inputs[frame - first];
+            m_remote[frame % WINDOW] = input;
+            ++m_remoteEnd;
+            // Already simulated with a prediction: if it was wrong, that frame and all after it are too
+            if (frame < m_frame && input != m_guess[frame % WINDOW]) m_rollbackFrame = std::min(m_rollbackFrame, frame);
+        }
+        if (hashFrame != 0) RememberHash(m_peerHashes, hashFrame, hash); // 0 until the peer's first hash, which is for a later frame
+    }
+
+    void RememberHash(HashEntry (&history)[HASH_HISTORY], uint32_t frame, uint64_t hash) {
+        HashEntry& entry = history[(frame / HASH_INTERVAL) % HASH_HISTORY];
+        if (entry.frame == frame) return;
+        entry.frame = frame;
+        entry.hash = hash;
+        const HashEntry& local = m_localHashes[(frame / HASH_INTERVAL) % HASH_HISTORY];
+        const HashEntry& peer = m_peerHashes[(frame / HASH_INTERVAL) % HASH_HISTORY];
+        if (local.frame == frame && peer.frame == frame && local.hash != peer.hash && m_desyncFrame < 0) m_desyncFrame = frame;
+    }
+};
+
+} // namespace net
+
+// Spectators: every simulation step, the frame's draw list goes out to viewers over a loopback
+// TCP stream, and a viewer process draws it again. Each draw command is one entity on the
+// stream. Positions are quantized to an eighth of a pixel, and a frame only carries the fields
+// of the commands that differ from the frame before; a new or lagging viewer gets a whole frame.
+namespace spectate {
+
+const float QUANT_STEPS = 8.0f; // Per pixel; int16 then covers +-4096 pixels
+
+// A draw command as it is sent: the fields of gfx::DrawCommand, quantized
+struct Command {
+    uint8_t type;
+    uint8_t layer;
+    int16_t ival;
+    Color color;
+    int16_t v[7];
+    uint16_t textLength; // Without the terminator
+    uint32_t text;       // Offset of the text in the frame's text buffer
+};
+static_assert(sizeof(Command) == 28, "Commands are hashed byte for byte and must not have padding");
+
+inline int16_t Quantize(float value) {
+    float steps = value * QUANT_STEPS;
+    if (!(steps > -32768.0f)) return -32768; // NaN too
+    if (steps > 32767.0f) return 32767;
+    return (int16_t)(steps < 0.0f ? steps - 0.5f : steps + 0.5f); // Rounded half away from zero, without a libm call
+}
+
+inline float Dequantize(int16_t value) { return value / QUANT_STEPS; }
+
+// What changed in a command, as sent in front of its fields. The fields follow in bit order.
+enum ChangeBits : uint16_t {
+    CHANGED_V0 = 1 << 0,    // Up to CHANGED_V0 << 6: geometry values
+    CHANGED_KIND = 1 << 7,  // Type and layer
+    CHANGED_COLOR = 1 << 8,
+    CHANGED_IVAL = 1 << 9,
+    CHANGED_TEXT = 1 << 10  // Length, then the bytes
+};
+
+enum FrameFlags : uint8_t {
+    FRAME_KEYFRAME = 1, // Encoded against an empty frame
+    FRAME_CHECKSUM = 2  // Ends with the Checksum() of the whole frame
+};
+
+const uint16_t END_OF_FRAME = 0xFFFF; // In place of a slot number
+const size_t MAX_COMMANDS = END_OF_FRAME - 1;
+const size_t MAX_TEXT = 1024;
+
+// Hash of quantized commands and their texts, for checking that a viewer decoded a frame right
+template <typename TextAt>
+uint64_t Checksum(const std::vector<Command>& commands, TextAt textAt) {
+    uint64_t hash = state::HashBytes(nullptr, 0);
+    for (size_t i = 0; i < commands.size(); ++i) {
+        Command command = commands[i];
+        command.text = 0; // Where the text is kept doesn't matter
+        hash = state::HashBytes(reinterpret_cast<const unsigned char*>(&command), sizeof(command), hash);
+        hash = state::HashBytes(reinterpret_cast<const unsigned char*>(textAt(i)), command.textLength, hash);
+    }
+    return hash;
+}
+
+// One frame's draw list, quantized
+struct Frame {
+    std::vector<Command> commands;
+    std::vector<char> text;
+
+    Frame() {
+        commands.reserve(1024);
+        text.reserve(4096);
+    }
+
+    void Capture(const gfx::DrawList& list) {
+        commands.clear();
+        text.clear();
+        size_t count = std::min(list.Size(), MAX_COMMANDS);
+        for (size_t i = 0; i < count; ++i) {
+            const gfx::DrawCommand& source = list.Commands()[i];
+            commands.emplace_back();
+            Command& command = commands.back();
+            command.type = (uint8_t)source.type;
+            command.layer = (uint8_t)source.layer;
+            command.ival = (int16_t)std::max(-32768, std::min(32767, source.ival));
+            command.color = source.color;
+            for (int n = 0; n < 7; ++n) command.v[n] = Quantize(source.v[n]);
+            command.textLength = 0;
+            command.text = (uint32_t)text.size();
+            if (source.type == gfx::CommandType::TEXT) {
+                const char* chars = list.Text(source);
+                command.textLength = (uint16_t)std::min(std::strlen(chars), MAX_TEXT);
+                text.insert(text.end(), chars, chars + command.textLength);
+            }
+        }
+    }
+
+    const char* TextOf(size_t index) const { return text.data() + commands[index].text; }
+    uint64_t Checksum() const { return spectate::Checksum(commands, [this](size_t i) { return TextOf(i); }); }
+};
+
+// Writes 'current' as the changes from 'base', or from an empty frame if there is none:
+// frame number, flags, command count, then (slot, change bits, changed fields) for every
+// command that differs, then END_OF_FRAME.
+inline void Encode(const Frame* base, const Frame& current, uint32_t frameNumber, bool withChecksum, state::Writer& out) {
+    static const Command EMPTY = {};
+    out.Clear();
+    out.Write(frameNumber);
+    out.Write((uint8_t)((base ? 0 : FRAME_KEYFRAME) | (withChecksum ? FRAME_CHECKSUM : 0)));
+    out.Write((uint16_t)current.commands.size());
+    for (size_t slot = 0; slot < current.commands.size(); ++slot) {
+        const Command& now = current.commands[slot];
+        bool inBase = base && slot < base->commands.size();
+        const Command& before = inBase ? base->commands[slot] : EMPTY;
+        uint16_t changes = 0;
+        for (int n = 0; n < 7; ++n) {
+            if (now.v[n] != before.v[n]) changes |= CHANGED_V0 << n;
+        }
+        if (now.type != before.type || now.layer != before.layer) changes |= CHANGED_KIND;
+        if (std::memcmp(&now.color, &before.color, sizeof(Color)) != 0) changes |= CHANGED_COLOR;
+        if (now.ival != before.ival) changes |= CHANGED_IVAL;
+        if (now.textLength != before.textLength ||
+            (now.textLength != 0 && std::memcmp(current.TextOf(slot), base->TextOf(slot), now.textLength) != 0)) changes |= CHANGED_TEXT;
+        if (changes == 0) continue;
+
+        out.Write((uint16_t)slot);
+        out.Write(changes);
+        for (int n = 0; n < 7; ++n) {
+            if (changes & (CHANGED_V0 << n)) out.Write(now.v[n]);
+        }
+        if (changes & CHANGED_KIND) {
+            out.Write(now.type);
+            out.Write(now.layer);
+        }
+        if (changes & CHANGED_COLOR) out.Write(now.color);
+        if (changes & CHANGED_IVAL) out.Write(now.ival);
+        if (changes & CHANGED_TEXT) {
+            out.Write(now.textLength);
+            out.WriteBytes(current.TextOf(slot), now.textLength);
+        }
+    }
+    out.Write(END_OF_FRAME);
+    if (withChecksum) out.Write(current.Checksum());
+}
+
+// The viewer's copy of the frame, kept up to date from encoded frames
+class Decoder {
+public:
+    Decoder() : m_synced(false), m_frame(0), m_hasChecksum(false), m_checksum(0) {}
+
+    void Reset() {
+        m_synced = false;
+        m_commands.clear();
+        m_texts.clear();
+    }
+
+    // Applies one encoded frame; false if it doesn't fit what we have
+    bool Apply(state::Reader& in) {
+        uint32_t frameNumber = in.Read<uint32_t>();
+        uint8_t flags = in.Read<uint8_t>();
+        uint16_t count = in.Read<uint16_t>();
+        if (in.Failed() || count > MAX_COMMANDS) return false;
+        if (flags & FRAME_KEYFRAME) {
+            m_commands.clear();
+            m_texts.clear();
+        } else if (!m_synced) {
+            return false; // A change to a frame we never had
+        }
+        m_commands.resize(count, Command{});
+        m_texts.resize(count);
+        for (;;) {
+            uint16_t slot = in.Read<uint16_t>();
+            if (slot == END_OF_FRAME) break;
+            uint16_t changes = in.Read<uint16_t>();
+            if (in.Failed() || slot >= count) return false;
+            Command& command = m_commands[slot];
+            for (int n = 0; n < 7; ++n) {
+                if (changes & (CHANGED_V0 << n)) in.Read(command.v[n]);
+            }
+            if (changes & CHANGED_KIND) {
+                in.Read(command.type);
+                in.Read(command.layer);
+                if (command.type > (uint8_t)gfx::CommandType::SPRITE || command.layer > (uint8_t)gfx::Layer::HUD) return false;
+            }
+            if (changes & CHANGED_COLOR) in.Read(command.color);
+            if (changes & CHANGED_IVAL) in.Read(command.ival);
+            if (changes & CHANGED_TEXT) {
+                in.Read(command.textLength);
+                if (in.Failed() || command.textLength > MAX_TEXT) return false;
+                char chars[MAX_TEXT];
+                in.ReadBytes(chars, command.textLength);
+                m_texts[slot].assign(chars, command.textLength);
+            }
+            if (in.Failed()) return false;
+        }
+        m_hasChecksum = (flags & FRAME_CHECKSUM) != 0;
+        if (m_hasChecksum) in.Read(m_checksum);
+        if (in.Failed() || !in.AtEnd()) return false;
+        m_frame = frameNumber;
+        m_synced = true;
+        return true;
+    }
+
+    // Records the frame into 'out' through the same calls the game made
+    void Replay(gfx::DrawList& out) const {
+        for (size_t i = 0; i < m_commands.size(); ++i) {
+            const Command& command = m_commands[i];
+            float v[7];
+            for (int n = 0; n < 7; ++n) v[n] = Dequantize(command.v[n]);
+            out.SetLayer((gfx::Layer)command.layer);
+            switch ((gfx::CommandType)command.type) {
+                case gfx::CommandType::CLEAR: out.ClearBackground(command.color); break;
+                case gfx::CommandType::RECTANGLE: out.DrawRectangleRec({ v[0], v[1], v[2], v[3] }, command.color); break;
+                case gfx::CommandType::RECTANGLE_LINES: out.DrawRectangleLines((int)v[0], (int)v[1], (int)v[2], (int)v[3], command.color); break;
+                case gfx::CommandType::RECTANGLE_LINES_EX: out.DrawRectangleLinesEx({ v[0], v[1], v[2], v[3] }, v[4], command.color); break;
+                case gfx::CommandType::RECTANGLE_ROUNDED: out.DrawRectangleRounded({ v[0], v[1], v[2], v[3] }, v[4], command.ival, command.color); break;
+                case gfx::CommandType::RECTANGLE_ROUNDED_LINES: out.DrawRectangleRoundedLines({ v[0], v[1], v[2], v[3] }, v[4], command.ival, v[5], command.color); break;
+                case gfx::CommandType::CIRCLE: out.DrawCircle((int)v[0], (int)v[1], v[2], command.color); break;
+                case gfx::CommandType::CIRCLE_LINES: out.DrawCircleLines((int)v[0], (int)v[1], v[2], command.color); break;
+                case gfx::CommandType::ELLIPSE: out.DrawEllipse((int)v[0], (int)v[1], v[2], v[3], command.color); break;
+                case gfx::CommandType::ELLIPSE_LINES: out.DrawEllipseLines((int)v[0], (int)v[1], v[2], v[3], command.color); break;
+                case gfx::CommandType::TRIANGLE: out.DrawTriangle({ v[0], v[1] }, { v[2], v[3] }, { v[4], v[5] }, command.color); break;
+                case gfx::CommandType::TEXT: out.DrawText(m_texts[i].c_str(), (int)v[0], (int)v[1], command.ival, command.color); break;
+                case gfx::CommandType::SPRITE:
+                    if (command.ival >= 0 && command.ival < (int16_t)gfx::Sprite::COUNT) out.DrawSprite((gfx::Sprite)command.ival, { v[0], v[1], v[2], v[3] }, command.color);
+                    break;
+            }
+        }
+    }
+
+    bool Synced() const { return m_synced; }
+    uint32_t FrameNumber() const { return m_frame; }
+    bool HasChecksum() const { return m_hasChecksum; } // The last frame came with one
+    uint64_t ExpectedChecksum() const { return m_checksum; }
+    uint64_t Checksum() const { return spectate::Checksum(m_commands, [this](size_t i) { return m_texts[i].data(); }); }
+
+private:
+    bool m_synced;
+    uint32_t m_frame;
+    bool m_hasChecksum;
+    uint64_t m_checksum;
+    std::vector<Command> m_commands;
+    std::vector<std::string> m_texts;
+};
+
+const uint32_t STREAM_MAGIC = 0x54505342; // "BSPT"
+const uint16_t STREAM_VERSION = 2;
+const size_t STREAM_HEADER_BYTES = 4 + 2 + 2 + 2; // Magic, version, screen width and height
+
+// The game's side: sends every published frame to each connected viewer. A viewer whose
+// connection can't take a whole frame right away misses frames until it has caught up, then
+// gets a keyframe, so Publish() never waits for anyone.
+class Broadcaster {
+public:
+    static const int MAX_SPECTATORS = 4;
+
+    Broadcaster() : m_spectatorCount(0), m_current(0), m_hasPrevious(false), m_checksums(false), m_frame(0), m_lastChecksum(0),
+                    m_frames(0), m_keyframes(0), m_skipped(0), m_bytesSent(0), m_publishSeconds(0.0), m_longestPublishSeconds(0.0) {}
+
+    // Listens for viewers on 127.0.0.1:'port' (0 picks a free one)
+    bool Start(uint16_t port) { return m_listener.Listen(port); }
+
+    void Stop() {
+        m_listener.Close();
+        for (Spectator& spectator : m_spectators) spectator.stream.Close();
+        m_spectatorCount = 0;
+        m_hasPrevious = false;
+    }
+
+    bool Running() const { return m_listener.IsOpen(); }
+    uint16_t Port() const { return m_listener.Port(); }
+
+    // Ends every frame with a checksum of it, so viewers can check what they decoded
+    void SendChecksums(bool on) { m_checksums = on; }
+
+    // Sends 'list' to the viewers as the next frame. Once per simulation step, from one thread.
+    void Publish(const gfx::DrawList& list) {
+        if (!m_listener.IsOpen()) return;
+        auto start = std::chrono::steady_clock::now();
+        AcceptSpectators();
+        if (m_spectatorCount == 0) {
+            m_hasPrevious = false; // Nobody to keep frames for
+            return;
+        }
+        ++m_frame;
+        Frame& current = m_frameData[m_current];
+        const Frame& previous = m_frameData[m_current ^ 1];
+        current.Capture(list);
+        bool deltaReady = false, keyframeReady = false;
+        for (Spectator& spectator : m_spectators) {
+            if (!spectator.stream.IsOpen()) continue;
+            if (!Flush(spectator)) continue;
+            if (spectator.sent < spectator.pending.size()) { // Still sending an older frame
+                spectator.needsKeyframe = true;
+                ++m_skipped;
+                continue;
+            }
+            bool keyframe = spectator.needsKeyframe || !m_hasPrevious;
+            state::Writer& encoded = keyframe ? m_keyframe : m_delta;
+            bool& ready = keyframe ? keyframeReady : deltaReady;
+            if (!ready) {
+                Encode(keyframe ? nullptr : &previous, current, m_frame, m_checksums, encoded);
+                if (keyframe) ++m_keyframes;
+                ready = true;
+            }
+            spectator.needsKeyframe = false;
+            spectator.pending.clear();
+            spectator.sent = 0;
+            uint32_t size = (uint32_t)encoded.Size();
+            Append(spectator, &size, sizeof(size));
+            Append(spectator, encoded.Data(), encoded.Size());
+            Flush(spectator);
+        }
+        if (m_checksums) m_lastChecksum = current.Checksum();
+        m_hasPrevious = true;
+        m_current ^= 1;
+        ++m_frames;
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        m_publishSeconds += seconds;
+        m_longestPublishSeconds = std::max(m_longestPublishSeconds, seconds);
+    }
+
+    int Spectators() const { return m_spectatorCount; }
+    uint32_t LastFrame() const { return m_frame; }
+    uint64_t LastChecksum() const { return m_lastChecksum; } // With SendChecksums() on
+    uint64_t FramesPublished() const { return m_frames; }    // Frames with at least one viewer
+    uint64_t Keyframes() const { return m_keyframes; }
+    uint64_t FramesSkipped() const { return m_skipped; }     // Summed over viewers
+    uint64_t BytesSent() const { return m_bytesSent; }
+    double AveragePublishSeconds() const { return m_frames ? m_publishSeconds / m_frames : 0.0; }
+    double LongestPublishSeconds() const { return m_longestPublishSeconds; }
+
+private:
+    struct Spectator {
+        net::LoopbackStream stream;
+        std::vector<unsigned char> pending; // The frame being sent, after its size
+        size_t sent = 0;
+        bool needsKeyframe = true;
+    };
+
+    net::LoopbackStream m_listener;
+    Spectator m_spectators[MAX_SPECTATORS];
+    int m_spectatorCount;
+    Frame m_frameData[2]; // Current and previous
+    int m_current;
+    bool m_hasPrevious;   // m_frameData[m_current ^ 1] holds the frame every synced viewer has
+    bool m_checksums;
+    uint32_t m_frame;
+    uint64_t m_lastChecksum;
+    state::Writer m_delta;
+    state::Writer m_keyframe;
+    uint64_t m_frames;
+    uint64_t m_keyframes;
+    uint64_t m_skipped;
+    uint64_t m_bytesSent;
+    double m_publishSeconds;
+    double m_longestPublishSeconds;
+
+    void AcceptSpectators() {
+        for (Spectator& spectator : m_spectators) {
+            if (spectator.stream.IsOpen()) continue;
+            if (!m_listener.Accept(spectator.stream)) return;
+            ++m_spectatorCount;
+            spectator.pending.clear();
+            spectator.sent = 0;
+            spectator.needsKeyframe = true;
+            state::Writer header;
+            header.Write(STREAM_MAGIC);
+            header.Write(STREAM_VERSION);
+            header.Write((uint16_t)GLOBAL_SCREEN_WIDTH);
+            header.Write((uint16_t)GLOBAL_SCREEN_HEIGHT);
+            Append(spectator, header.Data(), header.Size());
+        }
+    }
+
+    static void Append(Spectator& spectator, const void* data, size_t size) {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        spectator.pending.insert(spectator.pending.end(), bytes, bytes + size);
+    }
+
+    // Sends as much of the pending bytes as the connection takes; false if it is gone
+    bool Flush(Spectator& spectator) {
+        while (spectator.sent < spectator.pending.size()) {
+            int64_t sent = spectator.stream.Send(spectator.pending.data() + spectator.sent, spectator.pending.size() - spectator.sent);
+            if (sent < 0) {
+                spectator.stream.Close();
+                --m_spectatorCount;
+                return false;
+            }
+            if (sent == 0) break;
+            spectator.sent += (size_t)sent;
+            m_bytesSent += (uint64_t)sent;
+        }
+        return true;
+    }
+};
+
+// The viewer's side: reads frames from the game and keeps a Decoder up to date with them
+class Viewer {
+public:
+    Viewer() : m_gotHeader(false), m_error(nullptr), m_frames(0), m_keyframes(0), m_verify(false), m_verified(0), m_mismatches(0) {
+        m_inbox.reserve(64 * 1024);
+    }
+
+    bool Connect(uint16_t port) {
+        m_inbox.clear();
+        m_gotHeader = false;
+        m_error = nullptr;
+        m_decoder.Reset();
+        return m_stream.Connect(port);
+    }
+
+    bool Connected() const { return m_stream.IsOpen(); }
+
+    // Re-records every frame that comes with a checksum and compares, to check decoding and Replay()
+    void VerifyFrames(bool on) { m_verify = on; }
+
+    // Reads and applies everything that has arrived. False once the connection is gone or
+    // sent something we can't read; Error() says which.
+    bool Poll() {
+        if (!m_stream.IsOpen()) return false;
+        unsigned char buffer[16 * 1024];
+        for (;;) {
+            int64_t got = m_stream.Receive(buffer, sizeof(buffer));
+            if (got < 0) return Fail("the game stopped broadcasting");
+            if (got == 0) break;
+            m_inbox.insert(m_inbox.end(), buffer, buffer + got);
+        }
+        size_t offset = 0;
+        if (!m_gotHeader) {
+            if (m_inbox.size() < STREAM_HEADER_BYTES) return true;
+            state::Reader header(m_inbox.data(), STREAM_HEADER_BYTES);
+            uint32_t magic = header.Read<uint32_t>();
+            uint16_t version = header.Read<uint16_t>();
+            if (magic != STREAM_MAGIC) return Fail("that port isn't a game broadcast");
+            if (version != STREAM_VERSION) return Fail("the game runs a different version");
+            offset = STREAM_HEADER_BYTES;
+            m_gotHeader = true;
+        }
+        while (m_inbox.size() - offset >= sizeof(uint32_t)) {
+            uint32_t size;
+            std::memcpy(&size, m_inbox.data() + offset, sizeof(size));
+            if (m_inbox.size() - offset - sizeof(size) < size) break;
+            state::Reader frame(m_inbox.data() + offset + sizeof(size), size);
+            bool keyframe = size > 4 && (m_inbox[offset + sizeof(size) + 4] & FRAME_KEYFRAME);
+            if (!m_decoder.Apply(frame)) return Fail("the game sent a frame that doesn't decode");
+            offset += sizeof(size) + size;
+            ++m_frames;
+            if (keyframe) ++m_keyframes;
+            if (m_verify && m_decoder.HasChecksum()) Verify();
+        }
+        m_inbox.erase(m_inbox.begin(), m_inbox.begin() + offset);
+        return true;
+    }
+
+    void Draw(gfx::DrawList& out) const { m_decoder.Replay(out); }
+
+    const Decoder& State() const { return m_decoder; }
+    const char* Error() const { return m_error; }
+    uint64_t FramesReceived() const { return m_frames; }
+    uint64_t KeyframesReceived() const { return m_keyframes; }
+    uint64_t FramesVerified() const { return m_verified; }
+    uint64_t Mismatches() const { return m_mismatches; }
+
+private:
+    net::LoopbackStream m_stream;
+    Decoder m_decoder;
+    std::vector<unsigned char> m_inbox;
+    bool m_gotHeader;
+    const char* m_error;
+    uint64_t m_frames;
+    uint64_t m_keyframes;
+    bool m_verify;
+    uint64_t m_verified;
+    uint64_t m_mismatches;
+    gfx::DrawList m_replayed;
+    Frame m_requantized;
+
+    bool Fail(const char* error) {
+        m_error = error;
+        m_stream.Close();
+        return false;
+    }
+
+    void Verify() {
+        if (m_decoder.Checksum() == m_decoder.ExpectedChecksum()) { // Decoded right; now check that replaying records the same
+            m_replayed.Clear();
+            m_decoder.Replay(m_replayed);
+            m_requantized.Capture(m_replayed);
+            if (m_requantized.Checksum() == m_decoder.ExpectedChecksum()) {
+                ++m_verified;
+                return;
+            }
+        }
+        ++m_mismatches;
+    }
+};
+
+} // namespace spectate
+
+
+
+// Every level type has a fixed id, known at compile time
+enum class LevelTypeId : uint8_t {
+    MAZE = 0,
+    SPACE_INVADERS,
+    FLAPPY,
+    OBSTACLE_COURSE,
+    COUNT
+};
+
+// How a level ended (or that it hasn't yet)
+enum class LevelOutcome {
+    IN_PROGRESS,
+    WON,
+    LOST
+};
+
+// Plays a level on its own, one simulation step at a time, by producing the input a
+// person would. Bots only look at the level; everything they do goes through input.
+class LevelBot {
+public:
+    static constexpr float STEP_SECONDS = 1.0f / 60.0f; // Bots plan for the game's fixed simulation step
+
+    virtual ~LevelBot() = default;
+    virtual input::InputState NextInput() = 0; // Decides what to press for the coming step
+};
+
+// The base class for all our game levels. Each level will inherit from this!
+// Besides the virtuals below, a level class provides static TYPE_ID, NAME and INSTRUCTIONS
+// so it can be described in the level registry without being constructed, and a nested
+// Bot (a LevelBot constructed from the level) for unattended runs.
+class Levels {
+public:
+    Levels(int screenW, int screenH)
+        : screenWidth(screenW), screenHeight(screenH), random(rng::EntropySeed()),
+          chunkPool(arena, sizeof(ecs::Chunk), alignof(ecs::Chunk)), world(chunkPool) {}
+    virtual ~Levels() = default; // Important for proper cleanup of derived classes
+
+    virtual void Load() = 0;             // Get level-specific stuff ready (CPU only: may run on a worker thread)
+    virtual bool FinishLoad(double /*budgetSeconds*/) { return true; } // GPU uploads on the main thread, a slice at a time; true when done
+    virtual void Unload() = 0;           // Clean up level-specific stuff
+    virtual void Update(float deltaTime) = 0; // Update game logic for the level
+    virtual void Draw(gfx::DrawList& out) = 0; // Record everything in the level into the frame's draw list
+    virtual LevelOutcome GetOutcome() const = 0; // Won, lost or still playing
+    virtual int GetScore() const = 0; // Points so far, as the level's HUD counts them
+    virtual LevelTypeId GetTypeId() const = 0;
+    virtual const char* GetName() const = 0; 
+    virtual const char* GetInstructions() const = 0; 
+    virtual const char* CheckInvariants() { return nullptr; } // The first rule the level's state breaks, nullptr if it is consistent
+
+    bool IsComplete() const { return GetOutcome() != LevelOutcome::IN_PROGRESS; } // Check if the level is done (won or lost)
+
+    const mem::MonotonicArena& Arena() const { return arena; }
+
+    // Makes the level's randomness repeatable. Call before Load().
+    void Seed(uint64_t seed) { random = rng::Stream(seed); }
+    void Seed(const rng::Stream& stream) { random = stream; }
+
+    // Everything Update() can change, as plain bytes: for rewinding and for checking that a
+    // replay matches. LoadState() puts back exactly what SaveState() wrote. Loaded levels only.
+    void SaveState(state::Writer& out) const {
+        out.Write(random);
+        world.Save(out);
+        SaveLevelState(out);
+    }
+
+    bool LoadState(state::Reader& in) {
+        in.Read(random);
+        if (!world.Load(in)) return false;
+        LoadLevelState(in);
+        return !in.Failed() && in.AtEnd();
+    }
+
+protected:
+    int screenWidth;
+    int screenHeight;
+    rng::Stream random;        // All of the level's randomness; fork it for independent uses
+    mem::MonotonicArena arena; // Backing memory for everything the level owns while loaded
+    mem::FixedPool chunkPool;  // ECS chunks, carved out of the arena
+    ecs::World world;       // Every entity this level spawns (coins, bullets, pipes, platforms...)
+    ecs::Scheduler systems; // Per-frame systems that run over the world
+
+    virtual void SaveLevelState(state::Writer& out) const = 0; // The level's own fields; the world is saved already
+    virtual void LoadLevelState(state::Reader& in) = 0;
+
+    // Throws away all level-owned memory in one go. Called from Unload().
+    void ResetLevelMemory() {
+        world.Reset();
+        chunkPool.Reset();
+        arena.Reset();
+    }
+};
+
+// function to keep values within a certain range
+std::function<float(float, float, float)> minmax = [](float value, float min_val, float max_val) -> float {
+    if (value < min_val) return min_val;
+    if (value > max_val) return max_val;
+    return value;
+};
+
+// Constants specific to the Maze Level
+const int MAZE_BASE_WIDTH_CELLS = 35;
+const int MAZE_BASE_HEIGHT_CELLS = 21;
+
+const Color MAZE_WALL_COLOR = { 128, 0, 128, 255 }; // Walls are purple
+const Color MAZE_PATH_COLOR = { 0, 0, 0, 255 };     // Paths are black
+const Color MAZE_PLAYER_COLOR = { 255, 215, 0, 255 }; // Player is gold
+const Color MAZE_PLAYER_EYE_COLOR = { 0, 0, 0, 255 }; // Player eyes are black
+const Color MAZE_COIN_COLOR = { 255, 193, 7, 255 };   // Coins are orange-yellow
+const Color MAZE_START_COLOR = { 0, 0, 0, 255 };     // Start is black
+const Color MAZE_END_COLOR = { 50, 205, 50, 255 };   // End is green
+const Color MAZE_TEXT_COLOR = { 245, 245, 245, 255 }; // Text is off-white
+
+// first level: the Maze
+class MazeLevel : public Levels {
+public:
+    MazeLevel(int screenW, int screenH);
+    ~MazeLevel() override;
+
+    void Load() override;
+    void Unload() override;
+    void Update(float deltaTime) override;
+    void Draw(gfx::DrawList& out) override;
+    LevelOutcome GetOutcome() const override;
+    int GetScore() const override;
+
+    // The player's sprite: a simple circle with eyes, filling 'bounds'
+    static void DrawPlayerShape(gfx::DrawList& out, Rectangle bounds) {
+        float size = bounds.width;
+        out.DrawCircle(bounds.x + size / 2, bounds.y + size / 2, size / 2, MAZE_PLAYER_COLOR);
+        out.DrawCircle(bounds.x + size / 2 - size * 0.18f, bounds.y + size / 2 - size * 0.15f, size * 0.09f, MAZE_PLAYER_EYE_COLOR);
+        out.DrawCircle(bounds.x + size / 2 + size * 0.18f, bounds.y + size / 2 - size * 0.15f, size * 0.09f, MAZE_PLAYER_EYE_COLOR);
+    }
+
+    static constexpr LevelTypeId TYPE_ID = LevelTypeId::MAZE;
+    static constexpr const char* NAME = "Maze Level";
+    static constexpr bool SPLIT_SCREEN = true; // Lays itself out from the screen size, so it can be played at half width
+    static constexpr const char* INSTRUCTIONS = "Navigate the maze using ARROW keys. \n \n Collect all coins and reach the green exit to win.";
+    LevelTypeId GetTypeId() const override { return TYPE_ID; }
+    const char* GetName() const override { return NAME; }
+    const char* GetInstructions() const override { return INSTRUCTIONS; }
+
+    void GenerateNewMazeStructure();
+
+    const char* CheckInvariants() override;
+    class Bot;
+
+protected:
+    void SaveLevelState(state::Writer& out) const override;
+    void LoadLevelState(state::Reader& in) override;
+
+private:
+    uint8_t* mazeGrid; // Row-major cells from the level arena; nonzero means wall, zero means path
+    int mazeWidthCells;
+    int mazeHeightCells;
+    float cellSizePixels;
+    int startCol, startRow;
+    int endCol, endRow;
+
+    float playerX, playerY;
+    float playerSize;
+    float playerSpeed;
+
+    int totalInitialCoins;
+    int collectedCoins;
+    float coinSize;
+    const float COIN_SPAWN_CHANCE = 0.3f; // Chance for a coin to appear in a path cell
+
+    bool levelWon;
+    bool mazeGeneratedForPreview; 
+    rng::Stream mazeStream; // Carving order of the current layout
+
+    void InitMazeGrid();
+    bool IsWall(int r, int c) const { return mazeGrid[r * mazeWidthCells + c] != 0; }
+    void SetWall(int r, int c, bool wall) { mazeGrid[r * mazeWidthCells + c] = wall ? 1 : 0; }
+    void RecursiveGenerateMaze(int r, int c); 
+    bool CheckWallCollision(float px, float py, float pSize, float dx, float dy);
+    void ResetPlayerAndCoins();
+    void CalculateMazeDimensions(); 
+};
+
+MazeLevel::MazeLevel(int screenW, int screenH)
+    : Levels(screenW, screenH),
+      mazeGrid(nullptr),
+      mazeWidthCells(0), mazeHeightCells(0), cellSizePixels(0.0f),
+      startCol(0), startRow(0), endCol(0), endRow(0),
+      playerX(0), playerY(0), playerSize(0), playerSpeed(3.0f),
+      coinSize(0), totalInitialCoins(0), collectedCoins(0),
+      levelWon(false), mazeGeneratedForPreview(false)
+{
+    CalculateMazeDimensions();
+    InitMazeGrid();
+
+    // Pick up any coin the player touches
+    systems.Add(ecs::Phase::Update, "CollectCoins", [this](ecs::World& w, float) {
+        Rectangle playerRect = {playerX, playerY, playerSize, playerSize};
+        w.Each<ecs::Body, ecs::Collectible>([&](ecs::Entity e, ecs::Body& body, ecs::Collectible& coin) {
+            if (CheckCollisionRecs(playerRect, body.rect)) {
+                collectedCoins += coin.value;
+                telemetry::Emit(telemetry::EventType::COIN_COLLECTED, coin.value, body.rect.x, body.rect.y);
+                audio::Play(audio::Effect::COIN, 0.8f, audio::PanAt(body.rect.x, screenWidth));
+                w.Destroy(e);
+            }
+        });
+    });
+}
+
+MazeLevel::~MazeLevel() {
+    Unload();
+}
+
+void MazeLevel::CalculateMazeDimensions() {
+    mazeWidthCells = MAZE_BASE_WIDTH_CELLS;
+    if (mazeWidthCells % 2 == 0) mazeWidthCells++; // Making sure it's odd for maze generation
+    mazeHeightCells = MAZE_BASE_HEIGHT_CELLS;
+    if (mazeHeightCells % 2 == 0) mazeHeightCells++; 
+
+    float cellWidthByScreen = (float)screenWidth / mazeWidthCells;
+    float cellHeightByScreen = (float)screenHeight / mazeHeightCells;
+
+    cellSizePixels = std::floor(std::min(cellWidthByScreen, cellHeightByScreen));
+
+    mazeWidthCells = (int)(screenWidth / cellSizePixels);
+    if (mazeWidthCells % 2 == 0) mazeWidthCells--;
+    if (mazeWidthCells <= 0) mazeWidthCells = 1;
+
+    mazeHeightCells = (int)(screenHeight / cellSizePixels);
+    if (mazeHeightCells % 2 == 0) mazeHeightCells--;
+    if (mazeHeightCells <= 0) mazeHeightCells = 1;
+
+    if (mazeWidthCells < 3) mazeWidthCells = 3; // Minimum maze size
+    if (mazeHeightCells < 3) mazeHeightCells = 3;
+
+    startCol = 1; // Starting point for the player
+    startRow = 1;
+    endCol = mazeWidthCells - 2; // Ending point for the player
+    endRow = mazeHeightCells - 2;
+
+    playerSize = cellSizePixels * 0.6f;
+    coinSize = cellSizePixels * 0.3f;
+}
+
+void MazeLevel::InitMazeGrid() {
+    mazeGrid = arena.NewArray<uint8_t>((size_t)mazeWidthCells * mazeHeightCells);
+    std::fill(mazeGrid, mazeGrid + (size_t)mazeWidthCells * mazeHeightCells, (uint8_t)1); // All cells start as walls
+}
+
+void MazeLevel::RecursiveGenerateMaze(int r, int c) {
+    SetWall(r, c, false); // Mark current cell as path
+
+    int dr[] = {-2, 0, 2, 0}; // Directions for moving two cells at a time (skipping a wall)
+    int dc[] = {0, 2, 0, -2};
+
+    std::array<int, 4> directions = {0, 1, 2, 3}; // Lives on the stack, no allocation per recursion
+    mazeStream.Shuffle(directions.begin(), directions.end()); // Randomize directions
+
+    for (int dir : directions) {
+        int nextR = r + dr[dir];
+        int nextC = c + dc[dir];
+        int wallR = r + dr[dir] / 2; // Wall in between current and next cell
+        int wallC = c + dc[dir] / 2;
+
+        // If next cell is within bounds and is still a wall, make a path
+        if (nextR >= 0 && nextR < mazeHeightCells && nextC >= 0 && nextC < mazeWidthCells && IsWall(nextR, nextC)) {
+            SetWall(wallR, wallC, false); // the wall
+            RecursiveGenerateMaze(nextR, nextC); 
+        }
+    }
+}
+
+void MazeLevel::GenerateNewMazeStructure() {
+    CalculateMazeDimensions();
+    InitMazeGrid();
+    mazeStream = random.Fork(random.Next()); // Fresh layout every generation, independent of the coin draws
+    RecursiveGenerateMaze(startRow, startCol);
+    mazeGeneratedForPreview = true;
+}
+
+void MazeLevel::ResetPlayerAndCoins() {
+    // Put player back at the start
+    playerX = startCol * cellSizePixels + (cellSizePixels - playerSize) / 2;
+    playerY = startRow * cellSizePixels + (cellSizePixels - playerSize) / 2;
+    levelWon = false;
+
+    world.Clear();
+    collectedCoins = 0;
+    totalInitialCoins = 0;
+
+    // Distribute coins randomly in path cells
+    rng::Stream coinStream = random.Fork(random.Next());
+    for (int r = 0; r < mazeHeightCells; ++r) {
+        for (int c = 0; c < mazeWidthCells; ++c) {
+            // If it's a path cell and not the start/end
+            if (!IsWall(r, c) && !(r == startRow && c == startCol) && !(r == endRow && c == endCol)) {
+                if (coinStream.Chance(COIN_SPAWN_CHANCE)) {
+                    float coinX = c * cellSizePixels + cellSizePixels / 2;
+                    float coinY = r * cellSizePixels + cellSizePixels / 2;
+                    world.Create(ecs::Body{{coinX - coinSize / 2, coinY - coinSize / 2, coinSize, coinSize}}, ecs::Collectible{1});
+                    totalInitialCoins++;
+                }
+            }
+        }
+    }
+}
+
+void MazeLevel::Load() {
+    CalculateMazeDimensions();
+    if (!mazeGeneratedForPreview) {
+        GenerateNewMazeStructure();
+    }
+    ResetPlayerAndCoins(); // Set up player and coins for the current maze
+    audio::g_effects.Prepare({audio::Effect::COIN});
+}
+
+void MazeLevel::Unload() {
+    ResetLevelMemory(); // Grid and coins all live in the level arena
+    mazeGrid = nullptr;
+    mazeGeneratedForPreview = false; // Reset for next time we load a maze
+}
+
+bool MazeLevel::CheckWallCollision(float px, float py, float pSize, float dx, float dy) {
+    float newPlayerX = px + dx;
+    float newPlayerY = py + dy;
+    Rectangle playerRect = {newPlayerX, newPlayerY, pSize, pSize};
+
+    // Calculate which maze cells the player is currently overlapping
+    int minCol = static_cast<int>(playerRect.x / cellSizePixels);
+    int maxCol = static_cast<int>((playerRect.x + playerRect.width - 1) / cellSizePixels);
+    int minRow = static_cast<int>(playerRect.y / cellSizePixels);
+    int maxRow = static_cast<int>((playerRect.y + playerRect.height - 1) / cellSizePixels);
+
+    // Clamp to ensure we don't go out of bounds of the maze grid
+    minCol = minmax(minCol, 0, mazeWidthCells - 1);
+    maxCol = minmax(maxCol, 0, mazeWidthCells - 1);
+    minRow = minmax(minRow, 0, mazeHeightCells - 1);
+    maxRow = minmax(maxRow, 0, mazeHeightCells - 1);
+
+    for (int r = minRow; r <= maxRow; ++r) {
+        for (int c = minCol; c <= maxCol; ++c) {
+            if (r < 0 || r >= mazeHeightCells || c < 0 || c >= mazeWidthCells) continue;
+            if (IsWall(r, c)) { // check If it's a wall
+                Rectangle wallCellRect = { (float)c * cellSizePixels, (float)r * cellSizePixels, (float)cellSizePixels, (float)cellSizePixels };
+                if (CheckCollisionRecs(playerRect, wallCellRect)) { 
+
+                    return true; // Collision detected
+                }
+            }
+        }
+    }
+    return false; // No collision
+}
+
+void MazeLevel::Update(float deltaTime) {
+    if (levelWon) return; // Don't update if level is already won
+
+    float dx = 0, dy = 0;
+    // Handle player movement based on arrow keys
+    if (input::KeyDown(KEY_RIGHT)) dx += playerSpeed;
+    if (input::KeyDown(KEY_LEFT)) dx -= playerSpeed;
+    if (input::KeyDown(KEY_UP)) dy -= playerSpeed;
+    if (input::KeyDown(KEY_DOWN)) dy += playerSpeed;
+
+    // Move player if no wall collision
+    if (!CheckWallCollision(playerX, playerY, playerSize, dx, 0)) { playerX += dx; }
+    if (!CheckWallCollision(playerX, playerY, playerSize, 0, dy)) { playerY += dy; }
+
+    // Keep player within screen bounds
+    playerX = minmax(playerX, 0.0f, (float)screenWidth - playerSize);
+    playerY = minmax(playerY, 0.0f, (float)screenHeight - playerSize);
+
+    systems.Run(ecs::Phase::Update, world, deltaTime); // Coin collection
+
+    Rectangle playerRect = {playerX, playerY, playerSize, playerSize};
+
+    // Check for level completion (reached exit and collected all coins)
+    Rectangle exitRect = { (float)endCol * cellSizePixels, (float)endRow * cellSizePixels, (float)cellSizePixels, (float)cellSizePixels };
+    if (CheckCollisionRecs(playerRect, exitRect) && collectedCoins == totalInitialCoins) {
+        levelWon = true;
+    }
+}
+
+void MazeLevel::Draw(gfx::DrawList& out) {
+    // Draw maze grid
+    for (int r = 0; r < mazeHeightCells; r++) {
+        for (int c = 0; c < mazeWidthCells; c++) {
+            // Only draw if it's visible on screen
+            if (c * cellSizePixels < screenWidth && r * cellSizePixels < screenHeight) {
+                if (IsWall(r, c)) {
+                    out.DrawRectangle(c * cellSizePixels, r * cellSizePixels, cellSizePixels, cellSizePixels, MAZE_WALL_COLOR);
+                } else {
+                    out.DrawRectangle(c * cellSizePixels, r * cellSizePixels, cellSizePixels, cellSizePixels, MAZE_PATH_COLOR);
+                }
+            }
+        }
+    }
+
+    // Draw start and end points
+    out.DrawRectangle(startCol * cellSizePixels, startRow * cellSizePixels, cellSizePixels, cellSizePixels, MAZE_START_COLOR);
+    out.DrawRectangle(endCol * cellSizePixels, endRow * cellSizePixels, cellSizePixels, cellSizePixels, MAZE_END_COLOR);
+
+    // Draw all active coins
+    world.Each<ecs::Body, ecs::Collectible>([&](const ecs::Body& coin, const ecs::Collectible&) {
+        out.DrawCircle(coin.rect.x + coin.rect.width / 2, coin.rect.y + coin.rect.height / 2, coinSize / 2, MAZE_COIN_COLOR);
+    });
+
+    // Draw the player
+    out.SetLayer(gfx::Layer::ACTORS);
+    out.DrawSprite(gfx::Sprite::MAZE_PLAYER, { playerX, playerY, playerSize, playerSize });
+
+    // Display coin count
+    out.SetLayer(gfx::Layer::HUD);
+    out.DrawText(mem::ScratchFormat("Coins: %d/%d", collectedCoins, totalInitialCoins), 10, 10, 20, MAZE_TEXT_COLOR);
+}
+
+LevelOutcome MazeLevel::GetOutcome() const {
+    return levelWon ? LevelOutcome::WON : LevelOutcome::IN_PROGRESS; // The maze can only be won
+}
+
+int MazeLevel::GetScore() const {
+    return collectedCoins;
+}
+
+const char* MazeLevel::CheckInvariants() {
+    if (!mazeGrid) return "maze grid missing";
+    if (!(playerX >= 0 && playerY >= 0 && playerX + playerSize <= screenWidth && playerY + playerSize <= screenHeight)) return "player off screen";
+    if (CheckWallCollision(playerX, playerY, playerSize, 0, 0)) return "player inside a wall";
+    if (collectedCoins < 0 || collectedCoins + (int)world.Count<ecs::Collectible>() != totalInitialCoins) return "coins collected and left don't add up";
+    return nullptr;
+}
+
+void MazeLevel::SaveLevelState(state::Writer& out) const {
+    out.WriteBytes(mazeGrid, (size_t)mazeWidthCells * mazeHeightCells);
+    out.Write(startCol); out.Write(startRow);
+    out.Write(endCol); out.Write(endRow);
+    out.Write(playerX); out.Write(playerY);
+    out.Write(totalInitialCoins); out.Write(collectedCoins);
+    out.Write(levelWon); out.Write(mazeGeneratedForPreview);
+    out.Write(mazeStream);
+}
+
+void MazeLevel::LoadLevelState(state::Reader& in) {
+    if (!mazeGrid) InitMazeGrid();
+    in.ReadBytes(mazeGrid, (size_t)mazeWidthCells * mazeHeightCells);
+    in.Read(startCol); in.Read(startRow);
+    in.Read(endCol); in.Read(endRow);
+    in.Read(playerX); in.Read(playerY);
+    in.Read(totalInitialCoins); in.Read(collectedCoins);
+    in.Read(levelWon); in.Read(mazeGeneratedForPreview);
+    in.Read(mazeStream);
+}
+
+// Plays the maze: walks the shortest path to the nearest coin, and to the exit once every
+// coin is taken. The path is a breadth-first search over the cell grid from the player's
+// cell, redone every step so it never goes stale.
+class MazeLevel::Bot : public LevelBot {
+public:
+    explicit Bot(MazeLevel& level) : m_level(level) {}
+
+    input::InputState NextInput() override {
+        MazeLevel& maze = m_level;
+        input::InputState state;
+        if (maze.levelWon || !maze.mazeGrid) return state;
+
+        int width = maze.mazeWidthCells;
+        int cellCount = width * maze.mazeHeightCells;
+        float cell = maze.cellSizePixels;
+        m_goal.assign((size_t)cellCount, 0);
+        bool coinsLeft = false;
+        maze.world.Each<ecs::Body, ecs::Collectible>([&](const ecs::Body& coin, const ecs::Collectible&) {
+            int c = (int)((coin.rect.x + coin.rect.width / 2) / cell);
+            int r = (int)((coin.rect.y + coin.rect.height / 2) / cell);
+            m_goal[(size_t)(r * width + c)] = 1;
+            coinsLeft = true;
+        });
+        if (!coinsLeft) m_goal[(size_t)(maze.endRow * width + maze.endCol)] = 1;
+
+        float centerX = maze.playerX + maze.playerSize / 2;
+        float centerY = maze.playerY + maze.playerSize / 2;
+        int start = (int)(centerY / cell) * width + (int)(centerX / cell);
+
+        // Breadth-first until the first goal cell comes off the queue
+        m_cameFrom.assign((size_t)cellCount, -1);
+        m_queue.clear();
+        m_queue.reserve((size_t)cellCount); // Once; later steps don't touch the heap
+        m_queue.push_back(start);
+        m_cameFrom[(size_t)start] = start;
+        int found = -1;
+        const int dr[] = { -1, 1, 0, 0 };
+        const int dc[] = { 0, 0, -1, 1 };
+        for (size_t head = 0; head < m_queue.size(); ++head) {
+            int current = m_queue[head];
+            if (m_goal[(size_t)current]) {
+                found = current;
+                break;
+            }
+            for (int d = 0; d < 4; ++d) {
+                int r = current / width + dr[d];
+                int c = current % width + dc[d];
+                if (r < 0 || r >= maze.mazeHeightCells || c < 0 || c >= width || maze.IsWall(r, c)) continue;
+                int next = r * width + c;
+                if (m_cameFrom[(size_t)next] >= 0) continue;
+                m_cameFrom[(size_t)next] = current;
+                m_queue.push_back(next);
+            }
+        }
+        if (found < 0) return state; // Nothing reachable
+
+        // Walk back to the first cell on the path and steer the player's center onto it
+        int step = found;
+        while (step != start && m_cameFrom[(size_t)step] != start) step = m_cameFrom[(size_t)step];
+        float dx = (step % width + 0.5f) * cell - centerX;
+        float dy = (step / width + 0.5f) * cell - centerY;
+        float deadZone = maze.playerSpeed / 2;
+        if (dx > deadZone) input::Hold(state, KEY_RIGHT);
+        else if (dx < -deadZone) input::Hold(state, KEY_LEFT);
+        if (dy > deadZone) input::Hold(state, KEY_DOWN);
+        else if (dy < -deadZone) input::Hold(state, KEY_UP);
+        return state;
+    }
+
+private:
+    MazeLevel& m_level;
+    std::vector<uint8_t> m_goal; // Per cell: is there something to go to
+    std::vector<int> m_cameFrom; // Per cell: the cell the search reached it from, -1 if not reached
+    std::vector<int> m_queue;
+};
+
+
+// Constants for the Space Invaders Level
+const int SI_PLAYER_SPEED = 5;            // How fast the player's spaceship moves horizontally.
+const int SI_BULLET_SPEED = 3;            // How fast both player and invader bullets travel.
+const int SI_INVADER_SPEED = 1;           // The base speed for how much invaders shift horizontally in one step.
+const int SI_INVADER_ROWS = 2;            // Number of rows of invaders to spawn.
+const int SI_INVADER_COLS = 8;            // Number of columns of invaders to spawn in each row.
+const int SI_INVADER_SPACING_X = 50;      // Horizontal distance between the center of invaders.
+const int SI_INVADER_SPACING_Y = 40;      // Vertical distance between the center of invader rows.
+const int SI_INVADER_START_X = 50;        // X-coordinate where the first invader (top-left of formation) starts.
+const int SI_INVADER_START_Y = 100;       // Y-coordinate where the first invader (top-left of formation) starts.
+const float SI_INVADER_FIRE_RATE = 0.15f; // The chance (per second) an invader might fire a bullet.
+const float SI_INVADER_MOVE_INTERVAL = 0.8f; // How long (in seconds) between each horizontal movement step for the invaders.
+const float SI_INVADER_DESCENT_AMOUNT = 20.0f; // How much the invaders drop down when they hit a screen edge and reverse direction.
+
+// second level: Space Invaders
+class SpaceInvadersLevel : public Levels {
+public:
+    // Component for a bullet entity (position and size live in ecs::Body)
+    struct Bullet {
+        bool isPlayerBullet; // Is this a player's bullet or an invader's
+    };
+
+    // Spawns a 5x10 bullet entity at the given position
+    static void SpawnBullet(ecs::World& world, Vector2 pos, bool playerBullet) {
+        world.Create(ecs::Body{{ pos.x, pos.y, 5, 10 }}, Bullet{ playerBullet });
+    }
+
+    // Represents the player's spaceship
+    class Player {
+    public:
+        Rectangle rect;
+        int lives;
+        float lastShotTime; // To control firing rate
+
+        Player(int screenW, int screenH) : lives(5), lastShotTime(-1.0f) {
+            rect = { (float)screenW / 2 - 25, (float)screenH - 70, 50, 50 };
+        }
+
+        void Update(ecs::World& world, float screenW, float currentTime) {
+            // Move left/right
+            if (input::KeyDown(KEY_LEFT) && rect.x > 0) {
+                rect.x -= SI_PLAYER_SPEED;
+            }
+            if (input::KeyDown(KEY_RIGHT) && rect.x < screenW - rect.width) {
+                rect.x += SI_PLAYER_SPEED;
+            }
+            // Fire bullet if space is pressed and enough time has passed
+            if (input::KeyDown(KEY_SPACE) && (currentTime - lastShotTime >= 0.5f)) {
+                SpawnBullet(world, Vector2{ rect.x + rect.width / 2 - 2.5f, rect.y }, true);
+                lastShotTime = currentTime;
+                audio::Play(audio::Effect::SHOT, 0.6f, audio::PanAt(rect.x + rect.width / 2, (int)screenW));
+            }
+        }
+
+        void Draw(gfx::DrawList& out) const {
+            // Simple triangle shape for the player
+            Vector2 p1 = { rect.x + rect.width / 2, rect.y };
+            Vector2 p2 = { rect.x, rect.y + rect.height };
+            Vector3 p3_temp = { rect.x + rect.width, rect.y + rect.height, 0.0f };
+            out.DrawTriangle(p1, p2, { p3_temp.x, p3_temp.y }, DARKBLUE);
+
+            // Some details on the player ship
+            out.DrawRectangle(rect.x, rect.y + rect.height * 0.2f, rect.width, rect.height * 0.1f, WHITE);
+            out.DrawRectangle(rect.x, rect.y + rect.height * 0.4f, rect.width, rect.height * 0.1f, BLACK);
+            out.DrawRectangle(rect.x, rect.y + rect.height * 0.6f, rect.width, rect.height * 0.1f, WHITE);
+            out.DrawRectangle(rect.x, rect.y + rect.height * 0.8f, rect.width, rect.height * 0.1f, BLACK);
+            out.DrawRectangle(rect.x + rect.width / 4, rect.y + rect.height / 2, rect.width / 2, rect.height / 2, BLUE);
+        }
+
+        void TakeDamage() { lives--; }
+        bool IsAlive() const { return lives > 0; }
+    };
+
+    // Component for an invader amongus (position and size live in ecs::Body)
+    struct Invader {
+        int type; // Could be used for different invader behaviors/looks altho we have used a very simpler approach
+    };
+
+    static void DrawInvader(gfx::DrawList& out, const Rectangle& rect) {
+        out.DrawSprite(gfx::Sprite::INVADER_SAUCER, rect);
+    }
+
+    // The invader's sprite: a saucer with a window and a capped, lit top. Everything scales
+    // with 'rect' (30x30 in play, the sizes in the comments).
+    static void DrawInvaderShape(gfx::DrawList& out, const Rectangle& rect) {
+        out.DrawRectangleRec({ rect.x, rect.y + rect.height * 0.1f, rect.width, rect.height * 0.9f }, RED);
+        out.DrawCircle(rect.x + rect.width / 2, rect.y + rect.height * 0.1f, rect.width / 2, RED);
+        out.DrawCircle(rect.x + rect.width / 2, rect.y + rect.height, rect.width / 2, RED);
+
+        Rectangle window = { rect.x + rect.width * 0.2f, rect.y + rect.height * 0.2f, rect.width * 0.6f, rect.height * 0.4f };
+        out.DrawRectangleRec(window, SKYBLUE);
+        out.DrawRectangleLinesEx(window, rect.width / 30, DARKBLUE); // 1 pixel
+
+        out.DrawRectangleRec({ rect.x + rect.width * 0.15f, rect.y - rect.height / 3, rect.width * 0.7f, rect.height / 2 }, BLUE);           // 10 above, 15 tall
+        out.DrawRectangleRec({ rect.x + rect.width * 0.05f, rect.y - rect.height / 6, rect.width * 0.9f, rect.height / 6 }, DARKBLUE);       // 5 tall
+        out.DrawRectangleRec({ rect.x + rect.width * 0.4f, rect.y - rect.height * 7 / 30, rect.width / 5, rect.height / 5 }, YELLOW);        // 6x6
+    }
+
+    SpaceInvadersLevel(int screenW, int screenH);
+    ~SpaceInvadersLevel() override;
+
+    void Load() override;
+    void Unload() override;
+    void Update(float deltaTime) override;
+    void Draw(gfx::DrawList& out) override;
+    LevelOutcome GetOutcome() const override;
+    int GetScore() const override;
+
+    static constexpr LevelTypeId TYPE_ID = LevelTypeId::SPACE_INVADERS;
+    static constexpr const char* NAME = "Space Invaders Level";
+    static constexpr bool SPLIT_SCREEN = false; // Its layout is fixed to the full screen
+    static constexpr const char* INSTRUCTIONS = "Use LEFT/RIGHT arrows to move. \n \n Press SPACE to shoot. Destroy all invaders before\n \n  they reach the bottom or \n \n you run out of lives!";
+    LevelTypeId GetTypeId() const override { return TYPE_ID; }
+    const char* GetName() const override { return NAME; }
+    const char* GetInstructions() const override { return INSTRUCTIONS; }
+
+    const char* CheckInvariants() override;
+    class Bot;
+
+protected:
+    void SaveLevelState(state::Writer& out) const override;
+    void LoadLevelState(state::Reader& in) override;
+
+private:
+    Player player;
+    int score;
+    bool gameOver;
+    bool gameWon;
+    float invaderMoveDirection; // 1.0f for right, -1.0f for left
+    float invaderMoveTimer;
+    float levelTime; // Simulation clock; GetTime() is wall time and belongs to the render thread
+    float currentScreenW, currentScreenH;
+};
+
+SpaceInvadersLevel::SpaceInvadersLevel(int screenW, int screenH)
+    : Levels(screenW, screenH),
+      player(screenW, screenH),
+      score(0), gameOver(false), gameWon(false),
+      invaderMoveDirection(1.0f), invaderMoveTimer(0.0f), levelTime(0.0f),
+      currentScreenW((float)screenW), currentScreenH((float)screenH)
+{
+    // Move every bullet and drop the ones that left the screen
+    systems.Add(ecs::Phase::Update, "MoveBullets", [this](ecs::World& w, float) {
+        w.Each<ecs::Body, Bullet>([&](ecs::Entity e, ecs::Body& body, Bullet& bullet) {
+            body.rect.y += bullet.isPlayerBullet ? -SI_BULLET_SPEED : SI_BULLET_SPEED; // Player bullets go up, invader bullets go down
+            if (body.rect.y < 0 || body.rect.y > currentScreenH) {
+                w.Destroy(e);
+            }
+        });
+    });
+
+    // Step the invader formation sideways and down
+    systems.Add(ecs::Phase::Update, "MoveFormation", [this](ecs::World& w, float deltaTime) {
+        invaderMoveTimer += deltaTime;
+        // Check if it's time for invaders to move horizontally
+        if (invaderMoveTimer < SI_INVADER_MOVE_INTERVAL) return;
+        invaderMoveTimer = 0.0f;
+
+        float minX = currentScreenW;
+        float maxX = 0;
+        bool anyInvaderActive = false;
+        // Find the leftmost and rightmost invaders
+        w.Each<ecs::Body, Invader>([&](const ecs::Body& body, const Invader&) {
+            minX = std::min(minX, body.rect.x);
+            maxX = std::max(maxX, body.rect.x + body.rect.width);
+            anyInvaderActive = true;
+        });
+        if (!anyInvaderActive) return;
+
+        // Reverse direction and descend if invaders hit screen edges
+        bool shouldDescend = false;
+        if (invaderMoveDirection == 1.0f) { // Moving right
+            if (maxX >= currentScreenW - 20) {
+                invaderMoveDirection = -1.0f; // Switch to left
+                shouldDescend = true;
+            }
+        } else { // Moving left
+            if (minX <= 20) {
+                invaderMoveDirection = 1.0f; // Switch to right
+                shouldDescend = true;
+            }
+        }
+
+        // Move invaders
+        w.Each<ecs::Body, Invader>([&](ecs::Body& body, const Invader&) {
+            body.rect.x += invaderMoveDirection * SI_INVADER_SPEED * 10; // Move horizontally
+            if (shouldDescend) {
+                body.rect.y += SI_INVADER_DESCENT_AMOUNT; // Move down
+                if (body.rect.y + body.rect.height >= player.rect.y) {
+                    gameOver = true; // Invaders reached player line
+                }
+            }
+        });
+    });
+
+    // Invaders randomly fire bullets
+    systems.Add(ecs::Phase::Update, "InvaderFire", [this](ecs::World& w, float deltaTime) {
+        mem::ScratchVector<Vector2> muzzles;
+        w.Each<ecs::Body, Invader>([&](const ecs::Body& body, const Invader&) {
+            //generates a completely random number between 0 and 1 for each invader every frame and then calculates the probability of firing for the current frame.
+            if (random.Chance(SI_INVADER_FIRE_RATE * deltaTime)) {
+                muzzles.push_back({ body.rect.x + body.rect.width / 2 - 2.5f, body.rect.y + body.rect.height });
+            }
+        });
+        for (const Vector2& muzzle : muzzles) SpawnBullet(w, muzzle, false);
+    });
+
+    // Bullet hits on invaders and on the player
+    systems.Add(ecs::Phase::Update, "BulletHits", [this](ecs::World& w, float) {
+        bool playerHit = false;
+        w.Each<ecs::Body, Bullet>([&](ecs::Entity bulletEntity, const ecs::Body& bulletBody, const Bullet& bullet) {
+            if (bullet.isPlayerBullet) {
+                bool hit = false;
+                w.Each<ecs::Body, Invader>([&](ecs::Entity invaderEntity, const ecs::Body& invaderBody, const Invader&) {
+                    if (!hit && w.IsAlive(bulletEntity) && CheckCollisionRecs(bulletBody.rect, invaderBody.rect)) {
+                        hit = true;
+                        w.Destroy(bulletEntity);  // Bullet hits invader
+                        w.Destroy(invaderEntity); // Invader destroyed
+                        score += 100;
+                        telemetry::Emit(telemetry::EventType::INVADER_KILLED, score, invaderBody.rect.x, invaderBody.rect.y);
+                        audio::Play(audio::Effect::HIT, 0.7f, audio::PanAt(invaderBody.rect.x, screenWidth));
+                    }
+                });
+            } else if (!playerHit && CheckCollisionRecs(bulletBody.rect, player.rect)) {
+                playerHit = true;       // Only one hit per frame
+                w.Destroy(bulletEntity); // Bullet hits player
+                player.TakeDamage();     // Player loses a life
+                telemetry::Emit(telemetry::EventType::PLAYER_HIT, player.lives, player.rect.x, player.rect.y);
+                audio::Play(audio::Effect::HIT, 1.0f, audio::PanAt(player.rect.x, screenWidth));
+                if (!player.IsAlive()) {
+                    gameOver = true; // No more lives, game over
+                }
+            }
+        });
+    });
+}
+
+SpaceInvadersLevel::~SpaceInvadersLevel() {
+    Unload();
+}
+
+void SpaceInvadersLevel::Load() {
+    audio::g_effects.Prepare({audio::Effect::SHOT, audio::Effect::HIT});
+    player = Player(screenWidth, screenHeight); // Reset player state
+    score = 0;
+    gameOver = false;
+    gameWon = false;
+    invaderMoveDirection = 1.0f;
+    invaderMoveTimer = 0.0f;
+    levelTime = 0.0f;
+
+    world.Clear();
+
+    // Spawn invaders in a grid
+    for (int row = 0; row < SI_INVADER_ROWS; ++row) {
+        for (int col = 0; col < SI_INVADER_COLS; ++col) {
+            Vector2 invaderPos = {
+                (float)SI_INVADER_START_X + col * SI_INVADER_SPACING_X,
+                (float)SI_INVADER_START_Y + row * SI_INVADER_SPACING_Y
+            };
+            world.Create(ecs::Body{{ invaderPos.x, invaderPos.y, 30, 30 }}, Invader{ row });
+        }
+    }
+}
+
+void SpaceInvadersLevel::Unload() {
+    ResetLevelMemory(); // Invaders and bullets live in the level arena
+}
+
+void SpaceInvadersLevel::Update(float deltaTime) {
+    if (gameOver || gameWon) {
+        return; // Stop updating if game is over or won
+    }
+
+    levelTime += deltaTime;
+    player.Update(world, currentScreenW, levelTime);
+
+    systems.Run(ecs::Phase::Update, world, deltaTime);
+
+    // Check if all invaders are destroyed (win condition)
+    if (world.Count<Invader>() == 0) {
+        gameWon = true;
+    }
+}
+
+void SpaceInvadersLevel::Draw(gfx::DrawList& out) {
+    out.SetLayer(gfx::Layer::ACTORS);
+    player.Draw(out); // Draw the player
+
+    // Draw all active invaders and bullets
+    world.Each<ecs::Body, Invader>([&](const ecs::Body& body, const Invader&) { DrawInvader(out, body.rect); });
+    world.Each<ecs::Body, Bullet>([&](const ecs::Body& body, const Bullet& bullet) {
+        out.DrawRectangleRec(body.rect, bullet.isPlayerBullet ? YELLOW : RED);
+    });
+
+    // Display score and lives
+    out.SetLayer(gfx::Layer::HUD);
+    out.DrawText(mem::ScratchFormat("SCORE: %04i", score), 10, 10, 20, WHITE);
+    out.DrawText(mem::ScratchFormat("LIVES: %i", player.lives), screenWidth - 100, 10, 20, WHITE);
+
+    // Display game over or level complete messages
+    if (gameOver) {
+        out.DrawText("GAME OVER!", screenWidth / 2 - MeasureText("GAME OVER!", 40) / 2, screenHeight / 2 - 20, 40, RED);
+    } else if (gameWon) {
+        out.DrawText("LEVEL COMPLETE!", screenWidth / 2 - MeasureText("LEVEL COMPLETE!", 40) / 2, screenHeight / 2 - 20, 40, GOLD);
+    }
+}
+
+LevelOutcome SpaceInvadersLevel::GetOutcome() const {
+    if (gameWon) return LevelOutcome::WON;
+    return gameOver ? LevelOutcome::LOST : LevelOutcome::IN_PROGRESS;
+}
+
+int SpaceInvadersLevel::GetScore() const {
+    return score;
+}
+
+const char* SpaceInvadersLevel::CheckInvariants() {
+    if (player.lives < 0 || player.lives > 5) return "lives out of range";
+    if (!(player.rect.x >= 0 && player.rect.x + player.rect.width <= currentScreenW)) return "player off screen";
+    if (world.Count<Invader>() > (size_t)(SI_INVADER_ROWS * SI_INVADER_COLS)) return "more invaders than were spawned";
+    if (world.Count<Bullet>() > 256) return "bullets are piling up"; // They leave the screen within a few seconds
+    return nullptr;
+}
+
+void SpaceInvadersLevel::SaveLevelState(state::Writer& out) const {
+    out.Write(player.rect); out.Write(player.lives); out.Write(player.lastShotTime);
+    out.Write(score); out.Write(gameOver); out.Write(gameWon);
+    out.Write(invaderMoveDirection); out.Write(invaderMoveTimer); out.Write(levelTime);
+}
+
+void SpaceInvadersLevel::LoadLevelState(state::Reader& in) {
+    in.Read(player.rect); in.Read(player.lives); in.Read(player.lastShotTime);
+    in.Read(score); in.Read(gameOver); in.Read(gameWon);
+    in.Read(invaderMoveDirection); in.Read(invaderMoveTimer); in.Read(levelTime);
+}
+
+// Plays Space Invaders: lines up under the invader nearest to it sideways (leading it by
+// how far the formation drifts while the shot climbs) and fires when lined up, unless
+// staying on that course would walk into an invader bullet in the next second.
+class SpaceInvadersLevel::Bot : public LevelBot {
+public:
+    explicit Bot(SpaceInvadersLevel& level) : m_level(level) {}
+
+    input::InputState NextInput() override {
+        SpaceInvadersLevel& level = m_level;
+        input::InputState state;
+        if (level.gameOver || level.gameWon) return state;
+
+        const Rectangle& ship = level.player.rect;
+        float shipCenter = ship.x + ship.width / 2;
+        float aim = shipCenter;
+        float nearest = level.currentScreenW;
+        level.world.Each<ecs::Body, Invader>([&](const ecs::Body& body, const Invader&) {
+            float climbSteps = (ship.y - body.rect.y) / SI_BULLET_SPEED;
+            float drift = level.invaderMoveDirection * SI_INVADER_SPEED * 10 * climbSteps * STEP_SECONDS / SI_INVADER_MOVE_INTERVAL;
+            float x = body.rect.x + body.rect.width / 2 + drift;
+            if (std::fabs(x - shipCenter) < nearest) {
+                nearest = std::fabs(x - shipCenter);
+                aim = x;
+            }
+        });
+        int wanted = aim > shipCenter + SI_PLAYER_SPEED ? 1 : (aim < shipCenter - SI_PLAYER_SPEED ? -1 : 0);
+
+        // The wanted move if it is safe, otherwise whichever move gets hit last
+        int move = wanted;
+        int safeFor = StepsUntilHit(wanted);
+        for (int candidate : { 0, -1, 1 }) {
+            if (safeFor >= DODGE_HORIZON) break;
+            int steps = StepsUntilHit(candidate);
+            if (steps > safeFor) {
+                move = candidate;
+                safeFor = steps;
+            }
+        }
+
+        if (move < 0) input::Hold(state, KEY_LEFT);
+        if (move > 0) input::Hold(state, KEY_RIGHT);
+        if (std::fabs(aim - shipCenter) < 12.0f) input::Hold(state, KEY_SPACE);
+        return state;
+    }
+
+private:
+    static constexpr int DODGE_HORIZON = 60;    // Steps ahead the bot looks for incoming bullets
+    static constexpr float DODGE_MARGIN = 4.0f; // Extra room left around a bullet
+
+    SpaceInvadersLevel& m_level;
+
+    // Steps until an invader bullet hits the ship if it keeps moving in 'direction', DODGE_HORIZON if none does
+    int StepsUntilHit(int direction) {
+        const Rectangle& ship = m_level.player.rect;
+        float maxX = m_level.currentScreenW - ship.width;
+        int earliest = DODGE_HORIZON;
+        m_level.world.Each<ecs::Body, Bullet>([&](const ecs::Body& body, const Bullet& bullet) {
+            if (bullet.isPlayerBullet) return;
+            for (int step = 1; step < earliest; ++step) {
+                Rectangle shot = { body.rect.x - DODGE_MARGIN, body.rect.y + (float)SI_BULLET_SPEED * step,
+                                   body.rect.width + 2 * DODGE_MARGIN, body.rect.height };
+                if (shot.y > ship.y + ship.height) break;
+                Rectangle future = { minmax(ship.x + (float)direction * SI_PLAYER_SPEED * step, 0.0f, maxX), ship.y, ship.width, ship.height };
+                if (CheckCollisionRecs(future, shot)) {
+                    earliest = step;
+                    break;
+                }
+            }
+        });
+        return earliest;
+    }
+};
+
+// Constants specific to the Flappy Level
+const int FLAPPY_PIPE_WIDTH = 80;                     // The fixed width of each pipe segment in pixels.
+const int FLAPPY_PIPE_GAP = 150;                      // The vertical size of the opening/gap between the top and bottom pipes.
+const float FLAPPY_PIPE_SPEED = 100.0f;               // How fast pipes move from right to left across the screen (pixels per second).
+const Color FLAPPY_BIRD_COLOR = PURPLE;
+const float FLAPPY_BIRD_RADIUS = 20.0f;               // The radius of the bird's circular collision and visual model.
+const float FLAPPY_BIRD_JUMP_STRENGTH = -250.0f;      // The initial upward vertical velocity applied when the bird 'jumps' (negative because Y increases downwards).
+const float FLAPPY_GRAVITY = 700.0f;                  // The constant downward acceleration applied to the bird (pixels per second squared).
+const int FLAPPY_WIN_SCORE = 10;                      // The score the player needs to achieve to complete the Flappy Level.
+const float FLAPPY_INITIAL_HEALTH = 100.0f;           // The bird's starting health points for the level.
+const float FLAPPY_DAMAGE_PER_HIT = 25.0f;            // The amount of health the bird loses upon colliding with a pipe or screen edge.
+const float FLAPPY_MIN_HORIZONTAL_PIPE_SPACING = 250.0f; // The minimum horizontal distance maintained between the right edge of one pipe and the left edge of the next.
+const int FLAPPY_FONT_SIZE = 40;                      // The size of the font used for displaying score, health, and messages in this level.
+
+// third level: Flappy
+class FlappyLevel : public Levels {
+public:
+    // Internal states for the Flappy level
+    enum FlappyGameScreen {
+        FLAPPY_MENU = 0,
+        FLAPPY_PLAYING,
+        FLAPPY_GAME_OVER,
+        FLAPPY_WIN
+    };
+
+    // Base class for game objects in Flappy (the Bird; pipes are ECS entities)
+    class GameObject {
+    public:
+        virtual void Update(float deltaTime) = 0;
+        virtual void Draw(gfx::DrawList& out) = 0;
+        virtual ~GameObject() = default;
+    };
+
+    // The bird character
+    class Bird : public GameObject {
+    private:
+        Vector2 m_position;
+        float m_velocityY;
+        float m_radius;
+        float m_health;
+        int m_screenW, m_screenH;
+
+    public:
+        Bird(int screenW, int screenH)
+            : m_position({(float)screenW / 4, (float)screenH / 2}), // Start in the middle-left
+              m_velocityY(0.0f),
+              m_radius(FLAPPY_BIRD_RADIUS),
+              m_health(FLAPPY_INITIAL_HEALTH),
+              m_screenW(screenW), m_screenH(screenH)
+        {
+        }
+
+        Vector2 getPosition() const { return m_position; }
+        float getRadius() const { return m_radius; }
+        float getHealth() const { return m_health; }
+        float getVelocityY() const { return m_velocityY; }
+
+        void setPosition(Vector2 pos) { m_position = pos; }
+        void setVelocityY(float velocity) { m_velocityY = velocity; }
+        void setHealth(float health) { m_health = health; }
+
+        void Jump() {
+            m_velocityY = FLAPPY_BIRD_JUMP_STRENGTH; // Apply upward velocity
+        }
+
+        void takeDamage(float amount) {
+            m_health -= amount;
+            if (m_health < 0) {
+                m_health = 0;
+            }
+        }
+
+        void Update(float deltaTime) override {
+            m_velocityY += FLAPPY_GRAVITY * deltaTime; // Apply gravity
+            m_position.y += m_velocityY * deltaTime;    // Update vertical position
+
+            // Keep bird within vertical bounds of the screen
+            if (m_position.y < m_radius * 1.5f) {
+                m_position.y = m_radius * 1.5f;
+                m_velocityY = 0;
+            }
+            if (m_position.y > m_screenH - m_radius * 1.5f) {
+                m_position.y = m_screenH - m_radius * 1.5f;
+                m_velocityY = 0;
+            }
+        }
+
+        // The body: a slightly-squashed rectangle around the bird's position
+        Rectangle BodyRect() const {
+            float bodyWidth = m_radius * 2.0f;
+            float bodyHeight = m_radius * 2.5f;
+            return { m_position.x - bodyWidth / 2, m_position.y - bodyHeight / 2, bodyWidth, bodyHeight };
+        }
+
+        void Draw(gfx::DrawList& out) override {
+            out.DrawSprite(gfx::Sprite::FLAPPY_CREATURE, BodyRect());
+        }
+
+        // The bird's sprite: rounded body and legs with a visor, in 'body'
+        static void DrawShape(gfx::DrawList& out, Rectangle body, Color color) {
+            float radius = body.width / 2;
+            float legHeight = radius * 0.8f;
+            float legWidth = radius * 0.7f;
+            float visorWidth = radius * 1.2f;
+            float visorHeight = radius * 0.8f;
+            float centerX = body.x + radius;
+
+            out.DrawRectangleRounded(body, 0.5f, 8, color);
+
+            // Draw legs
+            Rectangle leftLegRect = { body.x + radius * 0.2f, body.y + body.height - legHeight, legWidth, legHeight };
+            out.DrawRectangleRounded(leftLegRect, 0.5f, 8, color);
+            Rectangle rightLegRect = { body.x + body.width - legWidth - radius * 0.2f, body.y + body.height - legHeight, legWidth, legHeight };
+            out.DrawRectangleRounded(rightLegRect, 0.5f, 8, color);
+
+            // Draw a visor/eye
+            float visorY = body.y + visorHeight / 2 + radius * 0.3f;
+            out.DrawEllipse((int)centerX, (int)visorY, visorWidth / 2, visorHeight / 2, SKYBLUE);
+            out.DrawEllipseLines((int)centerX, (int)visorY, visorWidth / 2, visorHeight / 2, DARKBLUE);
+        }
+    };
+
+    // Component for the pipes that the bird needs to avoid
+    struct Pipe {
+        Rectangle topRect;
+        Rectangle bottomRect;
+        bool scored; // Has the player scored by passing this pipe?
+    };
+
+    static Pipe MakePipe(float startX, float gapY, int screenH) {
+        // Calculate dimensions for top and bottom pipes based on gapY
+        Pipe pipe;
+        std::memset(&pipe, 0, sizeof(pipe)); // Padding too: saved states are hashed byte for byte
+        pipe.topRect = {startX, 0, (float)FLAPPY_PIPE_WIDTH, gapY - FLAPPY_PIPE_GAP / 2};
+        pipe.bottomRect = {startX, gapY + FLAPPY_PIPE_GAP / 2, (float)FLAPPY_PIPE_WIDTH, (float)screenH - (gapY + FLAPPY_PIPE_GAP / 2)};
+        pipe.scored = false;
+        return pipe;
+    }
+
+    FlappyLevel(int screenW, int screenH);
+    ~FlappyLevel() override;
+
+    void Load() override;
+    void Unload() override;
+    void Update(float deltaTime) override;
+    void Draw(gfx::DrawList& out) override;
+    LevelOutcome GetOutcome() const override;
+    int GetScore() const override;
+
+    static constexpr LevelTypeId TYPE_ID = LevelTypeId::FLAPPY;
+    static constexpr const char* NAME = "Flappy Level";
+    static constexpr bool SPLIT_SCREEN = true; // Lays itself out from the screen size, so it can be played at half width
+    static constexpr const char* INSTRUCTIONS = "Press SPACE to make your character flap.\n \n Avoid hitting the pipes and the ground. \n \nGet a score of 10 to win.";
+    LevelTypeId GetTypeId() const override { return TYPE_ID; }
+    const char* GetName() const override { return NAME; }
+    const char* GetInstructions() const override { return INSTRUCTIONS; }
+
+    const char* CheckInvariants() override;
+    class Bot;
+
+protected:
+    void SaveLevelState(state::Writer& out) const override;
+    void LoadLevelState(state::Reader& in) override;
+
+private:
+    Bird m_bird;
+    int m_score;
+    FlappyGameScreen m_currentScreen; // Current state of this level
+
+    rng::Stream m_pipeStream; // Gap positions
+
+    bool m_levelFinished; // True when this specific level is done
+    bool m_playerWonLevel; // True if player won this level
+
+    void GenerateNewPipe();
+    void ResetPipes();     // Clears the course and spawns the two starting pipes
+    float RightmostPipeX();
+    void InitFlappyGame(); // Sets up a new Flappy game instance
+    int RandomGapY() { return m_pipeStream.Range(FLAPPY_PIPE_GAP, screenHeight - FLAPPY_PIPE_GAP); }
+};
+
+FlappyLevel::FlappyLevel(int screenW, int screenH)
+    : Levels(screenW, screenH),
+      m_bird(screenW, screenH),
+      m_score(0),
+      m_currentScreen(FLAPPY_MENU),
+      m_levelFinished(false),
+      m_playerWonLevel(false)
+{
+    // Pipes move from right to left; the ones that left the screen are removed
+    systems.Add(ecs::Phase::Update, "ScrollPipes", [](ecs::World& w, float deltaTime) {
+        w.Each<Pipe>([&](ecs::Entity e, Pipe& pipe) {
+            pipe.topRect.x -= FLAPPY_PIPE_SPEED * deltaTime;
+            pipe.bottomRect.x -= FLAPPY_PIPE_SPEED * deltaTime;
+            if (pipe.topRect.x + FLAPPY_PIPE_WIDTH < 0) {
+                w.Destroy(e);
+            }
+        });
+    });
+}
+
+FlappyLevel::~FlappyLevel() {
+    Unload();
+}
+
+void FlappyLevel::InitFlappyGame() {
+    m_bird = Bird(screenWidth, screenHeight);
+    m_score = 0;
+    m_levelFinished = false;
+    m_playerWonLevel = false;
+    m_pipeStream = random.Fork(random.Next()); // New course every game
+    ResetPipes();
+    m_currentScreen = FLAPPY_MENU; // Start at the menu for this level
+}
+
+void FlappyLevel::Load() {
+    InitFlappyGame(); // Reset and set up the game
+    audio::g_effects.Prepare({audio::Effect::FLAP, audio::Effect::HIT, audio::Effect::COIN});
+}
+
+void FlappyLevel::Unload() {
+    ResetLevelMemory(); // Pipes live in the level arena
+}
+
+void FlappyLevel::ResetPipes() {
+    world.Clear();
+    // Add initial pipes, spaced out from the start
+    world.Create(MakePipe((float)screenWidth, (float)RandomGapY(), screenHeight));
+    world.Create(MakePipe((float)screenWidth + FLAPPY_MIN_HORIZONTAL_PIPE_SPACING, (float)RandomGapY(), screenHeight));
+}
+
+float FlappyLevel::RightmostPipeX() {
+    float maxX = -1.0f;
+    world.Each<Pipe>([&](const Pipe& pipe) { maxX = std::max(maxX, pipe.topRect.x); });
+    return maxX;
+}
+
+void FlappyLevel::GenerateNewPipe() {
+    float gapY = (float)RandomGapY(); // Random Y position for the gap
+    // Determine X position for the new pipe
+    float newPipeX = world.Count<Pipe>() == 0 ? (float)screenWidth : RightmostPipeX() + FLAPPY_MIN_HORIZONTAL_PIPE_SPACING;
+    world.Create(MakePipe(newPipeX, gapY, screenHeight));
+}
+
+void FlappyLevel::Update(float deltaTime) {
+    switch (m_currentScreen) {
+        case FLAPPY_MENU: {
+            if (input::KeyPressed(KEY_SPACE)) { // Start game on spacebar press
+                m_currentScreen = FLAPPY_PLAYING;
+            }
+        } break;
+        case FLAPPY_PLAYING: {
+            m_bird.Update(deltaTime);
+
+            systems.Run(ecs::Phase::Update, world, deltaTime); // Scroll pipes
+
+            bool collisionOccurred = false;
+            world.Each<Pipe>([&](Pipe& pipe) {
+                // Check for collision with top or bottom pipe
+                if (CheckCollisionCircleRec(m_bird.getPosition(), m_bird.getRadius(), pipe.topRect) ||
+                    CheckCollisionCircleRec(m_bird.getPosition(), m_bird.getRadius(), pipe.bottomRect)) {
+                    collisionOccurred = true;
+                }
+
+                // Score if bird passed the pipe and hasn't scored yet for this pipe
+                if (!pipe.scored && pipe.topRect.x + FLAPPY_PIPE_WIDTH < m_bird.getPosition().x - m_bird.getRadius()) {
+                    m_score++;
+                    pipe.scored = true;
+                    telemetry::Emit(telemetry::EventType::PIPE_PASSED, m_score, m_bird.getPosition().x, m_bird.getPosition().y);
+                    audio::Play(audio::Effect::COIN, 0.6f, audio::PanAt(m_bird.getPosition().x, screenWidth));
+                }
+            });
+
+            // Check for collision with top/bottom screen edges
+            if (m_bird.getPosition().y + m_bird.getRadius() >= screenHeight || m_bird.getPosition().y - m_bird.getRadius() <= 0) {
+                 collisionOccurred = true;
+            }
+
+            // Handle collisions
+            if (collisionOccurred) {
+                m_bird.takeDamage(FLAPPY_DAMAGE_PER_HIT); // Take damage
+                telemetry::Emit(telemetry::EventType::PLAYER_HIT, (int32_t)m_bird.getHealth(), m_bird.getPosition().x, m_bird.getPosition().y);
+                audio::Play(audio::Effect::HIT, 1.0f, audio::PanAt(m_bird.getPosition().x, screenWidth));
+                if (m_bird.getHealth() <= 0) {
+                    m_currentScreen = FLAPPY_GAME_OVER; // Game over if no health left
+                    m_levelFinished = true;
+                    m_playerWonLevel = false;
+                } else {
+                    // Reset bird position and clear pipes for a "retry"
+                    m_bird.setPosition({(float)screenWidth / 4, (float)screenHeight / 2});
+                    m_bird.setVelocityY(0.0f);
+                    ResetPipes();
+                }
+            }
+
+            // Generate new pipes if needed
+            if (RightmostPipeX() < screenWidth - FLAPPY_MIN_HORIZONTAL_PIPE_SPACING) {
+                GenerateNewPipe();
+            }
+
+            // Check for win condition
+            if (m_score >= FLAPPY_WIN_SCORE) {
+                m_currentScreen = FLAPPY_WIN;
+                m_levelFinished = true;
+                m_playerWonLevel = true;
+            }
+
+            if (input::KeyPressed(KEY_SPACE)) { // Player jumps on spacebar press
+                m_bird.Jump();
+                audio::Play(audio::Effect::FLAP, 0.5f, audio::PanAt(m_bird.getPosition().x, screenWidth));
+            }
+        } break;
+        default: break;
+    }
+}
+
+void FlappyLevel::Draw(gfx::DrawList& out) {
+    // Draw all active pipes
+    world.Each<Pipe>([&](const Pipe& pipe) {
+        out.DrawRectangleRec(pipe.topRect, GREEN);
+        out.DrawRectangleRec(pipe.bottomRect, GREEN);
+        out.DrawRectangleLinesEx(pipe.topRect, 2, DARKGREEN);
+        out.DrawRectangleLinesEx(pipe.bottomRect, 2, DARKBROWN);
+    });
+
+    out.SetLayer(gfx::Layer::ACTORS);
+    m_bird.Draw(out); // Draw the bird
+
+    // Draw ground
+    out.SetLayer(gfx::Layer::FOREGROUND);
+    out.DrawRectangle(0, screenHeight - 20, screenWidth, 20, BROWN);
+    out.DrawRectangleLines(0, screenHeight - 20, screenWidth, 20, DARKBROWN);
+
+    // Display score
+    out.SetLayer(gfx::Layer::HUD);
+    out.DrawText(mem::ScratchFormat("Score: %02i", m_score), 10, 10, FLAPPY_FONT_SIZE, WHITE);
+
+    // Draw health bar
+    int healthBarX = screenWidth - 10 - 100;
+    int healthBarY = 10;
+    int healthBarWidth = 100;
+    int healthBarHeight = 20;
+
+    out.DrawRectangle(healthBarX, healthBarY, healthBarWidth, healthBarHeight, DARKGRAY);
+    out.DrawRectangle(healthBarX, healthBarY, (int)(m_bird.getHealth() / FLAPPY_INITIAL_HEALTH * healthBarWidth), healthBarHeight, RED);
+    out.DrawRectangleLines(healthBarX, healthBarY, healthBarWidth, healthBarHeight, WHITE);
+    out.DrawText(mem::ScratchFormat("Health: %.0f", m_bird.getHealth()), healthBarX, healthBarY + healthBarHeight + 5, 20, WHITE);
+
+    // Draw different screens based on current level state
+    switch (m_currentScreen) {
+        case FLAPPY_MENU: {
+            out.DrawText("FLAPPY", screenWidth / 2 - MeasureText("FLAPPY", FLAPPY_FONT_SIZE * 1.5f) / 2, screenHeight / 4, FLAPPY_FONT_SIZE * 1.5f, WHITE);
+            out.DrawText("Press SPACE to Start", screenWidth / 2 - MeasureText("Press SPACE to Start", FLAPPY_FONT_SIZE) / 2, screenHeight / 2, FLAPPY_FONT_SIZE, GRAY);
+        } break;
+        case FLAPPY_GAME_OVER: {
+            out.DrawText("GAME OVER!", screenWidth / 2 - MeasureText("GAME OVER!", FLAPPY_FONT_SIZE * 1.5f) / 2, screenHeight / 4, FLAPPY_FONT_SIZE * 1.5f, RED);
+            out.DrawText(mem::ScratchFormat("Final Score: %02i", m_score), screenWidth / 2 - MeasureText(mem::ScratchFormat("Final Score: %02i", m_score), FLAPPY_FONT_SIZE) / 2, screenHeight / 2 - FLAPPY_FONT_SIZE / 2, FLAPPY_FONT_SIZE, WHITE);
+        } break;
+        case FLAPPY_WIN: {
+            out.DrawText("LEVEL COMPLETE!", screenWidth / 2 - MeasureText("LEVEL COMPLETE!", FLAPPY_FONT_SIZE * 1.5f) / 2, screenHeight / 4, FLAPPY_FONT_SIZE * 1.5f, GOLD);
+            out.DrawText(mem::ScratchFormat("Final Score: %02i", m_score), screenWidth / 2 - MeasureText(mem::ScratchFormat("Final Score: %02i", m_score), FLAPPY_FONT_SIZE) / 2, screenHeight / 2 - FLAPPY_FONT_SIZE / 2, FLAPPY_FONT_SIZE, WHITE);
+        } break;
+        default: break;
+    }
+}
+
+LevelOutcome FlappyLevel::GetOutcome() const {
+    if (!m_levelFinished) return LevelOutcome::IN_PROGRESS; // Level is complete when the internal state says so
+    return m_playerWonLevel ? LevelOutcome::WON : LevelOutcome::LOST;
+}
+
+int FlappyLevel::GetScore() const {
+    return m_score;
+}
+
+const char* FlappyLevel::CheckInvariants() {
+    float health = m_bird.getHealth();
+    if (!(health >= 0 && health <= FLAPPY_INITIAL_HEALTH)) return "health out of range";
+    float y = m_bird.getPosition().y;
+    if (!(y >= m_bird.getRadius() * 1.5f && y <= screenHeight - m_bird.getRadius() * 1.5f)) return "bird outside its vertical bounds";
+    if (m_score < 0 || m_score > FLAPPY_WIN_SCORE) return "score out of range";
+    if (world.Count<Pipe>() > 8) return "pipes are piling up"; // A screen holds about five
+    return nullptr;
+}
+
+void FlappyLevel::SaveLevelState(state::Writer& out) const {
+    out.Write(m_bird.getPosition()); out.Write(m_bird.getVelocityY()); out.Write(m_bird.getHealth());
+    out.Write(m_score); out.Write(m_currentScreen);
+    out.Write(m_pipeStream);
+    out.Write(m_levelFinished); out.Write(m_playerWonLevel);
+}
+
+void FlappyLevel::LoadLevelState(state::Reader& in) {
+    m_bird.setPosition(in.Read<Vector2>()); m_bird.setVelocityY(in.Read<float>()); m_bird.setHealth(in.Read<float>());
+    in.Read(m_score); in.Read(m_currentScreen);
+    in.Read(m_pipeStream);
+    in.Read(m_levelFinished); in.Read(m_playerWonLevel);
+}
+
+// Plays Flappy: every step it plays out the next 1.5 seconds (HORIZON steps) both ways, jumping now or not,
+// each time keeping to the gap of the pipe ahead afterwards, and jumps only if that
+// keeps the bird alive for longer. The play-out moves a copy of the level's own bird.
+class FlappyLevel::Bot : public LevelBot {
+public:
+    explicit Bot(FlappyLevel& level) : m_level(level) { m_pipes.reserve(16); } // More than ever fit on screen
+
+    input::InputState NextInput() override {
+        input::InputState state;
+        if (m_level.m_currentScreen == FLAPPY_MENU) {
+            input::Press(state, KEY_SPACE); // Start the game
+        } else if (m_level.m_currentScreen == FLAPPY_PLAYING) {
+            m_pipes.clear();
+            m_level.world.Each<Pipe>([&](const Pipe& pipe) { m_pipes.push_back(pipe); });
+            if (StepsSurvived(true) > StepsSurvived(false)) input::Press(state, KEY_SPACE);
+        }
+        return state;
+    }
+
+private:
+    static constexpr int HORIZON = 90; // Steps played out per choice
+
+    FlappyLevel& m_level;
+    std::vector<Pipe> m_pipes; // This step's pipes, copied once
+
+    // Mirrors the order of FlappyLevel::Update: the bird moves, pipes scroll, collisions, then the jump
+    int StepsSurvived(bool jumpNow) const {
+        Bird bird = m_level.m_bird;
+        for (int step = 0; step < HORIZON; ++step) {
+            bird.Update(STEP_SECONDS);
+            float scrolled = FLAPPY_PIPE_SPEED * STEP_SECONDS * (step + 1);
+            Vector2 position = bird.getPosition();
+            float radius = bird.getRadius();
+            float targetY = (float)m_level.screenHeight / 2;
+            float nextPipeX = (float)m_level.screenWidth;
+            for (const Pipe& pipe : m_pipes) {
+                Rectangle top = pipe.topRect, bottom = pipe.bottomRect;
+                top.x -= scrolled;
+                bottom.x -= scrolled;
+                if (CheckCollisionCircleRec(position, radius, top) || CheckCollisionCircleRec(position, radius, bottom)) return step;
+                if (top.x + top.width >= position.x - radius && top.x < nextPipeX) {
+                    nextPipeX = top.x;
+                    targetY = top.height + FLAPPY_PIPE_GAP / 2;
+                }
+            }
+            if (step == 0 ? jumpNow : position.y > targetY + 10.0f) bird.Jump();
+        }
+        return HORIZON;
+    }
+};
+
+
+// Constants specific to the Obstacle Level
+const float OBSTACLE_PLAYER_SIZE = 40.0f;
+const float OBSTACLE_PLAYER_SPEED = 200.0f; 
+const float OBSTACLE_JUMP_FORCE = 400.0f;
+const float OBSTACLE_GRAVITY = 800.0f;
+const Color OBSTACLE_DOOR_COLOR = BROWN; // Baked into the door's sprite
+
+
+// Our fourth level: the Obstacle Course!
+class ObstacleLevel : public Levels {
+public:
+    // Internal screens for the Obstacle level
+    enum ObstacleGameScreen {
+        OBSTACLE_TITLE = 0, // Title screen for this specific level (not used much now)
+        OBSTACLE_GAMEPLAY,  // Where the actual running and jumping happens
+        OBSTACLE_ENDING     // Win/loss screen for this level
+    };
+
+    // Base class for game objects in Obstacle Level
+    class GameObject {
+    protected:
+        Vector2 position;
+        Rectangle bounds;
+        Color color;
+
+    public:
+        GameObject() : position({0, 0}), bounds({0, 0, 0, 0}), color(WHITE) {}
+        GameObject(Vector2 pos, float width, float height, Color col)
+            : position(pos), bounds({pos.x, pos.y, width, height}), color(col) {}
+        GameObject(const GameObject& other)
+            : position(other.position), bounds(other.bounds), color(other.color) {}
+
+        virtual ~GameObject() = default;
+
+        virtual void Draw(gfx::DrawList& out) const = 0;
+        virtual void Update(float dt) {} // Default: static objects don't update
+
+        Rectangle GetBounds() const { return bounds; }
+        Vector2 GetPosition() const { return position; }
+        void SetPosition(Vector2 newPos) {
+            position = newPos;
+            bounds.x = newPos.x;
+            bounds.y = newPos.y;
+        }
+    };
+
+    // The player character for the Obstacle level
+    class Player : public GameObject {
+    private:
+        Vector2 velocity;
+        bool onGround;
+        bool jumped;
+        int m_screenW, m_screenH;
+
+    public:
+        Player(int screenW, int screenH)
+            : GameObject({100.0f, (float)screenH - OBSTACLE_PLAYER_SIZE - 50.0f}, OBSTACLE_PLAYER_SIZE, OBSTACLE_PLAYER_SIZE, PURPLE),
+              velocity({0, 0}), onGround(false), jumped(false), m_screenW(screenW), m_screenH(screenH) {}
+
+        Player(Vector2 pos, float size, Color col, int screenW, int screenH)
+            : GameObject(pos, size, size, col), velocity({0, 0}), onGround(false), jumped(false), m_screenW(screenW), m_screenH(screenH) {}
+
+        Player(const Player& other)
+            : GameObject(other), velocity(other.velocity), onGround(other.onGround), jumped(other.jumped), m_screenW(other.m_screenW), m_screenH(other.m_screenH) {}
+
+        ~Player() override = default;
+
+        void Draw(gfx::DrawList& out) const override {
+            out.DrawRectangleRounded(bounds, 0.5f, 8, color); // Main body
+            // Little decorative bits for the player
+            out.DrawRectangle(bounds.x - bounds.width * 0.2f, bounds.y + bounds.height * 0.1f, bounds.width * 0.2f, bounds.height * 0.6f, ColorAlpha(color, 0.8f));
+            Rectangle visor = {bounds.x + bounds.width * 0.2f, bounds.y + bounds.height * 0.2f, bounds.width * 0.6f, bounds.height * 0.3f};
+            out.DrawRectangleRounded(visor, 0.5f, 8, SKYBLUE);
+            out.DrawRectangleRoundedLines(visor, 0.5f, 8, 2, DARKBLUE);
+        }
+
+        void Update(float dt) override {
+            velocity.y += OBSTACLE_GRAVITY * dt; // Apply gravity
+
+            // Handle horizontal movement
+            if (input::KeyDown(KEY_LEFT)) {
+                velocity.x = -OBSTACLE_PLAYER_SPEED;
+            } else if (input::KeyDown(KEY_RIGHT)) {
+                velocity.x = OBSTACLE_PLAYER_SPEED;
+            } else {
+                velocity.x = 0;
+            }
+
+            // Handle jumping
+            if (input::KeyPressed(KEY_SPACE) && onGround) {
+                velocity.y = -OBSTACLE_JUMP_FORCE; // Instant upward force
+                onGround = false;
+                jumped = true;
+            }
+
+            position.x += velocity.x * dt; // Update horizontal position
+            position.y += velocity.y * dt; // Update vertical position
+
+            bounds.x = position.x;
+            bounds.y = position.y;
+
+            // Keep player within horizontal screen bounds
+            if (position.x < 0) {
+                position.x = 0;
+                velocity.x = 0;
+            } else if (position.x + bounds.width > m_screenW) {
+                position.x = m_screenW - bounds.width;
+                velocity.x = 0;
+            }
+            onGround = false; // Assume off ground until collision detects otherwise
+        }
+
+        Vector2 GetVelocity() const { return velocity; }
+        bool IsOnGround() const { return onGround; }
+        bool HasJumped() const { return jumped; }
+
+        void SetVelocity(Vector2 newVel) { velocity = newVel; }
+        void SetOnGround(bool status) { onGround = status; }
+        void SetJumped(bool status) { jumped = status; }
+
+        // Comparison for player state (useful for debugging/testing)
+        bool operator==(const Player& other) const {
+            return (position.x == other.position.x && position.y == other.position.y);
+        }
+    };
+
+    // Rectangular obstacles are ECS entities with Body, Tint and Solid
+    static void DrawObstacle(gfx::DrawList& out, const Rectangle& bounds, Color color) {
+        out.DrawRectangleRec(bounds, color);
+    }
+
+    // Collectible coins are ECS entities with Body, Tint and Collectible
+    static void DrawCoin(gfx::DrawList& out, const Rectangle& bounds, Color color) {
+        // Draw a circle with a dollar sign on it
+        out.DrawCircle((int)(bounds.x + bounds.width / 2), (int)(bounds.y + bounds.height / 2), bounds.width / 2, color);
+        out.DrawCircleLines((int)(bounds.x + bounds.width / 2), (int)(bounds.y + bounds.height / 2), bounds.width / 2, DARKGRAY);
+        const char* dollarSign = "$";
+        int fontSize = (int)(bounds.width * 0.6f);
+        int textWidth = MeasureText(dollarSign, fontSize);
+        out.DrawText(dollarSign, (int)(bounds.x + bounds.width / 2 - textWidth / 2), (int)(bounds.y + bounds.height / 2 - fontSize / 2), fontSize, BROWN);
+    }
+
+    // The exit door to complete the level
+    class ExitDoor : public GameObject {
+    public:
+        ExitDoor() : GameObject() {}
+        ExitDoor(Rectangle rect, Color col) : GameObject({rect.x, rect.y}, rect.width, rect.height, col) {}
+        ExitDoor(const ExitDoor& other) : GameObject(other) {}
+        ~ExitDoor() override = default;
+
+        void Draw(gfx::DrawList& out) const override {
+            out.DrawSprite(gfx::Sprite::EXIT_DOOR, bounds);
+            out.DrawText("EXIT", (int)bounds.x + 5, (int)bounds.y - 20, 15, WHITE);
+        }
+
+        // The door's sprite: a rectangular door with panels, outlines scaled from a 50x80 door
+        static void DrawShape(gfx::DrawList& out, Rectangle bounds, Color color) {
+            float line = bounds.width / 50;
+            out.DrawRectangleRec(bounds, color);
+            out.DrawRectangleLinesEx(bounds, 3 * line, BLACK);
+            Rectangle panel1 = {bounds.x + bounds.width * 0.1f, bounds.y + bounds.height * 0.1f, bounds.width * 0.8f, bounds.height * 0.4f};
+            Rectangle panel2 = {bounds.x + bounds.width * 0.1f, bounds.y + bounds.height * 0.55f, bounds.width * 0.8f, bounds.height * 0.35f};
+            out.DrawRectangleRec(panel1, DARKBROWN);
+            out.DrawRectangleRec(panel2, DARKBROWN);
+            out.DrawRectangleLinesEx(panel1, 2 * line, BLACK);
+            out.DrawRectangleLinesEx(panel2, 2 * line, BLACK);
+        }
+        void Update(float dt) override {}
+    };
+
+    ObstacleLevel(int screenW, int screenH);
+    ~ObstacleLevel() override;
+
+    void Load() override;
+    void Unload() override;
+    void Update(float dt) override;
+    void Draw(gfx::DrawList& out) override;
+    LevelOutcome GetOutcome() const override;
+    int GetScore() const override;
+
+    static constexpr LevelTypeId TYPE_ID = LevelTypeId::OBSTACLE_COURSE;
+    static constexpr const char* NAME = "Obstacle Course Level";
+    static constexpr bool SPLIT_SCREEN = false; // Its layout is fixed to the full screen
+    static constexpr const char* INSTRUCTIONS = "Use LEFT/RIGHT arrows to move. \n \n Press SPACE to jump. \n \n Collect all coins and reach the EXIT door to win!";
+    LevelTypeId GetTypeId() const override { return TYPE_ID; }
+    const char* GetName() const override { return NAME; }
+    const char* GetInstructions() const override { return INSTRUCTIONS; }
+
+    const char* CheckInvariants() override;
+    class Bot;
+
+protected:
+    void SaveLevelState(state::Writer& out) const override;
+    void LoadLevelState(state::Reader& in) override;
+
+private:
+    Player m_player;
+    ExitDoor m_exitDoor;
+    ObstacleGameScreen m_currentScreen;
+    bool m_levelFinished;
+    bool m_playerWonLevel;
+    Vector2 m_startPoint; // Player's starting position
+    int m_collectedCoins;
+    int m_totalCoins;
+
+    void InitObstacleGame(); // Setup for a new game in this level
+    void AddPlatform(Rectangle rect);
+    void ResolvePlayerCollisions(Player& player, float dt); // Lands, bumps or blocks 'player' against every platform
+};
+
+ObstacleLevel::ObstacleLevel(int screenW, int screenH)
+    : Levels(screenW, screenH),
+      m_player(screenW, screenH),
+      m_exitDoor(),
+      m_currentScreen(OBSTACLE_TITLE),
+      m_levelFinished(false),
+      m_playerWonLevel(false),
+      m_startPoint({0,0}),
+      m_collectedCoins(0),
+      m_totalCoins(0)
+{
+    // Pick up any coin the player touches
+    systems.Add(ecs::Phase::Update, "CollectCoins", [this](ecs::World& w, float) {
+        w.Each<ecs::Body, ecs::Collectible>([&](ecs::Entity e, const ecs::Body& body, const ecs::Collectible& coin) {
+            if (CheckCollisionRecs(m_player.GetBounds(), body.rect)) {
+                m_collectedCoins += coin.value;
+                telemetry::Emit(telemetry::EventType::COIN_COLLECTED, coin.value, body.rect.x, body.rect.y);
+                audio::Play(audio::Effect::COIN, 0.8f, audio::PanAt(body.rect.x, screenWidth));
+                w.Destroy(e); // Remove collected coin
+            }
+        });
+    });
+}
+
+ObstacleLevel::~ObstacleLevel() {
+    Unload();
+}
+
+void ObstacleLevel::InitObstacleGame() {
+    // Reset player and set starting point
+    m_player = Player({100.0f, (float)screenHeight - OBSTACLE_PLAYER_SIZE - 50.0f}, OBSTACLE_PLAYER_SIZE, PURPLE, screenWidth, screenHeight);
+    m_startPoint = m_player.GetPosition();
+
+    // Set the exit door's position
+    m_exitDoor = ExitDoor({ (float)screenWidth - 100.0f, 50.0f, 50.0f, 80.0f }, OBSTACLE_DOOR_COLOR);
+
+    world.Clear();
+
+    // Add ground obstacle (bottom of the screen)
+    AddPlatform(Rectangle{ 0, (float)screenHeight - 50, (float)screenWidth, 50 });
+
+    // Add various platforms as obstacles
+    AddPlatform(Rectangle{ 150, (float)screenHeight - 150, 100, 20 });
+    AddPlatform(Rectangle{ 300, (float)screenHeight - 250, 90, 20 });
+    AddPlatform(Rectangle{ 450, (float)screenHeight - 350, 80, 20 });
+
+    AddPlatform(Rectangle{ 550, (float)screenHeight - 300, 60, 20 });
+    AddPlatform(Rectangle{ 700, (float)screenHeight - 300, 60, 20 });
+
+    AddPlatform(Rectangle{ 800, (float)screenHeight - 400, 50, 20 });
+    AddPlatform(Rectangle{ 900, (float)screenHeight - 500, 50, 20 });
+    AddPlatform(Rectangle{ 800, (float)screenHeight - 600, 50, 20 });
+
+    AddPlatform(Rectangle{ 950, (float)screenHeight - 550, 60, 20 });
+    AddPlatform(Rectangle{ 1100, (float)screenHeight - 450, 70, 20 });
+
+    AddPlatform(Rectangle{ 1150, (float)screenHeight - 300, 50, 20 });
+    AddPlatform(Rectangle{ (float)screenWidth - 150, (float)screenHeight - 100, 100, 20 });
+    AddPlatform(Rectangle{ 1000, (float)screenHeight - 200, 80, 20 });
+
+    // Spawn coins above platforms
+    float coinSize = 20.0f;
+    mem::ScratchVector<Rectangle> coinSpots;
+    world.Each<ecs::Body, ecs::Solid>([&](const ecs::Body& obs, const ecs::Solid&) {
+        if (obs.rect.height < 50 && obs.rect.y < screenHeight - 50) { // Only add coins to platforms
+            coinSpots.push_back({ obs.rect.x + obs.rect.width / 2 - coinSize / 2, obs.rect.y - coinSize - 10, coinSize, coinSize });
+        }
+    });
+    for (const Rectangle& spot : coinSpots) {
+        world.Create(ecs::Body{ spot }, ecs::Tint{ YELLOW }, ecs::Collectible{ 1 });
+    }
+    m_totalCoins = (int)world.Count<ecs::Collectible>(); // Keep track of total coins
+    m_collectedCoins = 0;
+
+    m_currentScreen = OBSTACLE_GAMEPLAY; // Start directly in gameplay for this level
+    m_levelFinished = false;
+    m_playerWonLevel = false;
+}
+
+void ObstacleLevel::AddPlatform(Rectangle rect) {
+    world.Create(ecs::Body{ rect }, ecs::Tint{ BLUE }, ecs::Solid{});
+}
+
+void ObstacleLevel::Load() {
+    InitObstacleGame(); // Prepare the level for play
+    audio::g_effects.Prepare({audio::Effect::JUMP, audio::Effect::COIN});
+}
+
+void ObstacleLevel::Unload() {
+    ResetLevelMemory(); // Platforms and coins live in the level arena
+}
+
+void ObstacleLevel::ResolvePlayerCollisions(Player& player, float dt) {
+    world.Each<ecs::Body, ecs::Solid>([&](const ecs::Body& obs, const ecs::Solid&) {
+        const Rectangle obsBounds = obs.rect;
+        if (CheckCollisionRecs(player.GetBounds(), obsBounds)) {
+            // Check for collision from above (landing on platform)
+            if (player.GetVelocity().y > 0 && player.GetBounds().y + player.GetBounds().height - player.GetVelocity().y * dt <= obsBounds.y) {
+                player.SetPosition({player.GetPosition().x, obsBounds.y - player.GetBounds().height});
+                player.SetVelocity({player.GetVelocity().x, 0}); // Stop vertical movement
+                player.SetOnGround(true);
+                player.SetJumped(false);
+            }
+            // Check for collision from below (hitting head on platform)
+            else if (player.GetVelocity().y < 0 && player.GetBounds().y - player.GetBounds().y * dt >= obsBounds.y + obsBounds.height) {
+                player.SetPosition({player.GetPosition().x, obsBounds.y + obsBounds.height});
+                player.SetVelocity({player.GetVelocity().x, 0}); // Stop upward movement
+            }
+            // Check for collision from left (hitting side of platform)
+            else if (player.GetVelocity().x > 0 && player.GetBounds().x + player.GetBounds().width - player.GetVelocity().x * dt <= obsBounds.x) {
+                player.SetPosition({obsBounds.x - player.GetBounds().width, player.GetPosition().y});
+                player.SetVelocity({0, player.GetVelocity().y}); // Stop horizontal movement
+            }
+            // Check for collision from right (hitting side of platform)
+            else if (player.GetVelocity().x < 0 && player.GetBounds().x - player.GetVelocity().x * dt >= obsBounds.x + obsBounds.width) {
+                player.SetPosition({obsBounds.x + obsBounds.width, player.GetPosition().y});
+                player.SetVelocity({0, player.GetVelocity().y}); // Stop horizontal movement
+            }
+        }
+    });
+}
+
+void ObstacleLevel::Update(float dt) {
+    switch (m_currentScreen) {
+        case OBSTACLE_GAMEPLAY: {
+            bool couldJump = m_player.IsOnGround();
+            m_player.Update(dt); // Update player physics and input
+            if (couldJump && m_player.GetVelocity().y <= -OBSTACLE_JUMP_FORCE) { // Only a take-off leaves the ground this fast
+                audio::Play(audio::Effect::JUMP, 0.6f, audio::PanAt(m_player.GetPosition().x, screenWidth));
+            }
+
+            m_player.SetOnGround(false); // Assume airborne until collision with ground/platform
+
+            ResolvePlayerCollisions(m_player, dt); // Handle player-obstacle collisions
+
+            systems.Run(ecs::Phase::Update, world, dt); // Coin collection
+
+            // Check if player fell off the screen (game over)
+            if (m_player.GetPosition().y > screenHeight) {
+                m_levelFinished = true;
+                m_playerWonLevel = false;
+                m_currentScreen = OBSTACLE_ENDING;
+            }
+
+            // Check for level completion (reached exit door and collected all coins)
+            if (CheckCollisionRecs(m_player.GetBounds(), m_exitDoor.GetBounds())) {
+                if (m_collectedCoins == m_totalCoins) {
+                    m_playerWonLevel = true;
+                    m_levelFinished = true;
+                    m_currentScreen = OBSTACLE_ENDING;
+                }
+            }
+        } break;
+        case OBSTACLE_ENDING: {
+            // Nothing to update, waiting for main game state to change
+        } break;
+        default: break;
+    }
+}
+
+void ObstacleLevel::Draw(gfx::DrawList& out) {
+    switch (m_currentScreen) {
+        case OBSTACLE_GAMEPLAY: {
+            // Draw all obstacles and coins
+            world.Each<ecs::Body, ecs::Tint, ecs::Solid>([&](const ecs::Body& body, const ecs::Tint& tint, const ecs::Solid&) {
+                DrawObstacle(out, body.rect, tint.color);
+            });
+            world.Each<ecs::Body, ecs::Tint, ecs::Collectible>([&](const ecs::Body& body, const ecs::Tint& tint, const ecs::Collectible&) {
+                DrawCoin(out, body.rect, tint.color);
+            });
+            out.SetLayer(gfx::Layer::ACTORS);
+            m_player.Draw(out); // Draw the player
+            m_exitDoor.Draw(out); // Draw the exit door
+
+            // Draw start point indicator
+            out.DrawCircle((int)m_startPoint.x + (int)OBSTACLE_PLAYER_SIZE / 2, (int)m_startPoint.y + (int)OBSTACLE_PLAYER_SIZE / 2, 10, GREEN);
+            out.DrawText("START", (int)m_startPoint.x, (int)m_startPoint.y - 20, 15, GREEN);
+            // Display coin count
+            out.SetLayer(gfx::Layer::HUD);
+            out.DrawText(mem::ScratchFormat("Coins: %d/%d", m_collectedCoins, m_totalCoins), 10, 10, 20, WHITE);
+        } break;
+        case OBSTACLE_ENDING: {
+            // Display win or lose message
+            if (m_playerWonLevel) {
+                out.DrawText("LEVEL COMPLETE!", screenWidth / 2 - MeasureText("LEVEL COMPLETE!", 50) / 2, screenHeight / 3, 50, GOLD);
+                out.DrawText(mem::ScratchFormat("Collected: %d/%d Coins", m_collectedCoins, m_totalCoins), screenWidth / 2 - MeasureText(mem::ScratchFormat("Collected: %d/%d Coins", m_collectedCoins, m_totalCoins), 30) / 2, screenHeight / 3 + 60, 30, WHITE);
+            } else {
+                out.DrawText("GAME OVER!", screenWidth / 2 - MeasureText("GAME OVER!", 60) / 2, screenHeight / 3, 60, RED);
+            }
+        } break;
+        default: break;
+    }
+}
+
+LevelOutcome ObstacleLevel::GetOutcome() const {
+    if (!m_levelFinished) return LevelOutcome::IN_PROGRESS; // Level is complete when the internal state says so
+    return m_playerWonLevel ? LevelOutcome::WON : LevelOutcome::LOST;
+}
+
+int ObstacleLevel::GetScore() const {
+    return m_collectedCoins;
+}
+
+const char* ObstacleLevel::CheckInvariants() {
+    Vector2 position = m_player.GetPosition();
+    if (!std::isfinite(position.x) || !std::isfinite(position.y)) return "player position is not a number";
+    if (position.x < 0 || position.x + OBSTACLE_PLAYER_SIZE > screenWidth) return "player off screen";
+    if (m_collectedCoins < 0 || m_collectedCoins + (int)world.Count<ecs::Collectible>() != m_totalCoins) return "coins collected and left don't add up";
+    return nullptr;
+}
+
+// The exit door isn't saved: every game puts it in the same place
+void ObstacleLevel::SaveLevelState(state::Writer& out) const {
+    out.Write(m_player.GetPosition()); out.Write(m_player.GetVelocity());
+    out.Write(m_player.IsOnGround()); out.Write(m_player.HasJumped());
+    out.Write(m_currentScreen); out.Write(m_levelFinished); out.Write(m_playerWonLevel);
+    out.Write(m_startPoint); out.Write(m_collectedCoins); out.Write(m_totalCoins);
+}
+
+void ObstacleLevel::LoadLevelState(state::Reader& in) {
+    m_player.SetPosition(in.Read<Vector2>()); m_player.SetVelocity(in.Read<Vector2>());
+    m_player.SetOnGround(in.Read<bool>()); m_player.SetJumped(in.Read<bool>());
+    in.Read(m_currentScreen); in.Read(m_levelFinished); in.Read(m_playerWonLevel);
+    in.Read(m_startPoint); in.Read(m_collectedCoins); in.Read(m_totalCoins);
+}
+
+// Plays the obstacle course by following a fixed route over its platforms, then to the door.
+// To get to the next one it tries short plans (run for a while, maybe jump, keep running,
+// then steer for the target) on a copy of the player, moved by the level's own player and
+// collision code, and carries out the first plan that lands there. Out of reach it walks
+// towards the target and tries again.
+class ObstacleLevel::Bot : public LevelBot {
+public:
+    explicit Bot(ObstacleLevel& level) : m_level(level), m_waypoint(0), m_hasPlan(false), m_planStep(0), m_walkSteps(0) {}
+
+    input::InputState NextInput() override {
+        if (m_level.m_currentScreen != OBSTACLE_GAMEPLAY) return input::InputState();
+        if (m_platforms.empty()) {
+            m_level.world.Each<ecs::Body, ecs::Solid>([&](const ecs::Body& body, const ecs::Solid&) { m_platforms.push_back(body.rect); });
+        }
+        const Player& player = m_level.m_player;
+
+        if (m_hasPlan) {
+            if (m_planStep < m_plan.steps) return PlanInput(m_plan, m_planStep++, player);
+            m_hasPlan = false;
+        }
+
+        // Stand over the middle of a route platform (that's where its coin is) before moving on
+        if (m_waypoint < ROUTE_LENGTH && StandingOn(player, Target())) {
+            float offset = CenterX(Target()) - CenterX(player.GetBounds());
+            if (std::fabs(offset) > STEER_DEAD_ZONE) return Steer(offset);
+            ++m_waypoint;
+        }
+
+        if (m_walkSteps == 0 && player.IsOnGround() && FindPlan(player)) {
+            m_hasPlan = true;
+            m_planStep = 0;
+            return PlanInput(m_plan, m_planStep++, player);
+        }
+        m_walkSteps = m_walkSteps > 0 ? m_walkSteps - 1 : WALK_STEPS_BEFORE_REPLAN;
+        return Steer(CenterX(Target()) - CenterX(player.GetBounds()));
+    }
+
+private:
+    // Platforms by the order InitObstacleGame adds them (0 is the ground); each has a coin
+    static constexpr int ROUTE[] = { 12, 13, 11, 1, 2, 3, 4, 5, 6, 7, 8, 10, 9 };
+    static constexpr int ROUTE_LENGTH = sizeof(ROUTE) / sizeof(ROUTE[0]);
+    static constexpr float STEER_DEAD_ZONE = 2.0f;       // Pixels off target that count as on it
+    static constexpr float PLAN_REACH = 320.0f;          // Farther than this no plan can get there
+    static constexpr int MAX_RUN_STEPS = 60;
+    static constexpr int MAX_HOLD_STEPS = 45;
+    static constexpr int MAX_PLAN_STEPS = 150;
+    static constexpr int WALK_STEPS_BEFORE_REPLAN = 10;
+
+    struct Plan {
+        int runDirection; // -1 left, 0 stay, 1 right
+        int runSteps;     // Steps to run before jumping
+        bool jump;
+        int holdSteps;    // Steps to keep running after the jump before steering for the target
+        int steps;        // How long the plan takes, once simulated
+    };
+
+    ObstacleLevel& m_level;
+    std::vector<Rectangle> m_platforms;
+    int m_waypoint; // Position in ROUTE; ROUTE_LENGTH means the door
+    Plan m_plan;
+    bool m_hasPlan;
+    int m_planStep;
+    int m_walkSteps; // Steps left to walk before planning again
+
+    static float CenterX(const Rectangle& rect) { return rect.x + rect.width / 2; }
+
+    Rectangle Target() const {
+        return m_waypoint < ROUTE_LENGTH ? m_platforms[(size_t)ROUTE[m_waypoint]] : m_level.m_exitDoor.GetBounds();
+    }
+
+    static bool StandingOn(const Player& player, const Rectangle& platform) {
+        Rectangle bounds = player.GetBounds();
+        return player.IsOnGround() && std::fabs(bounds.y + bounds.height - platform.y) < 0.5f &&
+               bounds.x + bounds.width > platform.x && bounds.x < platform.x + platform.width;
+    }
+
+    bool Reached(const Player& player) const {
+        if (m_waypoint < ROUTE_LENGTH) return StandingOn(player, Target());
+        return CheckCollisionRecs(player.GetBounds(), Target());
+    }
+
+    static input::InputState Steer(float offset) {
+        input::InputState state;
+        if (offset > STEER_DEAD_ZONE) input::Hold(state, KEY_RIGHT);
+        else if (offset < -STEER_DEAD_ZONE) input::Hold(state, KEY_LEFT);
+        return state;
+    }
+
+    input::InputState PlanInput(const Plan& plan, int step, const Player& player) const {
+        if (step > plan.runSteps + plan.holdSteps) return Steer(CenterX(Target()) - CenterX(player.GetBounds()));
+        input::InputState state;
+        if (plan.runDirection < 0) input::Hold(state, KEY_LEFT);
+        if (plan.runDirection > 0) input::Hold(state, KEY_RIGHT);
+        if (plan.jump && step == plan.runSteps) input::Press(state, KEY_SPACE);
+        return state;
+    }
+
+    // Plays 'plan' out on a copy of the player; fills in its length if it reaches the target
+    bool Simulate(Plan& plan, const Player& start) {
+        Player player = start;
+        bool airborne = false;
+        for (int step = 0; step < MAX_PLAN_STEPS; ++step) {
+            input::InputState state = PlanInput(plan, step, player);
+            {
+                input::Scope inputScope(state);
+                player.Update(STEP_SECONDS); // Same steps as ObstacleLevel::Update
+            }
+            player.SetOnGround(false);
+            m_level.ResolvePlayerCollisions(player, STEP_SECONDS);
+
+            if (Reached(player)) {
+                plan.steps = step + 1;
+                return true;
+            }
+            if (player.GetPosition().y > m_level.screenHeight) return false; // Fell off
+            if (!player.IsOnGround()) airborne = true;
+            else if (airborne) return false; // Landed somewhere else
+        }
+        return false;
+    }
+
+    // Shortest run-up first; m_plan is set when one works
+    bool FindPlan(const Player& player) {
+        if (std::fabs(CenterX(Target()) - CenterX(player.GetBounds())) > PLAN_REACH) return false;
+        for (int runSteps = 0; runSteps <= MAX_RUN_STEPS; runSteps += 2) {
+            for (int direction : { 0, -1, 1 }) {
+                if (direction == 0 && runSteps > 0) continue;
+                for (int holdSteps = 0; holdSteps <= MAX_HOLD_STEPS; holdSteps += 3) {
+                    Plan plan = { direction, runSteps, true, holdSteps, 0 };
+                    if (Simulate(plan, player)) {
+                        m_plan = plan;
+                        return true;
+                    }
+                }
+                Plan walkOff = { direction, runSteps, false, 0, 0 };
+                if (Simulate(walkOff, player)) {
+                    m_plan = walkOff;
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+};
+
+
+// Registry of every level the game knows about. A descriptor is just a few pointers:
+// levels are only constructed when they are about to be played.
+struct LevelDescriptor {
+    LevelTypeId typeId;
+    const char* name;
+    const char* instructions;
+    std::unique_ptr<Levels> (*create)(int screenW, int screenH);
+    std::unique_ptr<LevelBot> (*createBot)(Levels& level); // 'level' must be of this type and outlive the bot
+    bool splitScreen; // Can be played in half the screen, e.g. in versus mode
+};
+
+template <typename T>
+std::unique_ptr<Levels> CreateLevel(int screenW, int screenH) {
+    return std::make_unique<T>(screenW, screenH);
+}
+
+template <typename T>
+std::unique_ptr<LevelBot> CreateBot(Levels& level) {
+    return std::make_unique<typename T::Bot>(static_cast<T&>(level));
+}
+
+template <typename T>
+constexpr LevelDescriptor DescribeLevel() {
+    return { T::TYPE_ID, T::NAME, T::INSTRUCTIONS, &CreateLevel<T>, &CreateBot<T>, T::SPLIT_SCREEN };
+}
+
+// Indexed by LevelTypeId
+const LevelDescriptor LEVEL_REGISTRY[] = {
+    DescribeLevel<MazeLevel>(),
+    DescribeLevel<SpaceInvadersLevel>(),
+    DescribeLevel<FlappyLevel>(),
+    DescribeLevel<ObstacleLevel>(),
+};
+static_assert(sizeof(LEVEL_REGISTRY) / sizeof(LEVEL_REGISTRY[0]) == (size_t)LevelTypeId::COUNT, "Every level type needs a registry entry");
+
+inline const LevelDescriptor& GetLevelDescriptor(LevelTypeId id) {
+    return LEVEL_REGISTRY[(size_t)id];
+}
+
+// The order levels are played in
+const LevelTypeId LEVEL_SEQUENCE[] = {
+    LevelTypeId::MAZE,
+    LevelTypeId::SPACE_INVADERS,
+    LevelTypeId::FLAPPY,
+    LevelTypeId::OBSTACLE_COURSE,
+};
+const size_t LEVEL_SEQUENCE_LENGTH = sizeof(LEVEL_SEQUENCE) / sizeof(LEVEL_SEQUENCE[0]);
+
+const uint32_t ATLAS_BAKE_VERSION = 1; // Bump when CoverageBackend changes how recipes become pixels
+
+// Draws every sprite's recipe (the primitives it is made of) where it goes in the atlas, at
+// the baked size. That is all --bake-atlas rasterizes, so its hash tells whether a baked
+// atlas still matches the code.
+void RecordSpriteRecipes(gfx::DrawList& out) {
+    const gfx::AtlasLayout& layout = gfx::GetAtlasLayout();
+    for (size_t i = 0; i < (size_t)gfx::Sprite::COUNT; ++i) {
+        const gfx::SpriteFrame& frame = gfx::SPRITE_FRAMES[i];
+        const Rectangle& source = layout.sources[i];
+        Rectangle bounds = { source.x + frame.left * gfx::ATLAS_SCALE, source.y + frame.top * gfx::ATLAS_SCALE,
+                             frame.width * gfx::ATLAS_SCALE, frame.height * gfx::ATLAS_SCALE };
+        switch ((gfx::Sprite)i) {
+            case gfx::Sprite::MAZE_PLAYER: MazeLevel::DrawPlayerShape(out, bounds); break;
+            case gfx::Sprite::FLAPPY_CREATURE: FlappyLevel::Bird::DrawShape(out, bounds, FLAPPY_BIRD_COLOR); break;
+            case gfx::Sprite::EXIT_DOOR: ObstacleLevel::ExitDoor::DrawShape(out, bounds, OBSTACLE_DOOR_COLOR); break;
+            case gfx::Sprite::INVADER_SAUCER: SpaceInvadersLevel::DrawInvaderShape(out, bounds); break;
+            case gfx::Sprite::COUNT: break;
+        }
+    }
+}
+
+uint64_t SpriteRecipeHash(const gfx::DrawList& recipes) {
+    const gfx::AtlasLayout& layout = gfx::GetAtlasLayout();
+    const uint32_t header[3] = { ATLAS_BAKE_VERSION, (uint32_t)layout.width, (uint32_t)layout.height };
+    uint64_t hash = state::HashBytes(reinterpret_cast<const unsigned char*>(header), sizeof(header));
+    return state::HashBytes(reinterpret_cast<const unsigned char*>(recipes.Commands().data()), recipes.Size() * sizeof(gfx::DrawCommand), hash);
+}
+
+std::vector<Color> RasterizeSpriteAtlas(const gfx::DrawList& recipes) {
+    const gfx::AtlasLayout& layout = gfx::GetAtlasLayout();
+    gfx::CoverageBackend backend(layout.width, layout.height);
+    recipes.Submit(backend);
+    return backend.Pixels();
+}
+
+// The atlas baked into the binary, if there is one and it was baked from the current recipes.
+// False otherwise, or if it doesn't decode.
+bool DecodeBakedAtlas(std::vector<Color>& pixels) {
+#ifdef BAKRA_BAKED_ATLAS
+    gfx::DrawList recipes;
+    RecordSpriteRecipes(recipes);
+    const gfx::AtlasLayout& layout = gfx::GetAtlasLayout();
+    if (baked_atlas::RECIPE_HASH != SpriteRecipeHash(recipes) || baked_atlas::WIDTH != layout.width || baked_atlas::HEIGHT != layout.height) return false;
+    pixels.assign((size_t)layout.width * layout.height, Color{ 0, 0, 0, 0 });
+    return gfx::DecodeRuns(baked_atlas::RUNS, sizeof(baked_atlas::RUNS), pixels);
+#else
+    (void)pixels;
+    return false;
+#endif
+}
+
+// Fills gfx::spriteAtlas, once: from the atlas baked into the binary, or, when that is missing
+// or out of date, by rasterizing the recipes (slower, but still without touching the disk)
+void LoadSpriteAtlas() {
+    if (gfx::spriteAtlas.HasPixels()) return;
+    const gfx::AtlasLayout& layout = gfx::GetAtlasLayout();
+    std::vector<Color> pixels;
+    if (!DecodeBakedAtlas(pixels)) {
+        std::cerr << "No baked sprite atlas for these sprites; rasterizing it (rebake with --bake-atlas bakra_atlas.h)" << std::endl;
+        gfx::DrawList recipes;
+        RecordSpriteRecipes(recipes);
+        pixels = RasterizeSpriteAtlas(recipes);
+    }
+    gfx::spriteAtlas.SetPixels(std::move(pixels), layout.width, layout.height);
+}
+
+// High scores and run statistics, kept in an append-only log so a crash or a killed process
+// loses at most the result that was being written. Results go to a writer thread through a
+// lock-free queue, so a slow disk never holds up a simulation step.
+namespace scores {
+
+enum class RecordKind : uint8_t {
+    LEVEL = 1,     // One attempt at a level
+    RUN,           // One game from the first level to a win or a loss
+    LEVEL_SUMMARY  // A level's totals, written when the log is compacted
+};
+
+// One log entry. Every byte belongs to a field, so records are written to disk as they are.
+struct Record {
+    RecordKind kind;
+    uint8_t levelType;     // LevelTypeId, for LEVEL and LEVEL_SUMMARY
+    uint8_t won;
+    uint8_t levelsCleared; // RUN only
+    int32_t score;
+    uint32_t steps;        // Simulation steps taken; for LEVEL_SUMMARY the fastest win (0 if none)
+    uint32_t wins;         // LEVEL_SUMMARY only
+    uint32_t deaths;       // LEVEL_SUMMARY only
+    uint32_t reserved;
+    int64_t time;          // Unix time it was recorded
+};
+static_assert(sizeof(Record) == 32, "Records are written byte for byte and must not have padding");
+
+const size_t TOP_RUNS = 10;
+
+// What the log adds up to: totals per level and the best runs. Fixed size, so applying a
+// record never allocates.
+class Index {
+public:
+    struct LevelStats {
+        uint32_t wins = 0;
+        uint32_t deaths = 0;
+        uint32_t bestSteps = 0; // Fastest win, 0 until there is one
+    };
+
+    Index() : m_runCount(0) {}
+
+    // Returns false for records that don't make sense, which are left out
+    bool Apply(const Record& record) {
+        switch (record.kind) {
+            case RecordKind::LEVEL:
+            case RecordKind::LEVEL_SUMMARY: {
+                if (record.levelType >= (uint8_t)LevelTypeId::COUNT) return false;
+                LevelStats& stats = m_levels[record.levelType];
+                bool summary = record.kind == RecordKind::LEVEL_SUMMARY;
+                stats.wins += summary ? record.wins : (record.won ? 1 : 0);
+                stats.deaths += summary ? record.deaths : (record.won ? 0 : 1);
+                if ((summary || record.won) && record.steps != 0 && (stats.bestSteps == 0 || record.steps < stats.bestSteps)) {
+                    stats.bestSteps = record.steps;
+                }
+                return true;
+            }
+            case RecordKind::RUN:
+                AddRun(record);
+                return true;
+        }
+        return false;
+    }
+
+    const LevelStats& Level(LevelTypeId type) const { return m_levels[(size_t)type]; }
+    size_t RunCount() const { return m_runCount; }
+    const Record& Run(size_t rank) const { return m_runs[rank]; } // 0 is the best
+
+    // Calls fn(record) for every record a compacted log needs to rebuild this index
+    template <typename Fn>
+    void ForEachSummary(Fn&& fn) const {
+        for (size_t i = 0; i < (size_t)LevelTypeId::COUNT; ++i) {
+            const LevelStats& stats = m_levels[i];
+            if (stats.wins == 0 && stats.deaths == 0) continue;
+            Record summary = {};
+            summary.kind = RecordKind::LEVEL_SUMMARY;
+            summary.levelType = (uint8_t)i;
+            summary.steps = stats.bestSteps;
+            summary.wins = stats.wins;
+            summary.deaths = stats.deaths;
+            fn(summary);
+        }
+        for (size_t i = 0; i < m_runCount; ++i) fn(m_runs[i]);
+    }
+
+private:
+    LevelStats m_levels[(size_t)LevelTypeId::COUNT];
+    Record m_runs[TOP_RUNS]; // Best first
+    size_t m_runCount;
+
+    // Higher score first, then the faster run, then the older one
+    static bool Better(const Record& a, const Record& b) {
+        if (a.score != b.score) return a.score > b.score;
+        if (a.steps != b.steps) return a.steps < b.steps;
+        return a.time < b.time;
+    }
+
+    void AddRun(const Record& run) {
+        size_t rank = m_runCount;
+        while (rank > 0 && Better(run, m_runs[rank - 1])) --rank;
+        if (rank >= TOP_RUNS) return;
+        size_t last = std::min(m_runCount, TOP_RUNS - 1);
+        for (size_t i = last; i > rank; --i) m_runs[i] = m_runs[i - 1];
+        m_runs[rank] = run;
+        m_runCount = std::min(m_runCount + 1, TOP_RUNS);
+    }
+};
+
+// The log on disk: a header, then one frame per record holding its size, an FNV-1a hash and the
+// record. Every append is flushed to the disk before it counts. A crash can only tear the last
+// frame, so opening the log keeps everything before the first frame that doesn't check out and
+// rewrites the file without the rest.
+class LogFile {
+public:
+    static const uint32_t MAGIC = 0x474C5342; // "BSLG"
+    static const uint32_t VERSION = 1;
+
+    LogFile() : m_file(nullptr), m_records(0) {}
+    ~LogFile() { Close(); }
+    LogFile(const LogFile&) = delete;
+    LogFile& operator=(const LogFile&) = delete;
+
+    // Applies every intact record at 'path' to 'index' and opens the file for appending,
+    // creating it if there is none. Fails, leaving the file alone, if it isn't a score log.
+    bool Open(const char* path, Index& index) {
+        Close();
+        m_path = path;
+        FILE* existing = std::fopen(path, "rb");
+        if (!existing) return Compact(index); // Writes an empty log
+        std::vector<unsigned char> bytes;
+        unsigned char chunk[4096];
+        size_t got;
+        while ((got = std::fread(chunk, 1, sizeof(chunk), existing)) > 0) bytes.insert(bytes.end(), chunk, chunk + got);
+        std::fclose(existing);
+
+        state::Reader reader(bytes.data(), bytes.size());
+        uint32_t magic = reader.Read<uint32_t>();
+        uint32_t version = reader.Read<uint32_t>();
+        if (reader.Failed() || magic != MAGIC || version != VERSION) {
+            std::cerr << "Score log " << path << " isn't one this build can use; scores won't be saved" << std::endl;
+            return false;
+        }
+        size_t records = 0;
+        size_t intactBytes = HEADER_BYTES;
+        while (!reader.AtEnd()) {
+            uint32_t size = reader.Read<uint32_t>();
+            uint64_t hash = reader.Read<uint64_t>();
+            Record record;
+            reader.Read(record);
+            if (reader.Failed() || size != sizeof(Record) ||
+                hash != state::HashBytes(reinterpret_cast<const unsigned char*>(&record), sizeof(record))) break;
+            index.Apply(record);
+            ++records;
+            intactBytes += FRAME_BYTES;
+        }
+        if (intactBytes != bytes.size()) {
+            std::cerr << "Score log " << path << " has a damaged tail (" << (bytes.size() - intactBytes)
+                      << " bytes); keeping " << records << " records" << std::endl;
+            return Compact(index);
+        }
+        m_file = std::fopen(path, "ab");
+        m_records = records;
+        return m_file != nullptr;
+    }
+
+    // Returns once the record is on the disk
+    bool Append(const Record& record) {
+        if (!m_file) return false;
+        if (!WriteFrame(m_file, record) || !Sync(m_file)) return false;
+        ++m_records;
+        return true;
+    }
+
+    // Replaces the log with the few records it takes to rebuild 'index'. The new log is written
+    // next to the old one and renamed over it, so a crash leaves one or the other.
+    bool Compact(const Index& index) {
+        if (m_file) std::fclose(m_file);
+        m_file = nullptr;
+        std::string temporary = m_path + ".tmp";
+        FILE* file = std::fopen(temporary.c_str(), "wb");
+        if (!file) return false;
+        uint32_t header[2] = { MAGIC, VERSION };
+        bool written = std::fwrite(header, 1, sizeof(header), file) == sizeof(header);
+        size_t records = 0;
+        index.ForEachSummary([&](const Record& record) {
+            written = written && WriteFrame(file, record);
+            ++records;
+        });
+        written = Sync(file) && written;
+        written = std::fclose(file) == 0 && written;
+        if (!written || std::rename(temporary.c_str(), m_path.c_str()) != 0) {
+            std::remove(temporary.c_str());
+            return false;
+        }
+        m_file = std::fopen(m_path.c_str(), "ab");
+        m_records = records;
+        return m_file != nullptr;
+    }
+
+    size_t Records() const { return m_records; }
+
+    void Close() {
+        if (m_file) std::fclose(m_file);
+        m_file = nullptr;
+    }
+
+private:
+    static const size_t HEADER_BYTES = 2 * sizeof(uint32_t);
+    static const size_t FRAME_BYTES = sizeof(uint32_t) + sizeof(uint64_t) + sizeof(Record);
+
+    std::string m_path;
+    FILE* m_file;
+    size_t m_records; // Frames in the file, the measure of when to compact
+
+    static bool WriteFrame(FILE* file, const Record& record) {
+        uint32_t size = sizeof(Record);
+        uint64_t hash = state::HashBytes(reinterpret_cast<const unsigned char*>(&record), sizeof(record));
+        unsigned char frame[FRAME_BYTES];
+        std::memcpy(frame, &size, sizeof(size));
+        std::memcpy(frame + sizeof(size), &hash, sizeof(hash));
+        std::memcpy(frame + sizeof(size) + sizeof(hash), &record, sizeof(record));
+        return std::fwrite(frame, 1, sizeof(frame), file) == sizeof(frame);
+    }
+
+    static bool Sync(FILE* file) {
+        if (std::fflush(file) != 0) return false;
+#ifdef __linux__
+        if (fsync(fileno(file)) != 0) return false;
+#endif
+        return true;
+    }
+};
+
+// The game's side of the log. Submit() is called from the simulation thread and only touches
+// memory; a writer thread appends what it is handed and compacts the log as it grows.
+class Store {
+public:
+    static const size_t COMPACT_AFTER_RECORDS = 256;
+
+    Store() : m_open(false), m_dropped(0), m_stop(false) {}
+    ~Store() { Close(); }
+
+    // Reads the log at 'path' and starts the writer. Without a log, results still count for
+    // this session but aren't saved.
+    bool Open(const char* path) {
+        Close();
+        Index loaded;
+        if (!m_log.Open(path, loaded)) return false;
+        m_index = loaded;
+        m_logIndex = loaded;
+        m_open = true;
+        m_stop.store(false, std::memory_order_relaxed);
+        m_writer = std::thread(&Store::WriterLoop, this);
+        return true;
+    }
+
+    // Writes whatever is still queued and stops the writer
+    void Close() {
+        if (!m_open) return;
+        m_stop.store(true, std::memory_order_release);
+        m_writer.join();
+        m_log.Close();
+        m_open = false;
+        if (m_dropped != 0) std::cerr << "Score log: " << m_dropped << " results didn't fit the queue and weren't saved" << std::endl;
+    }
+
+    // Simulation thread only. Never blocks; if the writer has fallen a whole queue behind, the
+    // result still counts for this session but isn't saved.
+    void Submit(Record record) {
+        record.time = (int64_t)std::time(nullptr);
+        m_index.Apply(record);
+        if (m_open && !m_queue.Push(record)) ++m_dropped;
+    }
+
+    // Simulation thread only
+    const Index& View() const { return m_index; }
+
+private:
+    static constexpr int WRITER_POLL_MS = 20;
+
+    Index m_index; // Everything submitted so far, for the simulation thread
+    jobs::SpscQueue<Record, 256> m_queue;
+    bool m_open;
+    uint64_t m_dropped;
+
+    // Writer thread only while it runs
+    LogFile m_log;
+    Index m_logIndex; // What the log holds, for compacting it
+    std::thread m_writer;
+    std::atomic<bool> m_stop;
+
+    void WriterLoop() {
+        for (;;) {
+            bool stopping = m_stop.load(std::memory_order_acquire); // Anything submitted before Close() is in the queue by now
+            bool wrote = false;
+            Record record;
+            while (m_queue.Pop(record)) {
+                m_logIndex.Apply(record);
+                if (!m_log.Append(record)) std::cerr << "Score log: couldn't append a result" << std::endl;
+                wrote = true;
+            }
+            if (wrote && m_log.Records() >= COMPACT_AFTER_RECORDS && !m_log.Compact(m_logIndex)) {
+                std::cerr << "Score log: compaction failed" << std::endl;
+            }
+            if (stopping) return;
+            if (!wrote) std::this_thread::sleep_for(std::chrono::milliseconds(WRITER_POLL_MS));
+        }
+    }
+};
+
+} // namespace scores
+
+scores::Store scoreStore; // Opened by main for the windowed game
+telemetry::Recorder telemetryRecorder; // Started by main for the windowed game
+
+// Enum for the overall game screens/states
+enum GameScreen {
+    TITLE_SCREEN_GLOBAL,         // The very first screen of the game
+    PLAYING_LEVEL,               // A level from our sequence is active
+    LEVEL_TRANSITION,            // Screen between levels
+    GAME_OVER_GLOBAL,            // Player lost the whole game
+    GAME_WON_GLOBAL              // Player completed all levels
+};
+
+GameScreen currentGlobalScreen = TITLE_SCREEN_GLOBAL; // Start here!
+size_t nextLevelIndex = LEVEL_SEQUENCE_LENGTH; // Position in LEVEL_SEQUENCE of the level to play next
+std::unique_ptr<Levels> currentActiveLevel = nullptr; // The level we are currently playing
+int currentLevelMemScope = 0; // Heap instrumentation scope of the active level (0 when not tracking)
+
+gfx::RenderJobQueue renderJobs; // GL work requested by the simulation, run by the thread that owns the window
+
+// Loads the next level in the background while the transition screen is up.
+// Load() runs on a worker thread; FinishLoad() then uploads to the GPU as a render job,
+// in small time slices so the transition screen keeps its frame rate.
+// Owned by the simulation thread.
+class LevelPreloader {
+public:
+    enum State { IDLE, LOADING, UPLOADING, READY };
+
+    LevelPreloader() : m_state(IDLE), m_typeId(LevelTypeId::MAZE), m_memScope(0), m_loadMs(0.0) {}
+    ~LevelPreloader() { Cancel(); }
+
+    // Builds the level from its descriptor on the calling thread (cheap), then loads it on a worker
+    void Start(const LevelDescriptor& descriptor) {
+        Cancel();
+        m_memScope = memtrack::ScopeFor(descriptor.name); // Registered here, the worker only reads it
+        {
+            memtrack::PhaseScope scope(m_memScope, memtrack::PHASE_LOAD);
+            m_level = descriptor.create(GLOBAL_SCREEN_WIDTH, GLOBAL_SCREEN_HEIGHT);
+        }
+        m_typeId = descriptor.typeId;
+        m_state = LOADING;
+        Levels* target = m_level.get();
+        int memScope = m_memScope;
+        m_job = std::async(std::launch::async, [target, memScope]() {
+            memtrack::PhaseScope scope(memScope, memtrack::PHASE_LOAD);
+            auto start = std::chrono::steady_clock::now();
+            target->Load();
+            mem::ResetFrameArena(); // Scratch used by Load() on this thread
+            return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        });
+    }
+
+    // Called once per simulation step
+    void Pump(double uploadBudgetSeconds) {
+        if (m_state == LOADING && m_job.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+            m_loadMs = m_job.get();
+            BeginUpload(uploadBudgetSeconds);
+        }
+        if (m_state == UPLOADING && m_uploaded->load(std::memory_order_acquire)) {
+            m_state = READY;
+        }
+    }
+
+    bool HasLevel() const { return m_level != nullptr; }
+    bool Holds(LevelTypeId typeId) const { return m_level && m_typeId == typeId; }
+    bool IsReady() const { return m_state == READY; }
+    State GetState() const { return m_state; }
+    int MemScope() const { return m_memScope; }
+    double LoadMilliseconds() const { return m_loadMs; }
+
+    // Hands over the loaded level, finishing any remaining work right now if the player was faster than us
+    std::unique_ptr<Levels> Take() {
+        if (m_state == LOADING) {
+            m_loadMs = m_job.get();
+            BeginUpload(1.0);
+        }
+        if (m_state == UPLOADING) {
+            renderJobs.WaitFor(*m_uploaded);
+        }
+        m_state = IDLE;
+        return std::move(m_level);
+    }
+
+    // Waits for an in-flight load and throws the level away
+    void Cancel() {
+        if (m_job.valid()) m_job.wait();
+        if (m_state == UPLOADING) renderJobs.WaitFor(*m_uploaded); // The upload job still points at the level
+        if (m_level) m_level->Unload();
+        m_level.reset();
+        m_state = IDLE;
+    }
+
+private:
+    State m_state;
+    std::unique_ptr<Levels> m_level;
+    LevelTypeId m_typeId;
+    std::future<double> m_job;
+    std::shared_ptr<std::atomic<bool>> m_uploaded;
+    int m_memScope;
+    double m_loadMs;
+
+    void BeginUpload(double budgetSeconds) {
+        m_state = UPLOADING;
+        m_uploaded = std::make_shared<std::atomic<bool>>(false);
+        Levels* target = m_level.get();
+        std::shared_ptr<std::atomic<bool>> uploaded = m_uploaded;
+        int memScope = m_memScope;
+        renderJobs.Post([target, uploaded, memScope, budgetSeconds](double budget) {
+            memtrack::PhaseScope scope(memScope, memtrack::PHASE_LOAD);
+            if (!target->FinishLoad(std::min(budget, budgetSeconds))) return false;
+            uploaded->store(true, std::memory_order_release);
+            return true;
+        });
+    }
+};
+
+const double PRELOAD_UPLOAD_BUDGET_SECONDS = 0.004; // Render-thread time per frame we allow for GPU uploads
+LevelPreloader levelPreloader;
+startup::DeferredWork deferredStartup; // Filled by main; empty for the headless modes
+
+const char* nextLevelName = "";
+const char* nextLevelInstructions = "";
+LevelTypeId nextLevelType = LevelTypeId::MAZE;
+Rectangle confirmButton = { (float)GLOBAL_SCREEN_WIDTH / 2 - 100, (float)GLOBAL_SCREEN_HEIGHT * 0.75f, 200, 50 };
+
+Rectangle escapeButton = { (float)GLOBAL_SCREEN_WIDTH / 2 - 150, (float)GLOBAL_SCREEN_HEIGHT / 2 + 50, 300, 70 };
+Rectangle sufferButton = { (float)GLOBAL_SCREEN_WIDTH / 2 - 150, (float)GLOBAL_SCREEN_HEIGHT / 2 + 150, 300, 70 };
+
+const float SIM_TIME_STEP = 1.0f / 60.0f; // Fixed simulation step when running on its own thread
+const size_t REWIND_BUDGET_BYTES = 8 * 1024 * 1024;
+const size_t REWIND_MAX_FRAMES = 30 * 60; // Thirty seconds of simulation steps
+
+gfx::TripleBuffer<gfx::RenderSnapshot> renderSnapshots; // Recorded frames, simulation -> render thread
+input::Mailbox inputMailbox; // Sampled input, render thread -> simulation
+spectate::Broadcaster spectatorBroadcast; // Sends every simulated frame to viewers, with --broadcast
+audio::RaylibSink audioSink; // The device's stream, opened by main unless --no-audio
+audio::Mixer audioMixer; // Mixes what the simulation thread plays into audioSink
+
+uint32_t levelSteps = 0; // Simulation steps spent in the active level
+int runScore = 0; // Totals of the levels played since the title screen
+uint32_t runSteps = 0;
+int runLevelsCleared = 0;
+
+// Logs how the active level ended and, when that ends the game, the whole run
+void RecordLevelResult(const Levels& level, bool won, bool endsRun) {
+    telemetry::Emit(telemetry::EventType::LEVEL_END, won ? 1 : 0);
+    scores::Record result = {};
+    result.kind = scores::RecordKind::LEVEL;
+    result.levelType = (uint8_t)level.GetTypeId();
+    result.won = won;
+    result.score = level.GetScore();
+    result.steps = levelSteps;
+    scoreStore.Submit(result);
+
+    runScore += result.score;
+    runSteps += levelSteps;
+    if (won) ++runLevelsCleared;
+    if (!endsRun) return;
+    scores::Record run = {};
+    run.kind = scores::RecordKind::RUN;
+    run.won = won;
+    run.levelsCleared = (uint8_t)runLevelsCleared;
+    run.score = runScore;
+    run.steps = runSteps;
+    scoreStore.Submit(run);
+}
+
+// Forward declarations for our global UI functions
+void UpdateStartingScreen(float deltaTime);
+void DrawStartingScreen(gfx::DrawList& out);
+void DrawLevelTransitionScreen(gfx::DrawList& out);
+void DrawGlobalGameOverScreen(gfx::DrawList& out);
+void DrawGlobalGameWonScreen(gfx::DrawList& out);
+void SetupGameLevels(); // Prepares the sequence of levels
+void LoadNextLevel(); // Loads the next level in the sequence
+
+// Handles the start screen buttons and the "suffer" message timer
+void UpdateStartingScreen(float deltaTime) {
+    levelPreloader.Pump(PRELOAD_UPLOAD_BUDGET_SECONDS); // A fast start preloads the first level here
+
+    // Check for button clicks
+    if (input::MouseLeftPressed()) {
+        Vector2 mousePoint = input::MousePosition();
+
+        if (CheckCollisionPointRec(mousePoint, escapeButton)) {
+            showSufferMessage = false; // Hide message if it was showing
+            deferredStartup.Finish(); // Levels need what a fast start hasn't got to yet
+            SetupGameLevels(); // Start the level sequence from the beginning
+            LoadNextLevel();   // Load the first level into memory
+            currentGlobalScreen = PLAYING_LEVEL; // Change state to main game
+            std::cout << "Escape button pressed! Changing to PLAYING_LEVEL." << std::endl; // Debug output
+        } else if (CheckCollisionPointRec(mousePoint, sufferButton)) {
+            showSufferMessage = true;
+            sufferMessageTimer = 0.0f; // Reset timer for the message
+            std::cout << "Suffer button pressed! Displaying message." << std::endl; // Debug output
+        }
+    }
+
+    if (showSufferMessage) {
+        sufferMessageTimer += deltaTime;
+        if (sufferMessageTimer >= SUFFER_MESSAGE_DISPLAY_TIME) {
+            showSufferMessage = false; // Hide message after its time
+        }
+    }
+}
+
+// Function to draw the new starting screen
+void DrawStartingScreen(gfx::DrawList& out) {
+    out.ClearBackground(BLACK); // Black background for the start screen
+
+    // Text inviting the player to "escape" or "suffer"
+    const char* descriptionText = "You are in prison for kidnapping a qurbani ka bakra,\n \n \n \n \n \n \n \n       you should";
+    int fontSize = 30;
+    int textWidth = MeasureText(descriptionText, fontSize);
+    out.DrawText(descriptionText, GLOBAL_SCREEN_WIDTH / 2 - textWidth / 2, GLOBAL_SCREEN_HEIGHT / 2 - 150, fontSize, WHITE);
+
+    // "Escape" Button
+    out.DrawRectangleRec(escapeButton, GREEN);
+    out.DrawText("ESCAPE", (int)(escapeButton.x + escapeButton.width / 2 - MeasureText("ESCAPE", 40) / 2), (int)(escapeButton.y + escapeButton.height / 2 - 20), 40, BLACK);
+
+    // "Suffer" Button
+    out.DrawRectangleRec(sufferButton, RED);
+    out.DrawText("SUFFER", (int)(sufferButton.x + sufferButton.width / 2 - MeasureText("SUFFER", 40) / 2), (int)(sufferButton.y + sufferButton.height / 2 - 20), 40, BLACK);
+
+    // "Suffer" message if active
+    if (showSufferMessage) {
+        out.DrawText("NO LOSER YOU NEED TO ESCAPE", GLOBAL_SCREEN_WIDTH / 2 - MeasureText("NO LOSER YOU NEED TO ESCAPE", 30) / 2, GLOBAL_SCREEN_HEIGHT / 2 + 280, 30, YELLOW);
+    }
+}
+
+// Advances the whole game by one step: title screen, active level and the screens in between
+void UpdateGame(float deltaTime) {
+    // Update logic based on the current overall game screen
+    switch (currentGlobalScreen) {
+        case TITLE_SCREEN_GLOBAL:
+            UpdateStartingScreen(deltaTime);
+            break;
+        case PLAYING_LEVEL:
+            if (currentActiveLevel) {
+                {
+                    memtrack::PhaseScope memScope(currentLevelMemScope, memtrack::PHASE_UPDATE);
+                    currentActiveLevel->Update(deltaTime); // Update the current level
+                }
+                ++levelSteps;
+                memtrack::CountFrame(currentLevelMemScope);
+                LevelOutcome outcome = currentActiveLevel->GetOutcome();
+                if (outcome != LevelOutcome::IN_PROGRESS) { // Check if the level is finished
+                    bool levelSucceeded = outcome == LevelOutcome::WON;
+                    RecordLevelResult(*currentActiveLevel, levelSucceeded, !levelSucceeded || nextLevelIndex >= LEVEL_SEQUENCE_LENGTH);
+
+                    currentActiveLevel->Unload(); // Clean up current level's resources
+                    memtrack::PrintReport(currentLevelMemScope, std::cout); // Memory budget for the level we just left
+                    currentActiveLevel = nullptr; // Finished levels aren't kept around
+
+                    if (levelSucceeded) {
+                        if (nextLevelIndex < LEVEL_SEQUENCE_LENGTH) {
+                            // Prepare data for the transition screen to the next level
+                            const LevelDescriptor& next = GetLevelDescriptor(LEVEL_SEQUENCE[nextLevelIndex++]);
+                            nextLevelName = next.name;
+                            nextLevelInstructions = next.instructions;
+                            nextLevelType = next.typeId;
+                            levelPreloader.Start(next); // Load it while the player reads the instructions
+                            currentGlobalScreen = LEVEL_TRANSITION; // Go to the transition screen
+                        } else {
+                            currentGlobalScreen = GAME_WON_GLOBAL; // Player completed all levels!
+                        }
+                    } else {
+                        currentGlobalScreen = GAME_OVER_GLOBAL; // Game Over for the whole game
+                    }
+                }
+            } else {
+                currentGlobalScreen = GAME_OVER_GLOBAL; // Fallback to game over if somehow no active level
+            }
+            break;
+
+        case LEVEL_TRANSITION: {
+            levelPreloader.Pump(PRELOAD_UPLOAD_BUDGET_SECONDS); // Keep the background load moving
+
+            // Wait for the player to click "Ready!"
+            if (input::MouseLeftPressed()) {
+                if (CheckCollisionPointRec(input::MousePosition(), confirmButton)) {
+                    LoadNextLevel(); // Load the next level
+                    if (currentActiveLevel) {
+                        currentGlobalScreen = PLAYING_LEVEL; // Start playing the new level
+                    } else {
+                        currentGlobalScreen = GAME_WON_GLOBAL; // Should mean all levels are done
+                    }
+                }
+            }
+        } break;
+
+        case GAME_OVER_GLOBAL:
+            if (input::KeyPressed(KEY_ENTER)) { // Press Enter to go back to title
+                currentGlobalScreen = TITLE_SCREEN_GLOBAL;
+                showSufferMessage = false; // Reset title screen messages
+                sufferMessageTimer = 0.0f;
+            }
+            break;
+
+        case GAME_WON_GLOBAL:
+            if (input::KeyPressed(KEY_ENTER)) { // Press Enter to go back to title
+                currentGlobalScreen = TITLE_SCREEN_GLOBAL;
+                showSufferMessage = false; // Reset title screen messages
+                sufferMessageTimer = 0.0f;
+            }
+            break;
+    }
+}
+
+// Records the current game screen into 'out'
+void DrawGame(gfx::DrawList& out) {
+    out.ClearBackground(BLACK); // Clear screen to black
+
+    // Draw based on the current overall game screen
+    if (currentGlobalScreen == PLAYING_LEVEL && currentActiveLevel) {
+        memtrack::PhaseScope memScope(currentLevelMemScope, memtrack::PHASE_DRAW);
+        currentActiveLevel->Draw(out); // Draw the current active game level
+    } else if (currentGlobalScreen == TITLE_SCREEN_GLOBAL) {
+        DrawStartingScreen(out); // Draw the initial game start screen
+    } else if (currentGlobalScreen == LEVEL_TRANSITION) {
+        DrawLevelTransitionScreen(out); // Draw the screen between levels
+    } else if (currentGlobalScreen == GAME_OVER_GLOBAL) {
+        DrawGlobalGameOverScreen(out); // Draw the game over screen
+    } else if (currentGlobalScreen == GAME_WON_GLOBAL) {
+        DrawGlobalGameWonScreen(out); // Draw the game won screen
+    }
+}
+
+bool autoplay = false; // Levels are played by their bots; menus still take the player's input
+std::unique_ptr<LevelBot> levelBot; // Bot for the active level while autoplaying
+
+// The active level's bot's input while a level is being played, 'sampled' anywhere else.
+// The bot is dropped as soon as the game leaves the level, so it never outlives it.
+input::InputState BotInput(const input::InputState& sampled) {
+    if (currentGlobalScreen != PLAYING_LEVEL || !currentActiveLevel) {
+        levelBot.reset();
+        return sampled;
+    }
+    if (!levelBot) levelBot = GetLevelDescriptor(currentActiveLevel->GetTypeId()).createBot(*currentActiveLevel);
+    return levelBot->NextInput();
+}
+
+bool practiceMode = false; // Hold BACKSPACE during a level to rewind it
+state::RewindBuffer practiceRewind(REWIND_BUDGET_BYTES, REWIND_MAX_FRAMES);
+state::Writer practiceState;
+std::vector<unsigned char> practiceRestore;
+
+// Practice mode's part of a step: keeps the level's state from before every step and, while
+// BACKSPACE is held in 'sampled', puts the newest kept state back instead. Returns true when
+// it rewound, in which case the game must not be updated this step.
+bool PracticeRewind(const input::InputState& sampled) {
+    if (currentGlobalScreen != PLAYING_LEVEL || !currentActiveLevel) {
+        practiceRewind.Clear();
+        return false;
+    }
+    if (input::Held(sampled, KEY_BACKSPACE)) {
+        if (practiceRewind.Pop(practiceRestore)) {
+            state::Reader reader(practiceRestore.data(), practiceRestore.size());
+            bool restored = currentActiveLevel->LoadState(reader);
+            assert(restored && "rewind state doesn't fit the level");
+            (void)restored;
+            levelBot.reset(); // Its plans were for the steps we just undid
+        }
+        return true; // Stays at the oldest kept state once they run out
+    }
+    practiceState.Clear();
+    currentActiveLevel->SaveState(practiceState);
+    practiceRewind.Push(practiceState.Data(), practiceState.Size());
+    return false;
+}
+
+const Levels* telemetryLevel = nullptr; // The level telemetry events are stamped with
+
+// Stamps the coming events with the active level, announcing a new one
+void UpdateTelemetryLevel() {
+    if (currentActiveLevel.get() == telemetryLevel) return;
+    telemetryLevel = currentActiveLevel.get(); // A finished level is dropped before the next one is built, so this can't miss a change
+    telemetry::SetLevel(telemetryLevel ? (uint8_t)telemetryLevel->GetTypeId() : telemetry::NO_LEVEL);
+    if (telemetryLevel) telemetry::Emit(telemetry::EventType::LEVEL_START);
+}
+
+// One simulation step: update with the given input, then record the frame into 'snapshot'
+void SimulateFrame(const input::InputState& frameInput, float deltaTime, gfx::RenderSnapshot& snapshot) {
+#ifdef BAKRA_CHECK_FRAME_ALLOCS
+    static int steadyFrames = 0; // Frames spent in the same level since it started
+    GameScreen screenAtFrameStart = currentGlobalScreen;
+#endif
+
+    telemetry::NextStep();
+    UpdateTelemetryLevel();
+    {
+        input::InputState stepInput = autoplay ? BotInput(frameInput) : frameInput;
+        input::Scope inputScope(stepInput);
+        if (!practiceMode || !PracticeRewind(frameInput)) UpdateGame(deltaTime);
+    }
+    snapshot.drawList.Clear();
+    DrawGame(snapshot.drawList);
+    snapshot.drawList.Sort(); // Group by layer and batch so raylib can draw it in few calls
+    spectatorBroadcast.Publish(snapshot.drawList);
+    ++snapshot.simFrame;
+    mem::ResetFrameArena(); // Everything formatted or collected this frame is gone now
+    startup::profile.FrameSimulated();
+
+#ifdef BAKRA_CHECK_FRAME_ALLOCS
+    // Once a level has warmed up, a frame must not allocate from the global heap
+    size_t frameAllocations = memtrack::g_heapAllocations.exchange(0);
+    if (currentGlobalScreen == PLAYING_LEVEL && currentGlobalScreen == screenAtFrameStart) {
+        if (++steadyFrames > STEADY_STATE_WARMUP_FRAMES && frameAllocations != 0) {
+            std::cerr << "Steady-state frame made " << frameAllocations << " heap allocations" << std::endl;
+            assert(frameAllocations == 0 && "steady-state frame touched the heap");
+        }
+    } else {
+        steadyFrames = 0;
+    }
+#endif
+}
+
+gfx::SubmitStats lastSubmitStats; // Commands and batches of the last presented frame
+
+bool dynamicResolution = true; // Levels render at a scale picked from frame times; --fixed-resolution turns it off
+gfx::ScaledRenderer sceneRenderer; // Offscreen target for dynamic resolution, set up once the window exists
+gfx::ResolutionScaler resolutionScaler(1.0 / 60.0); // Budget to match SetTargetFPS(60)
+bool framePacing = true; // Sleep before frames instead of after them; --no-frame-pacer hands pacing back to raylib
+gfx::FramePacer framePacer(1.0 / 60.0);
+
+// Reads input for the next frame. With frame pacing this first sleeps until the frame has to
+// start, then polls again, so input that arrived during the sleep makes it into this frame.
+input::InputState SampleFrameInput(std::chrono::steady_clock::time_point& sampledAt) {
+    input::InputState sampled = input::Sample(); // Presses picked up by the poll in EndDrawing()
+    if (framePacing) {
+        framePacer.WaitForFrameStart();
+        PollInputEvents();
+        input::Merge(sampled, input::Sample());
+    }
+    sampledAt = std::chrono::steady_clock::now();
+    return sampled;
+}
+
+// Presents the newest recorded frame. Render thread only.
+void RenderFrame(const gfx::RenderSnapshot& snapshot) {
+    BeginDrawing(); // Start drawing for this frame
+    renderJobs.Run(PRELOAD_UPLOAD_BUDGET_SECONDS); // GPU uploads requested by the simulation
+    auto workStart = std::chrono::steady_clock::now(); // Uploads don't count: they only happen between levels
+    static gfx::ScreenBackend screen;
+    if (dynamicResolution) {
+        lastSubmitStats = sceneRenderer.Present(snapshot.drawList, screen, resolutionScaler.Scale());
+    } else {
+        lastSubmitStats = snapshot.drawList.Submit(screen);
+    }
+#ifdef BAKRA_DRAW_STATS
+    char statsText[128];
+    std::snprintf(statsText, sizeof(statsText), "%u cmds, %u batches (%u unsorted), %d%% resolution",
+                  lastSubmitStats.commands, lastSubmitStats.batches, lastSubmitStats.unsortedBatches,
+                  dynamicResolution ? (int)std::lround(resolutionScaler.Scale() * 100) : 100);
+    ::DrawText(statsText, 10, GLOBAL_SCREEN_HEIGHT - 24, 16, LIME);
+#endif
+#ifdef BAKRA_LATENCY_STATS
+    char latencyText[96];
+    std::snprintf(latencyText, sizeof(latencyText), "input to photon ~%.1f ms, predicted work %.1f ms",
+                  framePacer.LastLatency() * 1000.0, framePacer.PredictedWork() * 1000.0);
+    ::DrawText(latencyText, 10, GLOBAL_SCREEN_HEIGHT - 44, 16, LIME);
+#endif
+    double workSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - workStart).count();
+    EndDrawing(); // End drawing for this frame
+    if (snapshot.simFrame != 0) startup::profile.FramePresented(); // Not the blank frame before the first step
+    if (dynamicResolution) resolutionScaler.Update(GetFrameTime(), workSeconds);
+    if (framePacing && framePacer.FramePresented(snapshot.inputSampledAt)) {
+#ifdef BAKRA_LATENCY_STATS
+        const gfx::FramePacer::LatencyReport& report = framePacer.Report();
+        std::printf("input to photon: min %.1f ms, avg %.1f ms, max %.1f ms, predicted work %.2f ms, %d/%d late\n",
+                    report.minSeconds * 1000.0, report.averageSeconds * 1000.0, report.maxSeconds * 1000.0,
+                    report.predictedWorkSeconds * 1000.0, report.missedDeadlines, report.frames);
+#endif
+    }
+}
+
+// Draws every level headless for 'frames' frames into the null backend and prints what it
+// costs and what it draws. Only meaningful with BAKRA_NULL_RENDERER, which has no window.
+int RunDrawBenchmark(int frames) {
+    gfx::DrawList list;
+    gfx::NullBackend backend;
+    int problems = 0;
+    for (const LevelDescriptor& descriptor : LEVEL_REGISTRY) {
+        std::unique_ptr<Levels> level = descriptor.create(GLOBAL_SCREEN_WIDTH, GLOBAL_SCREEN_HEIGHT);
+        level->Load();
+        while (!level->FinishLoad(1.0)) {}
+
+        input::InputState noInput;
+        input::Scope inputScope(noInput);
+        double recordMs = 0.0, submitMs = 0.0;
+        uint64_t commands = 0, batches = 0, invalid = 0, offscreen = 0;
+        for (int frame = 0; frame < frames; ++frame) {
+            level->Update(SIM_TIME_STEP);
+
+            auto start = std::chrono::steady_clock::now();
+            list.Clear();
+            level->Draw(list);
+            list.Sort();
+            auto recorded = std::chrono::steady_clock::now();
+            backend.BeginFrame();
+            gfx::SubmitStats stats = list.Submit(backend);
+            auto submitted = std::chrono::steady_clock::now();
+            mem::ResetFrameArena();
+
+            recordMs += std::chrono::duration<double, std::milli>(recorded - start).count();
+            submitMs += std::chrono::duration<double, std::milli>(submitted - recorded).count();
+            commands += stats.commands;
+            batches += stats.batches;
+            invalid += backend.InvalidCount();
+            offscreen += backend.OffscreenCount();
+            if (backend.InvalidCount() != 0 && problems++ < 10) {
+                std::cerr << descriptor.name << " frame " << frame << ": invalid " << backend.FirstProblem() << " draw" << std::endl;
+            }
+        }
+
+        std::cout << descriptor.name << ": " << frames << " frames, " << (double)commands / frames << " cmds/frame, "
+                  << (double)batches / frames << " batches/frame, record " << recordMs * 1000.0 / frames << " us/frame, submit "
+                  << submitMs * 1000.0 / frames << " us/frame, " << invalid << " invalid, " << offscreen << " offscreen" << std::endl;
+        std::cout << "  last frame:";
+        for (size_t type = 0; type < gfx::COMMAND_TYPE_COUNT; ++type) {
+            uint32_t count = backend.Count((gfx::CommandType)type);
+            if (count != 0) std::cout << " " << gfx::CommandTypeName((gfx::CommandType)type) << "=" << count;
+        }
+        Rectangle bounds = backend.Bounds();
+        std::cout << ", bounds " << bounds.x << "," << bounds.y << " " << bounds.width << "x" << bounds.height << std::endl;
+        level->Unload();
+    }
+    return problems == 0 ? 0 : 1;
+}
+
+const uint32_t GOLDEN_SEED = 20240613; // Fixed so every run builds the same mazes and pipes
+const int GOLDEN_FRAMES[] = { 1, 60, 240 }; // Simulation steps after which each level is captured
+const float GOLDEN_THRESHOLD = 0.1f; // Per-pixel perceptual difference that counts as changed
+const float GOLDEN_MAX_CHANGED_FRACTION = 0.001f; // Changed pixels a frame may have and still pass
+
+// Renders every level headless into CPU images at the window resolution. With 'record' the
+// images are written to 'directory' as the new goldens; otherwise each one is compared to
+// the stored golden and failures get *_actual.png and *_diff.png written next to it.
+int RunGoldenImages(const char* directory, bool record) {
+    int failures = 0;
+    gfx::DrawList list;
+    LoadSpriteAtlas();
+    for (const LevelDescriptor& descriptor : LEVEL_REGISTRY) {
+        std::unique_ptr<Levels> level = descriptor.create(GLOBAL_SCREEN_WIDTH, GLOBAL_SCREEN_HEIGHT);
+        level->Seed(GOLDEN_SEED);
+        level->Load();
+        while (!level->FinishLoad(1.0)) {}
+
+        std::string slug = descriptor.name;
+        for (char& c : slug) c = c == ' ' ? '_' : (char)std::tolower((unsigned char)c);
+
+        input::InputState noInput;
+        input::Scope inputScope(noInput);
+        int step = 0;
+        for (int captureFrame : GOLDEN_FRAMES) {
+            for (; step < captureFrame; ++step) level->Update(SIM_TIME_STEP);
+
+            list.Clear();
+            level->Draw(list);
+            list.Sort();
+            Image frame = GenImageColor(GLOBAL_SCREEN_WIDTH, GLOBAL_SCREEN_HEIGHT, BLACK);
+            gfx::ImageBackend backend(&frame);
+            list.Submit(backend);
+            mem::ResetFrameArena();
+
+            std::string path = std::string(directory) + "/" + slug + "_" + std::to_string(captureFrame);
+            if (record) {
+                if (!ExportImage(frame, (path + ".png").c_str())) {
+                    std::cerr << "Could not write " << path << ".png" << std::endl;
+                    ++failures;
+                }
+            } else {
+                Image golden = LoadImage((path + ".png").c_str());
+                if (golden.data == nullptr || golden.width != frame.width || golden.height != frame.height) {
+                    std::cerr << path << ".png: missing or wrong size" << std::endl;
+                    ++failures;
+                } else {
+                    ImageFormat(&golden, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+                    Image diffImage = GenImageColor(frame.width, frame.height, WHITE);
+                    gfx::ImageDiff diff = gfx::PerceptualDiff(golden, frame, GOLDEN_THRESHOLD, &diffImage);
+                    bool passed = diff.differentPixels <= diff.totalPixels * GOLDEN_MAX_CHANGED_FRACTION;
+                    std::cout << (passed ? "PASS " : "FAIL ") << slug << " frame " << captureFrame << ": "
+                              << diff.differentPixels << " changed pixels, max difference " << diff.maxDelta << std::endl;
+                    if (!passed) {
+                        ExportImage(frame, (path + "_actual.png").c_str());
+                        ExportImage(diffImage, (path + "_diff.png").c_str());
+                        ++failures;
+                    }
+                    UnloadImage(diffImage);
+                }
+                UnloadImage(golden);
+            }
+            UnloadImage(frame);
+        }
+        level->Unload();
+    }
+    if (record) std::cout << "Golden images written to " << directory << std::endl;
+    return failures == 0 ? 0 : 1;
+}
+
+// Rasterizes the sprite recipes and writes them to 'path' as a header of constants, which the
+// next build embeds. Run it after changing a sprite's recipe or frame.
+int BakeSpriteAtlas(const char* path) {
+    const gfx::AtlasLayout& layout = gfx::GetAtlasLayout();
+    gfx::DrawList recipes;
+    RecordSpriteRecipes(recipes);
+    std::vector<Color> pixels = RasterizeSpriteAtlas(recipes);
+    std::vector<unsigned char> runs;
+    gfx::EncodeRuns(pixels, runs);
+
+    FILE* file = std::fopen(path, "w");
+    if (!file) {
+        std::cerr << "Can't write " << path << std::endl;
+        return 1;
+    }
+    std::fprintf(file, "// The sprite atlas, baked by --bake-atlas from the sprite recipes in source.cpp. Don't edit;\n");
+    std::fprintf(file, "// rebake after changing a sprite. Pixels are RGBA, run-length coded (see gfx::EncodeRuns).\n");
+    std::fprintf(file, "#pragma once\n\nnamespace baked_atlas {\n\n");
+    std::fprintf(file, "constexpr int WIDTH = %d;\nconstexpr int HEIGHT = %d;\n", layout.width, layout.height);
+    std::fprintf(file, "constexpr unsigned long long RECIPE_HASH = 0x%016llXull;\n\n", (unsigned long long)SpriteRecipeHash(recipes));
+    std::fprintf(file, "constexpr unsigned char RUNS[%zu] = {\n", runs.size());
+    for (size_t i = 0; i < runs.size(); ++i) {
+        std::fprintf(file, "%s%u,%s", i % 24 == 0 ? "    " : "", runs[i], i % 24 == 23 || i + 1 == runs.size() ? "\n" : "");
+    }
+    std::fprintf(file, "};\n\n} // namespace baked_atlas\n");
+    bool written = !std::ferror(file);
+    written = std::fclose(file) == 0 && written;
+    if (!written) {
+        std::cerr << "Can't write " << path << std::endl;
+        return 1;
+    }
+    std::cout << (size_t)gfx::Sprite::COUNT << " sprites baked into a " << layout.width << "x" << layout.height << " atlas: "
+              << runs.size() << " bytes (" << pixels.size() * sizeof(Color) << " unpacked) in " << path << std::endl;
+    return 0;
+}
+
+// Checks that every recipe stays inside its sprite's frame, that the atlas baked into the
+// binary matches the recipes it was baked from, and what loading it costs against rasterizing
+int RunAtlasCheck() {
+    int failures = 0;
+    const gfx::AtlasLayout& layout = gfx::GetAtlasLayout();
+    gfx::DrawList recipes;
+    RecordSpriteRecipes(recipes);
+    gfx::NullBackend backend(layout.width, layout.height);
+    recipes.Submit(backend);
+    for (size_t i = 0; i < (size_t)gfx::Sprite::COUNT; ++i) {
+        // A sprite's primitives are the ones centred in its place in the atlas
+        const Rectangle& source = layout.sources[i];
+        bool inside = true;
+        for (const gfx::NullBackend::Primitive& primitive : backend.Primitives()) {
+            Rectangle b = primitive.bounds;
+            if (!CheckCollisionPointRec({ b.x + b.width / 2, b.y + b.height / 2 }, source)) continue;
+            inside = inside && b.x >= source.x - 0.5f && b.y >= source.y - 0.5f &&
+                     b.x + b.width <= source.x + source.width + 0.5f && b.y + b.height <= source.y + source.height + 0.5f;
+        }
+        if (!inside) {
+            std::cerr << "Sprite " << i << " draws outside its frame; widen its SPRITE_FRAMES entry" << std::endl;
+            ++failures;
+        }
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<Color> rasterized = RasterizeSpriteAtlas(recipes);
+    double rasterizeMillis = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    std::vector<Color> baked;
+    bool current = DecodeBakedAtlas(baked);
+    double decodeMillis = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    if (!current) {
+        std::cerr << "The baked atlas is missing or out of date: run --bake-atlas bakra_atlas.h and rebuild" << std::endl;
+        return 1;
+    }
+    int worst = 0;
+    for (size_t i = 0; i < baked.size(); ++i) {
+        const Color& a = baked[i];
+        const Color& b = rasterized[i];
+        worst = std::max({ worst, std::abs(a.r - b.r), std::abs(a.g - b.g), std::abs(a.b - b.b), std::abs(a.a - b.a) });
+    }
+    if (worst > 1) ++failures; // Float rounding may differ by a step between compilers, no more
+    std::cout << "Atlas " << layout.width << "x" << layout.height << ": baked copy decodes in " << decodeMillis << " ms (rasterizing takes "
+              << rasterizeMillis << " ms), pixels within " << worst << " of the recipes: " << (failures == 0 ? "ok" : "FAILED") << std::endl;
+    return failures == 0 ? 0 : 1;
+}
+
+// Throughput of rng::Stream against the standard Mersenne Twisters, in millions of values per second
+int RunRngBenchmark() {
+    const int COUNT = 50000000;
+    auto measure = [](const char* name, auto&& generate) {
+        auto start = std::chrono::steady_clock::now();
+        uint64_t sink = 0;
+        for (int i = 0; i < COUNT; ++i) sink += (uint64_t)generate();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "  " << name << ": " << COUNT / seconds / 1e6 << " M/s (checksum " << (sink & 0xFFFF) << ")" << std::endl;
+    };
+
+    std::mt19937 mt(1);
+    std::mt19937_64 mt64(1);
+    rng::Stream stream(1);
+    std::cout << "Random number throughput, " << COUNT << " values each" << std::endl;
+    measure("std::mt19937 (32-bit)", [&]() { return mt(); });
+    measure("std::mt19937_64", [&]() { return mt64(); });
+    measure("rng::Stream::Next (64-bit)", [&]() { return stream.Next(); });
+    measure("std::mt19937 + uniform_real_distribution<float>", [&, dist = std::uniform_real_distribution<float>(0.0f, 1.0f)]() mutable { return dist(mt) * 1000.0f; });
+    measure("rng::Stream::NextFloat", [&]() { return stream.NextFloat() * 1000.0f; });
+    uint64_t forkId = 0;
+    measure("rng::Stream::Fork + Next", [&]() { return stream.Fork(forkId++).Next(); });
+    return 0;
+}
+
+const int BATCH_MAX_STEPS_PER_LEVEL = 60 * 300; // Five simulated minutes before a level counts as timed out
+
+// How one headless session went, level by level through LEVEL_SEQUENCE
+struct SessionResult {
+    LevelOutcome outcomes[LEVEL_SEQUENCE_LENGTH]; // IN_PROGRESS means timed out or never reached
+    int steps[LEVEL_SEQUENCE_LENGTH];
+    size_t levelsPlayed = 0;
+};
+
+// Plays one whole game without a window: every level in sequence, fed by 'nextInput(level, step)'
+// (step 0 is the first of a new level), until a level is lost. Everything it touches is owned by the session, so any number
+// can run at once on different threads.
+template <typename InputSource>
+SessionResult RunSession(const rng::Stream& session, InputSource& nextInput) {
+    SessionResult result;
+    for (size_t index = 0; index < LEVEL_SEQUENCE_LENGTH; ++index) {
+        const LevelDescriptor& descriptor = GetLevelDescriptor(LEVEL_SEQUENCE[index]);
+        std::unique_ptr<Levels> level = descriptor.create(GLOBAL_SCREEN_WIDTH, GLOBAL_SCREEN_HEIGHT);
+        level->Seed(session.Fork(index));
+        level->Load();
+        while (!level->FinishLoad(1.0)) {}
+
+        int step = 0;
+        while (step < BATCH_MAX_STEPS_PER_LEVEL && level->GetOutcome() == LevelOutcome::IN_PROGRESS) {
+            input::InputState state = nextInput(*level, step);
+            input::Scope inputScope(state);
+            level->Update(SIM_TIME_STEP);
+            mem::ResetFrameArena();
+            ++step;
+        }
+        result.outcomes[index] = level->GetOutcome();
+        result.steps[index] = step;
+        result.levelsPlayed = index + 1;
+        level->Unload();
+        if (result.outcomes[index] == LevelOutcome::LOST) break; // Timed-out levels are skipped so later ones still get played
+    }
+    return result;
+}
+
+// Runs 'sessions' independent games across a work-stealing pool and prints per-level results.
+// Input is random key presses, or each level's bot with 'bots'.
+int RunBatchSimulation(int sessions, unsigned threads, uint32_t baseSeed, bool bots) {
+    std::vector<SessionResult> results((size_t)sessions);
+    auto start = std::chrono::steady_clock::now();
+    {
+        jobs::WorkStealingPool pool(threads);
+        for (int i = 0; i < sessions; ++i) {
+            pool.Submit([&results, i, baseSeed, bots]() {
+                rng::Stream session = rng::Stream(baseSeed).Fork((uint64_t)i); // Depends only on the seed and the index
+                if (bots) {
+                    std::unique_ptr<LevelBot> bot;
+                    auto nextInput = [&bot](Levels& level, int step) {
+                        if (step == 0) bot = GetLevelDescriptor(level.GetTypeId()).createBot(level);
+                        return bot->NextInput();
+                    };
+                    results[(size_t)i] = RunSession(session, nextInput);
+                } else {
+                    input::ScriptedInput script(session.Fork(~0ull));
+                    auto nextInput = [&script](Levels&, int) { return script.Next(); };
+                    results[(size_t)i] = RunSession(session, nextInput);
+                }
+            });
+        }
+        pool.WaitIdle();
+        threads = pool.ThreadCount();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    uint64_t totalSteps = 0;
+    std::cout << sessions << " sessions on " << threads << " threads (seed " << baseSeed << ", " << (bots ? "bots" : "random input") << ")" << std::endl;
+    for (size_t index = 0; index < LEVEL_SEQUENCE_LENGTH; ++index) {
+        int reached = 0, won = 0, lost = 0, timedOut = 0;
+        uint64_t wonSteps = 0;
+        for (const SessionResult& result : results) {
+            if (result.levelsPlayed <= index) continue;
+            ++reached;
+            totalSteps += (uint64_t)result.steps[index];
+            switch (result.outcomes[index]) {
+                case LevelOutcome::WON: ++won; wonSteps += (uint64_t)result.steps[index]; break;
+                case LevelOutcome::LOST: ++lost; break;
+                default: ++timedOut; break;
+            }
+        }
+        std::cout << "  " << GetLevelDescriptor(LEVEL_SEQUENCE[index]).name << ": reached " << reached << ", won " << won
+                  << ", lost " << lost << ", timed out " << timedOut;
+        if (won > 0) std::cout << ", " << (double)wonSteps / won / 60.0 << " s to win on average";
+        std::cout << std::endl;
+    }
+    std::cout << "  " << seconds << " s wall, " << sessions / seconds << " sessions/s, "
+              << totalSteps / seconds / 1e6 << " M steps/s" << std::endl;
+    return 0;
+}
+
+const uint64_t REWIND_CHECK_SEED = 7;
+const int REWIND_CHECK_REPLAY_INTERVAL = 97; // Steps between the states replays start from
+
+// Plays every level with its bot for up to 'steps' steps, keeping each step's state in a
+// RewindBuffer, then checks that the buffer gives every state back exactly and that replaying
+// the recorded input from a restored state reproduces the states that followed. The first
+// difference points at state a level doesn't save, or at an update that isn't deterministic.
+int RunRewindCheck(int steps) {
+    int failures = 0;
+    state::Writer writer;
+    std::vector<unsigned char> held;
+    std::vector<input::InputState> inputs;
+    for (const LevelDescriptor& descriptor : LEVEL_REGISTRY) {
+        std::unique_ptr<Levels> level = descriptor.create(GLOBAL_SCREEN_WIDTH, GLOBAL_SCREEN_HEIGHT);
+        level->Seed(REWIND_CHECK_SEED);
+        level->Load();
+        while (!level->FinishLoad(1.0)) {}
+        std::unique_ptr<LevelBot> bot = descriptor.createBot(*level);
+
+        state::RewindBuffer buffer(REWIND_BUDGET_BYTES, REWIND_MAX_FRAMES);
+        inputs.clear();
+        size_t rawBytes = 0;
+        double saveMicros = 0.0;
+        int step = 0;
+        for (;; ++step) {
+            auto start = std::chrono::steady_clock::now();
+            writer.Clear();
+            level->SaveState(writer);
+            buffer.Push(writer.Data(), writer.Size());
+            saveMicros += std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+            rawBytes += writer.Size();
+            if (step == steps || level->IsComplete()) break;
+
+            inputs.push_back(bot->NextInput());
+            input::Scope inputScope(inputs.back());
+            level->Update(SIM_TIME_STEP);
+            mem::ResetFrameArena();
+        }
+
+        // The newest state must come back exactly as it was saved
+        bool ok = buffer.Get(buffer.NextFrame() - 1, held) && held.size() == writer.Size() &&
+                  std::memcmp(held.data(), writer.Data(), held.size()) == 0;
+        if (!ok) std::cerr << descriptor.name << ": newest state doesn't decode to what was saved" << std::endl;
+
+        // Replay from several held states; every state after that must match the recorded one
+        for (uint64_t from = buffer.FirstFrame(); ok && from < buffer.NextFrame(); from += REWIND_CHECK_REPLAY_INTERVAL) {
+            buffer.Get(from, held);
+            state::Reader reader(held.data(), held.size());
+            if (!level->LoadState(reader)) {
+                std::cerr << descriptor.name << ": state of step " << from << " doesn't load" << std::endl;
+                ok = false;
+                break;
+            }
+            for (uint64_t frame = from; ok && frame + 1 < buffer.NextFrame(); ++frame) {
+                input::Scope inputScope(inputs[(size_t)frame]);
+                level->Update(SIM_TIME_STEP);
+                mem::ResetFrameArena();
+                writer.Clear();
+                level->SaveState(writer);
+                buffer.Get(frame + 1, held);
+                size_t differsAt = 0;
+                while (differsAt < std::min(held.size(), writer.Size()) && held[differsAt] == writer.Data()[differsAt]) ++differsAt;
+                if (held.size() != writer.Size() || differsAt != held.size()) {
+                    std::cerr << descriptor.name << ": replay from step " << from << " diverges at step " << frame + 1
+                              << " (byte " << differsAt << " of " << held.size() << ")" << std::endl;
+                    ok = false;
+                }
+            }
+        }
+
+        std::cout << descriptor.name << ": " << step << " steps, " << buffer.Frames() << " held in "
+                  << buffer.BytesUsed() / 1024 << " KB (" << (double)rawBytes / (step + 1) / 1024 << " KB raw per step, "
+                  << (double)buffer.BytesUsed() / buffer.Frames() << " bytes encoded), " << saveMicros / (step + 1)
+                  << " us to save and encode a step: " << (ok ? "replays match" : "FAILED") << std::endl;
+        if (!ok) ++failures;
+        level->Unload();
+    }
+    return failures == 0 ? 0 : 1;
+}
+
+// Save states: the level being played, in a file, so a kiosk can suspend in the middle of a
+// level and carry on from there. A file is a small header and the bytes of Levels::SaveState().
+const uint32_t SAVE_STATE_MAGIC = 0x53524B42; // "BKRS"
+const uint32_t SAVE_STATE_VERSION = 1;        // Bump whenever a level's SaveLevelState() changes
+const size_t SAVE_STATE_HEADER_BYTES = 4 + 4 + 8 + 1 + 4 + 4 + 8;
+
+// The component types that end up in save files, in a fixed order. Called first thing in main(),
+// it hands out their ids in this order. The returned fingerprint of ids and sizes goes into every
+// file, so a file whose components don't line up with this build is rejected instead of misread.
+uint64_t SavedComponentLayout() {
+    uint64_t layout = SAVE_STATE_VERSION;
+    auto add = [&layout](ecs::ComponentId id, size_t size) { layout = rng::Mix64(layout ^ ((uint64_t)id << 32 | size)); };
+    add(ecs::ComponentTypeId<ecs::Body>(), sizeof(ecs::Body));
+    add(ecs::ComponentTypeId<ecs::Velocity>(), sizeof(ecs::Velocity));
+    add(ecs::ComponentTypeId<ecs::Tint>(), sizeof(ecs::Tint));
+    add(ecs::ComponentTypeId<ecs::Collectible>(), sizeof(ecs::Collectible));
+    add(ecs::ComponentTypeId<ecs::Solid>(), sizeof(ecs::Solid));
+    add(ecs::ComponentTypeId<SpaceInvadersLevel::Bullet>(), sizeof(SpaceInvadersLevel::Bullet));
+    add(ecs::ComponentTypeId<SpaceInvadersLevel::Invader>(), sizeof(SpaceInvadersLevel::Invader));
+    add(ecs::ComponentTypeId<FlappyLevel::Pipe>(), sizeof(FlappyLevel::Pipe));
+    return layout;
+}
+
+// A whole file, read-only. On Linux it is mapped, so a save state is read straight out of the
+// page cache into the level; elsewhere it is read into memory once.
+class MappedFile {
+public:
+    explicit MappedFile(const char* path) : m_data(nullptr), m_size(0) {
+#ifdef __linux__
+        int fd = open(path, O_RDONLY);
+        if (fd < 0) return;
+        struct stat info;
+        if (fstat(fd, &info) == 0 && info.st_size > 0) {
+            void* mapped = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapped != MAP_FAILED) {
+                m_data = static_cast<const unsigned char*>(mapped);
+                m_size = (size_t)info.st_size;
+            }
+        }
+        close(fd);
+#else
+        FILE* file = std::fopen(path, "rb");
+        if (!file) return;
+        unsigned char buffer[4096];
+        for (size_t read; (read = std::fread(buffer, 1, sizeof(buffer), file)) > 0;) m_bytes.insert(m_bytes.end(), buffer, buffer + read);
+        std::fclose(file);
+        m_data = m_bytes.data();
+        m_size = m_bytes.size();
+#endif
+    }
+
+    ~MappedFile() {
+#ifdef __linux__
+        if (m_data) munmap(const_cast<unsigned char*>(m_data), m_size);
+#endif
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool IsOpen() const { return m_data != nullptr; }
+    const unsigned char* Data() const { return m_data; }
+    size_t Size() const { return m_size; }
+
+private:
+    const unsigned char* m_data;
+    size_t m_size;
+#ifndef __linux__
+    std::vector<unsigned char> m_bytes;
+#endif
+};
+
+// Writes 'level' (at 'sequenceIndex' in LEVEL_SEQUENCE) to 'path'. The file is written next to
+// it and renamed into place, so a reader never sees half a file. 'body' is scratch space.
+bool WriteSaveState(const char* path, const Levels& level, size_t sequenceIndex, state::Writer& body) {
+    body.Clear();
+    level.SaveState(body);
+    state::Writer header;
+    header.Write(SAVE_STATE_MAGIC);
+    header.Write(SAVE_STATE_VERSION);
+    header.Write(SavedComponentLayout());
+    header.Write((uint8_t)level.GetTypeId());
+    header.Write((uint32_t)sequenceIndex);
+    header.Write((uint32_t)body.Size());
+    header.Write(state::HashBytes(body.Data(), body.Size()));
+    assert(header.Size() == SAVE_STATE_HEADER_BYTES);
+
+    std::string temporary = std::string(path) + ".tmp";
+    FILE* file = std::fopen(temporary.c_str(), "wb");
+    if (!file) return false;
+    bool written = std::fwrite(header.Data(), 1, header.Size(), file) == header.Size() &&
+                   std::fwrite(body.Data(), 1, body.Size(), file) == body.Size();
+    written = std::fclose(file) == 0 && written;
+    if (!written || std::rename(temporary.c_str(), path) != 0) {
+        std::remove(temporary.c_str());
+        return false;
+    }
+    return true;
+}
+
+// Builds the level saved at 'path' and puts its state back. Returns nullptr with 'error' set if
+// the file can't be used, or with 'error' left null if there is no file. Runs FinishLoad(), so
+// call it on the render thread.
+std::unique_ptr<Levels> ReadSaveState(const char* path, size_t& sequenceIndex, const char*& error) {
+    error = nullptr;
+    MappedFile file(path);
+    if (!file.IsOpen()) return nullptr;
+
+    state::Reader header(file.Data(), std::min(file.Size(), SAVE_STATE_HEADER_BYTES));
+    uint32_t magic = header.Read<uint32_t>();
+    uint32_t version = header.Read<uint32_t>();
+    uint64_t layout = header.Read<uint64_t>();
+    uint8_t levelType = header.Read<uint8_t>();
+    sequenceIndex = header.Read<uint32_t>();
+    uint32_t stateBytes = header.Read<uint32_t>();
+    uint64_t checksum = header.Read<uint64_t>();
+    const unsigned char* body = file.Data() + SAVE_STATE_HEADER_BYTES;
+
+    if (header.Failed() || magic != SAVE_STATE_MAGIC) error = "not a save state";
+    else if (version != SAVE_STATE_VERSION) error = "saved by another version";
+    else if (layout != SavedComponentLayout()) error = "saved with a different component layout";
+    else if (levelType >= (uint8_t)LevelTypeId::COUNT || sequenceIndex >= LEVEL_SEQUENCE_LENGTH) error = "unknown level";
+    else if (file.Size() - SAVE_STATE_HEADER_BYTES != stateBytes || state::HashBytes(body, stateBytes) != checksum) error = "file is damaged";
+    if (error) return nullptr;
+
+    std::unique_ptr<Levels> level = GetLevelDescriptor((LevelTypeId)levelType).create(GLOBAL_SCREEN_WIDTH, GLOBAL_SCREEN_HEIGHT);
+    level->Load();
+    while (!level->FinishLoad(1.0)) {}
+    state::Reader reader(body, stateBytes);
+    if (!level->LoadState(reader)) {
+        error = "state doesn't fit the level";
+        level->Unload();
+        return nullptr;
+    }
+    return level;
+}
+
+// Times suspending and resuming each level a few steps into a bot's game, through a file at
+// 'path', and checks that the resumed level is in exactly the state that was saved.
+int RunSaveStateBenchmark(const char* path) {
+    const int ITERATIONS = 200;
+    const int WARMUP_STEPS = 600;
+    int failures = 0;
+    state::Writer body, resumed;
+    for (const LevelDescriptor& descriptor : LEVEL_REGISTRY) {
+        std::unique_ptr<Levels> level = descriptor.create(GLOBAL_SCREEN_WIDTH, GLOBAL_SCREEN_HEIGHT);
+        level->Seed(REWIND_CHECK_SEED);
+        level->Load();
+        while (!level->FinishLoad(1.0)) {}
+        std::unique_ptr<LevelBot> bot = descriptor.createBot(*level);
+        for (int step = 0; step < WARMUP_STEPS && !level->IsComplete(); ++step) {
+            input::InputState botInput = bot->NextInput();
+            input::Scope inputScope(botInput);
+            level->Update(SIM_TIME_STEP);
+            mem::ResetFrameArena();
+        }
+
+        double saveMicros = 0.0, resumeMicros = 0.0;
+        bool ok = true;
+        for (int i = 0; i < ITERATIONS && ok; ++i) {
+            auto start = std::chrono::steady_clock::now();
+            ok = WriteSaveState(path, *level, 0, body);
+            auto saved = std::chrono::steady_clock::now();
+            size_t sequenceIndex = 0;
+            const char* error = nullptr;
+            std::unique_ptr<Levels> copy = ok ? ReadSaveState(path, sequenceIndex, error) : nullptr;
+            auto loaded = std::chrono::steady_clock::now();
+            saveMicros += std::chrono::duration<double, std::micro>(saved - start).count();
+            resumeMicros += std::chrono::duration<double, std::micro>(loaded - saved).count();
+
+            if (copy) {
+                resumed.Clear();
+                copy->SaveState(resumed);
+                copy->Unload();
+            }
+            if (!copy || resumed.Size() != body.Size() || std::memcmp(resumed.Data(), body.Data(), body.Size()) != 0) {
+                std::cerr << descriptor.name << ": resumed state differs from the saved one" << (error ? ": " : "") << (error ? error : "") << std::endl;
+                ok = false;
+            }
+        }
+        std::cout << descriptor.name << ": " << SAVE_STATE_HEADER_BYTES + body.Size() << " bytes, suspend "
+                  << saveMicros / ITERATIONS << " us, resume " << resumeMicros / ITERATIONS << " us" << (ok ? "" : ": FAILED") << std::endl;
+        if (!ok) ++failures;
+        level->Unload();
+    }
+    std::remove(path);
+    return failures == 0 ? 0 : 1;
+}
+
+// Times Emit() in bursts far larger than any real step makes, then reads the files back and
+// checks that every event not counted as dropped arrived, in order.
+int RunTelemetryBenchmark(const char* prefix) {
+    const int BURSTS = 2000;
+    const int BURST_EVENTS = 48; // Far more than a level emits in one step, still within one batch
+    telemetry::Recorder recorder;
+    if (!recorder.Start(prefix)) return 1;
+    recorder.Attach();
+    double emitSeconds = 0.0, stepSeconds = 0.0;
+    for (int burst = 0; burst < BURSTS; ++burst) {
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < BURST_EVENTS; ++i) telemetry::Emit(telemetry::EventType::COIN_COLLECTED, i, (float)i, (float)burst);
+        auto emitted = std::chrono::steady_clock::now();
+        telemetry::NextStep(); // Hands the burst to the writer
+        emitSeconds += std::chrono::duration<double>(emitted - start).count();
+        stepSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - emitted).count();
+        std::this_thread::sleep_for(std::chrono::milliseconds(1)); // The rest of a (short) step
+    }
+    telemetry::Recorder::Detach();
+    uint64_t dropped = recorder.Dropped();
+    recorder.Stop();
+
+    const uint64_t emitted = (uint64_t)BURSTS * BURST_EVENTS;
+    uint64_t read = 0, missing = 0;
+    int64_t lastSequence = -1;
+    bool ordered = true;
+    for (int index = 0; index < recorder.FileCount(); ++index) {
+        std::string name = recorder.FileName(index);
+        MappedFile file(name.c_str());
+        state::Reader reader(file.Data(), file.Size());
+        uint32_t magic = reader.Read<uint32_t>();
+        uint32_t version = reader.Read<uint32_t>();
+        uint32_t eventBytes = reader.Read<uint32_t>();
+        uint32_t fileIndex = reader.Read<uint32_t>();
+        reader.Read<int64_t>(); // Session
+        ordered = ordered && magic == telemetry::Recorder::MAGIC && version == telemetry::Recorder::VERSION &&
+                  eventBytes == sizeof(telemetry::Event) && fileIndex == (uint32_t)index;
+        while (!reader.AtEnd()) {
+            telemetry::Event event;
+            reader.Read(event);
+            if (reader.Failed()) break;
+            ordered = ordered && (int64_t)event.sequence > lastSequence;
+            missing += event.sequence - (uint64_t)(lastSequence + 1);
+            lastSequence = event.sequence;
+            ++read;
+        }
+        ordered = ordered && !reader.Failed();
+        std::remove(name.c_str());
+    }
+    missing += emitted - (uint64_t)(lastSequence + 1);
+    std::cout << "Telemetry: " << emitSeconds / emitted * 1e9 << " ns per event, " << stepSeconds / BURSTS * 1e9 << " ns per step to hand "
+              << BURST_EVENTS << " to the writer, " << emitted << " emitted, " << read << " read back from "
+              << recorder.FileCount() << " files, " << dropped << " dropped" << std::endl;
+    bool ok = ordered && read + dropped == emitted && missing == dropped;
+    if (!ok) std::cerr << "Telemetry files don't match what was emitted" << std::endl;
+    return ok ? 0 : 1;
+}
+
+// Checks the audio path against a null device: how long Play() takes, that the SIMD mix matches
+// a scalar one, how long a block takes with every voice busy, and that each level, played by its
+// bot, makes sound that reaches the device intact.
+int RunAudioCheck(int steps) {
+    const int BURSTS = 2000;
+    const int BURST_SOUNDS = 8; // More than any level plays in one step
+    const int MIX_BLOCKS = 20;
+    int failures = 0;
+    for (size_t effect = 0; effect < (size_t)audio::Effect::COUNT; ++effect) audio::g_effects.Prepare((audio::Effect)effect);
+
+    // Play() in bursts against a device running in real time
+    {
+        audio::NullSink sink(audio::NullSink::Clock::REAL_TIME);
+        audio::Mixer mixer;
+        mixer.Start(sink);
+        mixer.Attach();
+        double playSeconds = 0.0;
+        for (int burst = 0; burst < BURSTS; ++burst) {
+            auto start = std::chrono::steady_clock::now();
+            for (int i = 0; i < BURST_SOUNDS; ++i) audio::Play((audio::Effect)(i % (int)audio::Effect::COUNT), 0.5f, (float)i / BURST_SOUNDS * 2.0f - 1.0f);
+            playSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        audio::Mixer::Detach();
+        mixer.Stop();
+        int16_t block[audio::BLOCK_FRAMES * 2];
+        mixer.MixBlock(block); // Starts whatever was still queued
+        const uint64_t played = (uint64_t)BURSTS * BURST_SOUNDS;
+        bool ok = mixer.Posted() == played && mixer.VoicesStarted() + mixer.Dropped() == played;
+        std::cout << "Play: " << playSeconds / played * 1e9 << " ns per sound, " << played << " played, " << mixer.Dropped()
+                  << " dropped, " << mixer.VoicesStolen() << " voices stolen, " << mixer.PeakVoices() << " playing at most, "
+                  << sink.Blocks() << " blocks, " << sink.ClippedSamples() << " samples clipped: " << (ok ? "ok" : "FAILED") << std::endl;
+        if (!ok) ++failures;
+    }
+
+    // The SIMD mix against plain float arithmetic, odd lengths included
+    {
+        rng::Stream random(1);
+        std::vector<float> samples(audio::BLOCK_FRAMES);
+        alignas(16) float left[audio::BLOCK_FRAMES], right[audio::BLOCK_FRAMES];
+        float expectedLeft[audio::BLOCK_FRAMES], expectedRight[audio::BLOCK_FRAMES];
+        int16_t interleaved[audio::BLOCK_FRAMES * 2];
+        int worst = 0;
+        for (int trial = 0; trial < 100; ++trial) {
+            for (int i = 0; i < audio::BLOCK_FRAMES; ++i) {
+                left[i] = expectedLeft[i] = random.NextFloat() - 0.5f;
+                right[i] = expectedRight[i] = random.NextFloat() - 0.5f;
+                samples[(size_t)i] = random.NextFloat() * 2.0f - 1.0f;
+            }
+            uint32_t frames = (uint32_t)random.Range(1, audio::BLOCK_FRAMES);
+            float gainLeft = random.NextFloat(), gainRight = random.NextFloat();
+            audio::Mixer::MixVoice(samples.data(), frames, gainLeft, gainRight, left, right);
+            audio::Mixer::ToInterleaved(left, right, interleaved);
+            for (uint32_t i = 0; i < audio::BLOCK_FRAMES; ++i) {
+                if (i < frames) {
+                    expectedLeft[i] += samples[i] * gainLeft;
+                    expectedRight[i] += samples[i] * gainRight;
+                }
+                int l = (int)std::lrint(std::max(-1.0f, std::min(1.0f, expectedLeft[i])) * 32767.0f);
+                int r = (int)std::lrint(std::max(-1.0f, std::min(1.0f, expectedRight[i])) * 32767.0f);
+                worst = std::max(worst, std::max(std::abs(l - interleaved[i * 2]), std::abs(r - interleaved[i * 2 + 1])));
+            }
+        }
+        bool ok = worst <= 1;
+        std::cout << "Mix: SIMD within " << worst << " LSB of scalar: " << (ok ? "ok" : "FAILED") << std::endl;
+        if (!ok) ++failures;
+    }
+
+    // A block with every voice playing the longest effect
+    {
+        audio::Mixer mixer;
+        for (int i = 0; i < audio::MAX_VOICES; ++i) mixer.Post({ audio::Effect::HIT, 1.0f, 0.0f });
+        int16_t block[audio::BLOCK_FRAMES * 2];
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < MIX_BLOCKS; ++i) mixer.MixBlock(block);
+        double micros = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / MIX_BLOCKS;
+        std::cout << "Mix: " << micros << " us per block of " << mixer.PeakVoices() << " voices (a block plays for "
+                  << 1e6 * audio::BLOCK_FRAMES / audio::SAMPLE_RATE << " us)" << std::endl;
+    }
+
+    // Every level with its bot, faster than real time, its sounds spaced as the steps are
+    const uint64_t STEP_FRAMES = (uint64_t)(SIM_TIME_STEP * audio::SAMPLE_RATE + 0.5f);
+    for (const LevelDescriptor& descriptor : LEVEL_REGISTRY) {
+        audio::NullSink sink(audio::NullSink::Clock::ADVANCED);
+        audio::Mixer mixer;
+        mixer.Start(sink);
+        mixer.Attach();
+        std::unique_ptr<Levels> level = descriptor.create(GLOBAL_SCREEN_WIDTH, GLOBAL_SCREEN_HEIGHT);
+        level->Seed(REWIND_CHECK_SEED);
+        level->Load();
+        while (!level->FinishLoad(1.0)) {}
+        std::unique_ptr<LevelBot> bot = descriptor.createBot(*level);
+        int step = 0;
+        for (; step < steps && !level->IsComplete(); ++step) {
+            input::InputState botInput = bot->NextInput();
+            input::Scope inputScope(botInput);
+            level->Update(SIM_TIME_STEP);
+            mem::ResetFrameArena();
+            sink.Advance(STEP_FRAMES);
+            while (sink.Frames() < sink.Advanced()) std::this_thread::yield(); // The mixer keeps up with the step
+        }
+        audio::Mixer::Detach();
+        sink.Advance(audio::SAMPLE_RATE); // A second for the last sounds to ring out
+        while (sink.Frames() < sink.Advanced()) std::this_thread::yield();
+        mixer.Stop();
+        level->Unload();
+        bool ok = mixer.Posted() > 0 && sink.AudibleBlocks() > 0 && mixer.VoicesStarted() + mixer.Dropped() == mixer.Posted();
+        std::cout << descriptor.name << ": " << step << " steps, " << mixer.Posted() << " sounds, " << mixer.Dropped() << " dropped, "
+                  << sink.AudibleBlocks() << " audible blocks, peak " << sink.Peak() << ", " << sink.ClippedSamples()
+                  << " samples clipped: " << (ok ? "ok" : "FAILED") << std::endl;
+        if (!ok) ++failures;
+    }
+    return failures == 0 ? 0 : 1;
+}
+
+const char* const VERSUS_LEVEL_NAMES[] = { "maze", "invaders", "flappy", "obstacle" }; // Indexed by LevelTypeId, for --versus
+const uint64_t VERSUS_PERTURB_SEED = 0xBAD5EED; // What NetVersus::Perturb() reseeds with
+
+// Both players' levels in a versus match: each level gets only its own player's input, and
+// every process runs both. Drawn side by side at half width, player 0 on the left. The first
+// player to win a level takes the match; if both lose, the higher score does.
+class VersusMatch {
+public:
+    VersusMatch() : m_over(false), m_winner(-1) {}
+    ~VersusMatch() {
+        for (std::unique_ptr<Levels>& level : m_levels) {
+            if (level) level->Unload();
+        }
+    }
+
+    void Start(const LevelDescriptor& descriptor, uint64_t seed) {
+        for (std::unique_ptr<Levels>& level : m_levels) {
+            level = descriptor.create(GLOBAL_SCREEN_WIDTH / 2, GLOBAL_SCREEN_HEIGHT);
+            level->Seed(seed); // Same layout for both
+            level->Load();
+            while (!level->FinishLoad(1.0)) {}
+        }
+    }
+
+    // One frame, with both players' inputs
+    void Step(uint16_t input0, uint16_t input1) {
+        const uint16_t inputs[2] = { input0, input1 };
+        for (int player = 0; player < 2; ++player) {
+            if (m_levels[player]->IsComplete()) continue;
+            input::InputState playerInput = input::Unpack(inputs[player]);
+            input::Scope inputScope(playerInput);
+            m_levels[player]->Update(SIM_TIME_STEP);
+        }
+        mem::ResetFrameArena();
+        if (!m_over) Decide();
+    }
+
+    // Everything Step() can change, to go back to when rolling back
+    struct Snapshot {
+        uint32_t frame = UINT32_MAX; // The frame about to be simulated from this state
+        state::Writer levels[2];
+        bool over = false;
+        int winner = -1;
+    };
+
+    void Save(Snapshot& snapshot, uint32_t frame) const {
+        snapshot.frame = frame;
+        for (int player = 0; player < 2; ++player) {
+            snapshot.levels[player].Clear();
+            m_levels[player]->SaveState(snapshot.levels[player]);
+        }
+        snapshot.over = m_over;
+        snapshot.winner = m_winner;
+    }
+
+    bool Load(const Snapshot& snapshot) {
+        for (int player = 0; player < 2; ++player) {
+            state::Reader reader(snapshot.levels[player].Data(), snapshot.levels[player].Size());
+            if (!m_levels[player]->LoadState(reader)) return false;
+        }
+        m_over = snapshot.over;
+        m_winner = snapshot.winner;
+        return true;
+    }
+
+    // Hash of a snapshot, which must match the other process's after the same frame
+    static uint64_t Hash(const Snapshot& snapshot) {
+        uint64_t hash = state::HashBytes(snapshot.levels[0].Data(), snapshot.levels[0].Size());
+        return hash * 31 + state::HashBytes(snapshot.levels[1].Data(), snapshot.levels[1].Size());
+    }
+
+    uint64_t Hash() {
+        Save(m_scratch, 0);
+        return Hash(m_scratch);
+    }
+
+    bool Over() const { return m_over; }
+    int Winner() const { return m_winner; } // -1 for a draw
+    Levels& Level(int player) { return *m_levels[player]; }
+
+    // 'showResult' once the result can no longer change, which it can while rolling back
+    void Draw(gfx::DrawList& out, int localPlayer, bool showResult) const {
+        out.ClearBackground(BLACK);
+        for (int player = 0; player < 2; ++player) {
+            out.SetViewport({ (float)(player * GLOBAL_SCREEN_WIDTH / 2), 0, (float)(GLOBAL_SCREEN_WIDTH / 2), (float)GLOBAL_SCREEN_HEIGHT });
+            out.SetLayer(gfx::Layer::WORLD);
+            m_levels[player]->Draw(out);
+            out.ResetViewport();
+            const char* label = player == localPlayer ? "YOU" : "OPPONENT";
+            out.SetLayer(gfx::Layer::HUD);
+            out.DrawText(label, player * GLOBAL_SCREEN_WIDTH / 2 + GLOBAL_SCREEN_WIDTH / 4 - MeasureText(label, 20) / 2, GLOBAL_SCREEN_HEIGHT - 50, 20, player == localPlayer ? GOLD : LIGHTGRAY);
+        }
+        out.SetLayer(gfx::Layer::HUD);
+        out.DrawRectangle(GLOBAL_SCREEN_WIDTH / 2 - 2, 0, 4, GLOBAL_SCREEN_HEIGHT, DARKGRAY);
+        if (m_over && showResult) {
+            const char* result = m_winner < 0 ? "DRAW" : m_winner == localPlayer ? "YOU WIN!" : "YOU LOSE";
+            out.DrawRectangle(0, GLOBAL_SCREEN_HEIGHT / 2 - 50, GLOBAL_SCREEN_WIDTH, 100, Fade(BLACK, 0.8f));
+            out.DrawText(result, GLOBAL_SCREEN_WIDTH / 2 - MeasureText(result, 60) / 2, GLOBAL_SCREEN_HEIGHT / 2 - 30, 60, m_winner == localPlayer ? GOLD : RAYWHITE);
+        }
+    }
+
+private:
+    std::unique_ptr<Levels> m_levels[2];
+    Snapshot m_scratch;
+    bool m_over;
+    int m_winner;
+
+    void Decide() {
+        LevelOutcome outcomes[2] = { m_levels[0]->GetOutcome(), m_levels[1]->GetOutcome() };
+        bool won0 = outcomes[0] == LevelOutcome::WON, won1 = outcomes[1] == LevelOutcome::WON;
+        bool bothLost = outcomes[0] == LevelOutcome::LOST && outcomes[1] == LevelOutcome::LOST;
+        if (!won0 && !won1 && !bothLost) return;
+        m_over = true;
+        if (won0 != won1) {
+            m_winner = won0 ? 0 : 1;
+        } else {
+            int score0 = m_levels[0]->GetScore(), score1 = m_levels[1]->GetScore();
+            m_winner = score0 == score1 ? -1 : score0 > score1 ? 0 : 1;
+        }
+    }
+};
+
+// Plays a VersusMatch against the peer through a net::Session. Keeps the match's state from
+// before each of the last SNAPSHOTS frames: a rollback loads one of them, and the hashes
+// compared with the peer come from them, since by the time both inputs for a frame are known
+// the match may have been predicted several frames further.
+class NetVersus {
+public:
+    static const uint32_t SNAPSHOTS = 16; // At least MAX_ROLLBACK + 1 frames back
+
+    explicit NetVersus(net::Session& session)
+        : m_session(session), m_perturbFrame(net::Session::NO_FRAME), m_framesResimulated(0), m_longestRollbackSeconds(0.0),
+          m_saveSeconds(0.0), m_loadSeconds(0.0), m_saves(0), m_loads(0) {}
+
+    void Start(const LevelDescriptor& descriptor, uint64_t seed) {
+        m_match.Start(descriptor, seed);
+        Save(0);
+    }
+
+    // Simulates again whatever a late input of the peer's changed, then Frame() if the
+    // session is ready for it and it is before 'endFrame'. Returns whether Frame() was simulated.
+    bool Update(uint32_t endFrame = net::Session::NO_FRAME) {
+        uint32_t from;
+        if (m_session.TakeRollback(from)) {
+            auto start = std::chrono::steady_clock::now();
+            Load(from);
+            for (uint32_t frame = from; frame < m_session.Frame(); ++frame) Simulate(frame);
+            m_framesResimulated += m_session.Frame() - from;
+            m_longestRollbackSeconds = std::max(m_longestRollbackSeconds, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+        }
+        bool ready = m_session.Ready() && m_session.Frame() < endFrame;
+        if (ready) {
+            Simulate(m_session.Frame());
+            m_session.Advance();
+        }
+        for (uint32_t frame = m_session.HashFrameDue(); frame != net::Session::NO_FRAME; frame = m_session.HashFrameDue()) {
+            m_session.RecordHash(frame, VersusMatch::Hash(SnapshotBefore(frame + 1)));
+        }
+        return ready;
+    }
+
+    // The match is decided, and no rollback can change that any more
+    bool Over() const { return m_match.Over() && m_session.ConfirmedFrames() == m_session.Frame(); }
+
+    VersusMatch& Match() { return m_match; }
+    void Draw(gfx::DrawList& out) const { m_match.Draw(out, m_session.LocalPlayer(), Over()); }
+
+    // Makes every simulation of 'frame' on this side differ from the peer's, for testing that a desync is caught
+    void Perturb(uint32_t frame) { m_perturbFrame = frame; }
+
+    uint64_t FramesResimulated() const { return m_framesResimulated; }
+    double LongestRollbackSeconds() const { return m_longestRollbackSeconds; }
+    double AverageSaveSeconds() const { return m_saves ? m_saveSeconds / m_saves : 0.0; }
+    double AverageLoadSeconds() const { return m_loads ? m_loadSeconds / m_loads : 0.0; }
+
+private:
+    net::Session& m_session;
+    VersusMatch m_match;
+    VersusMatch::Snapshot m_snapshots[SNAPSHOTS];
+    uint32_t m_perturbFrame;
+    uint64_t m_framesResimulated;
+    double m_longestRollbackSeconds;
+    double m_saveSeconds;
+    double m_loadSeconds;
+    uint64_t m_saves;
+    uint64_t m_loads;
+
+    void Simulate(uint32_t frame) {
+        m_match.Step(m_session.Input(0, frame), m_session.Input(1, frame));
+        if (frame == m_perturbFrame) m_match.Level(0).Seed(VERSUS_PERTURB_SEED);
+        Save(frame + 1);
+    }
+
+    VersusMatch::Snapshot& SnapshotBefore(uint32_t frame) {
+        VersusMatch::Snapshot& snapshot = m_snapshots[frame % SNAPSHOTS];
+        assert(snapshot.frame == frame && "rolled back further than the snapshots go");
+        return snapshot;
+    }
+
+    void Save(uint32_t frame) {
+        auto start = std::chrono::steady_clock::now();
+        m_match.Save(m_snapshots[frame % SNAPSHOTS], frame);
+        m_saveSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        ++m_saves;
+    }
+
+    void Load(uint32_t frame) {
+        auto start = std::chrono::steady_clock::now();
+        bool loaded = m_match.Load(SnapshotBefore(frame));
+        assert(loaded && "a snapshot didn't load");
+        (void)loaded;
+        m_loadSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        ++m_loads;
+    }
+};
+
+// Plays a versus match in a window against another process on this machine. Both are started
+// with the two ports swapped; player 0's level choice and seed are the ones played.
+// 'latencyMs' holds our packets back, to try the mode over a slower connection.
+int RunVersus(uint16_t localPort, uint16_t peerPort, const char* levelName, net::Session::Mode mode, int latencyMs) {
+    int levelType = -1;
+    for (size_t i = 0; i < (size_t)LevelTypeId::COUNT; ++i) {
+        if (std::strcmp(levelName, VERSUS_LEVEL_NAMES[i]) == 0) levelType = (int)i;
+    }
+    if (levelType < 0 || !GetLevelDescriptor((LevelTypeId)levelType).splitScreen) {
+        std::cerr << "Versus mode plays \"maze\" or \"flappy\"" << std::endl;
+        return 1;
+    }
+    net::LoopbackSocket socket;
+    if (localPort == peerPort || !socket.Open(localPort)) {
+        std::cerr << "Can't use port " << localPort << " for versus mode" << std::endl;
+        return 1;
+    }
+    socket.SetPeer(peerPort);
+    net::Session session(socket, mode);
+    session.SimulateLatency(latencyMs);
+    net::Session::Match match = { (uint8_t)levelType, (uint64_t)std::time(nullptr) };
+
+    InitWindow(GLOBAL_SCREEN_WIDTH, GLOBAL_SCREEN_HEIGHT, "");
+    SetTargetFPS(60); // One frame of the match per displayed frame
+    LoadSpriteAtlas();
+    gfx::spriteAtlas.Upload();
+    NetVersus versus(session);
+    bool started = false;
+    std::unique_ptr<LevelBot> bot;
+    input::InputState pending; // Presses since the last input we scheduled
+    gfx::DrawList frame;
+    gfx::ScreenBackend screen;
+    int stalledFrames = 0;
+    while (!WindowShouldClose()) {
+        input::Merge(pending, input::Sample());
+        const char* status = nullptr;
+        if (!started && session.Connect(match)) {
+            versus.Start(GetLevelDescriptor((LevelTypeId)match.levelType), match.seed);
+            if (autoplay) bot = GetLevelDescriptor((LevelTypeId)match.levelType).createBot(versus.Match().Level(session.LocalPlayer()));
+            started = true;
+        }
+        if (!started) {
+            status = session.Error() ? session.Error() : mem::ScratchFormat("Waiting for the other player on port %u...", (unsigned)peerPort);
+        } else {
+            if (!versus.Over() && session.DesyncFrame() < 0 && session.WantsLocalInput()) {
+                session.AddLocalInput(input::Pack(bot ? bot->NextInput() : pending));
+                pending.keysPressed = 0;
+            }
+            session.Pump(); // Keeps going after the match, so the peer gets our last inputs
+            if (!versus.Over() && session.DesyncFrame() < 0) {
+                if (versus.Update()) {
+                    stalledFrames = 0;
+                } else if (session.PeerLost()) {
+                    status = "The other player left";
+                } else if (++stalledFrames > 10) {
+                    status = "Waiting for the other player...";
+                }
+            }
+            if (session.DesyncFrame() >= 0) status = mem::ScratchFormat("Out of sync with the other player since frame %lld", (long long)session.DesyncFrame());
+        }
+
+        frame.Clear();
+        if (started) versus.Draw(frame);
+        else frame.ClearBackground(BLACK);
+        if (status) {
+            frame.SetLayer(gfx::Layer::HUD);
+            frame.DrawText(status, GLOBAL_SCREEN_WIDTH / 2 - MeasureText(status, 25) / 2, 20, 25, YELLOW);
+        }
+        frame.Sort();
+        BeginDrawing();
+        frame.Submit(screen);
+        EndDrawing();
+        mem::ResetFrameArena();
+    }
+    gfx::spriteAtlas.Unload();
+    CloseWindow();
+    return 0;
+}
+
+const uint64_t VERSUS_CHECK_SEED = 11;
+const int VERSUS_CHECK_LOSS_PERCENT = 10;
+const int VERSUS_CHECK_LATENCY_MS = 50; // Each way, for rollback; lockstep is checked at loopback speed
+
+// How one side of a headless versus match went
+struct VersusPeerResult {
+    const char* error = nullptr;
+    uint32_t frames = 0;
+    uint64_t finalHash = 0;
+    int64_t desyncFrame = -1;
+    uint32_t hashesChecked = 0;
+    uint32_t stalls = 0;
+    uint64_t bytesSent = 0;
+    double simulateSeconds = 0.0;
+    uint32_t rollbacks = 0;
+    uint32_t longestRollback = 0;
+    uint64_t framesResimulated = 0;
+    double longestRollbackSeconds = 0.0;
+    double saveSeconds = 0.0;
+    double loadSeconds = 0.0;
+};
+
+// One side of RunVersusCheck's matches. Player 0 is played by the level's bot, player 1 by
+// random input. Lockstep runs flat out; rollback ticks at 60 Hz, as the simulated latency is
+// real time. With 'perturbAt', this side's copy of player 0's level goes its own way there.
+void PlayVersusPeer(net::LoopbackSocket& socket, LevelTypeId type, net::Session::Mode mode, uint32_t frames, uint32_t perturbAt, VersusPeerResult& result) {
+    const bool rollback = mode == net::Session::Mode::ROLLBACK;
+    net::Session session(socket, mode);
+    session.SimulateLoss(VERSUS_CHECK_LOSS_PERCENT);
+    if (rollback) session.SimulateLatency(VERSUS_CHECK_LATENCY_MS);
+    net::Session::Match match = { (uint8_t)type, VERSUS_CHECK_SEED };
+    while (!session.Connect(match)) {
+        if (session.Error() || session.PeerLost()) {
+            result.error = session.Error() ? session.Error() : "no answer from the other side";
+            return;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    NetVersus versus(session);
+    versus.Start(GetLevelDescriptor((LevelTypeId)match.levelType), match.seed);
+    versus.Perturb(perturbAt);
+    std::unique_ptr<LevelBot> bot;
+    if (session.LocalPlayer() == 0) bot = GetLevelDescriptor((LevelTypeId)match.levelType).createBot(versus.Match().Level(0));
+    input::ScriptedInput scripted(rng::Stream(VERSUS_CHECK_SEED).Fork(1));
+
+    auto nextTick = std::chrono::steady_clock::now();
+    // Until every frame is simulated with the peer's real input, not a prediction
+    while (session.ConfirmedFrames() < frames && !versus.Over() && session.DesyncFrame() < 0) {
+        if (session.WantsLocalInput()) session.AddLocalInput(input::Pack(bot ? bot->NextInput() : scripted.Next()));
+        session.Pump();
+        if (session.PeerLost()) {
+            result.error = "the other side stopped answering";
+            return;
+        }
+        auto start = std::chrono::steady_clock::now();
+        bool simulated = versus.Update(frames);
+        result.simulateSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (rollback) {
+            nextTick += std::chrono::microseconds(16667);
+            std::this_thread::sleep_until(nextTick);
+        } else if (!simulated) {
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+        if (!simulated) ++result.stalls;
+    }
+    // Keep answering for a moment, so the other side gets our last inputs and hash
+    auto lingerUntil = std::chrono::steady_clock::now() + std::chrono::milliseconds(300 + 2 * VERSUS_CHECK_LATENCY_MS);
+    while (std::chrono::steady_clock::now() < lingerUntil) {
+        session.Pump();
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    result.frames = session.Frame();
+    result.finalHash = versus.Match().Hash();
+    result.desyncFrame = session.DesyncFrame();
+    result.hashesChecked = session.HashesChecked();
+    result.bytesSent = session.BytesSent();
+    result.rollbacks = session.Rollbacks();
+    result.longestRollback = session.LongestRollback();
+    result.framesResimulated = versus.FramesResimulated();
+    result.longestRollbackSeconds = versus.LongestRollbackSeconds();
+    result.saveSeconds = versus.AverageSaveSeconds();
+    result.loadSeconds = versus.AverageLoadSeconds();
+}
+
+// Plays headless versus matches between two threads over loopback UDP, with
+// VERSUS_CHECK_LOSS_PERCENT of packets dropped: every split-screen level in lockstep, or the
+// flappy race with rollback and VERSUS_CHECK_LATENCY_MS of latency. Checks that both sides
+// simulate the same frames into the same state, then that a desync is caught.
+int RunVersusCheck(uint32_t frames, net::Session::Mode mode) {
+    const bool rollback = mode == net::Session::Mode::ROLLBACK;
+    int failures = 0;
+    for (const LevelDescriptor& descriptor : LEVEL_REGISTRY) {
+        if (!descriptor.splitScreen || (rollback && descriptor.typeId != LevelTypeId::FLAPPY)) continue;
+        for (bool perturb : { false, true }) {
+            net::LoopbackSocket sockets[2];
+            if (!sockets[0].Open(0) || !sockets[1].Open(0)) {
+                std::cerr << "Can't open loopback sockets" << std::endl;
+                return 1;
+            }
+            sockets[0].SetPeer(sockets[1].Port());
+            sockets[1].SetPeer(sockets[0].Port());
+            const uint32_t perturbAt = perturb ? std::min(frames / 2, 100u) : net::Session::NO_FRAME;
+            VersusPeerResult results[2];
+            std::thread other(PlayVersusPeer, std::ref(sockets[1]), descriptor.typeId, mode, frames, net::Session::NO_FRAME, std::ref(results[1]));
+            PlayVersusPeer(sockets[0], descriptor.typeId, mode, frames, perturbAt, results[0]);
+            other.join();
+
+            bool ok;
+            if (results[0].error || results[1].error) {
+                std::cerr << descriptor.name << ": " << (results[0].error ? results[0].error : results[1].error) << std::endl;
+                ok = false;
+            } else if (!perturb) {
+                ok = results[0].frames == results[1].frames && results[0].finalHash == results[1].finalHash &&
+                     results[0].desyncFrame < 0 && results[1].desyncFrame < 0 && results[0].hashesChecked > 0;
+                std::cout << descriptor.name << ": " << results[0].frames << " frames, "
+                          << results[0].simulateSeconds / std::max(1u, results[0].frames) * 1e6 << " us per frame, "
+                          << (results[0].bytesSent + results[1].bytesSent) / std::max(1u, results[0].frames) << " bytes per frame, "
+                          << results[0].stalls + results[1].stalls << " stalls, " << results[0].hashesChecked << " hashes compared";
+                if (rollback) {
+                    const VersusPeerResult& worst = results[0].longestRollbackSeconds > results[1].longestRollbackSeconds ? results[0] : results[1];
+                    // Re-simulating the longest rollback must fit in a frame, alongside the frame itself
+                    ok = ok && worst.longestRollbackSeconds < SIM_TIME_STEP;
+                    std::cout << ", " << results[0].rollbacks + results[1].rollbacks << " rollbacks of up to "
+                              << std::max(results[0].longestRollback, results[1].longestRollback) << " frames ("
+                              << results[0].framesResimulated + results[1].framesResimulated << " frames simulated again, longest "
+                              << worst.longestRollbackSeconds * 1e3 << " ms), snapshots saved in " << results[0].saveSeconds * 1e6
+                              << " us and loaded in " << results[0].loadSeconds * 1e6 << " us";
+                }
+                std::cout << (ok ? "" : ": SIDES DIVERGED") << std::endl;
+            } else {
+                int64_t caught = results[0].desyncFrame;
+                ok = caught >= (int64_t)perturbAt && caught < (int64_t)(perturbAt + net::Session::HASH_INTERVAL) && results[1].desyncFrame == caught;
+                std::cout << descriptor.name << ": desync made at frame " << perturbAt << " caught at frame " << caught
+                          << " (other side: " << results[1].desyncFrame << ")" << (ok ? "" : ": NOT CAUGHT") << std::endl;
+            }
+            if (!ok) ++failures;
+        }
+    }
+    return failures == 0 ? 0 : 1;
+}
+
+// Starts the game inside the level saved at 'path', if there is a usable save state there.
+// The file is removed once resumed, so a game that ends doesn't come back on the next start.
+// Render thread, before the simulation starts.
+void ResumeFromSaveState(const char* path) {
+    auto start = std::chrono::steady_clock::now();
+    size_t sequenceIndex = 0;
+    const char* error = nullptr;
+    std::unique_ptr<Levels> level = ReadSaveState(path, sequenceIndex, error);
+    if (!level) {
+        if (error) std::cout << "Not resuming from " << path << ": " << error << std::endl;
+        return;
+    }
+    SetupGameLevels();
+    nextLevelIndex = sequenceIndex + 1;
+    runLevelsCleared = (int)sequenceIndex; // The run's earlier scores weren't saved with it
+    levelSteps = 0;
+    currentLevelMemScope = memtrack::ScopeFor(level->GetName());
+    currentActiveLevel = std::move(level);
+    currentGlobalScreen = PLAYING_LEVEL;
+    std::remove(path);
+    std::cout << "Resumed " << currentActiveLevel->GetName() << " from " << path << " in "
+              << std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() << " ms" << std::endl;
+}
+
+// Saves the level being played to 'path', if any, for ResumeFromSaveState() on the next start.
+// Once the simulation has stopped.
+void SuspendToSaveState(const char* path) {
+    if (currentGlobalScreen != PLAYING_LEVEL || !currentActiveLevel || currentActiveLevel->IsComplete()) return;
+    auto start = std::chrono::steady_clock::now();
+    state::Writer body;
+    if (!WriteSaveState(path, *currentActiveLevel, nextLevelIndex - 1, body)) {
+        std::cerr << "Could not write save state " << path << std::endl;
+        return;
+    }
+    std::cout << "Suspended " << currentActiveLevel->GetName() << " to " << path << " in "
+              << std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() << " ms" << std::endl;
+}
+
+const uint64_t SOAK_WINDOW_FRAMES = 60 * 60 * 30; // Half an hour of simulated play per report line
+const int SOAK_MAX_PROBLEM_REPORTS = 10;         // Problems printed in full; the rest are only counted
+
+// Bytes of the process resident in memory, 0 where we can't tell
+size_t ResidentBytes() {
+#ifdef __linux__
+    long totalPages = 0, residentPages = 0;
+    FILE* statm = std::fopen("/proc/self/statm", "r");
+    if (!statm) return 0;
+    if (std::fscanf(statm, "%ld %ld", &totalPages, &residentPages) != 2) residentPages = 0;
+    std::fclose(statm);
+    return (size_t)residentPages * (size_t)sysconf(_SC_PAGESIZE);
+#else
+    return 0;
+#endif
+}
+
+// What one report window of a soak run saw
+struct SoakWindow {
+    uint64_t frames = 0;
+    double frameMicros = 0.0; // Summed over the window
+    double maxFrameMicros = 0.0;
+    size_t levelArenaBytes = 0; // Largest level arena reservation seen
+    size_t residentBytes = 0;   // At the end of the window
+    int64_t liveHeapBytes = 0;  // At the end of the window; BAKRA_MEMORY_TRACKING only
+    int levelsWon = 0, levelsLost = 0, levelsTimedOut = 0, gamesWon = 0;
+
+    double AverageMicros() const { return frames ? frameMicros / frames : 0.0; }
+};
+
+// Input that clicks through the title, transition and end screens. Levels get their bot's
+// input instead while autoplaying, see BotInput.
+input::InputState UnattendedMenuInput() {
+    input::InputState menuInput;
+    if (currentGlobalScreen == TITLE_SCREEN_GLOBAL) {
+        input::Click(menuInput, escapeButton);
+    } else if (currentGlobalScreen == LEVEL_TRANSITION && levelPreloader.IsReady()) {
+        input::Click(menuInput, confirmButton);
+    } else if (currentGlobalScreen == GAME_OVER_GLOBAL || currentGlobalScreen == GAME_WON_GLOBAL) {
+        input::Press(menuInput, KEY_ENTER);
+    }
+    return menuInput;
+}
+
+// Plays the real game loop headless for 'frames' steps with every level played by its bot:
+// the title, transition and end screens are clicked through, games restart as they end,
+// and a level its bot hasn't finished after BATCH_MAX_STEPS_PER_LEVEL steps sends the game
+// back to the title. After every step the level's invariants and the recorded frame are
+// checked. Prints a line per window and how frame time and memory moved over the run.
+int RunSoak(uint64_t frames) {
+    renderJobs.SetRenderThread(); // Level uploads run here between steps
+    std::ostream report(std::cout.rdbuf());
+    std::streambuf* gameLog = std::cout.rdbuf(nullptr); // The game logs every level change; far too chatty here
+    autoplay = true;
+
+    gfx::RenderSnapshot snapshot;
+    gfx::NullBackend backend;
+    std::vector<SoakWindow> windows;
+    windows.reserve((size_t)(frames / SOAK_WINDOW_FRAMES + 1)); // Up front, so steady-state frames stay off the heap
+    SoakWindow window;
+    uint64_t problems = 0;
+    int stepsInLevel = 0; // For spotting a stuck bot; the global levelSteps is what gets scored
+    auto problem = [&](uint64_t frame, const char* what, const char* detail) {
+        if (problems++ < SOAK_MAX_PROBLEM_REPORTS) {
+            report << "frame " << frame << " (" << (currentActiveLevel ? currentActiveLevel->GetName() : "menus") << "): "
+                   << what << " " << detail << std::endl;
+        }
+    };
+
+    auto start = std::chrono::steady_clock::now();
+    for (uint64_t frame = 0; frame < frames; ++frame) {
+        input::InputState menuInput = UnattendedMenuInput();
+        bool wasPlaying = currentGlobalScreen == PLAYING_LEVEL;
+        auto stepStart = std::chrono::steady_clock::now();
+        SimulateFrame(menuInput, SIM_TIME_STEP, snapshot);
+        backend.BeginFrame();
+        snapshot.drawList.Submit(backend);
+        renderJobs.Run(PRELOAD_UPLOAD_BUDGET_SECONDS);
+        double micros = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - stepStart).count();
+        window.frameMicros += micros;
+        window.maxFrameMicros = std::max(window.maxFrameMicros, micros);
+        ++window.frames;
+
+        if (backend.InvalidCount() != 0) problem(frame, "invalid draw:", backend.FirstProblem());
+        if (currentGlobalScreen == PLAYING_LEVEL && currentActiveLevel) {
+            if (const char* broken = currentActiveLevel->CheckInvariants()) problem(frame, "invariant broken:", broken);
+            window.levelArenaBytes = std::max(window.levelArenaBytes, currentActiveLevel->Arena().BytesReserved());
+            if (++stepsInLevel > BATCH_MAX_STEPS_PER_LEVEL) { // The bot is stuck; start over
+                ++window.levelsTimedOut;
+                currentActiveLevel->Unload();
+                currentActiveLevel = nullptr;
+                currentGlobalScreen = TITLE_SCREEN_GLOBAL;
+            }
+        } else if (wasPlaying) { // The level just ended
+            if (currentGlobalScreen == GAME_OVER_GLOBAL) ++window.levelsLost;
+            else ++window.levelsWon;
+            if (currentGlobalScreen == GAME_WON_GLOBAL) ++window.gamesWon;
+        }
+        if (currentGlobalScreen != PLAYING_LEVEL) stepsInLevel = 0;
+
+        if (window.frames == SOAK_WINDOW_FRAMES || frame + 1 == frames) {
+            window.residentBytes = ResidentBytes();
+#ifdef BAKRA_MEMORY_TRACKING
+            window.liveHeapBytes = memtrack::g_totalLiveBytes.load();
+#endif
+            report << "frames " << frame + 1 - window.frames << "-" << frame + 1 << ": " << window.AverageMicros() << " us/frame (max "
+                   << window.maxFrameMicros << "), levels won " << window.levelsWon << ", lost " << window.levelsLost << ", timed out "
+                   << window.levelsTimedOut << ", games won " << window.gamesWon << ", level arena " << window.levelArenaBytes / 1024
+                   << " KB, resident " << window.residentBytes / 1024 << " KB";
+#ifdef BAKRA_MEMORY_TRACKING
+            report << ", live heap " << window.liveHeapBytes / 1024 << " KB";
+#endif
+            report << std::endl;
+            windows.push_back(window);
+            window = SoakWindow();
+        }
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    if (!windows.empty()) {
+        const SoakWindow& first = windows.front();
+        const SoakWindow& last = windows.back();
+        report << frames << " frames (" << frames / 60.0 / 3600.0 << " simulated hours) in " << seconds << " s, " << problems << " problems" << std::endl;
+        report << "frame time drift: " << first.AverageMicros() << " -> " << last.AverageMicros() << " us/frame" << std::endl;
+        report << "memory drift: resident " << ((int64_t)last.residentBytes - (int64_t)first.residentBytes) / 1024 << " KB";
+#ifdef BAKRA_MEMORY_TRACKING
+        report << ", live heap " << (last.liveHeapBytes - first.liveHeapBytes) / 1024 << " KB";
+#endif
+        report << " (first window to last)" << std::endl;
+    }
+
+    levelPreloader.Cancel();
+    if (currentActiveLevel) {
+        currentActiveLevel->Unload();
+        currentActiveLevel = nullptr;
+    }
+    levelBot.reset();
+    autoplay = false;
+    std::cout.rdbuf(gameLog);
+    return problems == 0 ? 0 : 1;
+}
+
+// Watches a game started with --broadcast 'port' on this machine, in a window. Keeps trying
+// to connect until the game is there, and again after it goes away.
+int RunSpectator(uint16_t port) {
+    InitWindow(GLOBAL_SCREEN_WIDTH, GLOBAL_SCREEN_HEIGHT, "");
+    SetTargetFPS(60);
+    LoadSpriteAtlas();
+    gfx::spriteAtlas.Upload();
+    spectate::Viewer viewer;
+    gfx::DrawList frame;
+    gfx::ScreenBackend screen;
+    double nextAttempt = 0.0;
+    while (!WindowShouldClose()) {
+        if (!viewer.Connected() && GetTime() >= nextAttempt) {
+            viewer.Connect(port);
+            nextAttempt = GetTime() + 1.0;
+        }
+        const char* status = nullptr;
+        if (!viewer.Poll()) {
+            status = viewer.Error() ? viewer.Error() : mem::ScratchFormat("Waiting for a game broadcasting on port %u...", (unsigned)port);
+        } else if (!viewer.State().Synced()) {
+            status = "Waiting for the first frame...";
+        }
+
+        frame.Clear();
+        if (viewer.State().Synced()) viewer.Draw(frame);
+        else frame.ClearBackground(BLACK);
+        if (status) {
+            frame.SetLayer(gfx::Layer::HUD);
+            frame.DrawText(status, GLOBAL_SCREEN_WIDTH / 2 - MeasureText(status, 25) / 2, 20, 25, YELLOW);
+        }
+        frame.Sort();
+        BeginDrawing();
+        frame.Submit(screen);
+        EndDrawing();
+        mem::ResetFrameArena();
+    }
+    gfx::spriteAtlas.Unload();
+    CloseWindow();
+    return 0;
+}
+
+const int SPECTATE_CHECK_VIEWERS = 2;
+const double SPECTATE_CHECK_DRAIN_SECONDS = 3.0; // For the viewers to catch up at the end
+
+// How one viewer of RunSpectateCheck got on
+struct SpectateViewerResult {
+    const char* error = nullptr;
+    uint64_t frames = 0;
+    uint64_t keyframes = 0;
+    uint64_t verified = 0;
+    uint64_t mismatches = 0;
+    bool caughtUp = false; // Had the game's last frame at the end
+};
+
+// Plays the real game loop headless at 60 Hz for 'frames' steps, with bots, while broadcasting
+// to viewers on other threads: one watches from the start and one joins halfway. Every frame
+// carries a checksum, and the viewers check that decoding it and recording it again give the
+// same frame. Reports bandwidth and what publishing costs the simulation step.
+int RunSpectateCheck(uint32_t frames) {
+    renderJobs.SetRenderThread();
+    std::ostream report(std::cout.rdbuf());
+    std::streambuf* gameLog = std::cout.rdbuf(nullptr);
+    autoplay = true;
+
+    spectatorBroadcast.SendChecksums(true);
+    if (!spectatorBroadcast.Start(0)) {
+        report << "Can't listen on a loopback port" << std::endl;
+        std::cout.rdbuf(gameLog);
+        return 1;
+    }
+    const uint16_t port = spectatorBroadcast.Port();
+    std::atomic<uint32_t> gameFrame(0);
+    std::atomic<uint32_t> lastFrame(0); // Set at the end: the frame viewers must get to
+    std::atomic<bool> stop(false);
+    SpectateViewerResult results[SPECTATE_CHECK_VIEWERS];
+    auto watch = [&](uint32_t joinAt, SpectateViewerResult& result) {
+        while (gameFrame.load() < joinAt && !stop.load()) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        spectate::Viewer viewer;
+        viewer.VerifyFrames(true);
+        if (!viewer.Connect(port)) {
+            result.error = "couldn't connect";
+            return;
+        }
+        while (!stop.load()) {
+            if (!viewer.Poll()) {
+                result.error = viewer.Error();
+                break;
+            }
+            uint32_t last = lastFrame.load();
+            if (last != 0 && viewer.State().Synced() && viewer.State().FrameNumber() == last) {
+                result.caughtUp = true;
+                break;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        result.frames = viewer.FramesReceived();
+        result.keyframes = viewer.KeyframesReceived();
+        result.verified = viewer.FramesVerified();
+        result.mismatches = viewer.Mismatches();
+    };
+    std::thread viewers[SPECTATE_CHECK_VIEWERS] = { std::thread(watch, 0u, std::ref(results[0])), std::thread(watch, frames / 2, std::ref(results[1])) };
+
+    gfx::RenderSnapshot snapshot;
+    auto tick = std::chrono::microseconds(16667);
+    auto nextTick = std::chrono::steady_clock::now();
+    for (uint32_t frame = 0; frame < frames; ++frame) {
+        SimulateFrame(UnattendedMenuInput(), SIM_TIME_STEP, snapshot);
+        renderJobs.Run(PRELOAD_UPLOAD_BUDGET_SECONDS);
+        gameFrame.store(frame + 1);
+        nextTick += tick;
+        std::this_thread::sleep_until(nextTick);
+    }
+    // Keep publishing the last frame until both viewers have it; one may have been skipping frames
+    auto drainUntil = std::chrono::steady_clock::now() + std::chrono::duration<double>(SPECTATE_CHECK_DRAIN_SECONDS);
+    while (std::chrono::steady_clock::now() < drainUntil && !(results[0].caughtUp && results[1].caughtUp)) {
+        spectatorBroadcast.Publish(snapshot.drawList);
+        lastFrame.store(spectatorBroadcast.LastFrame());
+        std::this_thread::sleep_for(tick);
+    }
+    stop.store(true);
+    for (std::thread& viewer : viewers) viewer.join();
+
+    bool ok = spectatorBroadcast.LongestPublishSeconds() < SIM_TIME_STEP;
+    report << "Broadcast: " << frames << " frames, " << (double)spectatorBroadcast.BytesSent() / std::max<uint64_t>(1, spectatorBroadcast.FramesPublished())
+           << " bytes per frame to all viewers, publish " << spectatorBroadcast.AveragePublishSeconds() * 1e6 << " us per frame (longest "
+           << spectatorBroadcast.LongestPublishSeconds() * 1e3 << " ms), " << spectatorBroadcast.Keyframes() << " keyframes, "
+           << spectatorBroadcast.FramesSkipped() << " frames skipped for slow viewers" << std::endl;
+    for (int i = 0; i < SPECTATE_CHECK_VIEWERS; ++i) {
+        const SpectateViewerResult& result = results[i];
+        bool viewerOk = !result.error && result.caughtUp && result.mismatches == 0 && result.verified > 0;
+        report << "Viewer " << i + 1 << " (joined at frame " << (i == 0 ? 0 : frames / 2) << "): " << result.frames << " frames, "
+               << result.keyframes << " keyframes, " << result.verified << " verified, " << result.mismatches << " mismatched"
+               << (result.error ? ", " : "") << (result.error ? result.error : "") << (result.caughtUp ? "" : ", DIDN'T CATCH UP") << std::endl;
+        ok = ok && viewerOk;
+    }
+
+    spectatorBroadcast.Stop();
+    spectatorBroadcast.SendChecksums(false);
+    levelPreloader.Cancel();
+    if (currentActiveLevel) {
+        currentActiveLevel->Unload();
+        currentActiveLevel = nullptr;
+    }
+    levelBot.reset();
+    autoplay = false;
+    std::cout.rdbuf(gameLog);
+    return ok ? 0 : 1;
+}
+
+// Main game loop and state management.
+// By default the simulation runs on its own thread at a fixed step and hands recorded frames
+// to the main thread through a triple buffer; --single-thread runs both in one loop instead.
+int main(int argc, char** argv) {
+    startup::profile.Mark("static initializers");
+    SavedComponentLayout(); // Fixes the ids of saved component types before anything else uses them
+
+    // Headless modes need no window
+    int batchSessions = 0;
+    unsigned batchThreads = std::thread::hardware_concurrency();
+    uint32_t batchSeed = 1;
+    for (int i = 1; i + 1 < argc; ++i) {
+        if (std::strcmp(argv[i], "--golden-record") == 0) return RunGoldenImages(argv[i + 1], true);
+        if (std::strcmp(argv[i], "--golden-check") == 0) return RunGoldenImages(argv[i + 1], false);
+        if (std::strcmp(argv[i], "--bake-atlas") == 0) return BakeSpriteAtlas(argv[i + 1]);
+        if (std::strcmp(argv[i], "--batch") == 0) batchSessions = std::atoi(argv[i + 1]);
+        if (std::strcmp(argv[i], "--threads") == 0) batchThreads = (unsigned)std::max(1, std::atoi(argv[i + 1]));
+        if (std::strcmp(argv[i], "--seed") == 0) batchSeed = (uint32_t)std::strtoul(argv[i + 1], nullptr, 10);
+    }
+    bool batchBots = false;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--bench-rng") == 0) return RunRngBenchmark();
+        if (std::strcmp(argv[i], "--atlas-check") == 0) return RunAtlasCheck();
+        if (std::strcmp(argv[i], "--bots") == 0) batchBots = true;
+        if (std::strcmp(argv[i], "--soak") == 0 && i + 1 < argc) return RunSoak(std::max(1ull, std::strtoull(argv[i + 1], nullptr, 10)));
+        if (std::strcmp(argv[i], "--rewind-check") == 0 && i + 1 < argc) return RunRewindCheck(std::max(1, std::atoi(argv[i + 1])));
+        if (std::strcmp(argv[i], "--bench-save-state") == 0 && i + 1 < argc) return RunSaveStateBenchmark(argv[i + 1]);
+        if (std::strcmp(argv[i], "--bench-telemetry") == 0 && i + 1 < argc) return RunTelemetryBenchmark(argv[i + 1]);
+        if (std::strcmp(argv[i], "--audio-check") == 0 && i + 1 < argc) return RunAudioCheck(std::max(1, std::atoi(argv[i + 1])));
+        if (std::strcmp(argv[i], "--versus-check") == 0 && i + 1 < argc) return RunVersusCheck((uint32_t)std::max(1, std::atoi(argv[i + 1])), net::Session::Mode::LOCKSTEP);
+        if (std::strcmp(argv[i], "--race-check") == 0 && i + 1 < argc) return RunVersusCheck((uint32_t)std::max(1, std::atoi(argv[i + 1])), net::Session::Mode::ROLLBACK);
+        if (std::strcmp(argv[i], "--spectate-check") == 0 && i + 1 < argc) return RunSpectateCheck((uint32_t)std::max(2, std::atoi(argv[i + 1])));
+    }
+    if (batchSessions > 0) return RunBatchSimulation(batchSessions, batchThreads, batchSeed, batchBots);
+
+#ifdef BAKRA_NULL_RENDERER
+    // No window and no GPU: draw every level into the counting backend and report
+    int benchmarkFrames = 600;
+    for (int i = 1; i + 1 < argc; ++i) {
+        if (std::strcmp(argv[i], "--frames") == 0) benchmarkFrames = std::max(1, std::atoi(argv[i + 1]));
+    }
+    return RunDrawBenchmark(benchmarkFrames);
+#endif
+
+    bool singleThread = false;
+    const char* saveStatePath = nullptr; // Resumed from at startup, suspended to on exit
+    const char* scoresPath = "bakra_scores.log";
+    const char* telemetryPrefix = "bakra_telemetry"; // nullptr: off
+    int netLatencyMs = 0; // Added to versus and race packets, for trying them over a slow connection
+    int broadcastPort = -1; // Where spectators connect, with --broadcast
+    bool sound = true;
+    bool fastStart = false; // Title screen first, everything else after it is up
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--single-thread") == 0) singleThread = true;
+        if (std::strcmp(argv[i], "--autoplay") == 0) autoplay = true;
+        if (std::strcmp(argv[i], "--fixed-resolution") == 0) dynamicResolution = false;
+        if (std::strcmp(argv[i], "--no-frame-pacer") == 0) framePacing = false;
+        if (std::strcmp(argv[i], "--practice") == 0) practiceMode = true;
+        if (std::strcmp(argv[i], "--save-state") == 0 && i + 1 < argc) saveStatePath = argv[++i];
+        if (std::strcmp(argv[i], "--scores") == 0 && i + 1 < argc) scoresPath = argv[++i];
+        if (std::strcmp(argv[i], "--telemetry") == 0 && i + 1 < argc) telemetryPrefix = argv[++i];
+        if (std::strcmp(argv[i], "--no-telemetry") == 0) telemetryPrefix = nullptr;
+        if (std::strcmp(argv[i], "--no-audio") == 0) sound = false;
+        if (std::strcmp(argv[i], "--fast-start") == 0) fastStart = true;
+        if (std::strcmp(argv[i], "--startup-profile") == 0) startup::profile.SetVerbose(true);
+        if (std::strcmp(argv[i], "--latency") == 0 && i + 1 < argc) netLatencyMs = std::max(0, std::atoi(argv[++i]));
+        if (std::strcmp(argv[i], "--broadcast") == 0 && i + 1 < argc) broadcastPort = std::atoi(argv[++i]);
+        if (std::strcmp(argv[i], "--spectate") == 0 && i + 1 < argc) return RunSpectator((uint16_t)std::atoi(argv[i + 1]));
+    }
+    for (int i = 1; i + 2 < argc; ++i) {
+        if (std::strcmp(argv[i], "--versus") == 0) {
+            const char* level = i + 3 < argc && argv[i + 3][0] != '-' ? argv[i + 3] : "flappy";
+            return RunVersus((uint16_t)std::atoi(argv[i + 1]), (uint16_t)std::atoi(argv[i + 2]), level, net::Session::Mode::LOCKSTEP, netLatencyMs);
+        }
+        if (std::strcmp(argv[i], "--race") == 0) {
+            return RunVersus((uint16_t)std::atoi(argv[i + 1]), (uint16_t)std::atoi(argv[i + 2]), "flappy", net::Session::Mode::ROLLBACK, netLatencyMs);
+        }
+    }
+    if (broadcastPort >= 0 && !spectatorBroadcast.Start((uint16_t)broadcastPort)) {
+        std::cerr << "Can't broadcast on port " << broadcastPort << "; playing without spectators" << std::endl;
+    }
+    startup::profile.Mark("arguments and broadcast");
+
+    InitWindow(GLOBAL_SCREEN_WIDTH, GLOBAL_SCREEN_HEIGHT, ""); // Initialize the game window
+    SetTargetFPS(framePacing ? 0 : 60); // Aim for 60 frames per second; the frame pacer does its own waiting
+    renderJobs.SetRenderThread(); // The thread that owns the GL context
+    startup::profile.Mark("window");
+    if (dynamicResolution) sceneRenderer.Init(GLOBAL_SCREEN_WIDTH, GLOBAL_SCREEN_HEIGHT);
+    startup::profile.Mark("scene renderer");
+
+    // Nothing below is needed to draw the title screen. Each step runs on the thread that
+    // simulates, which attaches itself to what the step starts.
+    deferredStartup.Add("score log", [scoresPath]() { scoreStore.Open(scoresPath); });
+    if (telemetryPrefix) {
+        deferredStartup.Add("telemetry", [telemetryPrefix]() {
+            telemetryRecorder.Start(telemetryPrefix);
+            telemetryRecorder.Attach();
+        });
+    }
+    deferredStartup.Add("sprite atlas", []() {
+        LoadSpriteAtlas(); // From the binary, no files
+        renderJobs.RunAndWait([](double) { gfx::spriteAtlas.Upload(); return true; }); // Its one texture upload
+    });
+    if (sound) {
+        deferredStartup.Add("audio", []() {
+            InitAudioDevice();
+            if (audioSink.Open()) audioMixer.Start(audioSink);
+            else std::cerr << "No audio device; playing without sound" << std::endl;
+            audioMixer.Attach();
+        });
+    }
+    if (fastStart) {
+        deferredStartup.Add("first level preload", []() { // Builds and seeds it here, loads it on a worker
+            if (currentGlobalScreen == TITLE_SCREEN_GLOBAL && !levelPreloader.HasLevel()) {
+                levelPreloader.Start(GetLevelDescriptor(LEVEL_SEQUENCE[0]));
+            }
+        });
+    }
+    if (!fastStart) deferredStartup.Finish();
+
+    if (saveStatePath) ResumeFromSaveState(saveStatePath);
+    if (currentGlobalScreen != TITLE_SCREEN_GLOBAL) deferredStartup.Finish(); // Resumed straight into a level
+    startup::profile.Mark("save state");
+
+    if (singleThread) {
+        telemetryRecorder.Attach(); // This thread simulates
+        audioMixer.Attach();
+        while (!WindowShouldClose()) { // Loop while the window is open
+            gfx::RenderSnapshot& snapshot = renderSnapshots.WriteSlot();
+            input::InputState frameInput = SampleFrameInput(snapshot.inputSampledAt);
+            SimulateFrame(frameInput, GetFrameTime(), snapshot);
+            RenderFrame(snapshot);
+            deferredStartup.RunNext(); // Fast start only
+        }
+    } else {
+        std::atomic<bool> running(true);
+        std::atomic<bool> simulationDone(false);
+        std::thread simulation([&running, &simulationDone]() {
+            telemetryRecorder.Attach();
+            audioMixer.Attach();
+            auto step = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<float>(SIM_TIME_STEP));
+            auto nextStep = std::chrono::steady_clock::now();
+            while (running.load(std::memory_order_acquire)) {
+                gfx::RenderSnapshot& snapshot = renderSnapshots.WriteSlot();
+                SimulateFrame(inputMailbox.Take(&snapshot.inputSampledAt), SIM_TIME_STEP, snapshot);
+                renderSnapshots.Publish();
+                if (deferredStartup.Pending() && startup::profile.Presented()) deferredStartup.RunNext(); // Fast start only
+
+                nextStep += step;
+                auto now = std::chrono::steady_clock::now();
+                if (nextStep < now) nextStep = now; // Fell behind (e.g. a blocking load); don't try to catch up
+                // Step when the render thread posts a frame's input, if that is near the scheduled time.
+                // That phase-locks the steps to the frame pacer instead of leaving input waiting up to a step.
+                std::this_thread::sleep_until(nextStep - step / 4);
+                if (inputMailbox.WaitForPost(nextStep + step / 4)) nextStep = std::chrono::steady_clock::now();
+            }
+            telemetry::Recorder::Detach();
+            audio::Mixer::Detach();
+            simulationDone.store(true, std::memory_order_release);
+        });
+
+        while (!WindowShouldClose()) { // Loop while the window is open
+            std::chrono::steady_clock::time_point sampledAt;
+            input::InputState frameInput = SampleFrameInput(sampledAt);
+            inputMailbox.Post(frameInput, sampledAt);
+            RenderFrame(renderSnapshots.Read());
+        }
+
+        // The simulation may be waiting on a render job, so keep serving them until it stops
+        running.store(false, std::memory_order_release);
+        renderJobs.WaitFor(simulationDone);
+        simulation.join();
+    }
+    if (saveStatePath) SuspendToSaveState(saveStatePath);
+    telemetry::Recorder::Detach();
+    audio::Mixer::Detach();
+    scoreStore.Close(); // Anything still queued is written before we go
+    telemetryRecorder.Stop();
+    spectatorBroadcast.Stop();
+    audioMixer.Stop();
+    audioSink.Close();
+    if (IsAudioDeviceReady()) CloseAudioDevice();
+    // Clean up resources before closing the window
+    levelPreloader.Cancel();
+    if (currentActiveLevel) {
+        currentActiveLevel->Unload();
+    }
+
+    sceneRenderer.Shutdown();
+    gfx::spriteAtlas.Unload();
+    CloseWindow(); // Close the Raylib window
+    return 0;
+}
+
+
+// Draws the screen shown between levels
+void DrawLevelTransitionScreen(gfx::DrawList& out) {
+    out.DrawRectangle(0, 0, GLOBAL_SCREEN_WIDTH, GLOBAL_SCREEN_HEIGHT, Fade(BLACK, 0.8f)); // Dark overlay
+
+    // Display next level's name and instructions
+    const char* titleText = "Next Level: ";
+    int titleFontSize = 40;
+    int titleTextWidth = MeasureText(titleText, titleFontSize);
+    int nameTextWidth = MeasureText(nextLevelName, titleFontSize);
+    out.DrawText(titleText, GLOBAL_SCREEN_WIDTH / 2 - (titleTextWidth + nameTextWidth) / 2, GLOBAL_SCREEN_HEIGHT / 4, titleFontSize, RAYWHITE);
+    out.DrawText(nextLevelName, GLOBAL_SCREEN_WIDTH / 2 - (titleTextWidth + nameTextWidth) / 2 + titleTextWidth, GLOBAL_SCREEN_HEIGHT / 4, titleFontSize, GOLD);
+
+    // How it went last time, from the score log
+    const scores::Index::LevelStats& stats = scoreStore.View().Level(nextLevelType);
+    if (stats.wins != 0 || stats.deaths != 0) {
+        const char* statsText = stats.bestSteps != 0
+            ? mem::ScratchFormat("Best time: %.1f s   Escaped %u times   Caught %u times", stats.bestSteps * SIM_TIME_STEP, stats.wins, stats.deaths)
+            : mem::ScratchFormat("Never escaped   Caught %u times", stats.deaths);
+        out.DrawText(statsText, GLOBAL_SCREEN_WIDTH / 2 - MeasureText(statsText, 20) / 2, GLOBAL_SCREEN_HEIGHT / 4 + 55, 20, GRAY);
+    }
+
+    out.DrawText("How to Play:", GLOBAL_SCREEN_WIDTH / 2 - MeasureText("How to Play:", 30) / 2, GLOBAL_SCREEN_HEIGHT / 2 - 50, 30, RAYWHITE);
+    out.DrawText(nextLevelInstructions, GLOBAL_SCREEN_WIDTH / 2 - MeasureText(nextLevelInstructions, 25) / 2, GLOBAL_SCREEN_HEIGHT / 2, 25, LIGHTGRAY);
+
+    // "Ready!" button to proceed
+    out.DrawRectangleRec(confirmButton, DARKGREEN);
+    out.DrawRectangleLinesEx(confirmButton, 3, GREEN);
+    const char* buttonText = "Ready!";
+    int buttonTextWidth = MeasureText(buttonText, 30);
+    out.DrawText(buttonText, (int)(confirmButton.x + confirmButton.width / 2 - buttonTextWidth / 2), (int)(confirmButton.y + confirmButton.height / 2 - 15), 30, RAYWHITE);
+
+    // Small hint while the next level is still loading in the background
+    if (!levelPreloader.IsReady()) {
+        out.DrawText("Preparing level...", GLOBAL_SCREEN_WIDTH / 2 - MeasureText("Preparing level...", 20) / 2, (int)(confirmButton.y + confirmButton.height + 15), 20, GRAY);
+    }
+}
+
+// Draws the best runs from the score log as a table starting at 'top'
+void DrawBestRuns(gfx::DrawList& out, int top) {
+    const scores::Index& index = scoreStore.View();
+    const size_t shown = std::min(index.RunCount(), (size_t)5);
+    if (shown == 0) return;
+    out.DrawText("Best Runs", GLOBAL_SCREEN_WIDTH / 2 - MeasureText("Best Runs", 25) / 2, top, 25, GOLD);
+    for (size_t i = 0; i < shown; ++i) {
+        const scores::Record& run = index.Run(i);
+        const char* row = mem::ScratchFormat("%zu.  %5d points   %d/%zu levels   %.1f s%s", i + 1, run.score, run.levelsCleared,
+                                             LEVEL_SEQUENCE_LENGTH, run.steps * SIM_TIME_STEP, run.won ? "   escaped" : "");
+        out.DrawText(row, GLOBAL_SCREEN_WIDTH / 2 - MeasureText(row, 20) / 2, top + 35 + (int)i * 24, 20, LIGHTGRAY);
+    }
+}
+
+// Draws the screen when the player loses the entire game
+void DrawGlobalGameOverScreen(gfx::DrawList& out) {
+    out.DrawText("loser you got caught.", GLOBAL_SCREEN_WIDTH / 2 - MeasureText("GAME OVER!", 60) / 2, GLOBAL_SCREEN_HEIGHT / 2 - 50, 60, RED);
+    out.DrawText("Press ENTER to bribe & Try Again", GLOBAL_SCREEN_WIDTH / 2 - MeasureText("Press ENTER to Try Again", 30) / 2, GLOBAL_SCREEN_HEIGHT / 2 + 20, 30, WHITE);
+    DrawBestRuns(out, GLOBAL_SCREEN_HEIGHT / 2 + 80);
+}
+
+// Draws the screen when the player wins the entire game
+void DrawGlobalGameWonScreen(gfx::DrawList& out) {
+    out.DrawText("CONGRATULATIONS!", GLOBAL_SCREEN_WIDTH / 2 - MeasureText("CONGRATULATIONS!", 50) / 2, GLOBAL_SCREEN_HEIGHT / 2 - 80, 50, GOLD);
+    out.DrawText("You Escaped prison!", GLOBAL_SCREEN_WIDTH / 2 - MeasureText("You Escaped ALL Levels!", 40) / 2, GLOBAL_SCREEN_HEIGHT / 2 - 20, 40, LIME);
+    out.DrawText("Press ENTER to kidnap a bakra again!", GLOBAL_SCREEN_WIDTH / 2 - MeasureText("Press ENTER to Play Again", 30) / 2, GLOBAL_SCREEN_HEIGHT / 2 + 50, 30, WHITE);
+    DrawBestRuns(out, GLOBAL_SCREEN_HEIGHT / 2 + 110);
+}
+
+// Sets up the predefined order of levels for the game
+void SetupGameLevels() {
+    // Drop anything left over from a previous run; levels themselves are built on demand.
+    // A first level preloaded by a fast start is kept, and counts as taken from the sequence.
+    if (!levelPreloader.Holds(LEVEL_SEQUENCE[0])) levelPreloader.Cancel();
+    nextLevelIndex = levelPreloader.HasLevel() ? 1 : 0;
+    runScore = 0;
+    runSteps = 0;
+    runLevelsCleared = 0;
+}
+
+// Helper function to load the next level in the sequence
+void LoadNextLevel() {
+    // Unload the current level if one is active
+    if (currentActiveLevel) {
+        currentActiveLevel->Unload();
+        currentActiveLevel = nullptr; // Ensure proper deallocation
+    }
+    
+    // Use the level the preloader prepared during the transition screen, if any
+    if (levelPreloader.HasLevel()) {
+        currentLevelMemScope = levelPreloader.MemScope();
+        currentActiveLevel = levelPreloader.Take(); // Already loaded, no hitch
+        std::cout << "Starting preloaded Level: " << currentActiveLevel->GetName() << " (loaded in background in "
+                  << levelPreloader.LoadMilliseconds() << " ms)" << std::endl; // Debug output
+    }
+    // Otherwise, if there are more levels in the sequence, build and load the next one right now
+    else if (nextLevelIndex < LEVEL_SEQUENCE_LENGTH) {
+        const LevelDescriptor& descriptor = GetLevelDescriptor(LEVEL_SEQUENCE[nextLevelIndex++]);
+        currentLevelMemScope = memtrack::ScopeFor(descriptor.name);
+        {
+            memtrack::PhaseScope memScope(currentLevelMemScope, memtrack::PHASE_LOAD);
+            currentActiveLevel = descriptor.create(GLOBAL_SCREEN_WIDTH, GLOBAL_SCREEN_HEIGHT);
+        }
+        auto loadStart = std::chrono::steady_clock::now();
+        {
+            memtrack::PhaseScope memScope(currentLevelMemScope, memtrack::PHASE_LOAD);
+            currentActiveLevel->Load(); // Initialize the new level
+            Levels* level = currentActiveLevel.get();
+            int levelScope = currentLevelMemScope;
+            renderJobs.RunAndWait([level, levelScope](double budget) {
+                memtrack::PhaseScope scope(levelScope, memtrack::PHASE_LOAD);
+                return level->FinishLoad(budget);
+            });
+        }
+        double loadMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - loadStart).count();
+        std::cout << "Loading Level: " << currentActiveLevel->GetName() << " (" << loadMs << " ms, arena "
+                  << currentActiveLevel->Arena().BytesUsed() / 1024 << "/" << currentActiveLevel->Arena().BytesReserved() / 1024 << " KB)" << std::endl; // Debug output
+        std::cout << "Instructions: " << currentActiveLevel->GetInstructions() << std::endl; // Debug output
+    } else {
+        currentActiveLevel = nullptr; // No more levels left
+    }
+    levelSteps = 0;
+}